@@ -48,6 +48,53 @@ inline int lx_unlink(const char *fname)
 }
 
 
+enum {
+	LX_MFD_CLOEXEC       = 0x1,
+	LX_MFD_ALLOW_SEALING = 0x2,
+	LX_MFD_HUGETLB       = 0x4,
+
+	LX_F_ADD_SEALS    = 1033,
+	LX_F_SEAL_SEAL    = 0x1,
+	LX_F_SEAL_SHRINK  = 0x2,
+	LX_F_SEAL_GROW    = 0x4,
+
+	LX_ENOSYS = 38,
+};
+
+
+inline int lx_memfd_create(char const *name, unsigned flags)
+{
+#ifdef SYS_memfd_create
+	return lx_syscall(SYS_memfd_create, name, flags);
+#else
+	return -LX_ENOSYS;
+#endif
+}
+
+
+inline int lx_fcntl(int fd, int cmd, unsigned long arg)
+{
+	return lx_syscall(SYS_fcntl, fd, cmd, arg);
+}
+
+
+/**
+ * Allocate backing store of file
+ *
+ * The system call is provided on 64-bit platforms only because the 64-bit
+ * offset and length arguments are split into register pairs otherwise.
+ */
+inline int lx_fallocate(int fd, unsigned long offset, unsigned long len)
+{
+#ifdef _LP64
+	return lx_syscall(SYS_fallocate, fd, 0, offset, len);
+#else
+	(void)fd; (void)offset; (void)len;
+	return -LX_ENOSYS;
+#endif
+}
+
+
 /*******************************************************
  ** Functions used by core's rom-session support code **
  *******************************************************/
@@ -15,7 +15,9 @@
 #include <fcntl.h>
 
 /* Genode includes */
+#include <base/log.h>
 #include <base/snprintf.h>
+#include <util/arg_string.h>
 
 /* local includes */
 #include <ram_dataspace_factory.h>
@@ -33,18 +35,114 @@ using namespace Genode;
 
 static int ram_ds_cnt = 0;  /* counter for creating unique dataspace IDs */
 
-void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
+
+/**
+ * List of Unix environment variables, initialized by the startup code
+ */
+extern char **lx_environ;
+
+
+/**
+ * Return minimum size of dataspaces backed by huge pages
+ *
+ * Huge pages are used only if explicitly enabled by setting the
+ * environment variable 'GENODE_HUGE_PAGES' to the size threshold, e.g.,
+ * 'GENODE_HUGE_PAGES=4M'. The huge pages must be reserved in the
+ * hugetlb pool of the host beforehand.
+ *
+ * A dataspace backed by huge pages can be mapped only at 2 MiB-aligned
+ * offsets and addresses. An attachment with a kernel-chosen address and an
+ * aligned offset is enlarged to whole huge pages by the component's region
+ * map. Attachments at unaligned offsets, at fixed unaligned addresses, or
+ * into managed dataspaces fail. Hence, huge pages should be enabled only
+ * for scenarios whose components attach their large dataspaces as a whole,
+ * with the threshold chosen above the size of any dataspace attached
+ * otherwise.
+ */
+static size_t huge_page_threshold()
+{
+	struct Threshold
+	{
+		size_t value = 0;
+
+		Threshold()
+		{
+			for (char **curr = lx_environ; curr && *curr; curr++) {
+
+				Arg const arg = Arg_string::find_arg(*curr, "GENODE_HUGE_PAGES");
+				if (arg.valid())
+					value = arg.ulong_value(0);
+			}
+		}
+	};
+
+	static Threshold threshold;
+	return threshold.value;
+}
+
+
+enum { HUGE_PAGE_SIZE_LOG2 = 21 };
+
+
+static bool use_huge_pages(size_t size)
+{
+	size_t const huge_page_size = 1UL << HUGE_PAGE_SIZE_LOG2;
+
+	return huge_page_threshold()
+	    && size >= huge_page_threshold()
+	    && (size & (huge_page_size - 1)) == 0;
+}
+
+
+/**
+ * Create anonymous memory file of 'size' bytes
+ *
+ * \return file descriptor, or a negative value if the kernel lacks
+ *         support for memfd_create
+ */
+static int memfd_ram_ds(char const *name, size_t size)
+{
+	unsigned const flags = LX_MFD_CLOEXEC | LX_MFD_ALLOW_SEALING;
+
+	/*
+	 * Allocate huge pages eagerly. Otherwise, the exhaustion of the hugetlb
+	 * pool would surface as fault in the component accessing the dataspace.
+	 */
+	if (use_huge_pages(size)) {
+
+		int const fd = lx_memfd_create(name, flags | LX_MFD_HUGETLB);
+
+		if (fd >= 0) {
+			if (lx_ftruncate(fd, size) == 0 && lx_fallocate(fd, 0, size) == 0)
+				return fd;
+
+			lx_close(fd);
+		}
+		warning("huge pages unavailable for dataspace of ", size, " bytes");
+	}
+
+	int const fd = lx_memfd_create(name, flags);
+	if (fd < 0)
+		return fd;
+
+	lx_ftruncate(fd, size);
+	return fd;
+}
+
+
+/**
+ * Create file using a unique file name in the resource path
+ *
+ * This is the fallback for kernels w/o memfd_create.
+ */
+static int named_file_ram_ds(char const *name, size_t size)
 {
 	char fname[Linux_dataspace::FNAME_LEN];
 
-	/* create file using a unique file name in the resource path */
-	snprintf(fname, sizeof(fname), "%s/ds-%d", resource_path(), ram_ds_cnt++);
+	snprintf(fname, sizeof(fname), "%s/%s", resource_path(), name);
 	lx_unlink(fname);
 	int const fd = lx_open(fname, O_CREAT|O_RDWR|O_TRUNC|LX_O_CLOEXEC, S_IRWXU);
-	lx_ftruncate(fd, ds.size());
-
-	/* remember file descriptor in dataspace component object */
-	ds.fd(fd);
+	lx_ftruncate(fd, size);
 
 	/*
 	 * Wipe the file from the Linux file system. The kernel will still keep the
@@ -53,6 +151,30 @@ void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
 	 * w/o the right file descriptor won't be able to open and access the file.
 	 */
 	lx_unlink(fname);
+
+	return fd;
+}
+
+
+void Ram_dataspace_factory::_export_ram_ds(Dataspace_component &ds)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "ds-%d", ram_ds_cnt++);
+
+	/*
+	 * Back the dataspace by an anonymous memory file, which does not
+	 * involve the host file system. Seal the file size so that components
+	 * can neither shrink nor grow the dataspace via the file descriptor.
+	 */
+	int fd = memfd_ram_ds(name, ds.size());
+	if (fd >= 0)
+		lx_fcntl(fd, LX_F_ADD_SEALS,
+		         LX_F_SEAL_SHRINK | LX_F_SEAL_GROW | LX_F_SEAL_SEAL);
+	else
+		fd = named_file_ram_ds(name, ds.size());
+
+	/* remember file descriptor in dataspace component object */
+	ds.fd(fd);
 }
 
 
@@ -71,6 +71,22 @@ class Genode::Native_thread
 
 				bool _rpc_ep_exited = false;
 
+				/*
+				 * Persistent channels established by clients, each bound to
+				 * the RPC object it was established for
+				 */
+				struct Channel
+				{
+					Lx_sd         sd    { -1 };
+					unsigned long badge = 0;
+				};
+
+				enum { MAX_CHANNELS = 64 };
+
+				Channel _channels[MAX_CHANNELS] { };
+
+				void _remove_channels(unsigned long badge);
+
 				struct Control_function : Interface
 				{
 					virtual void execute() = 0;
@@ -100,6 +116,28 @@ class Genode::Native_thread
 
 				void free_rpc_cap(Native_capability);
 
+				/**
+				 * Register client channel for RPC object 'badge'
+				 *
+				 * The method must be called by the polling thread. On
+				 * success, the epoll instance takes the ownership of 'sd'.
+				 *
+				 * \return false if the channel could not be registered
+				 */
+				bool add_channel(Lx_sd sd, unsigned long badge);
+
+				/**
+				 * Look up RPC object a channel is bound to
+				 *
+				 * \return false if 'sd' is not a registered channel
+				 */
+				bool channel_badge(Lx_sd sd, unsigned long &badge) const;
+
+				/**
+				 * Unregister and close channel
+				 */
+				void remove_channel(Lx_sd);
+
 				/**
 				 * Flag RPC entrypoint as no longer in charge of dispatching
 				 */
@@ -107,6 +145,47 @@ class Genode::Native_thread
 
 		} epoll { };
 
+		/**
+		 * Persistent channels used by the thread as RPC client
+		 *
+		 * A channel is a connected socket pair. Its remote end is handed
+		 * to the server along with the first RPC call to a destination.
+		 * Subsequent calls to the same destination are transferred over the
+		 * channel and replied via the channel, which spares the creation and
+		 * transfer of a reply socket pair per call.
+		 */
+		struct Ipc_channels
+		{
+			enum { MAX = 8 };
+
+			struct Channel
+			{
+				/* reference to the destination keeps its socket in use */
+				Native_capability dst { };
+
+				Lx_sd dst_socket { -1 };
+
+				Lx_sd sd { -1 };
+
+				/* server refused the channel, use the regular protocol */
+				bool refused = false;
+
+				unsigned long last_use = 0;
+			};
+
+			Channel channels[MAX] { };
+
+			unsigned long use_count = 0;
+
+			~Ipc_channels()
+			{
+				for (Channel &channel : channels)
+					if (channel.sd.valid())
+						lx_close(channel.sd.value);
+			}
+
+		} ipc_channels { };
+
 		Native_thread() { }
 };
 
@@ -71,6 +71,10 @@ class Genode::Region_map_mmap : public Region_map, public Dataspace
 
 		/**
 		 * Map dataspace into local address space
+		 *
+		 * \param mapped_size  if not null, the mapping may be enlarged to
+		 *                     whole huge pages, see 'ram_dataspace_support.cc'
+		 *                     of core, and the actual size is returned
 		 */
 		void *_map_local(Dataspace_capability ds,
 		                 size_t               size,
@@ -79,7 +83,8 @@ class Genode::Region_map_mmap : public Region_map, public Dataspace
 		                 addr_t               local_addr,
 		                 bool                 executable,
 		                 bool                 overmap,
-		                 bool                 writeable);
+		                 bool                 writeable,
+		                 size_t              *mapped_size = nullptr);
 
 		/**
 		 * Determine size of dataspace
@@ -34,6 +34,11 @@ struct Genode::Rpc_destination
 	 */
 	bool foreign = true;
 
+	/*
+	 * Reply capability referring to a persistent channel of the client
+	 */
+	bool channel = false;
+
 	Rpc_destination(Lx_sd socket) : socket(socket) { }
 
 	bool valid() const { return socket.valid(); }
@@ -43,6 +48,9 @@ struct Genode::Rpc_destination
 	void print(Output &out) const
 	{
 		Genode::print(out, "socket=", socket, ",foreign=", foreign);
+
+		if (channel)
+			Genode::print(out, ",channel");
 	}
 };
 
@@ -67,6 +67,9 @@ struct Protocol_header
 	/* badge of invoked object (on call) / exception code (on reply) */
 	unsigned long protocol_word;
 
+	/* 'REQUEST_CHANNEL' (on call) / 'CHANNEL_ACCEPTED' (on reply) */
+	unsigned long flags;
+
 	Genode::size_t num_caps;
 
 	/* badges of the transferred capability arguments */
@@ -74,6 +77,8 @@ struct Protocol_header
 
 	enum { INVALID_BADGE = ~1UL };
 
+	enum { REQUEST_CHANNEL = 1, CHANNEL_ACCEPTED = 1 };
+
 	void *msg_start() { return &protocol_word; }
 };
 
@@ -94,6 +99,7 @@ static_assert((int)Protocol_header::INVALID_BADGE != (int)Rpc_obj_key::INVALID,
 enum {
 	LX_EINTR        = 4,
 	LX_EAGAIN       = 11,
+	LX_EPIPE        = 32,
 	LX_ECONNREFUSED = 111
 };
 
@@ -256,23 +262,25 @@ static void extract_sds_from_message(unsigned start_index,
 /**
  * Send reply to client
  */
-static inline void lx_reply(Lx_sd reply_socket, Rpc_exception_code exception_code,
+static inline void lx_reply(Rpc_destination reply_dst, Rpc_exception_code exception_code,
                             Genode::Msgbuf_base &snd_msgbuf)
 {
+	Lx_sd const reply_socket = reply_dst.socket;
 
 	Protocol_header &header = snd_msgbuf.header<Protocol_header>();
 
 	header.protocol_word = exception_code.value;
+	header.flags         = reply_dst.channel ? Protocol_header::CHANNEL_ACCEPTED : 0;
 
 	Message msg(header.msg_start(), sizeof(Protocol_header) + snd_msgbuf.data_size());
 
 	/* marshall capabilities to be transferred to the client */
 	insert_sds_into_message(msg, header, snd_msgbuf);
 
-	int const ret = lx_sendmsg(reply_socket, msg.msg(), 0);
+	int const ret = lx_sendmsg(reply_socket, msg.msg(), MSG_NOSIGNAL);
 
 	/* ignore reply send error caused by disappearing client */
-	if (ret >= 0 || ret == -LX_ECONNREFUSED)
+	if (ret >= 0 || ret == -LX_ECONNREFUSED || ret == -LX_EPIPE)
 		return;
 
 	if (ret < 0)
@@ -285,6 +293,126 @@ static inline void lx_reply(Lx_sd reply_socket, Rpc_exception_code exception_cod
  ** IPC client **
  ****************/
 
+namespace {
+
+	using Ipc_channel = Native_thread::Ipc_channels::Channel;
+
+	void close_ipc_channel(Ipc_channel &channel)
+	{
+		if (channel.sd.valid())
+			lx_close(channel.sd.value);
+
+		channel.sd = Lx_sd::invalid();
+	}
+
+	/**
+	 * Return channel of the calling thread to the destination 'dst'
+	 *
+	 * If the thread has no channel to 'dst' yet, the least recently used
+	 * channel slot is assigned to 'dst'. The channel of such a slot is
+	 * established along with the next regular call.
+	 *
+	 * \return nullptr if the caller is not a Genode thread
+	 */
+	Ipc_channel *ipc_channel(Native_capability const &dst, Lx_sd dst_socket)
+	{
+		Thread * const myself_ptr = Thread::myself();
+		if (!myself_ptr)
+			return nullptr;
+
+		Native_thread::Ipc_channels &channels = myself_ptr->native_thread().ipc_channels;
+
+		Ipc_channel *lru_ptr = &channels.channels[0];
+
+		for (Ipc_channel &channel : channels.channels) {
+
+			if (channel.dst_socket.value == dst_socket.value) {
+				channel.last_use = ++channels.use_count;
+				return &channel;
+			}
+
+			if (channel.last_use < lru_ptr->last_use)
+				lru_ptr = &channel;
+		}
+
+		close_ipc_channel(*lru_ptr);
+
+		*lru_ptr = Ipc_channel { .dst        = dst,
+		                         .dst_socket = dst_socket,
+		                         .sd         = Lx_sd::invalid(),
+		                         .refused    = false,
+		                         .last_use   = ++channels.use_count };
+		return lru_ptr;
+	}
+
+	struct Reply_message : Message
+	{
+		Reply_message(Msgbuf_base &rcv_msgbuf)
+		:
+			Message(rcv_msgbuf.header<Protocol_header>().msg_start(),
+			        sizeof(Protocol_header) + rcv_msgbuf.capacity())
+		{
+			rcv_msgbuf.header<Protocol_header>().protocol_word = 0;
+			rcv_msgbuf.reset();
+
+			accept_sockets(MAX_SDS_PER_MSG);
+		}
+	};
+}
+
+
+enum class Channel_call_result { OK, SEND_FAILED, RECEIVE_FAILED };
+
+
+/**
+ * Perform RPC call via an established channel
+ *
+ * \return SEND_FAILED if the channel was closed by the server before the
+ *         request was sent, RECEIVE_FAILED if the channel was closed after
+ *         the request was sent
+ * \throw  Blocking_canceled
+ */
+static Channel_call_result channel_call(Ipc_channel &channel,
+                         Msgbuf_base &snd_msgbuf, Msgbuf_base &rcv_msgbuf,
+                         Rpc_exception_code &result)
+{
+	Protocol_header &snd_header = snd_msgbuf.header<Protocol_header>();
+	snd_header.protocol_word = 0;
+	snd_header.flags         = 0;
+
+	Message snd_msg(snd_header.msg_start(),
+	                sizeof(Protocol_header) + snd_msgbuf.data_size());
+
+	insert_sds_into_message(snd_msg, snd_header, snd_msgbuf);
+
+	if (lx_sendmsg(channel.sd, snd_msg.msg(), MSG_NOSIGNAL) < 0)
+		return Channel_call_result::SEND_FAILED;
+
+	Reply_message rcv_msg(rcv_msgbuf);
+
+	int const recv_ret = lx_recvmsg(channel.sd, rcv_msg.msg(), 0);
+
+	/*
+	 * The reply to the canceled call may still arrive. Drop the channel to
+	 * prevent the reply from being mistaken for the reply of a later call.
+	 */
+	if (recv_ret == -LX_EINTR) {
+		close_ipc_channel(channel);
+		throw Genode::Blocking_canceled();
+	}
+
+	if (recv_ret <= 0)
+		return Channel_call_result::RECEIVE_FAILED;
+
+	Protocol_header const &rcv_header = rcv_msgbuf.header<Protocol_header>();
+
+	extract_sds_from_message(0, rcv_msg, rcv_header, rcv_msgbuf);
+
+	result = Rpc_exception_code(rcv_header.protocol_word);
+	return Channel_call_result::OK;
+}
+
+
 Rpc_exception_code Genode::ipc_call(Native_capability dst,
                                     Msgbuf_base &snd_msgbuf, Msgbuf_base &rcv_msgbuf,
                                     size_t)
@@ -294,8 +422,48 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 		sleep_forever();
 	}
 
+	Lx_sd const dst_socket = Capability_space::ipc_cap_data(dst).dst.socket;
+
+	Ipc_channel * const channel_ptr = ipc_channel(dst, dst_socket);
+
+	if (channel_ptr && channel_ptr->sd.valid()) {
+
+		Rpc_exception_code result { Rpc_exception_code::INVALID_OBJECT };
+
+		switch (channel_call(*channel_ptr, snd_msgbuf, rcv_msgbuf, result)) {
+
+		case Channel_call_result::OK:
+			return result;
+
+		case Channel_call_result::SEND_FAILED:
+
+			/*
+			 * The server closed the channel before receiving the request,
+			 * resort to the regular protocol for this destination.
+			 */
+			close_ipc_channel(*channel_ptr);
+			channel_ptr->refused = true;
+			break;
+
+		case Channel_call_result::RECEIVE_FAILED:
+
+			/*
+			 * The server may have processed the request already. Re-sending
+			 * the request could execute a non-idempotent RPC twice.
+			 */
+			error(lx_getpid(), ":", lx_gettid(), " channel to sd ", dst_socket,
+			      " closed before receiving the result");
+			close_ipc_channel(*channel_ptr);
+			channel_ptr->refused = true;
+			return Rpc_exception_code(Rpc_exception_code::INVALID_OBJECT);
+		}
+	}
+
+	bool const request_channel = channel_ptr && !channel_ptr->refused;
+
 	Protocol_header &snd_header = snd_msgbuf.header<Protocol_header>();
 	snd_header.protocol_word = 0;
+	snd_header.flags         = request_channel ? Protocol_header::REQUEST_CHANNEL : 0;
 
 	Message snd_msg(snd_header.msg_start(),
 	                sizeof(Protocol_header) + snd_msgbuf.data_size());
@@ -303,16 +471,19 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 	/*
 	 * Create reply channel
 	 *
-	 * The reply channel will be closed when leaving the scope of 'lx_call'.
+	 * The reply channel will be closed when leaving the scope of 'lx_call'
+	 * unless it is kept as persistent channel to the destination.
 	 */
 	struct Reply_channel : Lx_socketpair
 	{
+		Reply_channel(int type) : Lx_socketpair(type) { }
+
 		~Reply_channel()
 		{
 			if (local.value  != -1) lx_close(local.value);
 			if (remote.value != -1) lx_close(remote.value);
 		}
-	} reply_channel;
+	} reply_channel { request_channel ? SOCK_SEQPACKET : SOCK_DGRAM };
 
 	/* assemble message */
 
@@ -322,8 +493,6 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 	/* marshal capabilities contained in 'snd_msgbuf' */
 	insert_sds_into_message(snd_msg, snd_header, snd_msgbuf);
 
-	Lx_sd const dst_socket = Capability_space::ipc_cap_data(dst).dst.socket;
-
 	int const send_ret = lx_sendmsg(dst_socket, snd_msg.msg(), 0);
 	if (send_ret < 0) {
 		error(lx_getpid(), ":", lx_gettid(), " lx_sendmsg to sd ", dst_socket,
@@ -332,14 +501,8 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 	}
 
 	/* receive reply */
-	Protocol_header &rcv_header = rcv_msgbuf.header<Protocol_header>();
-	rcv_header.protocol_word = 0;
+	Reply_message rcv_msg(rcv_msgbuf);
 
-	Message rcv_msg(rcv_header.msg_start(),
-	                sizeof(Protocol_header) + rcv_msgbuf.capacity());
-	rcv_msg.accept_sockets(Message::MAX_SDS_PER_MSG);
-
-	rcv_msgbuf.reset();
 	int const recv_ret = lx_recvmsg(reply_channel.local, rcv_msg.msg(), 0);
 
 	/* system call got interrupted by a signal */
@@ -351,8 +514,20 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 		sleep_forever();
 	}
 
+	Protocol_header const &rcv_header = rcv_msgbuf.header<Protocol_header>();
+
 	extract_sds_from_message(0, rcv_msg, rcv_header, rcv_msgbuf);
 
+	/* keep local end of the reply channel as persistent channel */
+	if (request_channel) {
+		if (rcv_header.flags & Protocol_header::CHANNEL_ACCEPTED) {
+			channel_ptr->sd     = reply_channel.local;
+			reply_channel.local = Lx_sd::invalid();
+		} else {
+			channel_ptr->refused = true;
+		}
+	}
+
 	return Rpc_exception_code(rcv_header.protocol_word);
 }
 
@@ -364,9 +539,9 @@ Rpc_exception_code Genode::ipc_call(Native_capability dst,
 void Genode::ipc_reply(Native_capability caller, Rpc_exception_code exc,
                        Msgbuf_base &snd_msg)
 {
-	Lx_sd const reply_socket = Capability_space::ipc_cap_data(caller).dst.socket;
+	Rpc_destination const reply_dst = Capability_space::ipc_cap_data(caller).dst;
 
-	try { lx_reply(reply_socket, exc, snd_msg); } catch (Ipc_error) { }
+	try { lx_reply(reply_dst, exc, snd_msg); } catch (Ipc_error) { }
 }
 
 
@@ -377,7 +552,7 @@ Rpc_request Genode::ipc_reply_wait(Reply_capability const &last_caller,
 {
 	/* when first called, there was no request yet */
 	if (last_caller.valid() && exc.value != Rpc_exception_code::INVALID_OBJECT)
-		lx_reply(Capability_space::ipc_cap_data(last_caller).dst.socket, exc, reply_msg);
+		lx_reply(Capability_space::ipc_cap_data(last_caller).dst, exc, reply_msg);
 
 	/*
 	 * Block infinitely if called from the main thread. This may happen if the
@@ -395,6 +570,9 @@ Rpc_request Genode::ipc_reply_wait(Reply_capability const &last_caller,
 
 		Lx_sd const selected_sd = epoll.poll();
 
+		unsigned long channel_badge = 0;
+		bool const via_channel = epoll.channel_badge(selected_sd, channel_badge);
+
 		Protocol_header &header = request_msg.header<Protocol_header>();
 		Message msg(header.msg_start(), sizeof(Protocol_header) + request_msg.capacity());
 
@@ -403,6 +581,36 @@ Rpc_request Genode::ipc_reply_wait(Reply_capability const &last_caller,
 		request_msg.reset();
 		int const ret = lx_recvmsg(selected_sd, msg.msg(), 0x40);
 
+		if (via_channel) {
+
+			if (ret == -LX_EAGAIN)
+				continue;
+
+			/* channel got closed by the client */
+			if (ret <= 0) {
+				epoll.remove_channel(selected_sd);
+				continue;
+			}
+
+			/*
+			 * The reply capability refers to a duplicate of the channel
+			 * socket so that the reply capability can be released
+			 * independently from the channel.
+			 */
+			Rpc_destination reply_dst(Lx_sd { lx_dup(selected_sd.value) });
+			reply_dst.channel = true;
+
+			if (!reply_dst.valid()) {
+				warning("ipc_reply_wait: failed to obtain reply socket");
+				continue;
+			}
+
+			extract_sds_from_message(0, msg, header, request_msg);
+
+			return Rpc_request(Capability_space::import(reply_dst, Rpc_obj_key()),
+			                   channel_badge);
+		}
+
 		if (ret < 0)
 			continue;
 
@@ -411,13 +619,26 @@ Rpc_request Genode::ipc_reply_wait(Reply_capability const &last_caller,
 			continue;
 		}
 
-		Lx_sd const reply_socket = msg.socket_at_index(0);
+		Rpc_destination reply_dst(msg.socket_at_index(0));
+
+		/* register reply socket as persistent channel if requested */
+		if (header.flags & Protocol_header::REQUEST_CHANNEL) {
+
+			Lx_sd const channel_sd { lx_dup(reply_dst.socket.value) };
+
+			if (channel_sd.valid()) {
+				if (epoll.add_channel(channel_sd, selected_sd.value))
+					reply_dst.channel = true;
+				else
+					lx_close(channel_sd.value);
+			}
+		}
 
 		/* start at offset 1 to skip the reply channel */
 		extract_sds_from_message(1, msg, header, request_msg);
 
-		return Rpc_request(Capability_space::import(Rpc_destination(reply_socket),
-		                                            Rpc_obj_key()), selected_sd.value);
+		return Rpc_request(Capability_space::import(reply_dst, Rpc_obj_key()),
+		                   selected_sd.value);
 	}
 }
 
@@ -33,6 +33,10 @@ Native_thread::Epoll::Epoll()
 
 Native_thread::Epoll::~Epoll()
 {
+	for (Channel &channel : _channels)
+		if (channel.sd.valid())
+			remove_channel(channel.sd);
+
 	_remove(_control.local);
 
 	lx_close(_control.local.value);
@@ -79,7 +83,12 @@ Lx_sd Native_thread::Epoll::poll()
 
 		int const event_count = lx_epoll_wait(_epoll, events, 1, -1);
 
-		if ((event_count == 1) && (events[0].events == POLLIN)) {
+		/*
+		 * A hang-up is reported for a channel closed by the client. It is
+		 * handled by the caller, which observes the end of the channel
+		 * when receiving from it.
+		 */
+		if ((event_count == 1) && (events[0].events & (POLLIN | POLLHUP | POLLERR))) {
 
 			Lx_sd const sd { events[0].data.fd };
 
@@ -205,5 +214,60 @@ void Native_thread::Epoll::free_rpc_cap(Native_capability cap)
 {
 	int const local_socket = Capability_space::ipc_cap_data(cap).rpc_obj_key.value();
 
-	_exec_control([&] () { _remove(Lx_sd{local_socket}); });
+	_exec_control([&] () {
+		_remove(Lx_sd{local_socket});
+		_remove_channels((unsigned long)local_socket);
+	});
+}
+
+
+bool Native_thread::Epoll::add_channel(Lx_sd sd, unsigned long badge)
+{
+	for (Channel &channel : _channels) {
+
+		if (channel.sd.valid())
+			continue;
+
+		try { _add(sd); } catch (Epoll_error) { return false; }
+
+		channel = Channel { .sd = sd, .badge = badge };
+		return true;
+	}
+	return false;
+}
+
+
+bool Native_thread::Epoll::channel_badge(Lx_sd sd, unsigned long &badge) const
+{
+	for (Channel const &channel : _channels) {
+		if (channel.sd.value == sd.value && channel.sd.valid()) {
+			badge = channel.badge;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+void Native_thread::Epoll::remove_channel(Lx_sd sd)
+{
+	for (Channel &channel : _channels) {
+
+		if (channel.sd.value != sd.value || !channel.sd.valid())
+			continue;
+
+		try { _remove(sd); } catch (Epoll_error) { }
+
+		lx_close(sd.value);
+		channel = Channel { };
+		return;
+	}
+}
+
+
+void Native_thread::Epoll::_remove_channels(unsigned long badge)
+{
+	for (Channel &channel : _channels)
+		if (channel.sd.valid() && channel.badge == badge)
+			remove_channel(channel.sd);
 }
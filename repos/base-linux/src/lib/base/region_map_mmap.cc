@@ -117,6 +117,19 @@ addr_t Region_map_mmap::_reserve_local(bool           use_local_addr,
 }
 
 
+/*
+ * RAM dataspaces may be backed by huge pages (see 'GENODE_HUGE_PAGES' in
+ * core). Such a dataspace can be mapped only at offsets, sizes, and
+ * addresses aligned to the huge-page size. Otherwise, mmap fails with
+ * EINVAL.
+ */
+enum { LX_EINVAL = 22, HUGE_PAGE_SIZE_LOG2 = 21 };
+
+
+static bool huge_page_aligned(addr_t value) {
+	return (value & ((1UL << HUGE_PAGE_SIZE_LOG2) - 1)) == 0; }
+
+
 void *Region_map_mmap::_map_local(Dataspace_capability ds,
                                   Genode::size_t       size,
                                   addr_t               offset,
@@ -124,7 +137,8 @@ void *Region_map_mmap::_map_local(Dataspace_capability ds,
                                   addr_t               local_addr,
                                   bool                 executable,
                                   bool                 overmap,
-                                  bool                 writeable)
+                                  bool                 writeable,
+                                  size_t              *mapped_size)
 {
 	int  const  fd        = _dataspace_fd(ds);
 	bool const  writable  = _dataspace_writable(ds) && writeable;
@@ -134,7 +148,27 @@ void *Region_map_mmap::_map_local(Dataspace_capability ds,
 	                      | (writable   ? PROT_WRITE : 0)
 	                      | (executable ? PROT_EXEC  : 0);
 	void * const addr_in  = use_local_addr ? (void*)local_addr : 0;
-	void * const addr_out = lx_mmap(addr_in, size, prot, flags, fd, offset);
+	void *       addr_out = lx_mmap(addr_in, size, prot, flags, fd, offset);
+
+	/*
+	 * A huge-page backed dataspace attached at an aligned offset and a
+	 * kernel-chosen address can be mapped if the size is rounded up to
+	 * whole huge pages, which never exceeds the dataspace.
+	 */
+	if ((long)addr_out == -LX_EINVAL && mapped_size && !use_local_addr
+	 && huge_page_aligned(offset) && !huge_page_aligned(size)) {
+
+		size_t const aligned_size = align_addr(size, HUGE_PAGE_SIZE_LOG2);
+
+		if (offset + aligned_size <= _dataspace_size(ds)) {
+			addr_out = lx_mmap(addr_in, aligned_size, prot, flags, fd, offset);
+			if (((long)addr_out >= 0) || ((long)addr_out <= -4095))
+				size = aligned_size;
+		}
+	}
+
+	if (mapped_size)
+		*mapped_size = size;
 
 	/*
 	 * We can close the file after calling mmap. The Linux kernel will still
@@ -153,6 +187,11 @@ void *Region_map_mmap::_map_local(Dataspace_capability ds,
 		error("_map_local: lx_mmap failed"
 		      "(addr_in=", addr_in, ", addr_out=", addr_out, "/", (long)addr_out, ") "
 		      "overmap=", overmap);
+
+		if ((long)addr_out == -LX_EINVAL
+		 && !(huge_page_aligned(offset) && huge_page_aligned(local_addr)))
+			error("_map_local: dataspaces backed by huge pages must be "
+			      "attached at 2 MiB-aligned offsets and addresses");
 		throw Region_map::Region_conflict();
 	}
 
@@ -307,10 +346,13 @@ Region_map::Local_addr Region_map_mmap::attach(Dataspace_capability ds,
 			 * Boring, a plain dataspace is attached to a root RM session.
 			 * Note, we do not overmap.
 			 */
+			size_t mapped_size = region_size;
+
 			void *addr = _map_local(ds, region_size, offset, use_local_addr,
-			                        local_addr, executable, false, writeable);
+			                        local_addr, executable, false, writeable,
+			                        &mapped_size);
 
-			_add_to_rmap(Region((addr_t)addr, offset, ds, region_size));
+			_add_to_rmap(Region((addr_t)addr, offset, ds, mapped_size));
 
 			return addr;
 		}
@@ -218,12 +218,12 @@ struct Lx_socketpair
 	Lx_sd local  { -1 };
 	Lx_sd remote { -1 };
 
-	Lx_socketpair()
+	explicit Lx_socketpair(int type = SOCK_DGRAM)
 	{
 		int sd[2];
 		sd[0] = -1; sd[1] = -1;
 
-		int const ret = lx_socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, sd);
+		int const ret = lx_socketpair(AF_UNIX, type | SOCK_CLOEXEC, 0, sd);
 		if (ret < 0) {
 			Genode::raw(lx_getpid(), ":", lx_gettid(), " lx_socketpair failed with ", ret);
 			Genode::sleep_forever();
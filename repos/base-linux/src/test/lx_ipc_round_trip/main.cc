@@ -0,0 +1,163 @@
+/*
+ * \brief  Microbenchmark for the round-trip time of RPCs
+ * \author Pirmin Duss
+ * \date   2020-10-23
+ *
+ * The benchmark measures the time of RPC round trips to an entrypoint of
+ * the same component, with and without capability arguments, and to the
+ * timer, which is a separate component.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/log.h>
+#include <base/rpc_client.h>
+#include <base/rpc_server.h>
+#include <base/thread.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+
+	using namespace Genode;
+
+	struct Session;
+	struct Client;
+	struct Component;
+	struct Benchmark;
+	struct Main;
+}
+
+
+struct Test::Session : Genode::Session
+{
+	static const char *service_name() { return "LX_IPC_ROUND_TRIP"; }
+
+	enum { CAP_QUOTA = 2 };
+
+	GENODE_RPC(Rpc_add, long, add, long, long);
+	GENODE_RPC(Rpc_cap, Native_capability, cap, Native_capability);
+	GENODE_RPC_INTERFACE(Rpc_add, Rpc_cap);
+};
+
+
+struct Test::Client : Rpc_client<Session>
+{
+	Client(Capability<Session> cap) : Rpc_client<Session>(cap) { }
+
+	long add(long a, long b) { return call<Rpc_add>(a, b); }
+
+	Native_capability cap(Native_capability cap) { return call<Rpc_cap>(cap); }
+};
+
+
+struct Test::Component : Rpc_object<Session, Component>
+{
+	long add(long a, long b) { return a + b; }
+
+	Native_capability cap(Native_capability cap) { return cap; }
+};
+
+
+/**
+ * Thread issuing the RPCs
+ *
+ * The calls are issued by a dedicated thread, which establishes its IPC
+ * channels on the first call to each destination.
+ */
+struct Test::Benchmark : Thread
+{
+	enum { ROUNDS = 100000, CAP_ROUNDS = 10000 };
+
+	Timer::Connection &_timer;
+	Client             _client;
+	Native_capability  _cap;
+
+	bool _failed = false;
+
+	Benchmark(Env &env, Timer::Connection &timer,
+	          Capability<Session> session_cap)
+	:
+		Thread(env, "benchmark", 8*1024*sizeof(long)),
+		_timer(timer), _client(session_cap), _cap(session_cap)
+	{ }
+
+	template <typename FN>
+	void _measure(char const *name, unsigned rounds, FN const &fn)
+	{
+		/* warm up, which also establishes the IPC channel */
+		fn(0);
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < rounds; i++)
+			fn(i);
+
+		uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+		log(name, ": ", rounds, " round trips in ", duration_us / 1000, " ms, ",
+		    (duration_us * 1000) / rounds, " ns per round trip");
+	}
+
+	void entry() override
+	{
+		_measure("local RPC", ROUNDS, [&] (unsigned i) {
+			if (_client.add(i, 1) != (long)i + 1)
+				_failed = true; });
+
+		_measure("local RPC with capability", CAP_ROUNDS, [&] (unsigned) {
+			if (!(_client.cap(_cap) == _cap))
+				_failed = true; });
+
+		_measure("timer RPC", ROUNDS, [&] (unsigned) {
+			_timer.elapsed_us(); });
+	}
+
+	bool failed() const { return _failed; }
+};
+
+
+struct Test::Main
+{
+	enum { STACK_SIZE = 4*1024*sizeof(long) };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	Rpc_entrypoint _ep { &_env.pd(), STACK_SIZE, "rpc_ep", Affinity::Location() };
+
+	Component _component { };
+
+	Capability<Session> _cap { _ep.manage(&_component) };
+
+	Benchmark _benchmark { _env, _timer, _cap };
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- IPC round-trip benchmark ---");
+
+		_benchmark.start();
+		_benchmark.join();
+
+		if (_benchmark.failed()) {
+			error("unexpected RPC result");
+			_env.parent().exit(-1);
+			return;
+		}
+
+		log("--- finished IPC round-trip benchmark ---");
+		_env.parent().exit(0);
+	}
+
+	~Main() { _ep.dissolve(&_component); }
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
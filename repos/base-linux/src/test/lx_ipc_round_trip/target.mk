@@ -0,0 +1,3 @@
+TARGET = test-lx_ipc_round_trip
+SRC_CC = main.cc
+LIBS   = base
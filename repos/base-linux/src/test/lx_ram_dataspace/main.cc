@@ -0,0 +1,109 @@
+/*
+ * \brief  Measure the costs of RAM dataspaces on base-linux
+ * \author Pirmin Duss
+ * \date   2020-10-26
+ *
+ * The test measures the latency of allocating, attaching, and freeing RAM
+ * dataspaces of different sizes. It further measures the time of random
+ * accesses to a large dataspace, which is dominated by TLB misses unless
+ * the dataspace is backed by huge pages.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/attached_ram_dataspace.h>
+#include <base/component.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+
+	using namespace Genode;
+
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	enum { ALLOC_ROUNDS = 200, ACCESS_ROUNDS = 4*1024*1024 };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	void _measure_alloc(size_t size)
+	{
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < ALLOC_ROUNDS; i++) {
+
+			Ram_dataspace_capability ds = _env.ram().alloc(size);
+
+			/* touch the first and last page */
+			char * const ptr = _env.rm().attach(ds);
+			ptr[0] = 1;
+			ptr[size - 1] = 1;
+
+			_env.rm().detach(ptr);
+			_env.ram().free(ds);
+		}
+
+		uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+		log("alloc/attach/free of ", Number_of_bytes(size), ": ",
+		    duration_us / ALLOC_ROUNDS, " us per dataspace");
+	}
+
+	void _measure_access(size_t size)
+	{
+		Attached_ram_dataspace ds(_env.ram(), _env.rm(), size);
+
+		unsigned long * const words     = ds.local_addr<unsigned long>();
+		size_t          const num_words = size / sizeof(unsigned long);
+
+		/* populate the dataspace */
+		for (size_t i = 0; i < num_words; i += 4096 / sizeof(unsigned long))
+			words[i] = i;
+
+		/* access one word of a pseudo-random page per round */
+		unsigned long seed = 1, sum = 0;
+
+		uint64_t const start_us = _timer.elapsed_us();
+
+		for (unsigned i = 0; i < ACCESS_ROUNDS; i++) {
+			seed = seed*6364136223846793005UL + 1442695040888963407UL;
+			sum += words[(seed >> 16) % num_words];
+		}
+
+		uint64_t const duration_us = _timer.elapsed_us() - start_us;
+
+		log("random access to ", Number_of_bytes(size), ": ",
+		    (duration_us * 1000) / ACCESS_ROUNDS, " ns per access "
+		    "(checksum ", Hex(sum), ")");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- RAM dataspace test ---");
+
+		_measure_alloc(4096);
+		_measure_alloc(64*1024);
+		_measure_alloc(1024*1024);
+		_measure_alloc(8*1024*1024);
+
+		_measure_access(64*1024*1024);
+
+		log("--- finished RAM dataspace test ---");
+		_env.parent().exit(0);
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
@@ -19,12 +19,14 @@
 #include <base/exception.h>
 #include <base/stdint.h>
 #include <rom_session/rom_session.h>
+#include <pd_session/pd_session.h>
 
 namespace Genode {
 
 	class  Shared_object;
 	struct Address_info;
 	struct Dynamic_linker;
+	struct Loaded_object_table;
 };
 
 
@@ -149,6 +151,13 @@ class Genode::Dynamic_linker
 
 		static void _for_each_loaded_object(Env &, For_each_fn const &);
 
+		struct Record_fn : Interface
+		{
+			virtual void supply_record(void const *, size_t) const = 0;
+		};
+
+		static void _with_relocation_record(Env &, Record_fn const &);
+
 		static void *_respawn(Env &, char const *, char const *);
 
 	public:
@@ -172,6 +181,35 @@ class Genode::Dynamic_linker
 			_for_each_loaded_object(env, wrapped_fn);
 		}
 
+		/**
+		 * Call 'fn' with the relocation record of the binary
+		 *
+		 * If configured via the 'ld_reloc_cache' attribute, the dynamic
+		 * linker records the symbols resolved while relocating the binary
+		 * and its shared objects. The functor is called with a pointer to
+		 * the record and its size as arguments only if the record was
+		 * created at startup, i.e., if the "ld_reloc_cache" ROM module was
+		 * missing or did not match the loaded objects. A component may
+		 * store the record such that it is provided as "ld_reloc_cache"
+		 * ROM module on the next start.
+		 */
+		template <typename FN>
+		static inline void with_relocation_record(Env &env, FN const &fn)
+		{
+			struct Record_fn_impl : Record_fn
+			{
+				FN const &fn;
+
+				void supply_record(void const *data, size_t size) const override {
+					fn(data, size); }
+
+				Record_fn_impl(FN const &fn) : fn(fn) { }
+
+			} wrapped_fn { fn };
+
+			_with_relocation_record(env, wrapped_fn);
+		}
+
 		/**
 		 * Prevent loaded shared object 'name' to be unloaded
 		 */
@@ -198,4 +236,45 @@ class Genode::Dynamic_linker
 		}
 };
 
+
+/**
+ * Table of the ELF objects loaded by the dynamic linker
+ *
+ * If enabled via the 'ld_object_table' configuration attribute, the dynamic
+ * linker keeps the table in the last page of the linker area. This way,
+ * tools that have access to the linker area of a component, like the CPU
+ * sampler, can relate instruction pointers to ELF objects without
+ * inspecting the linker's internal data structures. Otherwise, the last
+ * page of the linker area is not populated.
+ *
+ * While the table is updated, 'generation' has an odd value.
+ */
+struct Genode::Loaded_object_table
+{
+	enum { MAGIC = 0x4c4f4254 /* "LOBT" */, NAME_LEN = 48, SIZE = 4096 };
+
+	struct Object
+	{
+		addr_t start;       /* address of the first loaded segment */
+		size_t size;        /* size of all loaded segments */
+		addr_t reloc_base;  /* difference between load and link address */
+		char   name[NAME_LEN];
+	};
+
+	enum { MAX_OBJECTS = (SIZE - 4*sizeof(unsigned)) / sizeof(Object) };
+
+	unsigned volatile magic;
+	unsigned volatile generation;
+	unsigned          count;
+	unsigned          reserved;
+
+	Object objects[MAX_OBJECTS];
+
+	/**
+	 * Return offset of the table within the linker area
+	 */
+	static constexpr addr_t linker_area_offset() {
+		return Pd_session::LINKER_AREA_SIZE - SIZE; }
+};
+
 #endif /* _INCLUDE__BASE__SHARED_OBJECT_H_ */
@@ -202,12 +202,18 @@ CC_CXX_OPT += $(lastword $(CC_CXX_OPT_STD) $(CC_CXX_OPT_STD_$(subst .,_,$*)))
 # code when '-gc-sections' is enabled. Also, set max-page-size to 4KiB to
 # prevent the linker from aligning the text segment to any built-in default
 # (e.g., 4MiB on x86_64 or 64KiB on ARM). Otherwise, the padding bytes are
-# wasted at the beginning of the final binary.
+# wasted at the beginning of the final binary. Emit the GNU-style hash table
+# in addition to the SysV hash table to speed up symbol lookups by the
+# dynamic linker. The build ID identifies the objects for the relocation
+# cache of the dynamic linker.
 #
 LD_OPT_GC_SECTIONS ?= -gc-sections
 LD_OPT_ALIGN_SANE   = -z max-page-size=0x1000
+LD_OPT_HASH_STYLE  ?= --hash-style=both
+LD_OPT_BUILD_ID    ?= --build-id
 LD_OPT_PREFIX      := -Wl,
-LD_OPT             += $(LD_MARCH) $(LD_OPT_GC_SECTIONS) $(LD_OPT_ALIGN_SANE)
+LD_OPT             += $(LD_MARCH) $(LD_OPT_GC_SECTIONS) $(LD_OPT_ALIGN_SANE) \
+                      $(LD_OPT_HASH_STYLE) $(LD_OPT_BUILD_ID)
 CXX_LINK_OPT       += $(addprefix $(LD_OPT_PREFIX),$(LD_OPT))
 CXX_LINK_OPT       += $(LD_OPT_NOSTDLIB)
 
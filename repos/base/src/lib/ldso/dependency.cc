@@ -29,6 +29,7 @@ Linker::Dependency::Dependency(Env &env, Allocator &md_alloc,
 	_md_alloc(&md_alloc)
 {
 	deps.enqueue(*this);
+	flush_lookup_cache();
 	load_needed(env, *_md_alloc, deps, keep);
 }
 
@@ -38,6 +39,8 @@ Linker::Dependency::~Dependency()
 	if (!_unload_on_destruct)
 		return;
 
+	flush_lookup_cache();
+
 	if (!_obj.unload())
 		return;
 
@@ -49,6 +49,10 @@ class Linker::Config : Noncopyable
 
 		bool const _verbose     = _config.attribute_value("ld_verbose",     false);
 		bool const _check_ctors = _config.attribute_value("ld_check_ctors", true);
+		bool const _cache       = _config.attribute_value("ld_lookup_cache", true);
+		bool const _stats       = _config.attribute_value("ld_stats",       false);
+		bool const _reloc_cache = _config.attribute_value("ld_reloc_cache", false);
+		bool const _object_table = _config.attribute_value("ld_object_table", false);
 
 	public:
 
@@ -57,6 +61,10 @@ class Linker::Config : Noncopyable
 		Bind bind()        const { return _bind; }
 		bool verbose()     const { return _verbose; }
 		bool check_ctors() const { return _check_ctors; }
+		bool lookup_cache() const { return _cache; }
+		bool stats()       const { return _stats; }
+		bool reloc_cache() const { return _reloc_cache; }
+		bool object_table() const { return _object_table; }
 
 		typedef String<100> Rom_name;
 
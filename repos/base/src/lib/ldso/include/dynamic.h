@@ -20,6 +20,8 @@
 
 namespace Linker {
 	struct Hash_table;
+	struct Gnu_hash_table;
+	class  Symbol_name;
 	struct Dynamic;
 }
 
@@ -53,6 +55,120 @@ struct Linker::Hash_table
 };
 
 
+/**
+ * GNU-style hash table with bloom filter
+ *
+ * In contrast to the SysV hash table, the symbols of each bucket are stored
+ * consecutively in the symbol table and the hash values of the symbols are
+ * available in the chain array. So a lookup compares strings only if the
+ * hash values match. The bloom filter rejects most lookups of symbols not
+ * defined by the object without touching the buckets at all.
+ */
+struct Linker::Gnu_hash_table
+{
+	Elf::Hashelt const nbuckets;
+	Elf::Hashelt const symoffset;    /* index of first hashed symbol */
+	Elf::Hashelt const bloom_size;   /* number of bloom words, power of two */
+	Elf::Hashelt const bloom_shift;
+
+	Elf::Addr const *bloom() const { return (Elf::Addr const *)(this + 1); }
+
+	Elf::Hashelt const *buckets() const {
+		return (Elf::Hashelt const *)(bloom() + bloom_size); }
+
+	/**
+	 * Hash values of the symbols, starting at symbol index 'symoffset'
+	 *
+	 * The least-significant bit marks the last symbol of a bucket.
+	 */
+	Elf::Hashelt const *chain() const { return buckets() + nbuckets; }
+
+	/**
+	 * GNU hash function (Bernstein's hash)
+	 */
+	static Elf::Hashelt hash(char const *name)
+	{
+		Elf::Hashelt h = 5381;
+
+		for (unsigned char const *p = (unsigned char const *)name; *p; p++)
+			h = h*33 + *p;
+
+		return h;
+	}
+
+	/**
+	 * Return false if the object does not define a symbol with 'hash'
+	 */
+	bool may_contain(Elf::Hashelt hash) const
+	{
+		enum { BITS = sizeof(Elf::Addr)*8 };
+
+		Elf::Addr const word = bloom()[(hash / BITS) & (bloom_size - 1)];
+		Elf::Addr const mask = ((Elf::Addr)1 << (hash % BITS))
+		                     | ((Elf::Addr)1 << ((hash >> bloom_shift) % BITS));
+
+		return (word & mask) == mask;
+	}
+
+	/**
+	 * Return number of symbols of the symbol table
+	 *
+	 * The GNU hash table does not store the number of symbols. It is
+	 * determined by the end of the chain of the highest bucket.
+	 */
+	unsigned long num_symbols() const
+	{
+		Elf::Hashelt last = 0;
+		for (unsigned long i = 0; i < nbuckets; i++)
+			last = max(last, buckets()[i]);
+
+		if (last < symoffset)
+			return symoffset;
+
+		while (!(chain()[last - symoffset] & 1))
+			last++;
+
+		return last + 1;
+	}
+};
+
+
+/**
+ * Name of a symbol to look up along with its hash values
+ *
+ * The name is hashed once per lookup, not for each object searched. The
+ * SysV hash value is merely computed if an object lacks a GNU hash table.
+ */
+class Linker::Symbol_name
+{
+	private:
+
+		char         const *_string;
+		Elf::Hashelt const  _gnu_hash;
+
+		mutable unsigned long _elf_hash       = 0;
+		mutable bool          _elf_hash_valid = false;
+
+	public:
+
+		explicit Symbol_name(char const *string)
+		: _string(string), _gnu_hash(Gnu_hash_table::hash(string)) { }
+
+		char const *string() const { return _string; }
+
+		Elf::Hashelt gnu_hash() const { return _gnu_hash; }
+
+		unsigned long elf_hash() const
+		{
+			if (!_elf_hash_valid) {
+				_elf_hash       = Hash_table::hash(_string);
+				_elf_hash_valid = true;
+			}
+			return _elf_hash;
+		}
+};
+
+
 /**
  * .dynamic section entries
  */
@@ -94,6 +210,8 @@ class Linker::Dynamic
 		Allocator           *_md_alloc      = nullptr;
 
 		Hash_table          *_hash_table    = nullptr;
+		Gnu_hash_table      *_gnu_hash_table = nullptr;
+		unsigned long        _num_symbols   = 0;
 
 		Elf::Rela           *_reloca        = nullptr;
 		unsigned long        _reloca_size   = 0;
@@ -158,6 +276,7 @@ class Linker::Dynamic
 				case DT_PLTRELSZ: _pltrel_size = d->un.val;                             break;
 				case DT_PLTGOT  : _section<typeof(_pltgot)>(&_pltgot, d);               break;
 				case DT_HASH    : _section<typeof(_hash_table)>(&_hash_table, d);       break;
+				case DT_GNU_HASH: _section<typeof(_gnu_hash_table)>(&_gnu_hash_table, d); break;
 				case DT_RELA    : _section<typeof(_reloca)>(&_reloca, d);               break;
 				case DT_RELASZ  : _reloca_size = d->un.val;                             break;
 				case DT_SYMTAB  : _section<typeof(_symtab)>(&_symtab, d);               break;
@@ -173,6 +292,82 @@ class Linker::Dynamic
 					break;
 				}
 			}
+
+			_num_symbols = _hash_table     ? _hash_table->nchains()
+			             : _gnu_hash_table ? _gnu_hash_table->num_symbols()
+			             : 0;
+		}
+
+		/*
+		 * Return true if 'sym' is a definition of the symbol called 'name'
+		 */
+		bool _matches(Elf::Sym const &sym, char const *name) const
+		{
+			/* this omitts everything but 'NOTYPE', 'OBJECT', and 'FUNC' */
+			if (sym.type() > STT_FUNC)
+				return false;
+
+			if (sym.st_value == 0)
+				return false;
+
+			char const *sym_name = symbol_name(sym);
+
+			/* check for symbol name */
+			return name[0] == sym_name[0] && !strcmp(name, sym_name);
+		}
+
+		Elf::Sym const *_lookup_gnu(Symbol_name const &name) const
+		{
+			Gnu_hash_table const &h    = *_gnu_hash_table;
+			Elf::Hashelt   const  hash = name.gnu_hash();
+
+			if (!h.nbuckets || !h.may_contain(hash))
+				return nullptr;
+
+			unsigned long sym_index = h.buckets()[hash % h.nbuckets];
+
+			/* empty bucket */
+			if (sym_index < h.symoffset)
+				return nullptr;
+
+			/* traverse the symbols of the bucket */
+			for (; sym_index < _num_symbols; sym_index++) {
+
+				Elf::Hashelt const sym_hash = h.chain()[sym_index - h.symoffset];
+
+				if ((sym_hash | 1) == (hash | 1)
+				 && _matches(_symtab[sym_index], name.string()))
+					return _symtab + sym_index;
+
+				/* end of bucket */
+				if (sym_hash & 1)
+					break;
+			}
+
+			return nullptr;
+		}
+
+		Elf::Sym const *_lookup_sysv(Symbol_name const &name) const
+		{
+			Hash_table *h = _hash_table;
+
+			if (!h->buckets())
+				return nullptr;
+
+			unsigned long sym_index = h->buckets()[name.elf_hash() % h->nbuckets()];
+
+			/* traverse hash chain */
+			for (; sym_index != STN_UNDEF; sym_index = h->chains()[sym_index])
+			{
+				/* bad object */
+				if (sym_index > h->nchains())
+					return nullptr;
+
+				if (_matches(*symbol(sym_index), name.string()))
+					return symbol(sym_index);
+			}
+
+			return nullptr;
 		}
 
 	public:
@@ -216,7 +411,7 @@ class Linker::Dynamic
 
 		Elf::Sym const *symbol(unsigned sym_index) const
 		{
-			if (sym_index > _hash_table->nchains())
+			if (sym_index > _num_symbols)
 				return nullptr;
 
 			return _symtab + sym_index;
@@ -227,6 +422,14 @@ class Linker::Dynamic
 			return _strtab + sym.st_name;
 		}
 
+		/**
+		 * Return true if 'sym' refers to an entry of the symbol table
+		 */
+		bool symbol_valid(Elf::Sym const *sym) const
+		{
+			return _symtab && sym >= _symtab && sym < _symtab + _num_symbols;
+		}
+
 		void const *dynamic_ptr() const { return &_dynamic; }
 
 		void dep(Dependency const &dep) { _dep = &dep; }
@@ -234,46 +437,28 @@ class Linker::Dynamic
 		Dependency const &dep() const { return *_dep; }
 
 		/*
-		 * Use DT_HASH table address for linker, assuming that it will always be at
+		 * Use hash-table address for linker, assuming that it will always be at
 		 * the beginning of the file
 		 */
-		Elf::Addr link_map_addr() const { return trunc_page((Elf::Addr)_hash_table); }
+		Elf::Addr link_map_addr() const
+		{
+			return trunc_page(_hash_table ? (Elf::Addr)_hash_table
+			                              : (Elf::Addr)_gnu_hash_table);
+		}
 
 		/**
 		 * Lookup symbol name in this ELF
+		 *
+		 * The GNU hash table is preferred over the SysV hash table if
+		 * both are present.
 		 */
-		Elf::Sym const *lookup_symbol(char const *name, unsigned long hash) const
+		Elf::Sym const *lookup_symbol(Symbol_name const &name) const
 		{
-			Hash_table *h = _hash_table;
-
-			if (!h->buckets())
-				return nullptr;
-
-			unsigned long sym_index = h->buckets()[hash % h->nbuckets()];
+			if (_gnu_hash_table)
+				return _lookup_gnu(name);
 
-			/* traverse hash chain */
-			for (; sym_index != STN_UNDEF; sym_index = h->chains()[sym_index])
-			{
-				/* bad object */
-				if (sym_index > h->nchains())
-					return nullptr;
-
-				Elf::Sym const *sym      = symbol(sym_index);
-				char const     *sym_name = symbol_name(*sym);
-
-				/* this omitts everything but 'NOTYPE', 'OBJECT', and 'FUNC' */
-				if (sym->type() > STT_FUNC)
-					continue;
-
-				if (sym->st_value == 0)
-					continue;
-
-				/* check for symbol name */
-				if (name[0] != sym_name[0] || strcmp(name, sym_name))
-					continue;
-
-				return sym;
-			}
+			if (_hash_table)
+				return _lookup_sysv(name);
 
 			return nullptr;
 		}
@@ -285,7 +470,7 @@ class Linker::Dynamic
 		{
 			addr_t const reloc_base = _obj.reloc_base();
 
-			for (unsigned long i = 0; i < _hash_table->nchains(); i++)
+			for (unsigned long i = 0; i < _num_symbols; i++)
 			{
 				Elf::Sym const *sym = symbol(i);
 				if (!sym)
@@ -101,6 +101,13 @@ namespace Linker {
 	Elf::Sym const *lookup_symbol(char const *name, Dependency const &dep, Elf::Addr *base,
 	                              bool undef = false, bool other = false);
 
+	/**
+	 * Invalidate cached symbol-lookup results
+	 *
+	 * Must be called whenever the set of loaded objects changes.
+	 */
+	void flush_lookup_cache();
+
 	/**
 	 * Load an ELF (setup segments and map program header)
 	 *
@@ -0,0 +1,122 @@
+/*
+ * \brief  Cache of symbol-lookup results
+ * \author Pirmin Duss
+ * \date   2020-10-30
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__LOOKUP_CACHE_H_
+#define _INCLUDE__LOOKUP_CACHE_H_
+
+/* local includes */
+#include <dynamic.h>
+
+namespace Linker { class Lookup_cache; }
+
+
+/**
+ * Direct-mapped cache of resolved symbols
+ *
+ * The same symbols (e.g., 'memcpy', 'malloc', or the type information of
+ * common C++ classes) are referenced by most of the loaded objects. Without
+ * the cache, each reference is resolved by searching the dependency list
+ * anew. An entry is valid for the lookups that traverse the same dependency
+ * list. Since the result of a lookup may change whenever objects are loaded
+ * or unloaded, the cache is flushed on such occasions.
+ */
+class Linker::Lookup_cache : Noncopyable
+{
+	public:
+
+		enum { NUM_ENTRIES = 1024 };
+
+		struct Stats
+		{
+			unsigned long lookups;
+			unsigned long hits;
+		};
+
+	private:
+
+		struct Entry
+		{
+			unsigned           generation;
+			Elf::Hashelt       hash;
+			bool               undef;
+			Dependency const  *first;
+			char const        *name;  /* within string table of 'sym' */
+			Elf::Sym const    *sym;
+			Elf::Addr          base;
+		};
+
+		Entry _entries[NUM_ENTRIES] { };
+
+		/* entries of older generations are invalid */
+		unsigned _generation = 1;
+
+		Stats _stats { 0, 0 };
+
+		Entry &_entry(Symbol_name const &name) {
+			return _entries[name.gnu_hash() & (NUM_ENTRIES - 1)]; }
+
+	public:
+
+		void flush() { _generation++; }
+
+		/**
+		 * Look up cached symbol
+		 *
+		 * \param first  first element of the dependency list searched
+		 * \param base   returned relocation base of the symbol's object
+		 *
+		 * \return symbol, or nullptr if the lookup is not cached
+		 */
+		Elf::Sym const *lookup(Symbol_name const &name, Dependency const &first,
+		                       bool undef, Elf::Addr *base)
+		{
+			_stats.lookups++;
+
+			Entry const &e = _entry(name);
+
+			if (e.generation != _generation || e.hash != name.gnu_hash()
+			 || e.undef != undef || e.first != &first
+			 || strcmp(e.name, name.string()))
+				return nullptr;
+
+			_stats.hits++;
+
+			*base = e.base;
+			return e.sym;
+		}
+
+		/**
+		 * Insert lookup result
+		 *
+		 * \param dynamic  dynamic section of the object that defines 'sym'
+		 *
+		 * The symbol name is taken from the string table of the defining
+		 * object because the string of 'name' may be a temporary.
+		 */
+		void insert(Symbol_name const &name, Dependency const &first,
+		            bool undef, Elf::Sym const *sym, Elf::Addr base,
+		            Dynamic const &dynamic)
+		{
+			_entry(name) = Entry { .generation = _generation,
+			                       .hash       = name.gnu_hash(),
+			                       .undef      = undef,
+			                       .first      = &first,
+			                       .name       = dynamic.symbol_name(*sym),
+			                       .sym        = sym,
+			                       .base       = base };
+		}
+
+		Stats stats() const { return _stats; }
+};
+
+#endif /* _INCLUDE__LOOKUP_CACHE_H_ */
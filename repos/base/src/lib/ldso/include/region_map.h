@@ -19,6 +19,7 @@
 #include <base/env.h>
 #include <region_map/client.h>
 #include <base/allocator_avl.h>
+#include <base/shared_object.h>
 #include <util/retry.h>
 #include <util/reconstructible.h>
 
@@ -43,12 +44,20 @@ class Linker::Region_map
 
 	private:
 
+		/*
+		 * Noncopyable
+		 */
+		Region_map(Region_map const &);
+		Region_map &operator = (Region_map const &);
+
 		Env              &_env;
 		Region_map_client _rm { _env.pd().linker_area() };
 		Allocator_avl     _range; /* VM range allocator */
 		addr_t      const _base;  /* base address of dataspace */
 		addr_t            _end = _base + Pd_session::LINKER_AREA_SIZE;
 
+		Loaded_object_table *_object_table = nullptr;
+
 	protected:
 
 		Region_map(Env &env, Allocator &md_alloc, addr_t base)
@@ -65,6 +74,31 @@ class Linker::Region_map
 
 		static Constructible_region_map &r();
 
+		/**
+		 * Back the table of loaded objects at the end of the linker area
+		 *
+		 * The table is published only if enabled via the 'ld_object_table'
+		 * configuration attribute. It must be initialized before any region
+		 * is allocated at the end of the linker area.
+		 */
+		void init_object_table()
+		{
+			enum { SIZE = Loaded_object_table::SIZE };
+
+			if (_object_table)
+				return;
+
+			addr_t const at = alloc_region_at_end(SIZE);
+
+			if (at - _base != Loaded_object_table::linker_area_offset())
+				throw Region_conflict();
+
+			attach_at(_env.ram().alloc(SIZE), at);
+
+			_object_table = (Loaded_object_table *)at;
+			_object_table->magic = Loaded_object_table::MAGIC;
+		}
+
 		/**
 		 * Allocate region anywhere within the region map
 		 */
@@ -123,6 +157,30 @@ class Linker::Region_map
 		}
 
 		void detach(Local_addr local_addr) { _rm.detach((addr_t)local_addr - _base); }
+
+		/**
+		 * Replace content of the table of loaded objects
+		 *
+		 * The functor 'fn' is called with the table as argument and is
+		 * expected to fill in the objects and the object count. If the
+		 * table is not published, 'fn' is not called.
+		 */
+		template <typename FN>
+		void update_object_table(FN const &fn)
+		{
+			if (!_object_table)
+				return;
+
+			Loaded_object_table &table = *_object_table;
+
+			table.generation++;
+			asm volatile ("" ::: "memory");
+
+			fn(table);
+
+			asm volatile ("" ::: "memory");
+			table.generation++;
+		}
 };
 
 #endif /* _INCLUDE__REGION_MAP_H_ */
@@ -0,0 +1,301 @@
+/**
+ * \brief  Record and replay of the symbol lookups performed for relocations
+ * \author Pirmin Duss
+ * \date   2020-10-31
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__RELOC_CACHE_H_
+#define _INCLUDE__RELOC_CACHE_H_
+
+/* local includes */
+#include <linker.h>
+
+namespace Linker { class Reloc_cache; }
+
+
+/**
+ * Cache of the symbols resolved while relocating the loaded objects
+ *
+ * When loading a binary, the linker resolves the symbols referenced by the
+ * relocations of all objects in a deterministic order. Given the same set
+ * of ELF objects loaded at the same addresses, the lookups yield the same
+ * results each time the binary is started. The cache records the results
+ * in the order of the lookups. The record is keyed by the build IDs, the
+ * names, and the load addresses of the objects. On the next start of an
+ * identical set of objects, the record is obtained from the ROM module
+ * "ld_reloc_cache" and the recorded results are replayed instead of
+ * searching the dependencies. Each replayed entry is validated against the
+ * relocation at hand and against the symbol table of the defining object.
+ * On the first mismatch, the replay is abandoned. The lookups are then
+ * performed as usual and recorded, so that the record is replaced.
+ */
+class Linker::Reloc_cache : Noncopyable
+{
+	public:
+
+		typedef Genode::uint64_t Key;
+
+		enum { MAGIC = 0x4c445243 /* "LDRC" */, MAX_ENTRIES = 64*1024 };
+
+		struct Header
+		{
+			unsigned magic;
+			unsigned entry_size;
+			unsigned num_entries;
+			unsigned reserved;
+			Key      key;
+		};
+
+		struct Entry
+		{
+			Elf::Addr obj_base;   /* relocation base of referencing object */
+			Elf::Addr sym;        /* resolved symbol */
+			Elf::Addr base;       /* relocation base of defining object */
+			unsigned  sym_index;  /* symbol index within referencing object */
+			unsigned  flags;
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Reloc_cache(Reloc_cache const &);
+		Reloc_cache &operator = (Reloc_cache const &);
+
+		enum State { INACTIVE, RECORD, REPLAY };
+
+		enum { UNDEF = 1, OTHER = 2 };
+
+		Allocator &_alloc;
+
+		Key const _key;
+
+		State _state = INACTIVE;
+
+		Constructible<Attached_rom_dataspace> _rom { };
+
+		Entry const *_replay_entries = nullptr;
+		unsigned     _replay_count   = 0;
+		unsigned     _replay_pos     = 0;
+
+		/* record buffer, starting with the header */
+		char    *_record   = nullptr;
+		unsigned _capacity = 0;
+		unsigned _count    = 0;
+		bool     _complete = false;
+
+		static size_t _record_size(unsigned count) {
+			return sizeof(Header) + count*sizeof(Entry); }
+
+		Entry *_entries() { return (Entry *)(_record + sizeof(Header)); }
+
+		static unsigned _flags(bool undef, bool other) {
+			return (undef ? UNDEF : 0) | (other ? OTHER : 0); }
+
+		void _free_record()
+		{
+			if (_record)
+				_alloc.free(_record, _record_size(_capacity));
+
+			_record   = nullptr;
+			_capacity = 0;
+			_count    = 0;
+		}
+
+		bool _grow()
+		{
+			unsigned const capacity = _capacity ? 2*_capacity : 1024;
+
+			if (capacity > MAX_ENTRIES)
+				return false;
+
+			char *record = nullptr;
+			if (!_alloc.alloc(_record_size(capacity), &record))
+				return false;
+
+			if (_record)
+				memcpy(record, _record, _record_size(_count));
+
+			unsigned const count = _count;
+			_free_record();
+
+			_record   = record;
+			_capacity = capacity;
+			_count    = count;
+			return true;
+		}
+
+		/**
+		 * Switch from replay to recording after a mismatch
+		 *
+		 * The entries replayed so far were validated and are taken over
+		 * into the new record.
+		 */
+		void _rerecord()
+		{
+			_state = RECORD;
+
+			while (_capacity < _replay_pos)
+				if (!_grow()) {
+					_state = INACTIVE;
+					_free_record();
+					break;
+				}
+
+			if (_state == RECORD && _replay_pos) {
+				memcpy(_entries(), _replay_entries, _replay_pos*sizeof(Entry));
+				_count = _replay_pos;
+			}
+
+			_replay_entries = nullptr;
+			_replay_count   = 0;
+			_replay_pos     = 0;
+			_rom.destruct();
+		}
+
+		bool _try_replay(Env &env)
+		{
+			try { _rom.construct(env, "ld_reloc_cache"); }
+			catch (...) { return false; }
+
+			Header const &header = *_rom->local_addr<Header const>();
+			size_t const  size   = _rom->size();
+
+			if (size < sizeof(Header)
+			 || header.magic != MAGIC || header.entry_size != sizeof(Entry)
+			 || header.key   != _key
+			 || header.num_entries > MAX_ENTRIES
+			 || _record_size(header.num_entries) > size) {
+				_rom.destruct();
+				return false;
+			}
+
+			_replay_entries = (Entry const *)(&header + 1);
+			_replay_count   = header.num_entries;
+			return true;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param key  identity of the set of loaded objects, or 0 if the
+		 *             objects cannot be identified
+		 */
+		Reloc_cache(Env &env, Allocator &alloc, Key key)
+		:
+			_alloc(alloc), _key(key)
+		{
+			if (!_key)
+				return;
+
+			_state = _try_replay(env) ? REPLAY : RECORD;
+
+			if (verbose)
+				log("LD: relocation cache ",
+				    _state == REPLAY ? "replays " : "records ",
+				    _state == REPLAY ? _replay_count : 0, " entries");
+		}
+
+		~Reloc_cache() { _free_record(); }
+
+		/**
+		 * Return replayed symbol, or nullptr if no entry can be replayed
+		 *
+		 * \param valid_fn  functor called with the recorded symbol and the
+		 *                  relocation base of its defining object, returns
+		 *                  true if the symbol is defined by the object
+		 *                  loaded at this base and matches the name of the
+		 *                  referenced symbol
+		 */
+		template <typename VALID_FN>
+		Elf::Sym const *replay(Object const &obj, unsigned sym_index,
+		                       bool undef, bool other, Elf::Addr *base,
+		                       VALID_FN const &valid_fn)
+		{
+			if (_state != REPLAY)
+				return nullptr;
+
+			if (_replay_pos < _replay_count) {
+
+				Entry const &e = _replay_entries[_replay_pos];
+
+				if (e.obj_base  == obj.reloc_base() && e.sym_index == sym_index
+				 && e.flags     == _flags(undef, other)
+				 && valid_fn((Elf::Sym const *)e.sym, e.base)) {
+					_replay_pos++;
+					*base = e.base;
+					return (Elf::Sym const *)e.sym;
+				}
+			}
+
+			warning("LD: relocation cache does not match, resolving symbols");
+			_rerecord();
+			return nullptr;
+		}
+
+		void record(Object const &obj, unsigned sym_index, bool undef,
+		            bool other, Elf::Sym const *sym, Elf::Addr base)
+		{
+			if (_state != RECORD)
+				return;
+
+			if (_count == _capacity && !_grow()) {
+				_state = INACTIVE;
+				_free_record();
+				return;
+			}
+
+			_entries()[_count++] = Entry { .obj_base  = obj.reloc_base(),
+			                               .sym       = (Elf::Addr)sym,
+			                               .base      = base,
+			                               .sym_index = sym_index,
+			                               .flags     = _flags(undef, other) };
+		}
+
+		/**
+		 * Conclude the relocation of the binary
+		 *
+		 * Symbols resolved after this point, e.g., by binding PLT entries
+		 * lazily, are not cached because their order is not deterministic.
+		 */
+		void finish()
+		{
+			if (_state == RECORD && _record) {
+				*(Header *)_record = Header { .magic       = MAGIC,
+				                             .entry_size  = sizeof(Entry),
+				                             .num_entries = _count,
+				                             .reserved    = 0,
+				                             .key         = _key };
+				_complete = true;
+			}
+
+			_state = INACTIVE;
+			_rom.destruct();
+		}
+
+		/**
+		 * Call 'fn' with the recorded data and its size
+		 *
+		 * The functor is called only if the relocations were recorded,
+		 * i.e., if no matching record was available at startup or the
+		 * replay of the record was abandoned.
+		 */
+		template <typename FN>
+		void with_record(FN const &fn) const
+		{
+			if (_complete)
+				fn((void const *)_record, _record_size(_count));
+		}
+};
+
+#endif /* _INCLUDE__RELOC_CACHE_H_ */
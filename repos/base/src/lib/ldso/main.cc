@@ -20,6 +20,7 @@
 #include <base/thread.h>
 #include <base/heap.h>
 #include <base/sleep.h>
+#include <trace/timestamp.h>
 
 /* base-internal includes */
 #include <base/internal/unmanaged_singleton.h>
@@ -30,6 +31,8 @@
 #include <init.h>
 #include <region_map.h>
 #include <config.h>
+#include <lookup_cache.h>
+#include <reloc_cache.h>
 
 using namespace Linker;
 
@@ -41,10 +44,14 @@ namespace Linker {
 	struct Link_map;
 	struct Debug;
 	struct Config;
+
+	static void update_loaded_object_table();
 };
 
 static    Binary *binary_ptr = nullptr;
 static    Parent *parent_ptr = nullptr;
+static    Lookup_cache *lookup_cache_ptr = nullptr;
+static    Reloc_cache  *reloc_cache_ptr  = nullptr;
 bool      Linker::verbose  = false;
 Stage     Linker::stage    = STAGE_BINARY;
 Link_map *Link_map::first;
@@ -134,6 +141,8 @@ class Linker::Elf_object : public Object, private Fifo<Elf_object>::Element
 			Debug::state_change(Debug::ADD, nullptr);
 			setup_link_map();
 			Debug::state_change(Debug::CONSISTENT, &_map);
+
+			update_loaded_object_table();
 		}
 
 		virtual ~Elf_object()
@@ -152,6 +161,8 @@ class Linker::Elf_object : public Object, private Fifo<Elf_object>::Element
 			/* remove from loaded objects list */
 			obj_list()->remove(*this);
 			Init::list()->remove(this);
+
+			update_loaded_object_table();
 		}
 
 		/**
@@ -173,9 +184,9 @@ class Linker::Elf_object : public Object, private Fifo<Elf_object>::Element
 			return _dyn.symbol_name(sym);
 		}
 
-		Elf::Sym const *lookup_symbol(char const *name, unsigned long hash) const
+		Elf::Sym const *lookup_symbol(Symbol_name const &name) const
 		{
-			return _dyn.lookup_symbol(name, hash);
+			return _dyn.lookup_symbol(name);
 		}
 
 		/**
@@ -254,6 +265,31 @@ class Linker::Elf_object : public Object, private Fifo<Elf_object>::Element
 };
 
 
+void Linker::update_loaded_object_table()
+{
+	if (!Region_map::r().constructed())
+		return;
+
+	Region_map::r()->update_object_table([&] (Loaded_object_table &table) {
+
+		table.count = 0;
+
+		Elf_object::obj_list()->for_each([&] (Object const &obj) {
+
+			if (!obj.file() || table.count == Loaded_object_table::MAX_OBJECTS)
+				return;
+
+			Loaded_object_table::Object &entry = table.objects[table.count++];
+
+			entry.start      = obj.reloc_base() + obj.file()->start;
+			entry.size       = obj.size();
+			entry.reloc_base = obj.reloc_base();
+			copy_cstring(entry.name, obj.name(), sizeof(entry.name));
+		});
+	});
+}
+
+
 /**
  * The dynamic linker object (ld.lib.so)
  */
@@ -346,6 +382,92 @@ static int exit_status;
 static void exit_on_suspended() { genode_exit(exit_status); }
 
 
+/**
+ * Call 'fn' with the build ID found in the given note segment
+ */
+template <typename FN>
+static void with_build_id(addr_t notes, size_t size, FN const &fn)
+{
+	enum { NT_GNU_BUILD_ID = 3 };
+
+	struct Note { uint32_t namesz, descsz, type; };
+
+	addr_t const end = notes + size;
+
+	while (notes + sizeof(Note) <= end) {
+
+		Note const &note = *(Note const *)notes;
+
+		addr_t const name = notes + sizeof(Note);
+		addr_t const desc = name  + align_addr(note.namesz, 2);
+		addr_t const next = desc  + align_addr(note.descsz, 2);
+
+		if (next > end)
+			return;
+
+		if (note.type == NT_GNU_BUILD_ID && note.namesz == 4
+		 && !strcmp((char const *)name, "GNU", 4)) {
+			fn((void const *)desc, note.descsz);
+			return;
+		}
+
+		notes = next;
+	}
+}
+
+
+/**
+ * Return key of the relocation cache for the loaded objects
+ *
+ * \return 0 if an object lacks a build ID
+ */
+static Reloc_cache::Key reloc_cache_key()
+{
+	/* FNV-1a */
+	Reloc_cache::Key key = 0xcbf29ce484222325ULL;
+
+	auto mix = [&] (void const *data, size_t len) {
+		for (size_t i = 0; i < len; i++) {
+			key ^= ((unsigned char const *)data)[i];
+			key *= 0x100000001b3ULL;
+		}
+	};
+
+	bool identified = true;
+
+	Elf_object::obj_list()->for_each([&] (Object const &obj) {
+
+		File const *file = obj.file();
+		bool build_id = false;
+
+		for (unsigned i = 0; file && i < file->elf_phdr_count(); i++) {
+
+			Elf::Phdr const &ph = *file->elf_phdr(i);
+			if (ph.p_type != PT_NOTE)
+				continue;
+
+			with_build_id(obj.reloc_base() + ph.p_vaddr, ph.p_memsz,
+			              [&] (void const *id, size_t len) {
+				mix(id, len);
+				build_id = true;
+			});
+		}
+
+		if (!build_id) {
+			if (verbose)
+				log("LD: ", obj.name(), " lacks build ID, relocation cache disabled");
+			identified = false;
+		}
+
+		Elf::Addr const reloc_base = obj.reloc_base();
+		mix(obj.name(), strlen(obj.name()));
+		mix(&reloc_base, sizeof(reloc_base));
+	});
+
+	return identified ? key : 0;
+}
+
+
 /**
  * The dynamic binary to load
  */
@@ -364,6 +486,12 @@ struct Linker::Binary : private Root_object, public Elf_object
 		           *new (md_alloc) Dependency(*this, this), DONT_KEEP),
 		_check_ctors(config.check_ctors())
 	{
+		/* publish table before libraries are placed at the linker-area end */
+		if (config.object_table()) {
+			Region_map::r()->init_object_table();
+			update_loaded_object_table();
+		}
+
 		/* create dep for binary and linker */
 		Dependency *binary = const_cast<Dependency *>(&dynamic().dep());
 		Root_object::enqueue(*binary);
@@ -381,8 +509,15 @@ struct Linker::Binary : private Root_object, public Elf_object
 		/* load dependencies */
 		binary->load_needed(env, md_alloc, deps(), DONT_KEEP);
 
+		if (config.reloc_cache())
+			reloc_cache_ptr = new (md_alloc)
+				Reloc_cache(env, md_alloc, reloc_cache_key());
+
 		/* relocate and call constructors */
 		Init::list()->initialize(config.bind(), STAGE_BINARY);
+
+		if (reloc_cache_ptr)
+			reloc_cache_ptr->finish();
 	}
 
 	Elf::Addr lookup_symbol(char const *name)
@@ -513,8 +648,7 @@ void genode_exit(int status)
 
 Elf::Addr Linker::Object::_symbol_address(char const *name)
 {
-	unsigned long   hash = Hash_table::hash(name);
-	Elf::Sym const *sym  = dynamic().lookup_symbol(name, hash);
+	Elf::Sym const *sym = dynamic().lookup_symbol(Symbol_name(name));
 
 	if (sym)
 		return reloc_base() + sym->st_value;
@@ -554,6 +688,13 @@ Object &Linker::load(Env &env, Allocator &md_alloc, char const *path,
 }
 
 
+void Linker::flush_lookup_cache()
+{
+	if (lookup_cache_ptr)
+		lookup_cache_ptr->flush();
+}
+
+
 Object *Linker::obj_list_head()
 {
 	Object *result = nullptr;
@@ -579,7 +720,38 @@ Elf::Sym const *Linker::lookup_symbol(unsigned sym_index, Dependency const &dep,
 		return symbol;
 	}
 
-	return lookup_symbol(elf.symbol_name(*symbol), dep, base, undef, other);
+	/*
+	 * A replayed symbol must be defined by the object at the recorded
+	 * base and carry the name of the referenced symbol.
+	 */
+	auto replay_valid = [&] (Elf::Sym const *sym, Elf::Addr sym_base)
+	{
+		bool valid = false;
+		Elf_object::obj_list()->for_each([&] (Elf_object const &obj) {
+
+			if (valid || obj.reloc_base() != sym_base)
+				return;
+
+			Dynamic const &dynamic = obj.dynamic();
+
+			valid = dynamic.symbol_valid(sym)
+			     && !strcmp(dynamic.symbol_name(*sym), elf.symbol_name(*symbol));
+		});
+		return valid;
+	};
+
+	if (reloc_cache_ptr)
+		if (Elf::Sym const *sym = reloc_cache_ptr->replay(dep.obj(), sym_index,
+		                                                  undef, other, base,
+		                                                  replay_valid))
+			return sym;
+
+	Elf::Sym const *sym = lookup_symbol(elf.symbol_name(*symbol), dep, base,
+	                                    undef, other);
+	if (reloc_cache_ptr)
+		reloc_cache_ptr->record(dep.obj(), sym_index, undef, other, sym, *base);
+
+	return sym;
 }
 
 
@@ -587,11 +759,21 @@ Elf::Sym const *Linker::lookup_symbol(char const *name, Dependency const &dep,
                                       Elf::Addr *base, bool undef, bool other)
 {
 	Dependency const *curr        = &dep.first();
-	unsigned long     hash        = Hash_table::hash(name);
+	Symbol_name const symbol_name(name);
 	Elf::Sym   const *weak_symbol = 0;
 	Elf::Addr        weak_base    = 0;
+	Elf_object const *weak_elf    = 0;
 	Elf::Sym   const *symbol      = 0;
 
+	/*
+	 * The result does not depend on 'dep' except for lookups that skip
+	 * 'dep' itself, which are not cached.
+	 */
+	Lookup_cache * const cache = other ? nullptr : lookup_cache_ptr;
+
+	if (cache && (symbol = cache->lookup(symbol_name, dep.first(), undef, base)))
+		return symbol;
+
 	//TODO: handle vertab and search in object list
 	for (;curr; curr = curr->next()) {
 
@@ -600,7 +782,7 @@ Elf::Sym const *Linker::lookup_symbol(char const *name, Dependency const &dep,
 
 		Elf_object const &elf = static_cast<Elf_object const &>(curr->obj());
 
-		if ((symbol = elf.lookup_symbol(name, hash)) && (symbol->st_value || undef)) {
+		if ((symbol = elf.lookup_symbol(symbol_name)) && (symbol->st_value || undef)) {
 
 			if (dep.root() && verbose_lookup)
 				log("LD: lookup ", name, " obj_src ", elf.name(),
@@ -612,12 +794,18 @@ Elf::Sym const *Linker::lookup_symbol(char const *name, Dependency const &dep,
 
 			if (!symbol->weak() && symbol->st_shndx != SHN_UNDEF) {
 				*base = elf.reloc_base();
+
+				if (cache)
+					cache->insert(symbol_name, dep.first(), undef, symbol, *base,
+					              elf.dynamic());
+
 				return symbol;
 			}
 
 			if (!weak_symbol) {
 				weak_symbol = symbol;
 				weak_base   = elf.reloc_base();
+				weak_elf    = &elf;
 			}
 		}
 	}
@@ -637,6 +825,10 @@ Elf::Sym const *Linker::lookup_symbol(char const *name, Dependency const &dep,
 	if (!weak_symbol)
 		throw Not_found(name);
 
+	if (cache)
+		cache->insert(symbol_name, dep.first(), undef, weak_symbol, weak_base,
+		              weak_elf->dynamic());
+
 	*base = weak_base;
 	return weak_symbol;
 }
@@ -771,6 +963,14 @@ void Dynamic_linker::keep(Env &, char const *binary)
 }
 
 
+void Dynamic_linker::_with_relocation_record(Env &, Record_fn const &fn)
+{
+	if (reloc_cache_ptr)
+		reloc_cache_ptr->with_record([&] (void const *data, size_t size) {
+			fn.supply_record(data, size); });
+}
+
+
 void *Dynamic_linker::_respawn(Env &env, char const *binary, char const *entry_name)
 {
 	Object::Name const name(binary);
@@ -778,6 +978,13 @@ void *Dynamic_linker::_respawn(Env &env, char const *binary, char const *entry_n
 	/* unload original binary */
 	binary_ptr->~Binary();
 
+	flush_lookup_cache();
+
+	if (reloc_cache_ptr) {
+		destroy(*heap(), reloc_cache_ptr);
+		reloc_cache_ptr = nullptr;
+	}
+
 	Config const config(env);
 
 	/* load new binary */
@@ -804,6 +1011,11 @@ void Component::construct(Genode::Env &env)
 
 	parent_ptr = &env.parent();
 
+	if (config.lookup_cache())
+		lookup_cache_ptr = new (*heap()) Lookup_cache();
+
+	Trace::Timestamp const load_start = Trace::timestamp();
+
 	/* load binary and all dependencies */
 	try {
 		binary_ptr = unmanaged_singleton<Binary>(env, *heap(), config, binary_name());
@@ -815,6 +1027,16 @@ void Component::construct(Genode::Env &env)
 		throw;
 	}
 
+	if (config.stats()) {
+		Lookup_cache::Stats const stats = lookup_cache_ptr
+		                                ? lookup_cache_ptr->stats()
+		                                : Lookup_cache::Stats { 0, 0 };
+
+		log("LD: loaded ", binary_name(), " in ",
+		    Trace::timestamp() - load_start, " cycles, "
+		    "symbol lookups: ", stats.lookups, " cache hits: ", stats.hits);
+	}
+
 	/* print loaded object information */
 	try {
 		if (verbose) {
@@ -26,6 +26,22 @@ namespace Aes_cbc_4k {
 
 	void encrypt(Key const &, Block_number, Plaintext  const &, Ciphertext &);
 	void decrypt(Key const &, Block_number, Ciphertext const &, Plaintext  &);
+
+	/**
+	 * Encrypt 'count' blocks with consecutive block numbers
+	 *
+	 * The result equals the encryption of the blocks one by one with the
+	 * block numbers 'first', 'first' + 1, and so forth. On CPUs that
+	 * provide AES instructions, several blocks are processed at once.
+	 */
+	void encrypt(Key const &, Block_number first, Plaintext const *,
+	             Ciphertext *, unsigned count);
+
+	/**
+	 * Decrypt 'count' blocks with consecutive block numbers
+	 */
+	void decrypt(Key const &, Block_number first, Ciphertext const *,
+	             Plaintext *, unsigned count);
 }
 
 #endif /* _AES_CBC_4K_H_ */
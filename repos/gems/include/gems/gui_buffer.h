@@ -98,13 +98,19 @@ struct Gui_buffer
 		fn(pixel, alpha);
 	}
 
-	void reset_surface()
+	void reset_surface() { reset_surface(Rect(Point(0, 0), size())); }
+
+	/**
+	 * Reset the back buffer within the area 'rect'
+	 */
+	void reset_surface(Rect rect)
 	{
-		Pixel_surface pixel(pixel_surface_ds.local_addr<Pixel_rgb888>(), size());
-		Alpha_surface alpha(alpha_surface_ds.local_addr<Pixel_alpha8>(), size());
+		rect = Rect::intersect(rect, Rect(Point(0, 0), size()));
+		if (!rect.valid())
+			return;
 
-		Genode::size_t const num_pixels = size().count();
-		Genode::memset(alpha.addr(), 0, num_pixels);
+		Pixel_rgb888 * const pixel_base = pixel_surface_ds.local_addr<Pixel_rgb888>();
+		Pixel_alpha8 * const alpha_base = alpha_surface_ds.local_addr<Pixel_alpha8>();
 
 		/*
 		 * Initialize color buffer with 50% gray
@@ -112,12 +118,18 @@ struct Gui_buffer
 		 * We do not use black to limit the bleeding of black into antialiased
 		 * drawing operations applied onto an initially transparent background.
 		 */
-		Pixel_rgb888 *dst = pixel.addr();
-
 		Pixel_rgb888 const gray(127, 127, 127, 255);
 
-		for (unsigned n = num_pixels; n; n--)
-			*dst++ = gray;
+		for (int y = rect.y1(); y <= rect.y2(); y++) {
+
+			Genode::size_t const offset = y*size().w() + rect.x1();
+
+			Genode::memset(alpha_base + offset, 0, rect.w());
+
+			Pixel_rgb888 *dst = pixel_base + offset;
+			for (unsigned n = rect.w(); n; n--)
+				*dst++ = gray;
+		}
 	}
 
 	template <typename DST_PT, typename SRC_PT>
@@ -132,7 +144,7 @@ struct Gui_buffer
 		Blit_painter::paint(surface, texture, Point());
 	}
 
-	void _update_input_mask()
+	void _update_input_mask(Rect const rect)
 	{
 		unsigned const num_pixels = size().count();
 
@@ -141,9 +153,6 @@ struct Gui_buffer
 
 		unsigned char * const input_base = alpha_base + num_pixels;
 
-		unsigned char const *src = alpha_base;
-		unsigned char       *dst = input_base;
-
 		/*
 		 * Set input mask for all pixels where the alpha value is above a
 		 * given threshold. The threshold is defines such that typical
@@ -151,12 +160,29 @@ struct Gui_buffer
 		 */
 		unsigned char const threshold = 100;
 
-		for (unsigned i = 0; i < num_pixels; i++)
-			*dst++ = (*src++) > threshold;
+		for (int y = rect.y1(); y <= rect.y2(); y++) {
+
+			Genode::size_t const offset = y*size().w() + rect.x1();
+
+			unsigned char const *src = alpha_base + offset;
+			unsigned char       *dst = input_base + offset;
+
+			for (unsigned i = 0; i < rect.w(); i++)
+				*dst++ = (*src++) > threshold;
+		}
 	}
 
-	void flush_surface()
+	void flush_surface() { flush_surface(Rect(Point(0, 0), size())); }
+
+	/**
+	 * Transfer the back buffer within the area 'rect' to the GUI buffer
+	 */
+	void flush_surface(Rect rect)
 	{
+		Rect const clip_rect = Rect::intersect(rect, Rect(Point(0, 0), size()));
+		if (!clip_rect.valid())
+			return;
+
 		/* represent back buffer as texture */
 		Genode::Texture<Pixel_rgb888>
 			pixel_texture(pixel_surface_ds.local_addr<Pixel_rgb888>(),
@@ -166,9 +192,6 @@ struct Gui_buffer
 			alpha_texture(alpha_surface_ds.local_addr<Pixel_alpha8>(),
 			              nullptr, size());
 
-		// XXX track dirty rectangles
-		Rect const clip_rect(Genode::Surface_base::Point(0, 0), size());
-
 		Pixel_rgb888 *pixel_base = fb_ds.local_addr<Pixel_rgb888>();
 		Pixel_alpha8 *alpha_base = fb_ds.local_addr<Pixel_alpha8>()
 		                         + mode.bytes_per_pixel()*size().count();
@@ -176,7 +199,7 @@ struct Gui_buffer
 		_convert_back_to_front(pixel_base, pixel_texture, clip_rect);
 		_convert_back_to_front(alpha_base, alpha_texture, clip_rect);
 
-		_update_input_mask();
+		_update_input_mask(clip_rect);
 	}
 };
 
@@ -0,0 +1,7 @@
+SRC_CC += aes_ni.cc
+
+CC_OPT_aes_ni += -maes
+
+vpath aes_ni.cc $(REP_DIR)/src/lib/aes_cbc_4k/spec/x86_64
+
+include $(REP_DIR)/lib/mk/aes_cbc_4k.inc
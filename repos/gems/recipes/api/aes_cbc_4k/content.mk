@@ -2,7 +2,9 @@ MIRROR_FROM_REP_DIR := \
 	include/aes_cbc_4k \
 	src/lib/aes_cbc_4k \
 	lib/import/import-aes_cbc_4k.mk \
-	lib/mk/aes_cbc_4k.mk
+	lib/mk/aes_cbc_4k.mk \
+	lib/mk/aes_cbc_4k.inc \
+	lib/mk/spec/x86_64/aes_cbc_4k.mk
 
 content: $(MIRROR_FROM_REP_DIR)
 
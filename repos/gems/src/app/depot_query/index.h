@@ -0,0 +1,733 @@
+/*
+ * \brief  Persistent index of the depot meta data
+ * \author Pirmin Duss
+ * \date   2020-10-23
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INDEX_H_
+#define _INDEX_H_
+
+/* Genode includes */
+#include <base/registry.h>
+#include <util/avl_string.h>
+#include <os/vfs.h>
+#include <depot/archive.h>
+
+namespace Depot_query {
+
+	using namespace Depot;
+
+	class Index;
+}
+
+
+/**
+ * Index of the meta data found in the depot
+ *
+ * The index records the content of the 'archives' and 'used_apis' files
+ * as well as the presence of archives and ROM modules. Once populated,
+ * queries are answered without reading the depot.
+ *
+ * Each index entry belongs to the directory that hosts all versions of an
+ * archive, e.g., 'genodelabs/pkg/wm' or 'genodelabs/bin/x86_64/init'. The
+ * entries of such a name directory become stale as soon as its modification
+ * time - or its list of versions if the file system lacks modification
+ * times - changes. Because the content of a version directory is never
+ * changed after its installation, this check is sufficient. The check is
+ * performed at most once per name directory and query.
+ *
+ * Only positive results are recorded because archives absent at one query
+ * may be installed for a later query. The 'local' depot user is not
+ * indexed. The memory used for recording the presence of files and
+ * directories is bounded by the configured stat-cache size. Once the bound
+ * is reached, further presence checks are answered by the depot directly.
+ *
+ * If an index directory is configured, the index of each depot user is
+ * stored in a file named after the user. The file is read at the first
+ * access of an archive of the user and written whenever the index of the
+ * user changed.
+ */
+class Depot_query::Index : Noncopyable
+{
+	public:
+
+		typedef Archive::Path   Path;
+		typedef Directory::Path Dir_path;
+
+		struct Limit { size_t value; };
+
+		struct Stats { unsigned hits, misses; };
+
+	private:
+
+		typedef uint64_t Stamp;
+
+		struct User;
+		struct Entry;
+
+		struct Name_dir : Avl_string<Path::size()>
+		{
+			User &user;
+
+			Registry<Name_dir>::Element _element;
+
+			Registry<Entry> entries { };
+
+			Stamp    stamp;
+			unsigned generation = 0;
+
+			Name_dir(User &user, Path const &path, Stamp stamp)
+			:
+				Avl_string(path.string()), user(user),
+				_element(user.name_dirs, *this), stamp(stamp)
+			{ }
+
+			bool empty() const
+			{
+				bool result = true;
+				entries.for_each([&] (Entry const &) { result = false; });
+				return result;
+			}
+		};
+
+		/**
+		 * Known file or directory, optionally with the file content
+		 */
+		struct Entry : Avl_string<Path::size()>
+		{
+			/*
+			 * Noncopyable
+			 */
+			Entry(Entry const &);
+			Entry &operator = (Entry const &);
+
+			Allocator &_alloc;
+
+			Name_dir &name_dir;
+
+			Registry<Entry>::Element _element;
+
+			struct Content { bool valid; char const *src; size_t size; };
+
+			bool    const has_content;
+			char  * const content;
+			size_t  const size;
+
+			static char *_init_content(Allocator &alloc, size_t size)
+			{
+				return size ? (char *)alloc.alloc(size) : nullptr;
+			}
+
+			Entry(Allocator &alloc, Name_dir &name_dir, Path const &path,
+			      Content const &src)
+			:
+				Avl_string(path.string()), _alloc(alloc), name_dir(name_dir),
+				_element(name_dir.entries, *this), has_content(src.valid),
+				content(_init_content(alloc, src.size)), size(src.size)
+			{
+				if (size)
+					memcpy(content, src.src, size);
+			}
+
+			~Entry() { if (content) _alloc.free(content, size); }
+		};
+
+		struct User : Noncopyable
+		{
+			Archive::User const name;
+
+			Registry<User>::Element _element;
+
+			Registry<Name_dir> name_dirs { };
+
+			bool dirty = false;
+
+			User(Registry<User> &users, Archive::User const &name)
+			: name(name), _element(users, *this) { }
+		};
+
+		Allocator      &_alloc;
+		Root_directory &_root;
+
+		Directory const _depot { _root, "depot" };
+
+		Dir_path _index_dir  { };
+		Limit    _file_limit { 0 };
+		Limit    _stat_limit { 0 };
+
+		size_t _stat_used = 0;  /* bytes used by entries w/o content */
+
+		Registry<User> _users { };
+
+		Avl_tree<Avl_string_base> _name_dirs { };
+		Avl_tree<Avl_string_base> _entries   { };
+
+		unsigned _generation = 1;
+
+		Stats _stats { 0, 0 };
+
+		template <typename T>
+		static T *_lookup(Avl_tree<Avl_string_base> &tree, Path const &path)
+		{
+			Avl_string_base *node = tree.first();
+			return node ? static_cast<T *>(node->find_by_name(path.string())) : nullptr;
+		}
+
+		/**
+		 * Return path consisting of the first 'n' elements of 'path'
+		 */
+		static Path _leading_elements(Path const &path, unsigned n)
+		{
+			char const * const s = path.string();
+
+			size_t len = 0;
+			for (; s[len]; len++)
+				if (s[len] == '/' && --n == 0)
+					break;
+
+			return Path(Cstring(s, len));
+		}
+
+		/**
+		 * Return directory that hosts all versions of the archive at 'path'
+		 */
+		static Path _name_dir_path(Path const &path)
+		{
+			/* binary archives reside in an architecture-specific directory */
+			bool const bin = (_leading_elements(path, 2) ==
+			                  Path(Archive::user(path), "/bin"));
+
+			return _leading_elements(path, bin ? 4 : 3);
+		}
+
+		Stamp _stamp(Path const &name_dir_path)
+		{
+			Vfs::Directory_service::Stat stat { };
+
+			Dir_path const abs_path("/depot/", name_dir_path);
+
+			if (_root.root_dir().stat(abs_path.string(), stat)
+			    != Vfs::Directory_service::STAT_OK)
+				return 0;
+
+			if (stat.modification_time.value != Vfs::Timestamp::INVALID)
+				return stat.modification_time.value;
+
+			/* fall back to the hash of the names of the versions */
+			Stamp hash = 5381;
+			try {
+				Directory(_depot, name_dir_path).for_each_entry([&] (Directory::Entry const &entry) {
+					for (char const *s = entry.name().string(); *s; s++)
+						hash = hash*33 + *s;
+					hash = hash*33 + '/';
+				});
+			}
+			catch (Directory::Nonexistent_directory) { return 0; }
+			catch (Directory::Read_dir_failed)       { return 0; }
+
+			return hash;
+		}
+
+		void _destroy(Entry &entry)
+		{
+			if (!entry.has_content)
+				_stat_used -= sizeof(Entry);
+
+			_entries.remove(&entry);
+			destroy(_alloc, &entry);
+		}
+
+		void _destroy(Name_dir &name_dir)
+		{
+			name_dir.entries.for_each([&] (Entry &entry) { _destroy(entry); });
+			_name_dirs.remove(&name_dir);
+			destroy(_alloc, &name_dir);
+		}
+
+		Name_dir &_create_name_dir(User &user, Path const &path, Stamp stamp)
+		{
+			Name_dir &name_dir = *new (_alloc) Name_dir(user, path, stamp);
+			_name_dirs.insert(&name_dir);
+			return name_dir;
+		}
+
+		Entry &_create_entry(Name_dir &name_dir, Path const &path,
+		                     Entry::Content const &content)
+		{
+			Entry &entry = *new (_alloc) Entry(_alloc, name_dir, path, content);
+			_entries.insert(&entry);
+
+			if (!entry.has_content)
+				_stat_used += sizeof(Entry);
+
+			return entry;
+		}
+
+		bool _stat_limit_reached() const
+		{
+			return _stat_used + sizeof(Entry) > _stat_limit.value;
+		}
+
+		Dir_path _index_file_path(Archive::User const &name) const
+		{
+			return Dir_path(_index_dir, "/", name);
+		}
+
+		User &_user(Archive::User const &name)
+		{
+			User *result = nullptr;
+			_users.for_each([&] (User &user) {
+				if (user.name == name)
+					result = &user; });
+
+			if (result)
+				return *result;
+
+			User &user = *new (_alloc) User(_users, name);
+			_load(user);
+			return user;
+		}
+
+		/**
+		 * Return name directory of 'path', dropping stale entries
+		 */
+		Name_dir &_validated_name_dir(Path const &path)
+		{
+			Path const name_dir_path = _name_dir_path(path);
+
+			/* load the index of the user before looking up the name directory */
+			User &user = _user(Archive::user(path));
+
+			Name_dir *name_dir_ptr = _lookup<Name_dir>(_name_dirs, name_dir_path);
+			if (!name_dir_ptr)
+				name_dir_ptr = &_create_name_dir(user, name_dir_path, 0);
+
+			Name_dir &name_dir = *name_dir_ptr;
+
+			if (name_dir.generation == _generation)
+				return name_dir;
+
+			name_dir.generation = _generation;
+
+			Stamp const stamp = _stamp(name_dir_path);
+			if (stamp == name_dir.stamp)
+				return name_dir;
+
+			if (!name_dir.empty())
+				name_dir.user.dirty = true;
+
+			name_dir.entries.for_each([&] (Entry &entry) { _destroy(entry); });
+			name_dir.stamp = stamp;
+
+			return name_dir;
+		}
+
+		template <typename CHECK_FN>
+		bool _exists(Path const &path, CHECK_FN const &check_fn)
+		{
+			if (Archive::user(path) == "local")
+				return check_fn();
+
+			Name_dir &name_dir = _validated_name_dir(path);
+
+			if (_lookup<Entry>(_entries, path)) {
+				_stats.hits++;
+				return true;
+			}
+
+			_stats.misses++;
+
+			if (!check_fn())
+				return false;
+
+			if (_stat_limit_reached())
+				return true;
+
+			_create_entry(name_dir, path, Entry::Content { false, nullptr, 0 });
+			name_dir.user.dirty = true;
+			return true;
+		}
+
+		/**
+		 * Call 'fn' for each line of the text 'src' of 'size' bytes
+		 *
+		 * The lines are split the same way as by 'File_content::for_each_line'.
+		 */
+		template <typename STRING, typename FN>
+		static void _for_each_line(char const *src, size_t size, FN const &fn)
+		{
+			char const *curr_line     = src;
+			size_t      curr_line_len = 0;
+
+			for (size_t n = 0; ; n++) {
+
+				char const c = (n == size) ? 0 : *src++;
+				bool const end_of_data = (c == 0);
+				bool const end_of_line = (c == '\n');
+
+				if (!end_of_data && !end_of_line) {
+					curr_line_len++;
+					continue;
+				}
+
+				if (!end_of_data || curr_line_len > 0)
+					fn(STRING(Cstring(curr_line, curr_line_len)));
+
+				if (end_of_data)
+					break;
+
+				curr_line     = src;
+				curr_line_len = 0;
+			}
+		}
+
+
+		/*****************
+		 ** Persistence **
+		 *****************/
+
+		/*
+		 * An index file starts with a line containing the format version
+		 * followed by the records of the name directories and their entries.
+		 *
+		 *   N <stamp> <name-dir path>
+		 *   E <path>
+		 *   C <size> <path>
+		 *   <size bytes of content>
+		 *
+		 * The file is terminated by a line containing 'end'. Stamp and size
+		 * are hexadecimal numbers.
+		 */
+
+		enum { VERSION = 1 };
+
+		typedef String<32> Header;
+
+		static Header _header() { return Header("depot_query index ", (unsigned)VERSION); }
+
+		/**
+		 * Cursor for parsing the content of an index file
+		 */
+		struct Reader
+		{
+			char const *_ptr;
+			size_t      _len;
+
+			struct Malformed : Exception { };
+
+			bool at_end() const { return _len == 0; }
+
+			char const *take(size_t n)
+			{
+				if (n > _len)
+					throw Malformed();
+
+				char const * const result = _ptr;
+				_ptr += n;
+				_len -= n;
+				return result;
+			}
+
+			/**
+			 * Return next line without the newline character
+			 */
+			Cstring line()
+			{
+				size_t n = 0;
+				for (; n < _len && _ptr[n] != '\n'; n++);
+
+				if (n == _len)
+					throw Malformed();
+
+				Cstring const result(_ptr, n);
+				take(n + 1);
+				return result;
+			}
+		};
+
+		/**
+		 * Parse 'hexadecimal number, space, path' as found in the records
+		 */
+		static Path _number_and_path(char const *s, uint64_t &number)
+		{
+			size_t const n = ascii_to_unsigned(s, number, 16);
+			if (n == 0 || s[n] != ' ')
+				throw Reader::Malformed();
+
+			return Path(s + n + 1);
+		}
+
+		void _load(User &user)
+		{
+			if (!_index_dir.valid())
+				return;
+
+			Dir_path const file_path = _index_file_path(user.name);
+			if (!_root.file_exists(file_path))
+				return;
+
+			try {
+				File_content const file(_alloc, _root, file_path,
+				                        File_content::Limit{_file_limit.value});
+
+				file.bytes([&] (char const *start, size_t size) {
+
+					Reader reader { start, size };
+
+					if (Header(reader.line()) != _header())
+						throw Reader::Malformed();
+
+					Name_dir *name_dir = nullptr;
+
+					for (;;) {
+
+						typedef String<Path::size() + 24> Line;
+						Line const line(reader.line());
+
+						if (line == "end")
+							break;
+
+						char const * const s    = line.string();
+						char const * const args = s + 2;
+
+						if (line.length() < 3 || s[1] != ' ')
+							throw Reader::Malformed();
+
+						switch (s[0]) {
+
+						case 'N':
+							{
+								uint64_t stamp = 0;
+								Path const path = _number_and_path(args, stamp);
+
+								if (_lookup<Name_dir>(_name_dirs, path))
+									throw Reader::Malformed();
+
+								name_dir = &_create_name_dir(user, path, stamp);
+							}
+							break;
+
+						case 'E':
+							if (!name_dir || _lookup<Entry>(_entries, Path(args)))
+								throw Reader::Malformed();
+
+							if (_stat_limit_reached())
+								break;
+
+							_create_entry(*name_dir, Path(args),
+							              Entry::Content { false, nullptr, 0 });
+							break;
+
+						case 'C':
+							{
+								uint64_t size = 0;
+								Path const path = _number_and_path(args, size);
+
+								if (!name_dir || _lookup<Entry>(_entries, path))
+									throw Reader::Malformed();
+
+								_create_entry(*name_dir, path, Entry::Content {
+									true, reader.take((size_t)size), (size_t)size });
+								reader.line();
+							}
+							break;
+
+						default:
+							throw Reader::Malformed();
+						}
+					}
+				});
+			}
+			catch (Reader::Malformed) {
+				warning("ignoring malformed depot index '", file_path, "'");
+				user.name_dirs.for_each([&] (Name_dir &name_dir) { _destroy(name_dir); });
+			}
+			catch (Directory::Nonexistent_file) { }
+			catch (File::Truncated_during_read) {
+				warning("unable to read depot index '", file_path, "'"); }
+		}
+
+		void _save(User &user)
+		{
+			bool write_error = false;
+
+			try {
+				New_file file(_root, _index_file_path(user.name));
+
+				typedef String<Path::size() + 24> Line;
+
+				auto append = [&] (auto const &string) {
+					if (file.append(string.string(), string.length() - 1)
+					    != New_file::Append_result::OK)
+						write_error = true; };
+
+				append(Header(_header(), "\n"));
+
+				user.name_dirs.for_each([&] (Name_dir const &name_dir) {
+
+					if (name_dir.empty())
+						return;
+
+					append(Line("N ", Hex(name_dir.stamp, Hex::OMIT_PREFIX), " ",
+					            name_dir.name(), "\n"));
+
+					name_dir.entries.for_each([&] (Entry const &entry) {
+
+						if (!entry.has_content) {
+							append(Line("E ", entry.name(), "\n"));
+							return;
+						}
+
+						append(Line("C ", Hex(entry.size, Hex::OMIT_PREFIX), " ",
+						            entry.name(), "\n"));
+
+						if (file.append(entry.content, entry.size)
+						    != New_file::Append_result::OK)
+							write_error = true;
+
+						append(Line("\n"));
+					});
+				});
+
+				append(Line("end\n"));
+			}
+			catch (New_file::Create_failed) { write_error = true; }
+
+			if (write_error)
+				warning("failed to write depot index for user '", user.name, "'");
+		}
+
+	public:
+
+		Index(Allocator &alloc, Root_directory &root) : _alloc(alloc), _root(root) { }
+
+		~Index()
+		{
+			_users.for_each([&] (User &user) {
+				user.name_dirs.for_each([&] (Name_dir &name_dir) { _destroy(name_dir); });
+				destroy(_alloc, &user);
+			});
+		}
+
+		/**
+		 * Apply configuration
+		 *
+		 * \param index_dir   VFS directory for storing the index files, an
+		 *                    invalid path disables the persistence
+		 * \param file_limit  maximum size of an index file
+		 * \param stat_limit  maximum memory used for recording the presence
+		 *                    of files and directories
+		 */
+		void configure(Dir_path const &index_dir, Limit file_limit,
+		               Limit stat_limit)
+		{
+			_file_limit = file_limit;
+			_stat_limit = stat_limit;
+
+			if (index_dir == _index_dir)
+				return;
+
+			/* index files of the old directory are not related to the new one */
+			_users.for_each([&] (User &user) { user.dirty = true; });
+
+			_index_dir = index_dir;
+		}
+
+		/**
+		 * Start a new query
+		 *
+		 * The name directories are checked for modifications once per query.
+		 */
+		void begin_query()
+		{
+			_generation++;
+			_stats = Stats { 0, 0 };
+		}
+
+		/**
+		 * Write index files of all users with modified index
+		 */
+		void end_query()
+		{
+			_users.for_each([&] (User &user) {
+
+				if (!user.dirty)
+					return;
+
+				if (_index_dir.valid())
+					_save(user);
+
+				user.dirty = false;
+			});
+		}
+
+		Stats stats() const { return _stats; }
+
+		bool file_exists(Path const &path)
+		{
+			return _exists(path, [&] () { return _depot.file_exists(path); });
+		}
+
+		bool directory_exists(Path const &path)
+		{
+			return _exists(path, [&] () { return _depot.directory_exists(path); });
+		}
+
+		/**
+		 * Call 'fn' for each line of the depot file at 'path'
+		 *
+		 * \param STRING  string type used for the line
+		 *
+		 * \throw Directory::Nonexistent_file
+		 * \throw File::Truncated_during_read
+		 */
+		template <typename STRING, typename FN>
+		void for_each_line(Path const &path, FN const &fn)
+		{
+			File_content::Limit const limit { 16*1024 };
+
+			if (Archive::user(path) == "local") {
+				File_content(_alloc, _depot, path, limit).bytes([&] (char const *src, size_t size) {
+					_for_each_line<STRING>(src, size, fn); });
+				return;
+			}
+
+			Name_dir &name_dir = _validated_name_dir(path);
+
+			Entry *entry = _lookup<Entry>(_entries, path);
+
+			if (entry && entry->has_content) {
+				_stats.hits++;
+				_for_each_line<STRING>(entry->content, entry->size, fn);
+				return;
+			}
+
+			_stats.misses++;
+
+			/* replace entry that lacks the content */
+			if (entry)
+				_destroy(*entry);
+
+			File_content const file(_alloc, _depot, path, limit);
+
+			Entry::Content content { true, nullptr, 0 };
+			file.bytes([&] (char const *src, size_t size) {
+				content.src  = src;
+				content.size = size; });
+
+			entry = &_create_entry(name_dir, path, content);
+
+			name_dir.user.dirty = true;
+
+			_for_each_line<STRING>(entry->content, entry->size, fn);
+		}
+};
+
+#endif /* _INDEX_H_ */
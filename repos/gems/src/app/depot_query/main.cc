@@ -19,6 +19,10 @@
 #include <os/vfs.h>
 #include <depot/archive.h>
 #include <gems/lru_cache.h>
+#include <timer_session/connection.h>
+
+/* local includes */
+#include <index.h>
 
 namespace Depot_query {
 
@@ -28,7 +32,6 @@ namespace Depot_query {
 
 	struct Recursion_limit;
 	struct Dependencies;
-	class  Stat_cache;
 	struct Rom_query;
 	class  Cached_rom_query;
 	struct Main;
@@ -116,16 +119,16 @@ class Depot_query::Dependencies
 			void for_each(FN const &fn) const { _entries.for_each(fn); };
 		};
 
-		Directory const &_depot;
+		Index &_index;
 
 		Collection _present;
 		Collection _missing;
 
 	public:
 
-		Dependencies(Allocator &alloc, Directory const &depot)
+		Dependencies(Allocator &alloc, Index &index)
 		:
-			_depot(depot), _present(alloc), _missing(alloc)
+			_index(index), _present(alloc), _missing(alloc)
 		{ }
 
 		bool known(Archive::Path const &path) const
@@ -135,7 +138,7 @@ class Depot_query::Dependencies
 
 		void record(Archive::Path const &path)
 		{
-			if (_depot.directory_exists(path))
+			if (_index.directory_exists(path))
 				_present.insert(path);
 			else
 				_missing.insert(path);
@@ -152,89 +155,11 @@ class Depot_query::Dependencies
 };
 
 
-class Depot_query::Stat_cache
-{
-	private:
-
-		struct Key
-		{
-			struct Value
-			{
-				Archive::Path path;
-
-				bool operator > (Value const &other) const
-				{
-					return strcmp(path.string(), other.path.string()) > 0;
-				}
-
-				bool operator == (Value const &other) const
-				{
-					return path == other.path;
-				}
-
-			} value;
-		};
-
-		struct Result { bool file_exists; };
-
-		typedef Lru_cache<Key, Result> Cache;
-
-		Cache::Size const _size;
-
-		Cache _cache;
-
-		Directory const &_dir;
-
-	public:
-
-		Stat_cache(Directory const &dir, Allocator &alloc, Xml_node const config)
-		:
-			_size({.value = config.attribute_value("stat_cache", Number_of_bytes(64*1024))
-			              / Cache::element_size()}),
-			_cache(alloc, _size),
-			_dir(dir)
-		{ }
-
-		bool file_exists(Archive::Path const path)
-		{
-			/* don't cache the state of the 'local' depot user */
-			if (Archive::user(path) == "local")
-				return _dir.file_exists(path);
-
-			bool result = false;
-
-			auto hit_fn  = [&] (Result const &cached_result)
-			{
-				result = cached_result.file_exists;
-			};
-
-			auto miss_fn = [&] (Cache::Missing_element &missing_element)
-			{
-				Result const stat_result { _dir.file_exists(path) };
-
-				/*
-				 * Don't cache negative results because files may appear
-				 * during installation. Later queries may find files absent
-				 * from earlier queries.
-				 */
-				if (stat_result.file_exists)
-					missing_element.construct(stat_result);
-			};
-
-			Key const key { .value = { .path = path } };
-			(void)_cache.try_apply(key, hit_fn, miss_fn);
-
-			return result;
-		}
-};
-
-
 struct Depot_query::Rom_query : Interface
 {
 	/**
 	 * Look up ROM module 'rom_label' in the archives referenced by 'pkg_path'
 	 *
-	 * \throw Directory::Nonexistent_directory
 	 * \throw Directory::Nonexistent_file
 	 * \throw File::Truncated_during_read
 	 * \throw Recursion_limit::Reached
@@ -331,7 +256,9 @@ struct Depot_query::Main : private Rom_query
 
 	Directory _depot_dir { _root, "depot" };
 
-	Stat_cache _depot_stat_cache { _depot_dir, _heap, _config.xml() };
+	Index _index { _heap, _root };
+
+	Constructible<Timer::Connection> _timer { };
 
 	Signal_handler<Main> _config_handler {
 		_env.ep(), *this, &Main::_handle_config };
@@ -442,10 +369,22 @@ struct Depot_query::Main : private Rom_query
 
 		_root.apply_config(config.sub_node("vfs"));
 
+		_index.configure(config.attribute_value("index_dir", Index::Dir_path()),
+		                 Index::Limit { config.attribute_value("index_limit",
+		                                                       Number_of_bytes(1024*1024)) },
+		                 Index::Limit { config.attribute_value("stat_cache",
+		                                                       Number_of_bytes(64*1024)) });
+
+		_construct_if(config.attribute_value("timing", false), _timer, _env);
+
 		/* ignore incomplete queries that may occur at the startup */
 		if (query.has_type("empty"))
 			return;
 
+		uint64_t const start_us = _timer.constructed() ? _timer->elapsed_us() : 0;
+
+		_index.begin_query();
+
 		if (!query.has_attribute("arch"))
 			warning("query lacks 'arch' attribute");
 
@@ -473,7 +412,7 @@ struct Depot_query::Main : private Rom_query
 		});
 
 		_gen_versioned_report(_dependencies_reporter, version, [&] (Xml_generator &xml) {
-			Dependencies dependencies(_heap, _depot_dir);
+			Dependencies dependencies(_heap, _index);
 			query.for_each_sub_node("dependencies", [&] (Xml_node node) {
 
 				Archive::Path const path = node.attribute_value("path", Archive::Path());
@@ -503,6 +442,14 @@ struct Depot_query::Main : private Rom_query
 				             node.attribute_value("version", Archive::Version()),
 				             node.attribute_value("content", false),
 				             xml); }); });
+
+		_index.end_query();
+
+		if (_timer.constructed()) {
+			Index::Stats const stats = _index.stats();
+			log("query ", version, " took ", _timer->elapsed_us() - start_us, " us "
+			    "(index hits: ", stats.hits, ", misses: ", stats.misses, ")");
+		}
 	}
 
 	Main(Env &env) : _env(env)
@@ -518,20 +465,14 @@ Depot_query::Main::find_rom_in_pkg(Directory::Path const &pkg_path,
                                    Rom_label       const &rom_label,
                                    Recursion_limit        recursion_limit)
 {
-	/*
-	 * \throw Directory::Nonexistent_directory
-	 */
-	Directory pkg_dir(_depot_dir, pkg_path);
+	Archive::Path result;
 
 	/*
 	 * \throw Directory::Nonexistent_file
 	 * \throw File::Truncated_during_read
 	 */
-	File_content archives(_heap, pkg_dir, "archives", File_content::Limit{16*1024});
-
-	Archive::Path result;
-
-	archives.for_each_line<Archive::Path>([&] (Archive::Path const &archive_path) {
+	_index.for_each_line<Archive::Path>(Archive::Path(pkg_path, "/archives"),
+	                                    [&] (Archive::Path const &archive_path) {
 
 		/*
 		 * \throw Archive::Unknown_archive_type
@@ -545,7 +486,7 @@ Depot_query::Main::find_rom_in_pkg(Directory::Path const &pkg_path,
 					         Archive::name(archive_path),    "/",
 					         Archive::version(archive_path), "/", rom_label);
 
-				if (_depot_stat_cache.file_exists(rom_path))
+				if (_index.file_exists(rom_path))
 					result = rom_path;
 			}
 			break;
@@ -557,7 +498,7 @@ Depot_query::Main::find_rom_in_pkg(Directory::Path const &pkg_path,
 					         Archive::name(archive_path),    "/",
 					         Archive::version(archive_path), "/", rom_label);
 
-				if (_depot_stat_cache.file_exists(rom_path))
+				if (_index.file_exists(rom_path))
 					result = rom_path;
 			}
 			break;
@@ -662,20 +603,16 @@ void Depot_query::Main::_collect_source_dependencies(Archive::Path const &path,
 	try { switch (Archive::type(path)) {
 
 	case Archive::PKG: {
-		File_content archives(_heap, Directory(_depot_dir, path),
-		                      "archives", File_content::Limit{16*1024});
-
-		archives.for_each_line<Archive::Path>([&] (Archive::Path const &path) {
+		_index.for_each_line<Archive::Path>(Archive::Path(path, "/archives"),
+		                                    [&] (Archive::Path const &path) {
 			_collect_source_dependencies(path, dependencies, recursion_limit); });
 		break;
 	}
 
 	case Archive::SRC: {
-		File_content used_apis(_heap, Directory(_depot_dir, path),
-		                       "used_apis", File_content::Limit{16*1024});
-
 		typedef String<160> Api;
-		used_apis.for_each_line<Archive::Path>([&] (Api const &api) {
+		_index.for_each_line<Archive::Path>(Archive::Path(path, "/used_apis"),
+		                                    [&] (Api const &api) {
 			dependencies.record(Archive::Path(Archive::user(path), "/api/", api));
 		});
 		break;
@@ -705,10 +642,8 @@ void Depot_query::Main::_collect_binary_dependencies(Archive::Path const &path,
 		try {
 			dependencies.record(path);
 
-			File_content archives(_heap, Directory(_depot_dir, path),
-			                      "archives", File_content::Limit{16*1024});
-
-			archives.for_each_line<Archive::Path>([&] (Archive::Path const &archive_path) {
+			_index.for_each_line<Archive::Path>(Archive::Path(path, "/archives"),
+			                                    [&] (Archive::Path const &archive_path) {
 				_collect_binary_dependencies(archive_path, dependencies, recursion_limit); });
 
 		}
@@ -194,6 +194,12 @@ struct Menu_view::Button_widget : Widget, Animator::Item
 	}
 
 
+	bool _animation_in_progress() const override
+	{
+		return Animator::Item::animated();
+	}
+
+
 	/******************************
 	 ** Animator::Item interface **
 	 ******************************/
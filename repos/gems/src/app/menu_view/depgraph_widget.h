@@ -197,6 +197,14 @@ struct Menu_view::Depgraph_widget : Widget
 
 		Registry<Registered<Dependency> > _deps { };
 
+		bool deps_animated() const
+		{
+			bool result = false;
+			_deps.for_each([&] (Dependency const &dep) {
+				result |= dep.animated(); });
+			return result;
+		}
+
 		void cut_dependencies()
 		{
 			_deps.for_each([&] (Dependency &dep) {
@@ -516,6 +524,51 @@ struct Menu_view::Depgraph_widget : Widget
 		_children.destroy_all_elements(_model_update_policy);
 	}
 
+	/*
+	 * The edges between the nodes are drawn by the depgraph widget. Hence,
+	 * any change of the graph structure or of the node positions affects
+	 * the whole widget.
+	 */
+	unsigned long _content_hash_of(Xml_node node) const override
+	{
+		unsigned long result = Widget::_content_hash_of(node);
+
+		auto mix = [&] (char const *s, size_t len) {
+			result = result*33 + _hash(s, len); };
+
+		node.for_each_sub_node([&] (Xml_node sub_node) {
+
+			if (sub_node.has_type("dep")) {
+				sub_node.with_raw_node(mix);
+				return;
+			}
+
+			auto mix_attr = [&] (char const *attr) {
+				typedef String<64> Value;
+				Value const value = sub_node.attribute_value(attr, Value());
+				mix(value.string(), value.length());
+			};
+
+			mix_attr("name");
+			mix_attr("dep");
+			mix_attr("dep_visible");
+		});
+		return result;
+	}
+
+	bool _animation_in_progress() const override
+	{
+		bool result = false;
+
+		_nodes.for_each([&] (Node const &node) {
+			result |= node.deps_animated(); });
+
+		_children.for_each([&] (Widget const &w) {
+			result |= w.geometry_animated(); });
+
+		return result;
+	}
+
 	void update(Xml_node node) override
 	{
 		/* update depth direction */
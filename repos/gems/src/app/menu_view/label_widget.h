@@ -82,6 +82,25 @@ struct Menu_view::Label_widget : Widget, Cursor::Glyph_position
 		_selections.update_from_xml(_selection_update_policy, node);
 	}
 
+	/*
+	 * The cursor and selection sub nodes are part of the label's look
+	 */
+	unsigned long _content_hash_of(Xml_node node) const override
+	{
+		unsigned long result = 0;
+		node.with_raw_node([&] (char const *start, size_t len) {
+			result = _hash(start, len); });
+		return result;
+	}
+
+	bool _animation_in_progress() const override
+	{
+		bool result = _color.animated();
+		_cursors.for_each([&] (Cursor const &cursor) {
+			result |= cursor.animated(); });
+		return result;
+	}
+
 	Area min_size() const override
 	{
 		if (!_font)
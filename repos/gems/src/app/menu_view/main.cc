@@ -165,6 +165,25 @@ struct Menu_view::Main
 
 	bool _schedule_redraw = false;
 
+	/*
+	 * Areas of the dialog to redraw, collected from the widget tree
+	 */
+	Damage _damage { };
+
+	/* set if the whole dialog must be redrawn, e.g., after a style change */
+	bool _full_redraw = true;
+
+	Genode::Reporter _render_time_reporter = { _env, "render_time" };
+
+	struct Render_stats
+	{
+		Genode::uint64_t frames   = 0;
+		Genode::uint64_t max_us   = 0;
+		Genode::uint64_t total_us = 0;
+	} _render_stats { };
+
+	void _report_render_time(Genode::uint64_t us, size_t pixels, unsigned rects);
+
 	/**
 	 * Frame of last call of 'handle_frame_timer'
 	 */
@@ -269,12 +288,18 @@ void Menu_view::Main::_handle_config()
 	_config.update();
 
 	try {
-		_hover_reporter.enabled(_config.xml().sub_node("report")
-		                                     .attribute_value("hover", false));
+		Xml_node const report = _config.xml().sub_node("report");
+
+		_hover_reporter      .enabled(report.attribute_value("hover",       false));
+		_render_time_reporter.enabled(report.attribute_value("render_time", false));
 	} catch (...) {
-		_hover_reporter.enabled(false);
+		_hover_reporter      .enabled(false);
+		_render_time_reporter.enabled(false);
 	}
 
+	/* styles may have changed */
+	_full_redraw = true;
+
 	_handle_dialog_update();
 }
 
@@ -332,6 +357,8 @@ void Menu_view::Main::_handle_frame_timer()
 
 		_frame_cnt = 0;
 
+		Genode::uint64_t const start_us = _timer.elapsed_us();
+
 		Area const size = _root_widget_size();
 
 		unsigned const buffer_w = _buffer.constructed() ? _buffer->size().w() : 0,
@@ -342,25 +369,55 @@ void Menu_view::Main::_handle_frame_timer()
 		bool const size_increased = (max_size.w() > buffer_w)
 		                         || (max_size.h() > buffer_h);
 
-		if (!_buffer.constructed() || size_increased)
+		bool const new_buffer = !_buffer.constructed() || size_increased;
+
+		if (new_buffer)
 			_buffer.construct(_gui, max_size, _env.ram(), _env.rm());
-		else
-			_buffer->reset_surface();
 
 		_root_widget.position(Point(0, 0));
 
-		// XXX restrict redraw to dirty regions
-		//     don't perform a full dialog update
-		_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
-		                               Surface<Pixel_alpha8> &alpha) {
-			_root_widget.draw(pixel, alpha, Point(0, 0));
+		/* determine the areas affected by changes since the last redraw */
+		_root_widget.collect_damage(_damage, Point(0, 0));
+
+		Rect const buffer_rect(Point(0, 0), _buffer->size());
+
+		if (new_buffer || _full_redraw) {
+			_damage.flush([] (Rect const &) { });
+			_damage.mark_as_dirty(buffer_rect);
+			_full_redraw = false;
+		}
+
+		size_t   redrawn_pixels = 0;
+		unsigned redrawn_rects  = 0;
+
+		_damage.flush([&] (Rect const &dirty) {
+
+			Rect const rect = Rect::intersect(dirty, buffer_rect);
+			if (!rect.valid())
+				return;
+
+			_buffer->reset_surface(rect);
+
+			_buffer->apply_to_surface([&] (Surface<Pixel_rgb888> &pixel,
+			                               Surface<Pixel_alpha8> &alpha) {
+				pixel.clip(rect);
+				alpha.clip(rect);
+				_root_widget.draw(pixel, alpha, Point(0, 0));
+			});
+
+			_buffer->flush_surface(rect);
+			_gui.framebuffer()->refresh(rect.x1(), rect.y1(), rect.w(), rect.h());
+
+			redrawn_pixels += rect.area().count();
+			redrawn_rects++;
 		});
 
-		_buffer->flush_surface();
-		_gui.framebuffer()->refresh(0, 0, _buffer->size().w(), _buffer->size().h());
 		_update_view(Rect(_position, size));
 
 		_schedule_redraw = false;
+
+		_report_render_time(_timer.elapsed_us() - start_us,
+		                    redrawn_pixels, redrawn_rects);
 	}
 
 	/*
@@ -374,6 +431,27 @@ void Menu_view::Main::_handle_frame_timer()
 }
 
 
+void Menu_view::Main::_report_render_time(Genode::uint64_t const us,
+                                          size_t const pixels, unsigned const rects)
+{
+	_render_stats.frames++;
+	_render_stats.total_us += us;
+	_render_stats.max_us    = max(_render_stats.max_us, us);
+
+	if (!_render_time_reporter.enabled())
+		return;
+
+	Genode::Reporter::Xml_generator xml(_render_time_reporter, [&] () {
+		xml.attribute("frame",  _render_stats.frames);
+		xml.attribute("us",     us);
+		xml.attribute("rects",  rects);
+		xml.attribute("pixels", pixels);
+		xml.attribute("avg_us", _render_stats.total_us / _render_stats.frames);
+		xml.attribute("max_us", _render_stats.max_us);
+	});
+}
+
+
 Menu_view::Widget *
 Menu_view::Widget_factory::create(Xml_node node)
 {
@@ -17,6 +17,7 @@
 /* Genode includes */
 #include <util/xml_generator.h>
 #include <util/list_model.h>
+#include <util/dirty_rect.h>
 #include <gems/animated_geometry.h>
 
 /* local includes */
@@ -28,6 +29,11 @@ namespace Menu_view {
 	struct Widget;
 
 	typedef Margin Padding;
+
+	/**
+	 * Areas of the dialog that must be redrawn
+	 */
+	typedef Dirty_rect<Rect, 3> Damage;
 }
 
 
@@ -125,19 +131,32 @@ class Menu_view::Widget : List_model<Widget>::Element
 		{
 			Widget_factory &_factory;
 
+			/* set whenever a child widget is added or removed */
+			bool children_changed = false;
+
 			Model_update_policy(Widget_factory &factory) : _factory(factory) { }
 
-			void destroy_element(Widget &w) { _factory.destroy(&w); }
+			void destroy_element(Widget &w)
+			{
+				children_changed = true;
+				_factory.destroy(&w);
+			}
 
 			Widget &create_element(Xml_node elem_node)
 			{
+				children_changed = true;
+
 				if (Widget *w = _factory.create(elem_node))
 					return *w;
 
 				throw Unknown_element_type();
 			}
 
-			void update_element(Widget &w, Xml_node node) { w.update(node); }
+			void update_element(Widget &w, Xml_node node)
+			{
+				w._track_content(node);
+				w.update(node);
+			}
 
 			static bool element_matches_xml_node(Widget const &w, Xml_node node)
 			{
@@ -151,8 +170,67 @@ class Menu_view::Widget : List_model<Widget>::Element
 		inline void _update_children(Xml_node node)
 		{
 			_children.update_from_xml(_model_update_policy, node);
+
+			/* redraw the area of removed children */
+			if (_model_update_policy.children_changed)
+				_content_changed = true;
+
+			_model_update_policy.children_changed = false;
+		}
+
+		/*
+		 * Absolute widget area at the time of the most recent redraw
+		 */
+		Rect _drawn { };
+
+		unsigned long _content_hash = 0;
+
+		bool _content_changed = true;
+
+		static unsigned long _hash(char const *s, size_t len)
+		{
+			/* djb2 */
+			unsigned long h = 5381;
+			for (size_t i = 0; i < len; i++)
+				h = h*33 + (unsigned char)s[i];
+			return h;
+		}
+
+		/**
+		 * Return hash of the parts of 'node' that affect the widget's look
+		 *
+		 * By default, only the start tag is considered because sub nodes
+		 * are handled by the child widgets.
+		 */
+		virtual unsigned long _content_hash_of(Xml_node node) const
+		{
+			unsigned long result = 0;
+			node.with_raw_node([&] (char const *start, size_t len) {
+				size_t n = 0;
+				while (n < len && start[n] != '>')
+					n++;
+				result = _hash(start, n);
+			});
+			return result;
+		}
+
+		void _track_content(Xml_node node)
+		{
+			unsigned long const hash = _content_hash_of(node);
+
+			if (hash != _content_hash)
+				_content_changed = true;
+
+			_content_hash = hash;
 		}
 
+		/**
+		 * Return true if the look of the widget changes by an animation
+		 *
+		 * Geometry animations are covered by 'collect_damage' already.
+		 */
+		virtual bool _animation_in_progress() const { return false; }
+
 		void _draw_children(Surface<Pixel_rgb888> &pixel_surface,
 		                    Surface<Pixel_alpha8> &alpha_surface,
 		                    Point at) const
@@ -203,6 +281,8 @@ class Menu_view::Widget : List_model<Widget>::Element
 
 		Rect animated_geometry() const { return _animated_geometry.rect(); }
 
+		bool geometry_animated() const { return _animated_geometry.animated(); }
+
 		/*
 		 * Return x/y positions of the edges of the widget with the margin
 		 * applied
@@ -254,6 +334,34 @@ class Menu_view::Widget : List_model<Widget>::Element
 			_geometry = Rect(position, _geometry.area());
 		}
 
+		/**
+		 * Mark areas affected by changes since the last call as damaged
+		 *
+		 * \param at  absolute position of the widget, as passed to 'draw'
+		 */
+		void collect_damage(Damage &damage, Point at)
+		{
+			Rect const rect(at, _animated_geometry.rect().area());
+
+			bool const moved = rect.p1()   != _drawn.p1()
+			                || rect.area() != _drawn.area();
+
+			if (moved || _content_changed || _animation_in_progress()) {
+
+				if (_drawn.valid())
+					damage.mark_as_dirty(_drawn);
+
+				if (rect.valid())
+					damage.mark_as_dirty(rect);
+			}
+
+			_drawn           = rect;
+			_content_changed = false;
+
+			_children.for_each([&] (Widget &w) {
+				w.collect_damage(damage, at + w._animated_geometry.p1()); });
+		}
+
 		static Point _at_child(Point at, Widget const &w)
 		{
 			return at - w.geometry().p1();
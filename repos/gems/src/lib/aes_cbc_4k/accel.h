@@ -0,0 +1,35 @@
+/*
+ * \brief  Interface of the hardware-accelerated AES CBC back end
+ * \author Pirmin Duss
+ * \date   2020-11-04
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _ACCEL_H_
+#define _ACCEL_H_
+
+/* Genode includes */
+#include <base/stdint.h>
+#include <aes_cbc_4k/aes_cbc_4k.h>
+
+namespace Aes_cbc_4k { namespace Accel {
+
+	/**
+	 * Return true if the CPU provides the instructions used by the back end
+	 */
+	bool available();
+
+	void encrypt(Key const &, Block_number first, Plaintext const *,
+	             Ciphertext *, unsigned count);
+
+	void decrypt(Key const &, Block_number first, Ciphertext const *,
+	             Plaintext *, unsigned count);
+} }
+
+#endif /* _ACCEL_H_ */
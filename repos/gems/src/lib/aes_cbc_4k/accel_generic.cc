@@ -0,0 +1,23 @@
+/*
+ * \brief  Back end for CPUs without supported AES instructions
+ * \author Pirmin Duss
+ * \date   2020-11-04
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* local includes */
+#include <accel.h>
+
+bool Aes_cbc_4k::Accel::available() { return false; }
+
+void Aes_cbc_4k::Accel::encrypt(Key const &, Block_number, Plaintext const *,
+                                Ciphertext *, unsigned) { }
+
+void Aes_cbc_4k::Accel::decrypt(Key const &, Block_number, Ciphertext const *,
+                                Plaintext *, unsigned) { }
@@ -0,0 +1,45 @@
+/*
+ * \brief  Encryption and decryption of several 4KiB data blocks at once
+ * \author Pirmin Duss
+ * \date   2020-11-04
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* local includes */
+#include <accel.h>
+
+using namespace Aes_cbc_4k;
+
+
+void Aes_cbc_4k::encrypt(Key const &key, Block_number first,
+                         Plaintext const *plaintext, Ciphertext *ciphertext,
+                         unsigned count)
+{
+	if (Accel::available()) {
+		Accel::encrypt(key, first, plaintext, ciphertext, count);
+		return;
+	}
+
+	for (unsigned i = 0; i < count; i++)
+		encrypt(key, Block_number { first.value + i }, plaintext[i], ciphertext[i]);
+}
+
+
+void Aes_cbc_4k::decrypt(Key const &key, Block_number first,
+                         Ciphertext const *ciphertext, Plaintext *plaintext,
+                         unsigned count)
+{
+	if (Accel::available()) {
+		Accel::decrypt(key, first, ciphertext, plaintext, count);
+		return;
+	}
+
+	for (unsigned i = 0; i < count; i++)
+		decrypt(key, Block_number { first.value + i }, ciphertext[i], plaintext[i]);
+}
@@ -0,0 +1,273 @@
+/*
+ * \brief  AES CBC back end using the AES-NI instructions of x86 CPUs
+ * \author Pirmin Duss
+ * \date   2020-11-04
+ *
+ * CBC encryption is sequential within a block because each 16-byte chunk
+ * depends on the ciphertext of its predecessor. Different 4KiB blocks are
+ * independent, however. Hence, 'LANES' blocks are encrypted in an
+ * interleaved way, which hides the latency of the AES instructions. For
+ * decryption, the chunks of a block are independent and thus processed
+ * 'LANES' chunks at a time.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <util/string.h>
+
+/* local includes */
+#include <accel.h>
+#include <sha256.h>
+
+using namespace Aes_cbc_4k;
+
+namespace {
+
+	typedef long long V2di __attribute__ ((vector_size (16)));
+	typedef int       V4si __attribute__ ((vector_size (16)));
+
+	enum { ROUNDS = 14, LANES = 4, CHUNK = 16, CHUNKS = sizeof(Block)/CHUNK };
+
+	/**
+	 * Overwrite key material with zeros
+	 *
+	 * The empty asm statement that takes the buffer as input keeps the
+	 * compiler from eliminating the 'memset' of memory that is not read
+	 * afterwards.
+	 */
+	void wipe(void *dst, Genode::size_t size)
+	{
+		Genode::memset(dst, 0, size);
+		asm volatile ("" : : "r" (dst) : "memory");
+	}
+
+	struct Round_keys
+	{
+		V2di k[ROUNDS + 1];
+
+		~Round_keys() { wipe(k, sizeof(k)); }
+	};
+
+	inline V2di load(void const *p)
+	{
+		V2di v;
+		Genode::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	inline void store(void *p, V2di v) { Genode::memcpy(p, &v, sizeof(v)); }
+
+	inline V2di shift_xor(V2di x)
+	{
+		/* x ^ (x << 32) ^ (x << 64) ^ (x << 96) */
+		V2di t = __builtin_ia32_pslldqi128(x, 32);
+		x ^= t;
+		t  = __builtin_ia32_pslldqi128(t, 32);
+		x ^= t;
+		t  = __builtin_ia32_pslldqi128(t, 32);
+		return x ^ t;
+	}
+
+	inline V2di next_even(V2di prev, V2di assist)
+	{
+		return shift_xor(prev) ^ (V2di)__builtin_ia32_pshufd((V4si)assist, 0xff);
+	}
+
+	inline V2di next_odd(V2di prev, V2di even)
+	{
+		V2di const assist = __builtin_ia32_aeskeygenassist128(even, 0);
+		return shift_xor(prev) ^ (V2di)__builtin_ia32_pshufd((V4si)assist, 0xaa);
+	}
+
+	/**
+	 * Expand 256-bit key into encryption round keys
+	 */
+	void expand_key(Round_keys &rk, void const *key)
+	{
+		V2di *k = rk.k;
+
+		k[0] = load(key);
+		k[1] = load((char const *)key + 16);
+
+		/* the RCON operand of 'aeskeygenassist' must be an immediate */
+		k[ 2] = next_even(k[ 0], __builtin_ia32_aeskeygenassist128(k[ 1], 0x01));
+		k[ 3] = next_odd (k[ 1], k[ 2]);
+		k[ 4] = next_even(k[ 2], __builtin_ia32_aeskeygenassist128(k[ 3], 0x02));
+		k[ 5] = next_odd (k[ 3], k[ 4]);
+		k[ 6] = next_even(k[ 4], __builtin_ia32_aeskeygenassist128(k[ 5], 0x04));
+		k[ 7] = next_odd (k[ 5], k[ 6]);
+		k[ 8] = next_even(k[ 6], __builtin_ia32_aeskeygenassist128(k[ 7], 0x08));
+		k[ 9] = next_odd (k[ 7], k[ 8]);
+		k[10] = next_even(k[ 8], __builtin_ia32_aeskeygenassist128(k[ 9], 0x10));
+		k[11] = next_odd (k[ 9], k[10]);
+		k[12] = next_even(k[10], __builtin_ia32_aeskeygenassist128(k[11], 0x20));
+		k[13] = next_odd (k[11], k[12]);
+		k[14] = next_even(k[12], __builtin_ia32_aeskeygenassist128(k[13], 0x40));
+	}
+
+	/**
+	 * Derive decryption round keys for the equivalent inverse cipher
+	 */
+	void invert_keys(Round_keys &dk, Round_keys const &rk)
+	{
+		dk.k[0] = rk.k[ROUNDS];
+		for (unsigned i = 1; i < ROUNDS; i++)
+			dk.k[i] = __builtin_ia32_aesimc128(rk.k[ROUNDS - i]);
+		dk.k[ROUNDS] = rk.k[0];
+	}
+
+	template <unsigned N>
+	inline void encrypt_chunks(Round_keys const &rk, V2di (&x)[N])
+	{
+		for (unsigned l = 0; l < N; l++)
+			x[l] ^= rk.k[0];
+
+		for (unsigned r = 1; r < ROUNDS; r++)
+			for (unsigned l = 0; l < N; l++)
+				x[l] = __builtin_ia32_aesenc128(x[l], rk.k[r]);
+
+		for (unsigned l = 0; l < N; l++)
+			x[l] = __builtin_ia32_aesenclast128(x[l], rk.k[ROUNDS]);
+	}
+
+	template <unsigned N>
+	inline void decrypt_chunks(Round_keys const &dk, V2di (&x)[N])
+	{
+		for (unsigned l = 0; l < N; l++)
+			x[l] ^= dk.k[0];
+
+		for (unsigned r = 1; r < ROUNDS; r++)
+			for (unsigned l = 0; l < N; l++)
+				x[l] = __builtin_ia32_aesdec128(x[l], dk.k[r]);
+
+		for (unsigned l = 0; l < N; l++)
+			x[l] = __builtin_ia32_aesdeclast128(x[l], dk.k[ROUNDS]);
+	}
+
+	/**
+	 * Initialization vectors of 'N' consecutive blocks
+	 *
+	 * The IV of a block is the block number, padded to 16 bytes, encrypted
+	 * with the SHA-256 hash of the key.
+	 */
+	template <unsigned N>
+	inline void init_ivs(Round_keys const &iv_rk, Block_number first, V2di (&iv)[N])
+	{
+		for (unsigned l = 0; l < N; l++) {
+			uint64_t const text[2] = { first.value + l, 0 };
+			iv[l] = load(text);
+		}
+		encrypt_chunks(iv_rk, iv);
+	}
+
+	struct Keys
+	{
+		Round_keys rk { };     /* round keys of the data key */
+		Round_keys iv_rk { };  /* round keys of the hashed key */
+
+		Keys(Key const &key)
+		{
+			expand_key(rk, key.values);
+
+			uint8_t digest[32];
+			sha256((uint8_t const *)key.values, sizeof(key.values), digest);
+			expand_key(iv_rk, digest);
+
+			wipe(digest, sizeof(digest));
+		}
+	};
+
+	template <unsigned N>
+	void encrypt_lanes(Keys const &keys, Block_number first,
+	                   Plaintext const *p, Ciphertext *c)
+	{
+		V2di x[N];
+		init_ivs(keys.iv_rk, first, x);
+
+		for (unsigned i = 0; i < CHUNKS; i++) {
+
+			for (unsigned l = 0; l < N; l++)
+				x[l] ^= load(p[l].values + i*CHUNK);
+
+			encrypt_chunks(keys.rk, x);
+
+			for (unsigned l = 0; l < N; l++)
+				store(c[l].values + i*CHUNK, x[l]);
+		}
+	}
+
+	void decrypt_block(Round_keys const &dk, V2di iv,
+	                   Ciphertext const &c, Plaintext &p)
+	{
+		V2di prev = iv;
+
+		for (unsigned i = 0; i < CHUNKS; i += LANES) {
+
+			V2di x[LANES], in[LANES];
+
+			for (unsigned l = 0; l < LANES; l++)
+				x[l] = in[l] = load(c.values + (i + l)*CHUNK);
+
+			decrypt_chunks(dk, x);
+
+			for (unsigned l = 0; l < LANES; l++) {
+				store(p.values + (i + l)*CHUNK, x[l] ^ prev);
+				prev = in[l];
+			}
+		}
+	}
+
+	bool cpu_has_aes()
+	{
+		unsigned eax = 1, ebx = 0, ecx = 0, edx = 0;
+		asm volatile ("cpuid" : "+a" (eax), "=b" (ebx), "+c" (ecx), "=d" (edx));
+
+		enum { ECX_AES = 1U << 25 };
+		return ecx & ECX_AES;
+	}
+}
+
+
+bool Aes_cbc_4k::Accel::available()
+{
+	static bool const aes = cpu_has_aes();
+	return aes;
+}
+
+
+void Aes_cbc_4k::Accel::encrypt(Key const &key, Block_number first,
+                                Plaintext const *p, Ciphertext *c,
+                                unsigned count)
+{
+	Keys const keys(key);
+
+	unsigned i = 0;
+	for (; i + LANES <= count; i += LANES)
+		encrypt_lanes<LANES>(keys, Block_number { first.value + i }, p + i, c + i);
+
+	for (; i < count; i++)
+		encrypt_lanes<1>(keys, Block_number { first.value + i }, p + i, c + i);
+}
+
+
+void Aes_cbc_4k::Accel::decrypt(Key const &key, Block_number first,
+                                Ciphertext const *c, Plaintext *p,
+                                unsigned count)
+{
+	Keys const keys(key);
+
+	Round_keys dk;
+	invert_keys(dk, keys.rk);
+
+	for (unsigned i = 0; i < count; i++) {
+		V2di iv[1];
+		init_ivs(keys.iv_rk, Block_number { first.value + i }, iv);
+		decrypt_block(dk, iv[0], c[i], p[i]);
+	}
+}
@@ -13,8 +13,8 @@
 
 #include <vfs/file_system_factory.h>
 #include <os/path.h>
-#include <os/ring_buffer.h>
 #include <base/registry.h>
+#include <util/misc_math.h>
 
 namespace Vfs_pipe {
 	using namespace Vfs;
@@ -23,8 +23,11 @@ namespace Vfs_pipe {
 	typedef Vfs::File_io_service::Read_result Read_result;
 	typedef Genode::Path<32> Path;
 
-	enum { PIPE_BUF_SIZE = 8192U };
-	typedef Genode::Ring_buffer<unsigned char, PIPE_BUF_SIZE+1> Pipe_buffer;
+	enum {
+		DEFAULT_BUFFER_SIZE = 8*1024,
+	};
+
+	class Pipe_buffer;
 
 	struct Pipe_handle;
 	typedef Genode::Fifo_element<Pipe_handle> Handle_element;
@@ -41,6 +44,176 @@ namespace Vfs_pipe {
 }
 
 
+/**
+ * Ring buffer that grows on demand up to a maximum capacity
+ *
+ * A pipe starts with a small buffer. When a write does not fit, the buffer
+ * grows by powers of two until the write fits or the maximum capacity is
+ * reached. So a writer that outpaces the reader moves large chunks per
+ * wakeup of the reader instead of a few KiB. The buffer shrinks back to its
+ * initial capacity only after the reader drained it several times in a row
+ * without the fill level exceeding the initial capacity in between. A
+ * continuous transfer thereby keeps the grown buffer while a pipe that saw
+ * a single burst returns the memory. Data is copied by 'memcpy' of at most
+ * two contiguous segments per operation.
+ */
+class Vfs_pipe::Pipe_buffer
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Pipe_buffer(Pipe_buffer const &);
+		Pipe_buffer &operator = (Pipe_buffer const &);
+
+		typedef Genode::size_t size_t;
+
+		/*
+		 * Number of consecutive drains with a low fill level before the
+		 * grown buffer is released
+		 */
+		enum { SHRINK_DRAINS = 64 };
+
+		Genode::Allocator &_alloc;
+
+		size_t const _initial;
+		size_t const _max;
+		size_t       _capacity;
+		char        *_data = (char *)_alloc.alloc(_capacity);
+		size_t       _head = 0;  /* offset of the first unread byte */
+		size_t       _used = 0;
+		unsigned     _low_drains = 0;
+
+		/**
+		 * Grow buffer such that 'len' more bytes fit in, as far as possible
+		 */
+		void _grow(size_t len)
+		{
+			size_t capacity = _capacity;
+			while (capacity < _used + len && capacity < _max)
+				capacity = Genode::min(2*capacity, _max);
+
+			if (capacity == _capacity)
+				return;
+
+			char *data = nullptr;
+			try { data = (char *)_alloc.alloc(capacity); }
+			catch (Genode::Out_of_ram)  { return; }
+			catch (Genode::Out_of_caps) { return; }
+
+			_read(data, _used);
+
+			_alloc.free(_data, _capacity);
+			_data     = data;
+			_capacity = capacity;
+			_head     = 0;
+		}
+
+		/**
+		 * Release grown buffer of the drained pipe
+		 */
+		void _shrink()
+		{
+			char *data = nullptr;
+			try { data = (char *)_alloc.alloc(_initial); }
+			catch (Genode::Out_of_ram)  { return; }
+			catch (Genode::Out_of_caps) { return; }
+
+			_alloc.free(_data, _capacity);
+			_data     = data;
+			_capacity = _initial;
+			_head     = 0;
+		}
+
+		/**
+		 * Copy 'len' bytes from the head of the buffer without consuming them
+		 */
+		void _read(char *dst, size_t len) const
+		{
+			size_t const first = Genode::min(len, _capacity - _head);
+			Genode::memcpy(dst, _data + _head, first);
+			Genode::memcpy(dst + first, _data, len - first);
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 */
+		Pipe_buffer(Genode::Allocator &alloc, size_t initial, size_t max)
+		:
+			_alloc(alloc), _initial(initial), _max(Genode::max(max, initial)),
+			_capacity(initial)
+		{ }
+
+		~Pipe_buffer() { _alloc.free(_data, _capacity); }
+
+		bool   empty() const { return _used == 0; }
+		size_t used()  const { return _used; }
+
+		/**
+		 * Number of bytes that can be written, including growth
+		 */
+		size_t avail_capacity() const { return _max - _used; }
+
+		/**
+		 * Append up to 'len' bytes
+		 *
+		 * \return number of bytes written
+		 */
+		size_t write(char const *src, size_t len)
+		{
+			if (_capacity - _used < len)
+				_grow(len);
+
+			len = Genode::min(len, _capacity - _used);
+
+			size_t const tail  = (_head + _used) % _capacity;
+			size_t const first = Genode::min(len, _capacity - tail);
+			Genode::memcpy(_data + tail, src, first);
+			Genode::memcpy(_data, src + first, len - first);
+
+			_used += len;
+
+			if (_used > _initial)
+				_low_drains = 0;
+
+			return len;
+		}
+
+		/**
+		 * Consume up to 'len' bytes
+		 *
+		 * \return number of bytes read
+		 */
+		size_t read(char *dst, size_t len)
+		{
+			len = Genode::min(len, _used);
+
+			_read(dst, len);
+
+			_head  = (_head + len) % _capacity;
+			_used -= len;
+
+			/* restart at the beginning to keep subsequent copies contiguous */
+			if (!_used) {
+				_head = 0;
+
+				if (_capacity > _initial && ++_low_drains >= SHRINK_DRAINS) {
+					_low_drains = 0;
+					_shrink();
+				}
+			}
+
+			return len;
+		}
+};
+
+
 struct Vfs_pipe::Pipe_handle : Vfs::Vfs_handle, private Pipe_handle_registry_element
 {
 	Pipe &pipe;
@@ -79,9 +252,17 @@ struct Vfs_pipe::Pipe_handle : Vfs::Vfs_handle, private Pipe_handle_registry_ele
 
 struct Vfs_pipe::Pipe
 {
+	/*
+	 * Noncopyable
+	 */
+	Pipe(Pipe const &);
+	Pipe &operator = (Pipe const &);
+
+	struct Buffer_size { Genode::size_t initial, max; };
+
 	Genode::Allocator &alloc;
 	Pipe_space::Element space_elem;
-	Pipe_buffer buffer { };
+	Pipe_buffer buffer;
 	Pipe_handle_registry registry { };
 	Handle_fifo io_progress_waiters { };
 	Handle_fifo read_ready_waiters { };
@@ -92,8 +273,13 @@ struct Vfs_pipe::Pipe
 	bool new_handle_active { true };
 
 	Pipe(Genode::Allocator &alloc, Pipe_space &space,
-	     Genode::Signal_context_capability &notify_sigh)
-	: alloc(alloc), space_elem(*this, space), notify_sigh(notify_sigh) { }
+	     Genode::Signal_context_capability &notify_sigh,
+	     Buffer_size const &buffer_size)
+	:
+		alloc(alloc), space_elem(*this, space),
+		buffer(alloc, buffer_size.initial, buffer_size.max),
+		notify_sigh(notify_sigh)
+	{ }
 
 	~Pipe() { }
 
@@ -179,13 +365,9 @@ struct Vfs_pipe::Pipe
 	                   const char *buf, file_size count,
 	                   file_size &out_count)
 	{
-		file_size out = 0;
 		bool notify = buffer.empty();
 
-		while (out < count && 0 < buffer.avail_capacity()) {
-			buffer.add(*(buf++));
-			++out;
-		}
+		file_size const out = buffer.write(buf, (Genode::size_t)count);
 
 		out_count = out;
 		if (out < count)
@@ -201,13 +383,10 @@ struct Vfs_pipe::Pipe
 	                 char *buf, file_size count,
 	                 file_size &out_count)
 	{
-		bool notify = buffer.avail_capacity() == 0;
+		/* wake up writers that stalled on the full buffer */
+		bool notify = !io_progress_waiters.empty();
 
-		file_size out = 0;
-		while (out < count && !buffer.empty()) {
-			*(buf++) = buffer.get();
-			++out;
-		}
+		file_size const out = buffer.read(buf, (Genode::size_t)count);
 
 		out_count = out;
 		if (!out) {
@@ -267,9 +446,10 @@ struct Vfs_pipe::New_pipe_handle : Vfs::Vfs_handle
 	                Genode::Allocator &alloc,
 	                unsigned flags,
 	                Pipe_space &pipe_space,
-	                Genode::Signal_context_capability &notify_sigh)
+	                Genode::Signal_context_capability &notify_sigh,
+	                Pipe::Buffer_size const &buffer_size)
 	: Vfs::Vfs_handle(fs, fs, alloc, flags),
-	  pipe(*(new (alloc) Pipe(alloc, pipe_space, notify_sigh)))
+	  pipe(*(new (alloc) Pipe(alloc, pipe_space, notify_sigh, buffer_size)))
 	{ }
 
 	~New_pipe_handle()
@@ -298,6 +478,23 @@ class Vfs_pipe::File_system : public Vfs::File_system
 
 		Pipe_space _pipe_space { };
 
+		Pipe::Buffer_size const _buffer_size;
+
+		static Pipe::Buffer_size _buffer_size_from_config(Genode::Xml_node config)
+		{
+			typedef Genode::Number_of_bytes Number_of_bytes;
+
+			Genode::size_t const initial = Genode::max((Genode::size_t)
+				config.attribute_value("buffer_size",
+				                       Number_of_bytes(DEFAULT_BUFFER_SIZE)), 1UL);
+
+			/* growth is opt-in because a pipe may consume up to the maximum */
+			Genode::size_t const max =
+				config.attribute_value("max_buffer_size", Number_of_bytes(initial));
+
+			return { initial, Genode::max(initial, max) };
+		}
+
 		/*
 		 * XXX: a hack to defer cross-thread notifications at
 		 * the libc until the io_progress handler
@@ -313,8 +510,11 @@ class Vfs_pipe::File_system : public Vfs::File_system
 
 	public:
 
-		File_system(Vfs::Env &env)
-		: _notify_handler(env.env().ep(), *this, &File_system::_notify_any) { }
+		File_system(Vfs::Env &env, Genode::Xml_node config)
+		:
+			_buffer_size(_buffer_size_from_config(config)),
+			_notify_handler(env.env().ep(), *this, &File_system::_notify_any)
+		{ }
 
 		const char* type() override { return "pipe"; }
 
@@ -337,8 +537,13 @@ class Vfs_pipe::File_system : public Vfs::File_system
 			if (path == "/new") {
 				if ((Directory_service::OPEN_MODE_ACCMODE & mode) == Directory_service::OPEN_MODE_WRONLY)
 					return Open_result::OPEN_ERR_NO_PERM;
-				*handle = new (alloc)
-					New_pipe_handle(*this, alloc, mode, _pipe_space, _notify_cap);
+				try {
+					*handle = new (alloc)
+						New_pipe_handle(*this, alloc, mode, _pipe_space,
+						                _notify_cap, _buffer_size);
+				}
+				catch (Genode::Out_of_ram)  { return Open_result::OPEN_ERR_OUT_OF_RAM; }
+				catch (Genode::Out_of_caps) { return Open_result::OPEN_ERR_OUT_OF_CAPS; }
 				return Open_result::OPEN_OK;
 			}
 
@@ -477,8 +682,7 @@ class Vfs_pipe::File_system : public Vfs::File_system
 						} else
 						if (filename == "/out") {
 							out = Stat {
-								.size              = file_size(PIPE_BUF_SIZE
-								                             - pipe.buffer.avail_capacity()),
+								.size              = file_size(pipe.buffer.used()),
 								.type              = Node_type::CONTINUOUS_FILE,
 								.rwx               = Node_rwx::ro(),
 								.inode             = Genode::addr_t(&pipe) + 2,
@@ -610,10 +814,10 @@ extern "C" Vfs::File_system_factory *vfs_file_system_factory(void)
 {
 	struct Factory : Vfs::File_system_factory
 	{
-		Vfs::File_system *create(Vfs::Env &env, Genode::Xml_node) override
+		Vfs::File_system *create(Vfs::Env &env, Genode::Xml_node config) override
 		{
 			return new (env.alloc())
-				Vfs_pipe::File_system(env);
+				Vfs_pipe::File_system(env, config);
 		}
 	};
 
@@ -71,7 +71,7 @@ class Cpu_sampler::Cpu_session_component : public Rpc_object<Cpu_session>
 
 	public:
 
-		Session_label &session_label() { return _session_label; }
+		Session_label const &session_label() const { return _session_label; }
 		Cpu_session_client &parent_cpu_session() { return _parent_cpu_session; }
 		Rpc_entrypoint &thread_ep() { return _thread_ep; }
 
@@ -34,6 +34,7 @@ Cpu_sampler::Cpu_thread_component::Cpu_thread_component(
                                 unsigned int             thread_id)
 : _cpu_session_component(cpu_session_component), _env(env),
   _md_alloc(md_alloc),
+  _pd(pd),
   _parent_cpu_thread(
       _cpu_session_component.parent_cpu_session().create_thread(pd,
                                                                 name,
@@ -87,7 +88,26 @@ void Cpu_sampler::Cpu_thread_component::take_sample()
 
 			Thread_state thread_state = _parent_cpu_thread.state();
 
-			_sample_buf[_sample_buf_index++] = thread_state.ip;
+			if (_stacks.constructed()) {
+
+				/*
+				 * Take the snapshot of the loaded objects while the thread
+				 * is known to be alive, once per sample period.
+				 */
+				if (_resolve_symbols && !_loaded_objects_valid) {
+					_loaded_objects.update(_env.rm(), _pd);
+					_loaded_objects_valid = true;
+				}
+
+				addr_t frames[MAX_STACK_DEPTH];
+				unsigned const depth =
+					_stack_walker->walk(thread_state, frames, _stacks->max_depth());
+
+				_stacks->record(frames, depth);
+
+			} else {
+				_sample_buf[_sample_buf_index++] = thread_state.ip;
+			}
 
 		} catch (State_access_failed) {
 			continue;
@@ -109,6 +129,93 @@ void Cpu_sampler::Cpu_thread_component::take_sample()
 void Cpu_sampler::Cpu_thread_component::reset()
 {
 	_sample_buf_index = 0;
+
+	if (_stacks.constructed())
+		_stacks->reset();
+
+	_loaded_objects_valid = false;
+}
+
+
+void Cpu_sampler::Cpu_thread_component::sample_stacks(unsigned depth,
+                                                      unsigned max_stacks,
+                                                      Object_name const &binary_name,
+                                                      bool symbols)
+{
+	depth = min(depth, (unsigned)MAX_STACK_DEPTH);
+
+	_binary_name     = binary_name;
+	_resolve_symbols = symbols;
+
+	if (!_stack_walker.constructed())
+		_stack_walker.construct(_env, _pd);
+
+	if (!_stacks.constructed() || _stacks->max_depth() != depth
+	 || _stacks->max_stacks() != max_stacks)
+		_stacks.construct(_md_alloc, depth, max_stacks);
+}
+
+
+void Cpu_sampler::Cpu_thread_component::sample_ips()
+{
+	_stacks.destruct();
+	_stack_walker.destruct();
+}
+
+
+void Cpu_sampler::Cpu_thread_component::_print_frame(Output       &out,
+                                                     addr_t        addr,
+                                                     bool          return_addr,
+                                                     Symbol_cache &symbols) const
+{
+	/* a return address points to the instruction following the call */
+	addr_t const lookup_addr = return_addr ? addr - 1 : addr;
+
+	bool const found =
+		_loaded_objects.with_object(lookup_addr, [&] (Object_name const &name,
+		                                              addr_t reloc_base) {
+
+			/* the dynamic linker refers to the program as 'binary' */
+			Object_name const rom_name =
+				(name == "binary") ? _binary_name : name;
+
+			addr_t const offset = lookup_addr - reloc_base;
+
+			if (char const *function = symbols.lookup(rom_name, offset))
+				print(out, function);
+			else
+				print(out, rom_name, "+", Hex(offset));
+		});
+
+	if (!found)
+		print(out, Hex(addr));
+}
+
+
+void Cpu_sampler::Cpu_thread_component::write_folded(Output &out,
+                                                     Symbol_cache &symbols)
+{
+	if (!_stacks.constructed() || _stacks->empty())
+		return;
+
+	_stacks->for_each([&] (addr_t const *frames, unsigned depth,
+	                       unsigned long count) {
+
+		print(out, _label);
+
+		for (unsigned i = depth; i > 0; i--) {
+			print(out, ";");
+			_print_frame(out, frames[i - 1], i > 1, symbols);
+		}
+
+		print(out, " ", count, "\n");
+	});
+
+	if (_stacks->dropped())
+		warning(_label, ": ", _stacks->dropped(), " of ", _stacks->total(),
+		        " samples dropped, consider increasing 'max_stacks'");
+
+	reset();
 }
 
 
@@ -21,6 +21,9 @@
 
 /* local includes */
 #include "cpu_session_component.h"
+#include "folded_stacks.h"
+#include "stack_walker.h"
+#include "symbols.h"
 
 namespace Cpu_sampler {
 	using namespace Genode;
@@ -34,11 +37,19 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 
 		enum { SAMPLE_BUF_SIZE = 1024 };
 
+	public:
+
+		enum { MAX_STACK_DEPTH = 128 };
+
+	private:
+
 		Cpu_session_component &_cpu_session_component;
 		Env                   &_env;
 
 		Allocator             &_md_alloc;
 
+		Pd_session_capability  _pd;
+
 		Cpu_thread_client      _parent_cpu_thread;
 
 		bool                   _started = false;
@@ -51,6 +62,19 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 
 		Constructible<Log_connection> _log;
 
+		/*
+		 * State of the call-stack sampling mode
+		 */
+		Constructible<Stack_walker>  _stack_walker { };
+		Constructible<Folded_stacks> _stacks       { };
+
+		Object_name    _binary_name { };
+		bool           _resolve_symbols = false;
+		Loaded_objects _loaded_objects { };
+		bool           _loaded_objects_valid = false;
+
+		void _print_frame(Output &, addr_t, bool, Symbol_cache &) const;
+
 	public:
 
 		Cpu_thread_component(Cpu_session_component   &cpu_session_component,
@@ -75,6 +99,33 @@ class Cpu_sampler::Cpu_thread_component : public Rpc_object<Cpu_thread>
 		void reset();
 		void flush();
 
+		/**
+		 * Sample the call stacks of the thread instead of its instruction pointer
+		 *
+		 * \param depth        maximum number of frames per sample
+		 * \param max_stacks   maximum number of distinct stacks per sample period
+		 * \param binary_name  ROM module of the program binary
+		 * \param symbols      resolve addresses via the table of loaded
+		 *                     objects, which exists for dynamically linked
+		 *                     components only
+		 */
+		void sample_stacks(unsigned depth, unsigned max_stacks,
+		                   Object_name const &binary_name, bool symbols);
+
+		/**
+		 * Sample the instruction pointer only
+		 */
+		void sample_ips();
+
+		/**
+		 * Write the call stacks sampled so far in the folded-stack format
+		 *
+		 * Each line consists of the thread label followed by the frames from
+		 * the outermost to the innermost function, separated by semicolons,
+		 * and the number of samples.
+		 */
+		void write_folded(Output &out, Symbol_cache &symbols);
+
 		/**************************
 		 ** CPU thread interface **
 		 *************************/
@@ -0,0 +1,188 @@
+/*
+ * \brief  Aggregation of sampled call stacks
+ * \author Pirmin Duss
+ * \date   2020-10-26
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _FOLDED_STACKS_H_
+#define _FOLDED_STACKS_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/string.h>
+
+namespace Cpu_sampler {
+	using namespace Genode;
+	class Folded_stacks;
+}
+
+
+/**
+ * Hash table of distinct call stacks and their number of occurrences
+ *
+ * The table is dimensioned at construction time and never grows. Samples
+ * of stacks that do not fit into the table anymore are only counted.
+ */
+class Cpu_sampler::Folded_stacks
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Folded_stacks(Folded_stacks const &);
+		Folded_stacks &operator = (Folded_stacks const &);
+
+		struct Entry
+		{
+			unsigned long count;
+			unsigned      depth;
+			unsigned      hash;
+
+			addr_t *frames() { return (addr_t *)(this + 1); }
+			addr_t const *frames() const { return (addr_t const *)(this + 1); }
+		};
+
+		Allocator &_alloc;
+
+		unsigned const _max_depth;
+		unsigned const _capacity;   /* number of slots, power of two */
+		unsigned const _max_used;   /* maximum number of occupied slots */
+		size_t   const _entry_size;
+
+		char * const _entries;
+
+		unsigned      _used     = 0;
+		unsigned long _dropped  = 0;
+		unsigned long _total    = 0;
+
+		static unsigned _slot_count(unsigned max_stacks)
+		{
+			/* keep the load factor of the table below 3/4 */
+			unsigned count = 16;
+			while (count < max_stacks + max_stacks/3 + 1)
+				count <<= 1;
+			return count;
+		}
+
+		size_t _table_size() const { return _capacity*_entry_size; }
+
+		Entry &_entry(unsigned i) { return *(Entry *)(_entries + i*_entry_size); }
+
+		Entry const &_entry(unsigned i) const {
+			return *(Entry const *)(_entries + i*_entry_size); }
+
+		static unsigned _hash(addr_t const *frames, unsigned depth)
+		{
+			unsigned long h = 5381;
+			for (unsigned i = 0; i < depth; i++)
+				h = h*33 ^ frames[i];
+
+			/* the hash 0 marks an empty slot */
+			return (unsigned)(h ^ (h >> 32)) | 1;
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param max_depth   maximum number of frames per stack
+		 * \param max_stacks  maximum number of distinct stacks
+		 *
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 */
+		Folded_stacks(Allocator &alloc, unsigned max_depth, unsigned max_stacks)
+		:
+			_alloc(alloc), _max_depth(max(max_depth, 1U)),
+			_capacity(_slot_count(max_stacks)), _max_used(max_stacks),
+			_entry_size(sizeof(Entry) + _max_depth*sizeof(addr_t)),
+			_entries((char *)_alloc.alloc(_table_size()))
+		{
+			reset();
+		}
+
+		~Folded_stacks() { _alloc.free(_entries, _table_size()); }
+
+		unsigned max_depth()  const { return _max_depth; }
+		unsigned max_stacks() const { return _max_used; }
+
+		/**
+		 * Account one sample of the given call stack
+		 *
+		 * \param frames  frames ordered from the innermost to the outermost
+		 */
+		void record(addr_t const *frames, unsigned depth)
+		{
+			depth = min(depth, _max_depth);
+
+			_total++;
+
+			unsigned const hash = _hash(frames, depth);
+
+			for (unsigned i = hash & (_capacity - 1); ; i = (i + 1) & (_capacity - 1)) {
+
+				Entry &e = _entry(i);
+
+				if (e.hash == 0) {
+
+					if (_used == _max_used) {
+						_dropped++;
+						return;
+					}
+
+					e.hash  = hash;
+					e.depth = depth;
+					e.count = 1;
+					memcpy(e.frames(), frames, depth*sizeof(addr_t));
+					_used++;
+					return;
+				}
+
+				if (e.hash == hash && e.depth == depth
+				 && !memcmp(e.frames(), frames, depth*sizeof(addr_t))) {
+					e.count++;
+					return;
+				}
+			}
+		}
+
+		/**
+		 * Call 'fn' for each distinct stack
+		 *
+		 * The functor is called with the frames, the depth, and the number
+		 * of samples of the stack as arguments.
+		 */
+		template <typename FN>
+		void for_each(FN const &fn) const
+		{
+			for (unsigned i = 0; i < _capacity; i++) {
+				Entry const &e = _entry(i);
+				if (e.hash)
+					fn(e.frames(), e.depth, e.count);
+			}
+		}
+
+		bool empty() const { return _total == 0; }
+
+		unsigned long total()   const { return _total; }
+		unsigned long dropped() const { return _dropped; }
+
+		void reset()
+		{
+			for (unsigned i = 0; i < _capacity; i++)
+				_entry(i).hash = 0;
+
+			_used = 0; _dropped = 0; _total = 0;
+		}
+};
+
+#endif /* _FOLDED_STACKS_H_ */
@@ -19,6 +19,7 @@
 #include <base/attached_dataspace.h>
 #include <os/session_policy.h>
 #include <os/static_root.h>
+#include <os/vfs.h>
 #include <timer_session/connection.h>
 #include <util/list.h>
 
@@ -26,14 +27,53 @@
 #include "cpu_root.h"
 #include "cpu_session_component.h"
 #include "cpu_thread_component.h"
+#include "symbols.h"
 #include "thread_list_change_handler.h"
 
-namespace Cpu_sampler { struct Main; }
+namespace Cpu_sampler {
+	struct Folded_file;
+	struct Main;
+}
 
 static constexpr bool verbose = false;
 static constexpr bool verbose_sample_duration = true;
 
 
+/**
+ * Output of folded stacks to a file, buffered per line
+ */
+struct Cpu_sampler::Folded_file : Genode::Output
+{
+	New_file &_file;
+
+	char     _buf[512];
+	unsigned _len = 0;
+	bool     _write_error = false;
+
+	Folded_file(New_file &file) : _file(file) { }
+
+	~Folded_file() { flush(); }
+
+	void flush()
+	{
+		if (_len && _file.append(_buf, _len) != New_file::Append_result::OK)
+			_write_error = true;
+
+		_len = 0;
+	}
+
+	bool write_error() const { return _write_error; }
+
+	void out_char(char c) override
+	{
+		_buf[_len++] = c;
+
+		if (c == '\n' || _len == sizeof(_buf))
+			flush();
+	}
+};
+
+
 /******************
  ** Main program **
  ******************/
@@ -52,6 +92,35 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 	unsigned int            max_sample_index;
 	Genode::uint64_t        timeout_us;
 
+	/*
+	 * Call-stack sampling, enabled by the 'folded' attribute
+	 */
+	typedef Directory::Path Path;
+
+	Path                          folded_path { };
+	unsigned                      stack_depth = 32;
+	unsigned                      max_stacks  = 1024;
+	Constructible<Root_directory> vfs { };
+	Constructible<Symbol_cache>   symbols { };
+
+	bool stack_sampling() const { return vfs.constructed() && folded_path.valid(); }
+
+	void write_folded_stacks()
+	{
+		try {
+			New_file    file(*vfs, folded_path);
+			Folded_file out(file);
+
+			for_each_thread(selected_thread_list, [&] (Thread_element *element) {
+				element->object()->write_folded(out, *symbols); });
+
+			out.flush();
+			if (out.write_error())
+				Genode::error("failed to write to '", folded_path, "'");
+		}
+		catch (New_file::Create_failed) { }
+	}
+
 
 	void handle_timeout()
 	{
@@ -67,6 +136,9 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 
 		for_each_thread(selected_thread_list, lambda);
 
+		if (stack_sampling() && (sample_index == max_sample_index))
+			write_folded_stacks();
+
 		if (verbose_sample_duration && (sample_index == max_sample_index))
 			Genode::log("sample period finished");
 
@@ -90,15 +162,42 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 		Genode::uint64_t sample_interval_ms =
 			config.xml().attribute_value<Genode::uint64_t>("sample_interval_ms", 1000);
 
+		/* a sample interval in microseconds takes precedence */
+		Genode::uint64_t sample_interval_us =
+			config.xml().attribute_value<Genode::uint64_t>("sample_interval_us",
+			                                               sample_interval_ms * 1000);
+
 		Genode::uint64_t sample_duration_s =
 			config.xml().attribute_value<Genode::uint64_t>("sample_duration_s", 10);
 
-		max_sample_index = ((sample_duration_s * 1000) / sample_interval_ms) - 1;
+		sample_interval_us = Genode::max(sample_interval_us, (Genode::uint64_t)1);
 
-		timeout_us = sample_interval_ms * 1000;
+		max_sample_index = (unsigned)(((sample_duration_s * 1000 * 1000) /
+		                               sample_interval_us) - 1);
+
+		timeout_us = sample_interval_us;
+
+		folded_path = config.xml().attribute_value("folded", Path());
+		stack_depth = config.xml().attribute_value("stack_depth", 32U);
+		max_stacks  = config.xml().attribute_value("max_stacks",  1024U);
+
+		if (folded_path.valid() && !vfs.constructed()) {
+			try {
+				vfs.construct(env, alloc, config.xml().sub_node("vfs")); }
+			catch (Xml_node::Nonexistent_sub_node) {
+				Genode::error("missing <vfs> configuration for 'folded' output"); }
+		}
+
+		/* drop the symbols of objects that may have been updated meanwhile */
+		symbols.destruct();
+		if (stack_sampling())
+			symbols.construct(env, alloc);
 
 		thread_list_changed();
 
+		for_each_thread(selected_thread_list, [&] (Thread_element *element) {
+			element->object()->reset(); });
+
 		if (verbose_sample_duration)
 			Genode::log("starting a new sample period");
 
@@ -140,7 +239,18 @@ struct Cpu_sampler::Main : Thread_list_change_handler
 			try {
 
 				Session_policy policy(cpu_thread->label(), config.xml());
-				cpu_thread->reset();
+
+				if (stack_sampling()) {
+					Object_name const default_binary =
+						cpu_thread->cpu_session_component()->session_label().last_element();
+
+					cpu_thread->sample_stacks(stack_depth, max_stacks,
+					                          policy.attribute_value("binary", default_binary),
+					                          policy.attribute_value("symbols", false));
+				} else {
+					cpu_thread->sample_ips();
+				}
+
 				selected_thread_list.insert(new (&alloc)
 				                            Thread_element(cpu_thread));
 
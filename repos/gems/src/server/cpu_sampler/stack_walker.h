@@ -0,0 +1,177 @@
+/*
+ * \brief  Frame-pointer based walk of the call stack of a sampled thread
+ * \author Pirmin Duss
+ * \date   2020-10-26
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _STACK_WALKER_H_
+#define _STACK_WALKER_H_
+
+/* Genode includes */
+#include <base/thread.h>
+#include <base/thread_state.h>
+#include <pd_session/client.h>
+#include <region_map/client.h>
+
+namespace Cpu_sampler {
+	using namespace Genode;
+	class Stack_walker;
+}
+
+
+/**
+ * Access to the stack of a sampled thread
+ *
+ * The stack area of the sampled component is obtained from the PD session
+ * of the thread. The stack slot of the thread is attached read-only to
+ * the local address space. Only the part of the slot between the stack
+ * pointer and the end of the slot is accessed because this part is
+ * guaranteed to be backed by the thread's stack dataspace.
+ *
+ * The walk relies on frame pointers. Hence, the sampled code must be
+ * compiled with '-fno-omit-frame-pointer' to obtain complete call stacks.
+ */
+class Cpu_sampler::Stack_walker : Noncopyable
+{
+	private:
+
+		Env &_env;
+
+		Pd_session_capability const _pd;
+
+		Dataspace_capability _stack_area_ds { };
+
+		addr_t _slot_base  = 0;  /* base of attached slot in the component */
+		addr_t _slot_local = 0;  /* local address of the attached slot */
+
+		static addr_t _frame_pointer(Thread_state const &state)
+		{
+#if defined(__x86_64__)
+			return state.rbp;
+#elif defined(__i386__)
+			return state.ebp;
+#elif defined(__aarch64__)
+			return state.r[29];
+#else
+			(void)state;
+			return 0;
+#endif
+		}
+
+		void _detach_slot()
+		{
+			if (_slot_local)
+				_env.rm().detach(_slot_local);
+
+			_slot_base = _slot_local = 0;
+		}
+
+		/**
+		 * Attach stack slot containing 'sp'
+		 *
+		 * \return false if 'sp' does not lie within the stack area
+		 */
+		bool _attach_slot(addr_t sp)
+		{
+			addr_t const area_base = Thread::stack_area_virtual_base();
+			size_t const area_size = Thread::stack_area_virtual_size();
+			size_t const slot_size = Thread::stack_virtual_size();
+
+			if (sp < area_base || sp - area_base >= area_size)
+				return false;
+
+			addr_t const slot_base = area_base + ((sp - area_base) & ~(slot_size - 1));
+
+			if (slot_base == _slot_base)
+				return true;
+
+			_detach_slot();
+
+			try {
+				if (!_stack_area_ds.valid())
+					_stack_area_ds =
+						Region_map_client(Pd_session_client(_pd).stack_area()).dataspace();
+
+				_slot_local = _env.rm().attach(_stack_area_ds, slot_size,
+				                               slot_base - area_base,
+				                               false, (addr_t)0, false, false);
+				_slot_base = slot_base;
+			}
+			catch (...) {
+				warning("unable to attach stack of sampled thread");
+				_slot_local = 0;
+			}
+
+			return _slot_local != 0;
+		}
+
+		addr_t _read(addr_t addr) const
+		{
+			return *(addr_t const *)(_slot_local + (addr - _slot_base));
+		}
+
+	public:
+
+		Stack_walker(Env &env, Pd_session_capability pd) : _env(env), _pd(pd) { }
+
+		~Stack_walker() { _detach_slot(); }
+
+		/**
+		 * Fill 'frames' with the instruction pointer and the return addresses
+		 *
+		 * The walk must be performed while the thread is paused.
+		 *
+		 * \return number of valid entries in 'frames'
+		 */
+		unsigned walk(Thread_state const &state, addr_t *frames, unsigned max_frames)
+		{
+			if (max_frames == 0)
+				return 0;
+
+			unsigned count = 0;
+			frames[count++] = state.ip;
+
+			addr_t const sp = state.sp;
+			addr_t       fp = _frame_pointer(state);
+
+			if (count == max_frames || !fp || !_attach_slot(sp))
+				return count;
+
+			addr_t const slot_end = _slot_base + Thread::stack_virtual_size();
+
+			/* a frame consists of the saved frame pointer and the return address */
+			while (count < max_frames) {
+
+				bool const valid_fp = (fp >= sp)
+				                   && (fp <= slot_end - 2*sizeof(addr_t))
+				                   && !(fp & (sizeof(addr_t) - 1));
+				if (!valid_fp)
+					break;
+
+				addr_t const next_fp     = _read(fp);
+				addr_t const return_addr = _read(fp + sizeof(addr_t));
+
+				if (!return_addr)
+					break;
+
+				frames[count++] = return_addr;
+
+				/* frames are located at ascending addresses */
+				if (next_fp <= fp)
+					break;
+
+				fp = next_fp;
+			}
+
+			return count;
+		}
+};
+
+#endif /* _STACK_WALKER_H_ */
@@ -0,0 +1,351 @@
+/*
+ * \brief  Resolution of sampled addresses to symbols
+ * \author Pirmin Duss
+ * \date   2020-10-26
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SYMBOLS_H_
+#define _SYMBOLS_H_
+
+/* Genode includes */
+#include <base/attached_rom_dataspace.h>
+#include <base/registry.h>
+#include <base/shared_object.h>
+#include <pd_session/client.h>
+#include <region_map/client.h>
+
+namespace Cpu_sampler {
+	using namespace Genode;
+	class Loaded_objects;
+	class Elf_symbols;
+	class Symbol_cache;
+
+	typedef String<Loaded_object_table::NAME_LEN> Object_name;
+}
+
+
+/**
+ * Snapshot of the objects loaded by the dynamic linker of a component
+ *
+ * The dynamic linker publishes the table of loaded objects at a fixed
+ * location within the linker area of the component's PD.
+ */
+class Cpu_sampler::Loaded_objects
+{
+	private:
+
+		Loaded_object_table _table { };
+
+		bool _valid = false;
+
+	public:
+
+		/**
+		 * Update snapshot from the linker area of the given PD
+		 *
+		 * The component must be dynamically linked because only then is
+		 * the table backed by memory.
+		 */
+		void update(Region_map &rm, Pd_session_capability pd)
+		{
+			enum { MAX_ATTEMPTS = 4 };
+
+			try {
+				Dataspace_capability const ds =
+					Region_map_client(Pd_session_client(pd).linker_area()).dataspace();
+
+				addr_t const local = rm.attach(ds, Loaded_object_table::SIZE,
+				                               Loaded_object_table::linker_area_offset(),
+				                               false, (addr_t)0, false, false);
+
+				Loaded_object_table const &table = *(Loaded_object_table const *)local;
+
+				_valid = false;
+				for (unsigned i = 0; i < MAX_ATTEMPTS && !_valid; i++) {
+
+					unsigned const generation = table.generation;
+					if (table.magic != Loaded_object_table::MAGIC || (generation & 1))
+						continue;
+
+					memcpy(&_table, &table, sizeof(_table));
+
+					_valid = (table.generation == generation)
+					      && (_table.count <= Loaded_object_table::MAX_OBJECTS);
+				}
+
+				rm.detach(local);
+			}
+			catch (...) { _valid = false; }
+		}
+
+		/**
+		 * Call 'fn' with the object that contains 'addr'
+		 *
+		 * \return false if no loaded object contains 'addr'
+		 */
+		template <typename FN>
+		bool with_object(addr_t addr, FN const &fn) const
+		{
+			if (!_valid)
+				return false;
+
+			for (unsigned i = 0; i < _table.count; i++) {
+				Loaded_object_table::Object const &obj = _table.objects[i];
+				if (addr >= obj.start && addr - obj.start < obj.size) {
+					fn(Object_name(Cstring(obj.name, sizeof(obj.name))), obj.reloc_base);
+					return true;
+				}
+			}
+			return false;
+		}
+};
+
+
+/**
+ * Function symbols of an ELF object obtained as ROM module
+ */
+class Cpu_sampler::Elf_symbols
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Elf_symbols(Elf_symbols const &);
+		Elf_symbols &operator = (Elf_symbols const &);
+
+		/*
+		 * Minimal ELF definitions, the layout of 'Ehdr' and 'Shdr' matches
+		 * both ELF classes when using 'addr_t' for the word-sized members.
+		 */
+		struct Ehdr
+		{
+			unsigned char  ident[16];
+			uint16_t       type, machine;
+			uint32_t       version;
+			addr_t         entry, phoff, shoff;
+			uint32_t       flags;
+			uint16_t       ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+		};
+
+		struct Shdr
+		{
+			uint32_t name, type;
+			addr_t   flags, addr, offset, size;
+			uint32_t link, info;
+			addr_t   addralign, entsize;
+		};
+
+#ifdef __LP64__
+		struct Sym
+		{
+			uint32_t      name;
+			unsigned char info, other;
+			uint16_t      shndx;
+			addr_t        value;
+			size_t        size;
+		};
+#else
+		struct Sym
+		{
+			uint32_t      name;
+			addr_t        value;
+			size_t        size;
+			unsigned char info, other;
+			uint16_t      shndx;
+		};
+#endif
+
+		enum { SHT_SYMTAB = 2, SHT_DYNSYM = 11, STT_FUNC = 2 };
+
+		struct Symbol
+		{
+			addr_t      value;
+			size_t      size;
+			char const *name;
+		};
+
+		Allocator &_alloc;
+
+		Constructible<Attached_rom_dataspace> _rom { };
+
+		Symbol   *_symbols = nullptr;
+		unsigned  _count   = 0;
+
+		Shdr const *_section(Ehdr const &ehdr, size_t rom_size, unsigned type) const
+		{
+			if (ehdr.shoff + (addr_t)ehdr.shnum*sizeof(Shdr) > rom_size)
+				return nullptr;
+
+			Shdr const * const shdr = (Shdr const *)((addr_t)&ehdr + ehdr.shoff);
+			for (unsigned i = 0; i < ehdr.shnum; i++)
+				if (shdr[i].type == type && shdr[i].link < ehdr.shnum)
+					return &shdr[i];
+
+			return nullptr;
+		}
+
+		void _import(addr_t const base, size_t const rom_size)
+		{
+			Ehdr const &ehdr = *(Ehdr const *)base;
+
+			if (rom_size < sizeof(Ehdr) || memcmp(ehdr.ident, "\177ELF", 4)
+			 || ehdr.shentsize != sizeof(Shdr))
+				return;
+
+			/* prefer the full symbol table over the dynamic symbols */
+			Shdr const *symtab = _section(ehdr, rom_size, SHT_SYMTAB);
+			if (!symtab)
+				symtab = _section(ehdr, rom_size, SHT_DYNSYM);
+			if (!symtab)
+				return;
+
+			Shdr const &strtab = ((Shdr const *)(base + ehdr.shoff))[symtab->link];
+
+			if (symtab->offset + symtab->size > rom_size
+			 || strtab.offset + strtab.size > rom_size || strtab.size == 0)
+				return;
+
+			Sym  const *syms  = (Sym const *)(base + symtab->offset);
+			unsigned    num   = (unsigned)(symtab->size / sizeof(Sym));
+			char const *names = (char const *)(base + strtab.offset);
+
+			auto is_func = [&] (Sym const &sym) {
+				return (sym.info & 0xf) == STT_FUNC && sym.value
+				    && sym.name < strtab.size; };
+
+			unsigned count = 0;
+			for (unsigned i = 0; i < num; i++)
+				if (is_func(syms[i]))
+					count++;
+
+			if (!count)
+				return;
+
+			_symbols = (Symbol *)_alloc.alloc(count*sizeof(Symbol));
+
+			for (unsigned i = 0; i < num; i++)
+				if (is_func(syms[i]))
+					_symbols[_count++] = { syms[i].value, syms[i].size,
+					                       names + syms[i].name };
+
+			/* shell sort by symbol value */
+			for (unsigned gap = _count/2; gap > 0; gap /= 2)
+				for (unsigned i = gap; i < _count; i++) {
+					Symbol const s = _symbols[i];
+					unsigned j = i;
+					for (; j >= gap && _symbols[j - gap].value > s.value; j -= gap)
+						_symbols[j] = _symbols[j - gap];
+					_symbols[j] = s;
+				}
+		}
+
+	public:
+
+		Object_name const name;
+
+		Elf_symbols(Env &env, Allocator &alloc, Object_name const &name)
+		:
+			_alloc(alloc), name(name)
+		{
+			try {
+				_rom.construct(env, name.string());
+				_import((addr_t)_rom->local_addr<char>(), _rom->size());
+			}
+			catch (...) {
+				warning("no symbols available for '", name, "'"); }
+
+			/* release the ROM if it does not contain any symbols */
+			if (!_count)
+				_rom.destruct();
+		}
+
+		virtual ~Elf_symbols()
+		{
+			if (_symbols)
+				_alloc.free(_symbols, _count*sizeof(Symbol));
+		}
+
+		/**
+		 * Return name of the function containing the object-relative 'addr'
+		 *
+		 * \return nullptr if 'addr' could not be resolved
+		 */
+		char const *lookup(addr_t addr) const
+		{
+			/* find the last symbol with a value not greater than 'addr' */
+			unsigned lo = 0, hi = _count;
+			while (lo < hi) {
+				unsigned const mid = lo + (hi - lo)/2;
+				if (_symbols[mid].value <= addr)
+					lo = mid + 1;
+				else
+					hi = mid;
+			}
+
+			if (lo == 0)
+				return nullptr;
+
+			Symbol const &sym = _symbols[lo - 1];
+
+			if (sym.size && addr - sym.value >= sym.size)
+				return nullptr;
+
+			return sym.name;
+		}
+};
+
+
+/**
+ * Symbols of all ELF objects encountered so far
+ *
+ * The symbols of an object are imported on first use and kept until the
+ * sampler is reconfigured.
+ */
+class Cpu_sampler::Symbol_cache : Noncopyable
+{
+	private:
+
+		Env       &_env;
+		Allocator &_alloc;
+
+		Registry<Registered<Elf_symbols> > _objects { };
+
+	public:
+
+		Symbol_cache(Env &env, Allocator &alloc) : _env(env), _alloc(alloc) { }
+
+		~Symbol_cache()
+		{
+			_objects.for_each([&] (Registered<Elf_symbols> &obj) {
+				destroy(_alloc, &obj); });
+		}
+
+		/**
+		 * Return function name for 'addr' within the object 'name'
+		 *
+		 * \param addr  address relative to the object's relocation base
+		 */
+		char const *lookup(Object_name const &name, addr_t addr)
+		{
+			Elf_symbols *symbols = nullptr;
+			_objects.for_each([&] (Elf_symbols &obj) {
+				if (obj.name == name)
+					symbols = &obj; });
+
+			if (!symbols)
+				symbols = new (_alloc)
+					Registered<Elf_symbols>(_objects, _env, _alloc, name);
+
+			return symbols->lookup(addr);
+		}
+};
+
+#endif /* _SYMBOLS_H_ */
@@ -6,7 +6,7 @@ SRC_CC += main.cc \
 
 INC_DIR = $(REP_DIR)/src/server/cpu_sampler
 
-LIBS   += base cpu_sampler_platform
+LIBS   += base vfs cpu_sampler_platform
 
 vpath %.cc $(REP_DIR)/src/server/cpu_sampler
 
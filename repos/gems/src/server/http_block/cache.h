@@ -0,0 +1,245 @@
+/*
+ * \brief  Local cache of the remote file
+ * \author Pirmin Duss
+ * \date   2020-11-03
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/log.h>
+#include <util/misc_math.h>
+
+/* libc includes */
+#include <fcntl.h>
+#include <unistd.h>
+
+class Cache
+{
+	typedef Genode::size_t size_t;
+
+	public:
+
+		enum { CHUNK_SIZE = 64*1024 };
+
+		class Io_error : public Genode::Exception { };
+
+		/**
+		 * Storage of the cached chunks
+		 *
+		 * The last chunk of the file may be shorter than 'CHUNK_SIZE'.
+		 */
+		struct Store : Genode::Interface
+		{
+			virtual void write(unsigned slot, char const *src, size_t len) = 0;
+			virtual void read(unsigned slot, size_t offset, char *dst, size_t len) = 0;
+		};
+
+		/**
+		 * Chunks stored in RAM
+		 */
+		class Ram_store : public Store
+		{
+			private:
+
+				/*
+				 * Noncopyable
+				 */
+				Ram_store(Ram_store const &);
+				Ram_store &operator = (Ram_store const &);
+
+				Genode::Allocator &_alloc;
+				size_t      const  _size;
+				char      * const  _data;
+
+			public:
+
+				Ram_store(Genode::Allocator &alloc, unsigned slots)
+				:
+					_alloc(alloc), _size((size_t)slots*CHUNK_SIZE),
+					_data((char *)_alloc.alloc(_size))
+				{ }
+
+				~Ram_store() { _alloc.free(_data, _size); }
+
+				void write(unsigned slot, char const *src, size_t len) override {
+					Genode::memcpy(_data + (size_t)slot*CHUNK_SIZE, src, len); }
+
+				void read(unsigned slot, size_t offset, char *dst, size_t len) override {
+					Genode::memcpy(dst, _data + (size_t)slot*CHUNK_SIZE + offset, len); }
+		};
+
+		/**
+		 * Chunks stored in a file of the VFS
+		 *
+		 * The file is truncated when opened because its content cannot be
+		 * validated against the remote file.
+		 */
+		class File_store : public Store
+		{
+			private:
+
+				int const _fd;
+
+				static int _open(char const *path)
+				{
+					int const fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+					if (fd < 0) {
+						Genode::error("cache: could not open ", path);
+						throw Open_failed();
+					}
+					return fd;
+				}
+
+			public:
+
+				class Open_failed : public Genode::Exception { };
+
+				/**
+				 * Constructor
+				 *
+				 * \throw Open_failed
+				 */
+				File_store(char const *path) : _fd(_open(path)) { }
+
+				~File_store() { close(_fd); }
+
+				void write(unsigned slot, char const *src, size_t len) override
+				{
+					if (pwrite(_fd, src, len, (off_t)slot*CHUNK_SIZE) != (ssize_t)len)
+						throw Io_error();
+				}
+
+				void read(unsigned slot, size_t offset, char *dst, size_t len) override
+				{
+					if (pread(_fd, dst, len, (off_t)slot*CHUNK_SIZE + offset) != (ssize_t)len)
+						throw Io_error();
+				}
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Cache(Cache const &);
+		Cache &operator = (Cache const &);
+
+		enum { INVALID = ~0UL };
+
+		Genode::Allocator &_alloc;
+		Store             &_store;
+		unsigned     const _slots;
+
+		/* number of the chunk cached in each slot */
+		unsigned long * const _tags;
+
+		unsigned _slot(unsigned long chunk) const { return chunk % _slots; }
+
+		void _invalidate(unsigned long chunk) { _tags[_slot(chunk)] = INVALID; }
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param slots  number of chunks held by the store
+		 */
+		Cache(Genode::Allocator &alloc, Store &store, unsigned slots)
+		:
+			_alloc(alloc), _store(store), _slots(Genode::max(slots, 1U)),
+			_tags((unsigned long *)_alloc.alloc(_slots*sizeof(unsigned long)))
+		{
+			for (unsigned i = 0; i < _slots; i++)
+				_tags[i] = INVALID;
+		}
+
+		~Cache() { _alloc.free(_tags, _slots*sizeof(unsigned long)); }
+
+		bool cached(unsigned long chunk) const {
+			return _tags[_slot(chunk)] == chunk; }
+
+		/**
+		 * Return true if the range is cached completely
+		 */
+		bool contains(size_t offset, size_t len) const
+		{
+			for (unsigned long c = offset / CHUNK_SIZE; c*CHUNK_SIZE < offset + len; c++)
+				if (!cached(c))
+					return false;
+
+			return true;
+		}
+
+		/**
+		 * Copy cached range to 'dst'
+		 *
+		 * \return false if the range is not cached completely
+		 */
+		bool read(size_t offset, char *dst, size_t len)
+		{
+			if (!contains(offset, len))
+				return false;
+
+			try {
+				while (len) {
+					unsigned long const chunk = offset / CHUNK_SIZE;
+					size_t        const off   = offset % CHUNK_SIZE;
+					size_t        const n     = Genode::min(len, CHUNK_SIZE - off);
+
+					_store.read(_slot(chunk), off, dst, n);
+
+					offset += n; dst += n; len -= n;
+				}
+			} catch (Io_error) {
+				_invalidate(offset / CHUNK_SIZE);
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		 * Insert all chunks that are fully covered by the data
+		 *
+		 * \param file_size  size of the remote file, the last chunk is
+		 *                   complete if the data reaches the end of file
+		 */
+		void insert(size_t offset, char const *data, size_t len,
+		            size_t file_size)
+		{
+			size_t const end = offset + len;
+
+			for (unsigned long c = (offset + CHUNK_SIZE - 1) / CHUNK_SIZE;
+			     c*CHUNK_SIZE < end; c++) {
+
+				size_t const chunk_end = Genode::min((c + 1)*CHUNK_SIZE, file_size);
+
+				if (chunk_end > end)
+					break;
+
+				if (cached(c))
+					continue;
+
+				/* the slot's former content is lost when writing fails */
+				_invalidate(c);
+
+				try {
+					_store.write(_slot(c), data + (c*CHUNK_SIZE - offset),
+					             chunk_end - c*CHUNK_SIZE);
+					_tags[_slot(c)] = c;
+				}
+				catch (Io_error) { }
+			}
+		}
+};
+
+#endif /* _CACHE_H_ */
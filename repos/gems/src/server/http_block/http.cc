@@ -20,6 +20,7 @@
 #include <unistd.h>
 #include <netdb.h>
 #include <errno.h>
+#include <strings.h>
 
 #include "http.h"
 
@@ -54,29 +55,29 @@ void Http::cmd_head()
 
 	int length = snprintf(_http_buf, HTTP_BUF, http_templ, "HEAD", _path, _host);
 
-	if (write(_fd, _http_buf, length) != length) {
+	if (write(_fd[0], _http_buf, length) != length) {
 		error("cmd_head: write error");
 		throw Http::Socket_error();
 	}
 }
 
 
-void Http::connect()
+void Http::connect(unsigned conn)
 {
-	_fd = socket(AF_INET, SOCK_STREAM, 0);
-	if (_fd < 0) {
+	_fd[conn] = socket(AF_INET, SOCK_STREAM, 0);
+	if (_fd[conn] < 0) {
 		error("connect: no socket avaiable");
 		throw Http::Socket_error();
 	}
 
-	if (::connect(_fd, _info->ai_addr, sizeof(*(_info->ai_addr))) < 0) {
+	if (::connect(_fd[conn], _info->ai_addr, sizeof(*(_info->ai_addr))) < 0) {
 		error("connect: connect failed");
 		throw Http::Socket_error();
 	}
 }
 
 
-void Http::reconnect(){ close(_fd); connect(); }
+void Http::reconnect(unsigned conn) { close(_fd[conn]); connect(conn); }
 
 
 void Http::resolve_uri()
@@ -92,12 +93,12 @@ void Http::resolve_uri()
 }
 
 
-Genode::size_t Http::read_header()
+Genode::size_t Http::read_header(unsigned conn)
 {
 	bool header = true; size_t i = 0;
 
 	while (header) {
-		if (!read(_fd, &_http_buf[i], 1))
+		if (read(_fd[conn], &_http_buf[i], 1) <= 0)
 			throw Http::Socket_closed();
 
 		if (i >= 3 && _http_buf[i - 3] == '\r' && _http_buf[i - 2] == '\n'
@@ -129,14 +130,13 @@ Genode::size_t Http::read_header()
 }
 
 
-void Http::get_capacity()
+Genode::size_t Http::header_value(size_t header_len, char const *key,
+                                   size_t def)
 {
-	cmd_head();
-	size_t  len = read_header();
 	char buf[32];
-	Http_token t(_http_buf, len);
+	Http_token t(_http_buf, header_len);
 
-	bool key = false;
+	bool found = false;
 	while (t) {
 
 		if (t.type() != Http_token::IDENT) {
@@ -144,30 +144,47 @@ void Http::get_capacity()
 			continue;
 		}
 
-		if (key) {
-			ascii_to(t.start(), _size);
-			break;
+		if (found) {
+			size_t value = def;
+			ascii_to(t.start(), value);
+			return value;
 		}
 
 		t.string(buf, 32);
 
-		if (!Genode::strcmp(buf, "Content-Length", 32))
-			key = true;
+		/* header field names are case insensitive */
+		if (!strcasecmp(buf, key))
+			found = true;
 
 		t = t.next();
 	}
+
+	return def;
+}
+
+
+void Http::get_capacity()
+{
+	cmd_head();
+	size_t len = read_header(0);
+
+	_size = header_value(len, "Content-Length", 0);
 }
 
 
-void Http::do_read(void * buf, size_t size)
+void Http::do_read(unsigned conn, void * buf, size_t size)
 {
 	size_t buf_fill = 0;
 
 	while (buf_fill < size) {
 
-		int part;
-		if ((part = read(_fd, (void *)((addr_t)buf + buf_fill),
-		                      size - buf_fill)) <= 0) {
+		int part = read(_fd[conn], (void *)((addr_t)buf + buf_fill),
+		                size - buf_fill);
+
+		if (part == 0)
+			throw Http::Socket_closed();
+
+		if (part < 0) {
 			error("could not read data (", errno, ")");
 			throw Http::Socket_error();
 		}
@@ -177,8 +194,10 @@ void Http::do_read(void * buf, size_t size)
 }
 
 
-Http::Http(Genode::Heap &heap, ::String const &uri)
-: _heap(heap), _port((char *)"80")
+Http::Http(Genode::Heap &heap, ::String const &uri, unsigned connections)
+:
+	_heap(heap), _port((char *)"80"),
+	_num_fds(Genode::max(1U, Genode::min(connections, (unsigned)MAX_CONNECTIONS)))
 {
 	_heap.alloc(HTTP_BUF, (void**)&_http_buf);
 
@@ -189,7 +208,8 @@ Http::Http(Genode::Heap &heap, ::String const &uri)
 	resolve_uri();
 
 	/* connect to host */
-	connect();
+	for (unsigned i = 0; i < _num_fds; i++)
+		connect(i);
 
 	/* retrieve file info */
 	get_capacity();
@@ -198,6 +218,9 @@ Http::Http(Genode::Heap &heap, ::String const &uri)
 
 Http::~Http()
 {
+	for (unsigned i = 0; i < _num_fds; i++)
+		close(_fd[i]);
+
 	_heap.free(_host, Genode::strlen(_host) + 1);
 	_heap.free(_path, Genode::strlen(_path) + 2);
 	_heap.free(_http_buf, HTTP_BUF);
@@ -237,40 +260,36 @@ void Http::parse_uri(::String const &u)
 }
 
 
-void Http::cmd_get(size_t file_offset, size_t size, addr_t buffer)
+void Http::send_get(unsigned conn, size_t file_offset, size_t size)
 {
-	while (true) {
-
-		const char *http_templ = "GET %s HTTP/1.1\r\n"
-		                         "Host: %s\r\n"
-		                         "Range: bytes=%lu-%lu\r\n"
-		                         "\r\n";
-
-		int length = snprintf(_http_buf, HTTP_BUF, http_templ, _path, _host,
-		                      file_offset, file_offset + size - 1);
+	const char *http_templ = "GET %s HTTP/1.1\r\n"
+	                         "Host: %s\r\n"
+	                         "Range: bytes=%lu-%lu\r\n"
+	                         "\r\n";
 
-		if (write(_fd, _http_buf, length) < 0) {
+	int length = snprintf(_http_buf, HTTP_BUF, http_templ, _path, _host,
+	                      file_offset, file_offset + size - 1);
 
-			if (errno == ESHUTDOWN)
-				reconnect();
+	if (write(_fd[conn], _http_buf, length) != length)
+		throw Http::Socket_closed();
+}
 
-			if (write(_fd, _http_buf, length) < 0)
-				throw Http::Socket_error();
-		}
 
-		try {
-			read_header();
-		} catch (Http::Socket_closed) {
-			reconnect();
-			continue;
-		}
+void Http::receive(unsigned conn, void *buffer, size_t size)
+{
+	size_t const len = read_header(conn);
 
-		if (_http_ret != HTTP_SUCC_PARTIAL) {
-			error("cmd_get: server returned ", _http_ret);
-			throw Http::Server_error();
-		}
+	if (_http_ret != HTTP_SUCC_PARTIAL) {
+		error("receive: server returned ", _http_ret);
+		throw Http::Server_error();
+	}
 
-		do_read((void *)(buffer), size);
-		return;
+	size_t const content_length = header_value(len, "Content-Length", 0);
+	if (content_length != size) {
+		error("receive: server returned ", content_length, " bytes, "
+		      "expected ", size);
+		throw Http::Server_error();
 	}
+
+	do_read(conn, buffer, size);
 }
@@ -25,9 +25,13 @@ class Http
 	typedef Genode::addr_t addr_t;
 	typedef Genode::off_t  off_t;
 
+	public:
+
+		enum { MAX_CONNECTIONS = 8 };
+
 	private:
 
-		Genode::Heap   &_heap;
+		Genode::Heap    &_heap;
 		size_t           _size;      /* number of bytes in file */
 		char            *_host;      /* host name */
 		char            *_port;      /* host port */
@@ -35,8 +39,8 @@ class Http
 		char            *_http_buf;  /* internal data buffer */
 		unsigned         _http_ret;  /* HTTP status code */
 		struct addrinfo *_info;      /* Resolved address info for host */
-		int              _fd;        /* Socket file handle */
-		addr_t          _base_addr; /* Address of I/O dataspace */
+		unsigned         _num_fds;   /* number of connections */
+		int              _fd[MAX_CONNECTIONS]; /* Socket file handles */
 
 		/*
 		 * Send 'HEAD' command
@@ -46,12 +50,7 @@ class Http
 		/*
 		 * Connect to host
 		 */
-		void connect();
-
-		/*
-		 * Re-connect to host
-		 */
-		void reconnect();
+		void connect(unsigned conn);
 
 		/*
 		 * Set URI of remote file
@@ -66,7 +65,12 @@ class Http
 		/*
 		 * Read HTTP header and parse server-status code
 		 */
-		size_t read_header();
+		size_t read_header(unsigned conn);
+
+		/*
+		 * Return numeric value of header field 'key', or 'def' if absent
+		 */
+		size_t header_value(size_t header_len, char const *key, size_t def);
 
 		/*
 		 * Determine remote-file size
@@ -76,14 +80,16 @@ class Http
 		/*
 		 * Read 'size' bytes into buffer
 		 */
-		void do_read(void * buf, size_t size);
+		void do_read(unsigned conn, void * buf, size_t size);
 
 	public:
 
 		/*
-		 * Constructor (default host port is 80
+		 * Constructor (default host port is 80)
+		 *
+		 * \param connections  number of keep-alive connections to the host
 		 */
-		Http(Genode::Heap &heap, ::String const &uri);
+		Http(Genode::Heap &heap, ::String const &uri, unsigned connections = 1);
 
 		/*
 		 * Destructor
@@ -98,20 +104,43 @@ class Http
 		size_t file_size() const { return _size; }
 
 		/**
-		 * Set base address of I/O dataspace
+		 * Return number of connections to the host
+		 */
+		unsigned connections() const { return _num_fds; }
+
+		/**
+		 * Close connection and connect to host anew
+		 *
+		 * Replies to commands sent over the connection before are lost.
+		 */
+		void reconnect(unsigned conn);
+
+		/**
+		 * Send 'GET' command for a range of the remote file
+		 *
+		 * The command is sent without waiting for the reply. Several
+		 * commands may be sent over the same connection before their
+		 * replies are received in order via 'receive'.
 		 *
-		 * \param base_addr  Base of dataspace
+		 * \param conn         connection used for the command
+		 * \param file_offset  read from offset of remote file
+		 * \param size         number of bytes to transfer
+		 *
+		 * \throw Socket_closed
 		 */
-		void  base_addr(addr_t base_addr) { _base_addr = base_addr; }
+		void send_get(unsigned conn, size_t file_offset, size_t size);
 
 		/**
-		 * Send 'GET' command
+		 * Receive reply to the oldest pending 'GET' command of a connection
+		 *
+		 * \param buffer  destination of the content
+		 * \param size    number of bytes requested by the command
 		 *
-		 * \param file_offset  Read from offset of remote file
-		 * \param size         Number of byts to transfer
-		 * \param buffer       address in I/O dataspace
+		 * \throw Socket_closed
+		 * \throw Socket_error
+		 * \throw Server_error
 		 */
-		void cmd_get(size_t file_offset, size_t size, addr_t buffer);
+		void receive(unsigned conn, void *buffer, size_t size);
 
 		/* Exceptions */
 		class Exception     : public ::Genode::Exception { };
@@ -17,8 +17,10 @@
 #include <base/log.h>
 #include <block/component.h>
 #include <libc/component.h>
+#include <util/reconstructible.h>
 
 /* local includes */
+#include "cache.h"
 #include "http.h"
 
 using namespace Genode;
@@ -27,15 +29,270 @@ class Driver : public Block::Driver
 {
 	private:
 
-		size_t _block_size;
-		Http   _http;
+		enum {
+			MAX_REQUESTS   = 32,         /* block requests in progress */
+			MAX_FETCHES    = 32,         /* 'GET' commands in flight */
+			MAX_FETCH_SIZE = 256*1024,   /* bytes per 'GET' command */
+			MAX_RETRIES    = 3,
+		};
+
+		/*
+		 * Noncopyable
+		 */
+		Driver(Driver const &);
+		Driver &operator = (Driver const &);
+
+		struct Request
+		{
+			bool                     used;
+			bool                     scheduled;
+			size_t                   offset;
+			size_t                   size;
+			size_t                   remaining;
+			char                    *buffer;
+			Block::Packet_descriptor packet;
+		};
+
+		struct Range { size_t start, end; };
+
+		struct Fetch
+		{
+			size_t   offset;
+			size_t   size;
+			unsigned conn;
+		};
+
+		Heap         &_heap;
+		size_t const  _block_size;
+		Http          _http;
+		Cache        *_cache;
+		size_t const  _read_ahead;
+
+		Request  _requests[MAX_REQUESTS] { };
+		unsigned _num_requests = 0;
+
+		/* buffer for receiving the reply to one command */
+		char *_buf = nullptr;
+
+		Signal_handler<Driver> _process_handler;
+
+		Request *_alloc_request()
+		{
+			for (Request &r : _requests)
+				if (!r.used)
+					return &r;
+
+			return nullptr;
+		}
+
+		void _complete(Request &r, bool success)
+		{
+			/* free the slot first, acknowledging may submit a new request */
+			Block::Packet_descriptor packet = r.packet;
+			r.used = false;
+			_num_requests--;
+
+			ack_packet(packet, success);
+		}
+
+		/**
+		 * Return range to fetch for a request
+		 *
+		 * With the cache enabled, the range is extended to whole chunks
+		 * and to the uncached chunks read ahead.
+		 */
+		Range _range(Request const &r) const
+		{
+			size_t start = r.offset, end = r.offset + r.size;
+
+			if (!_cache)
+				return { start, end };
+
+			size_t const chunk = Cache::CHUNK_SIZE;
+
+			start = start & ~(chunk - 1);
+			end   = (end + chunk - 1) & ~(chunk - 1);
+
+			size_t const limit = end + _read_ahead;
+			while (end < limit && end < _http.file_size()
+			    && !_cache->cached(end / Cache::CHUNK_SIZE))
+				end += Cache::CHUNK_SIZE;
+
+			return { start, min(end, _http.file_size()) };
+		}
+
+		/**
+		 * Hand out fetched data to the scheduled requests
+		 */
+		void _deliver(size_t offset, char const *data, size_t size)
+		{
+			if (_cache)
+				_cache->insert(offset, data, size, _http.file_size());
+
+			for (Request &r : _requests) {
+
+				if (!r.used || !r.scheduled)
+					continue;
+
+				size_t const start = max(r.offset, offset),
+				             end   = min(r.offset + r.size, offset + size);
+
+				if (start >= end)
+					continue;
+
+				memcpy(r.buffer + (start - r.offset), data + (start - offset),
+				       end - start);
+
+				r.remaining -= end - start;
+				if (!r.remaining)
+					_complete(r, true);
+			}
+		}
+
+		/**
+		 * Reconnect and repeat the unanswered commands of a connection
+		 */
+		void _resend(Fetch const *fetches, unsigned from, unsigned to,
+		             unsigned conn)
+		{
+			_http.reconnect(conn);
+
+			for (unsigned i = from; i < to; i++)
+				if (fetches[i].conn == conn)
+					_http.send_get(conn, fetches[i].offset, fetches[i].size);
+		}
+
+		/**
+		 * Issue all commands before receiving the replies
+		 */
+		void _fetch(Fetch const *fetches, unsigned num)
+		{
+			for (unsigned i = 0; i < num; i++) {
+				try {
+					_http.send_get(fetches[i].conn, fetches[i].offset,
+					               fetches[i].size); }
+				catch (Http::Socket_closed) {
+					_resend(fetches, 0, i + 1, fetches[i].conn); }
+			}
+
+			for (unsigned i = 0; i < num; i++) {
+
+				for (unsigned attempt = 0;; attempt++) {
+					try {
+						_http.receive(fetches[i].conn, _buf, fetches[i].size);
+						break;
+					}
+					catch (Http::Socket_closed) {
+						if (attempt == MAX_RETRIES)
+							throw;
+
+						_resend(fetches, i, num, fetches[i].conn);
+					}
+				}
+
+				_deliver(fetches[i].offset, _buf, fetches[i].size);
+			}
+		}
+
+		void _process()
+		{
+			/* schedule the pending requests in the order of their offsets */
+			Request *sorted[MAX_REQUESTS];
+			unsigned num = 0;
+
+			for (Request &r : _requests) {
+
+				if (!r.used || r.scheduled)
+					continue;
+
+				r.scheduled = true;
+
+				unsigned i = num++;
+				for (; i > 0 && sorted[i - 1]->offset > r.offset; i--)
+					sorted[i] = sorted[i - 1];
+				sorted[i] = &r;
+			}
+
+			/* merge adjacent and overlapping requests */
+			Range    ranges[MAX_REQUESTS];
+			unsigned num_ranges = 0;
+
+			for (unsigned i = 0; i < num; i++) {
+
+				Range const range = _range(*sorted[i]);
+
+				if (num_ranges && range.start <= ranges[num_ranges - 1].end)
+					ranges[num_ranges - 1].end = max(ranges[num_ranges - 1].end,
+					                                 range.end);
+				else
+					ranges[num_ranges++] = range;
+			}
+
+			/* split ranges into commands, distributed over the connections */
+			unsigned r   = 0;
+			size_t   pos = num_ranges ? ranges[0].start : 0;
+
+			while (r < num_ranges) {
+
+				Fetch    fetches[MAX_FETCHES];
+				unsigned num_fetches = 0;
+
+				for (; num_fetches < MAX_FETCHES && r < num_ranges; num_fetches++) {
+
+					size_t const size = min(ranges[r].end - pos, (size_t)MAX_FETCH_SIZE);
+
+					fetches[num_fetches] = Fetch { .offset = pos, .size = size,
+					                               .conn   = num_fetches % _http.connections() };
+					pos += size;
+
+					if (pos == ranges[r].end && ++r < num_ranges)
+						pos = ranges[r].start;
+				}
+
+				_fetch(fetches, num_fetches);
+			}
+		}
+
+		void _handle_process()
+		{
+			Libc::with_libc([&] () {
+
+				/* requests may be submitted while acknowledging others */
+				while (_num_requests) {
+					try { _process(); }
+					catch (Http::Exception) {
+						error("fetching blocks failed");
+
+						/* resynchronize with the server */
+						for (unsigned i = 0; i < _http.connections(); i++) {
+							try { _http.reconnect(i); }
+							catch (Http::Exception) { }
+						}
+					}
+
+					for (Request &r : _requests)
+						if (r.used && r.scheduled)
+							_complete(r, false);
+				}
+			});
+		}
 
 	public:
 
-		Driver(Heap &heap, Ram_allocator &ram,
-		       size_t block_size, ::String const &uri)
-		: Block::Driver(ram),
-		  _block_size(block_size), _http(heap, uri) {}
+		Driver(Entrypoint &ep, Heap &heap, Ram_allocator &ram,
+		       size_t block_size, ::String const &uri, unsigned connections,
+		       Cache *cache, size_t read_ahead)
+		:
+			Block::Driver(ram),
+			_heap(heap), _block_size(block_size),
+			_http(heap, uri, connections),
+			_cache(cache), _read_ahead(read_ahead),
+			_process_handler(ep, *this, &Driver::_handle_process)
+		{
+			_heap.alloc(MAX_FETCH_SIZE, (void **)&_buf);
+		}
+
+		~Driver() { _heap.free(_buf, MAX_FETCH_SIZE); }
 
 
 		/*******************************
@@ -53,13 +310,39 @@ class Driver : public Block::Driver
 		void read(Block::sector_t           block_nr,
 		          Genode::size_t            block_count,
 		          char                     *buffer,
-		          Block::Packet_descriptor &packet)
+		          Block::Packet_descriptor &packet) override
 		{
-			_http.cmd_get(block_nr * _block_size, block_count * _block_size,
-			              (addr_t)buffer);
-			ack_packet(packet);
+			size_t const offset = block_nr * _block_size,
+			             size   = block_count * _block_size;
+
+			bool const cached = _cache && Libc::with_libc([&] () {
+				return _cache->read(offset, buffer, size); });
+
+			if (!size || cached) {
+				ack_packet(packet);
+				return;
+			}
+
+			Request *r = _alloc_request();
+			if (!r)
+				throw Request_congestion();
+
+			*r = Request { .used      = true,
+			               .scheduled = false,
+			               .offset    = offset,
+			               .size      = size,
+			               .remaining = size,
+			               .buffer    = buffer,
+			               .packet    = packet };
+
+			/*
+			 * The requests are processed once the session has handed over
+			 * all requests available, which permits merging them.
+			 */
+			if (!_num_requests++)
+				Signal_transmitter(_process_handler).submit();
 		}
-	};
+};
 
 
 class Factory : public Block::Driver_factory
@@ -71,6 +354,37 @@ class Factory : public Block::Driver_factory
 		Attached_rom_dataspace _config { _env, "config" };
 		::String         const _uri;
 		size_t           const _blk_sz;
+		unsigned         const _connections;
+		size_t           const _read_ahead;
+
+		Constructible<Cache::Ram_store>  _ram_store  { };
+		Constructible<Cache::File_store> _file_store { };
+		Constructible<Cache>             _cache      { };
+
+		void _construct_cache(Xml_node config)
+		{
+			size_t const size = config.attribute_value("cache", Number_of_bytes(0));
+			if (size < Cache::CHUNK_SIZE)
+				return;
+
+			unsigned const slots = size / Cache::CHUNK_SIZE;
+
+			typedef Genode::String<256> Path;
+			Path const path = config.attribute_value("cache_file", Path());
+
+			try {
+				if (path.valid()) {
+					_file_store.construct(path.string());
+					_cache.construct(_heap, *_file_store, slots);
+				} else {
+					_ram_store.construct(_heap, slots);
+					_cache.construct(_heap, *_ram_store, slots);
+				}
+				log("Using ", Number_of_bytes(size), " of ",
+				    path.valid() ? path.string() : "RAM", " as cache.");
+			}
+			catch (Cache::File_store::Open_failed) { }
+		}
 
 	public:
 
@@ -78,17 +392,30 @@ class Factory : public Block::Driver_factory
 		:
 			_env(env), _heap(heap),
 			_uri   (_config.xml().attribute_value("uri", ::String())),
-			_blk_sz(_config.xml().attribute_value("block_size", 512U))
+			_blk_sz(_config.xml().attribute_value("block_size", 512U)),
+			_connections(_config.xml().attribute_value("connections", 2U)),
+			_read_ahead(_config.xml().attribute_value("read_ahead",
+			                                          Number_of_bytes(256*1024)))
 		{
 			log("Using file=", _uri, " as device with block size ",
 			    Hex(_blk_sz, Hex::OMIT_PREFIX), ".");
+
+			_construct_cache(_config.xml());
 		}
 
-		Block::Driver *create() {
-			return new (&_heap) Driver(_heap, _env.ram(), _blk_sz, _uri); }
+		Block::Driver *create() override
+		{
+			return Libc::with_libc([&] () {
+				return new (&_heap)
+					Driver(_env.ep(), _heap, _env.ram(), _blk_sz, _uri,
+					       _connections, _cache.constructed() ? &*_cache : nullptr,
+					       _read_ahead); });
+		}
 
-	void destroy(Block::Driver *driver) {
-		Genode::destroy(&_heap, driver); }
+		void destroy(Block::Driver *driver) override
+		{
+			Libc::with_libc([&] () { Genode::destroy(&_heap, driver); });
+		}
 };
 
 
@@ -0,0 +1,172 @@
+/*
+ * \brief  Cache of rendered character cells
+ * \author Pirmin Duss
+ * \date   2020-10-28
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _GLYPH_CACHE_H_
+#define _GLYPH_CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/color.h>
+
+/* local includes */
+#include "types.h"
+
+namespace Terminal { template <typename> class Glyph_cache; }
+
+
+/**
+ * Direct-mapped cache of character cells rendered into pixels
+ *
+ * Each entry holds the pixels of one character cell as rendered for a
+ * codepoint, a pair of foreground and background colors, and the subpixel
+ * position of the cell. Painting a cached cell merely copies its pixels
+ * instead of blending the glyph anew. Entries are evicted on collision.
+ */
+template <typename PT>
+class Terminal::Glyph_cache
+{
+	public:
+
+		struct Key
+		{
+			Codepoint codepoint;
+			Color     fg, bg;
+			int       subpixel;  /* fractional part of the cell position */
+			unsigned  width;     /* cell width in pixels */
+
+			bool operator == (Key const &other) const
+			{
+				return codepoint.value == other.codepoint.value
+				    && fg == other.fg && bg == other.bg
+				    && subpixel == other.subpixel && width == other.width;
+			}
+
+			unsigned hash() const
+			{
+				auto rgb = [] (Color c) {
+					return (unsigned)((c.r << 16) | (c.g << 8) | c.b); };
+
+				unsigned long h = codepoint.value;
+				h = h*31 + rgb(fg);
+				h = h*31 + rgb(bg);
+				h = h*31 + (unsigned)subpixel;
+				return (unsigned)(h ^ (h >> 16));
+			}
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Glyph_cache(Glyph_cache const &);
+		Glyph_cache &operator = (Glyph_cache const &);
+
+		struct Entry
+		{
+			Key  key;
+			bool valid;
+
+			PT       *pixels()       { return (PT *)(this + 1); }
+			PT const *pixels() const { return (PT const *)(this + 1); }
+		};
+
+		Allocator &_alloc;
+
+		unsigned const _max_width;
+		unsigned const _height;
+		size_t   const _entry_size;
+		unsigned const _num_entries;   /* power of two */
+
+		char * const _entries;
+
+		static unsigned _num_entries_for(size_t limit, size_t entry_size)
+		{
+			unsigned count = 1;
+			while ((count*2)*entry_size <= limit)
+				count *= 2;
+			return count;
+		}
+
+		Entry &_entry(Key const &key)
+		{
+			return *(Entry *)(_entries + (key.hash() & (_num_entries - 1))*_entry_size);
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param max_width  maximum cell width in pixels
+		 * \param height     cell height in pixels
+		 * \param limit      upper bound of the memory used for cache entries
+		 *
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 */
+		Glyph_cache(Allocator &alloc, unsigned max_width, unsigned height,
+		            size_t limit)
+		:
+			_alloc(alloc), _max_width(max_width), _height(height),
+			_entry_size(align_addr(sizeof(Entry) + max_width*height*sizeof(PT), 3)),
+			_num_entries(_num_entries_for(limit, _entry_size)),
+			_entries((char *)_alloc.alloc(_num_entries*_entry_size))
+		{
+			flush();
+		}
+
+		~Glyph_cache() { _alloc.free(_entries, _num_entries*_entry_size); }
+
+		void flush()
+		{
+			for (unsigned i = 0; i < _num_entries; i++)
+				((Entry *)(_entries + i*_entry_size))->valid = false;
+		}
+
+		/**
+		 * Return pixels of the cell, or nullptr if the cell is not cached
+		 *
+		 * The returned pixels are stored line by line with a line length of
+		 * 'key.width' pixels.
+		 */
+		PT const *lookup(Key const &key)
+		{
+			Entry const &entry = _entry(key);
+
+			return (entry.valid && entry.key == key) ? entry.pixels() : nullptr;
+		}
+
+		/**
+		 * Import rendered cell from pixel buffer
+		 *
+		 * \param src           upper-left pixel of the cell
+		 * \param src_line_len  line length of the 'src' buffer in pixels
+		 */
+		void insert(Key const &key, PT const *src, unsigned src_line_len)
+		{
+			if (key.width > _max_width)
+				return;
+
+			Entry &entry = _entry(key);
+
+			PT *dst = entry.pixels();
+			for (unsigned y = 0; y < _height; y++, dst += key.width, src += src_line_len)
+				memcpy(dst, src, key.width*sizeof(PT));
+
+			entry.key   = key;
+			entry.valid = true;
+		}
+};
+
+#endif /* _GLYPH_CACHE_H_ */
@@ -55,6 +55,9 @@ struct Terminal::Main : Character_consumer
 
 	Cached_font::Limit _font_cache_limit { 0 };
 
+	/* memory used for caching rendered character cells */
+	size_t _glyph_cache_limit = 0;
+
 	struct Font
 	{
 		Vfs_font    _vfs_font;
@@ -187,6 +190,9 @@ void Terminal::Main::_handle_config()
 
 	_font.construct(_heap, _root_dir, cache_limit);
 
+	_glyph_cache_limit =
+		config.attribute_value("glyph_cache", Number_of_bytes(256*1024));
+
 	_clipboard_reporter.conditional(config.attribute_value("copy", false),
 	                                _env, "clipboard", "clipboard");
 
@@ -241,7 +247,8 @@ void Terminal::Main::_handle_config()
 			                               : Position();
 
 			_text_screen_surface.construct(_heap, _font->font(),
-			                               _color_palette, _framebuffer);
+			                               _color_palette, _framebuffer,
+			                               _glyph_cache_limit);
 
 			if (snapshot.constructed())
 				_text_screen_surface->import(*snapshot);
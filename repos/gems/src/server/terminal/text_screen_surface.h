@@ -28,6 +28,7 @@
 /* local includes */
 #include "color_palette.h"
 #include "framebuffer.h"
+#include "glyph_cache.h"
 
 namespace Terminal { template <typename> class Text_screen_surface; }
 
@@ -144,11 +145,28 @@ class Terminal::Text_screen_surface
 
 	private:
 
+		Allocator           &_alloc;
 		Font          const &_font;
 		Color_palette const &_palette;
 		Framebuffer         &_framebuffer;
 		Geometry             _geometry { _font, _framebuffer };
 
+		size_t const _glyph_cache_limit;
+
+		Constructible<Glyph_cache<PT>> _glyph_cache { };
+
+		void _construct_glyph_cache()
+		{
+			_glyph_cache.destruct();
+
+			/* a cell covers at most one pixel more than the character width */
+			unsigned const max_cell_width = _geometry.char_width.decimal() + 1;
+
+			_glyph_cache.conditional(_glyph_cache_limit > 0, _alloc,
+			                         max_cell_width, _geometry.char_height,
+			                         _glyph_cache_limit);
+		}
+
 		Cell_array<Char_cell>            _cell_array;
 		Char_cell_array_character_screen _character_screen { _cell_array };
 
@@ -177,21 +195,100 @@ class Terminal::Text_screen_surface
 
 		Position _pointer { -1, -1 };
 
+		void _copy_cell(PT const *src, unsigned width, PT *dst,
+		                unsigned dst_line_len) const
+		{
+			for (unsigned y = 0; y < _geometry.char_height; y++) {
+				memcpy(dst, src, width*sizeof(PT));
+				src += width;
+				dst += dst_line_len;
+			}
+		}
+
+		/**
+		 * Move the pixels of scrolled lines to their new positions
+		 *
+		 * Lines that were merely scrolled since the last redraw are not
+		 * rendered anew but their pixels are copied within the framebuffer.
+		 */
+		void _move_scrolled_lines(PT *fb_base)
+		{
+			int const num_lines = _cell_array.num_lines();
+
+			auto moved = [&] (int line) {
+				return _cell_array.line_unmodified(line)
+				    && _cell_array.line_origin(line) != line; };
+
+			bool any_moved = false;
+			for (int line = 0; line < num_lines && !any_moved; line++)
+				any_moved = moved(line);
+
+			if (!any_moved)
+				return;
+
+			/* the pointer highlighting must not move with the content */
+			if (_pointer.y >= 0 && _pointer.y < num_lines) {
+				_cell_array.mark_line_as_dirty(_pointer.y);
+				for (int line = 0; line < num_lines; line++)
+					if (moved(line) && _cell_array.line_origin(line) == _pointer.y)
+						_cell_array.mark_line_as_dirty(line);
+			}
+
+			/*
+			 * Lines moving up are copied first in ascending order, followed
+			 * by the lines moving down in descending order. A line moving
+			 * down whose origin gets overwritten by a line moving up is
+			 * rendered instead.
+			 */
+			for (int line = 0; line < num_lines; line++) {
+				int const origin = _cell_array.line_origin(line);
+				if (moved(line) && origin < line && moved(origin)
+				 && _cell_array.line_origin(origin) > origin)
+					_cell_array.mark_line_as_dirty(line);
+			}
+
+			unsigned const line_len = _geometry.fb_size.w(),
+			               height   = _geometry.char_height;
+
+			auto line_pixels = [&] (int line) {
+				return fb_base + (_geometry.start().y() + line*height)*line_len; };
+
+			auto move = [&] (int line) {
+				memcpy(line_pixels(line), line_pixels(_cell_array.line_origin(line)),
+				       line_len*height*sizeof(PT)); };
+
+			for (int line = 0; line < num_lines; line++)
+				if (moved(line) && _cell_array.line_origin(line) > line)
+					move(line);
+
+			for (int line = num_lines - 1; line >= 0; line--)
+				if (moved(line) && _cell_array.line_origin(line) < line)
+					move(line);
+		}
+
 	public:
 
 		/**
 		 * Constructor
 		 *
+		 * \param glyph_cache_limit  memory used for caching rendered
+		 *                           character cells, 0 disables the cache
+		 *
 		 * \throw Geometry::Invalid
 		 */
 		Text_screen_surface(Allocator &alloc, Font const &font,
-		                    Color_palette &palette, Framebuffer &framebuffer)
+		                    Color_palette &palette, Framebuffer &framebuffer,
+		                    size_t glyph_cache_limit)
 		:
+			_alloc(alloc),
 			_font(font),
 			_palette(palette),
 			_framebuffer(framebuffer),
+			_glyph_cache_limit(glyph_cache_limit),
 			_cell_array(_geometry.columns, _geometry.lines, alloc)
-		{ }
+		{
+			_construct_glyph_cache();
+		}
 
 		/**
 		 * Update geometry
@@ -203,6 +300,7 @@ class Terminal::Text_screen_surface
 		void geometry(Geometry const &geometry)
 		{
 			_geometry = geometry;
+			_construct_glyph_cache(); /* the font may have changed */
 			_cell_array.mark_all_lines_as_dirty(); /* trigger refresh */
 		}
 
@@ -230,13 +328,17 @@ class Terminal::Text_screen_surface
 					Box_painter::paint(surface, r[i], bg_color);
 			}
 
+			_move_scrolled_lines(fb_base);
+
 			int const clip_top  = 0, clip_bottom = _geometry.fb_size.h(),
 			          clip_left = 0, clip_right  = _geometry.fb_size.w();
 
+			unsigned const fb_line_len = _geometry.fb_size.w();
+
 			unsigned y = _geometry.start().y();
 			for (unsigned line = 0; line < _cell_array.num_lines(); line++) {
 
-				if (_cell_array.line_dirty(line)) {
+				if (!_cell_array.line_unmodified(line)) {
 
 					Fixpoint_number x { (int)_geometry.start().x() };
 					for (unsigned column = 0; column < _cell_array.num_cols(); column++) {
@@ -256,42 +358,56 @@ class Terminal::Text_screen_surface
 						if (!codepoint_valid)
 							codepoint = Codepoint{' '};
 
-						_font.apply_glyph(codepoint, [&] (Glyph_painter::Glyph const &glyph) {
+						Color_palette::Highlighted const highlighted { cell.highlight() };
+
+						Color_palette::Index fg_idx { cell.colidx_fg() };
+						Color_palette::Index bg_idx { cell.colidx_bg() };
+
+						/* swap color index for inverse cells */
+						if (cell.inverse()) {
+							Color_palette::Index tmp { fg_idx };
+							fg_idx = bg_idx;
+							bg_idx = tmp;
+						}
 
-							Color_palette::Highlighted const highlighted { cell.highlight() };
+						Color fg_color = _palette.foreground(fg_idx, highlighted);
+						Color bg_color = _palette.background(bg_idx, highlighted);
 
-							Color_palette::Index fg_idx { cell.colidx_fg() };
-							Color_palette::Index bg_idx { cell.colidx_bg() };
+						if (selected) {
+							bg_color = Color(180, 180, 180);
+							fg_color = Color( 50, 50,   50);
+						}
 
-							/* swap color index for inverse cells */
-							if (cell.inverse()) {
-								Color_palette::Index tmp { fg_idx };
-								fg_idx = bg_idx;
-								bg_idx = tmp;
-							}
+						if (pointer) {
+							bg_color = Color(220, 220, 220);
+							fg_color = Color( 50, 50,   50);
+						}
 
-							Color fg_color = _palette.foreground(fg_idx, highlighted);
-							Color bg_color = _palette.background(bg_idx, highlighted);
+						if (cell.has_cursor()) {
+							fg_color = Color( 63,  63,  63);
+							bg_color = Color(255, 255, 255);
+						}
 
-							if (selected) {
-								bg_color = Color(180, 180, 180);
-								fg_color = Color( 50, 50,   50);
-							}
+						Fixpoint_number next_x = x;
+						next_x.value += _geometry.char_width.value;
 
-							if (pointer) {
-								bg_color = Color(220, 220, 220);
-								fg_color = Color( 50, 50,   50);
-							}
+						typename Glyph_cache<PT>::Key const key {
+							codepoint, fg_color, bg_color, x.value & 0xff,
+							(unsigned)(next_x.decimal() - x.decimal()) };
 
-							if (cell.has_cursor()) {
-								fg_color = Color( 63,  63,  63);
-								bg_color = Color(255, 255, 255);
-							}
+						PT * const cell_pixels = fb_base + y*fb_line_len + x.decimal();
 
-							PT const pixel(fg_color.r, fg_color.g, fg_color.b);
+						PT const * const cached = _glyph_cache.constructed()
+						                        ? _glyph_cache->lookup(key) : nullptr;
+						if (cached) {
+							_copy_cell(cached, key.width, cell_pixels, fb_line_len);
+							x = next_x;
+							continue;
+						}
 
-							Fixpoint_number next_x = x;
-							next_x.value += _geometry.char_width.value;
+						_font.apply_glyph(codepoint, [&] (Glyph_painter::Glyph const &glyph) {
+
+							PT const pixel(fg_color.r, fg_color.g, fg_color.b);
 
 							Box_painter::paint(surface,
 							                   Rect(Point(x.decimal(), y),
@@ -300,14 +416,24 @@ class Terminal::Text_screen_surface
 							                   bg_color);
 
 							/* horizontally align glyph within cell */
-							x.value += (_geometry.char_width.value - (int)((glyph.width - 1)<<8)) >> 1;
+							Fixpoint_number glyph_x = x;
+							glyph_x.value += (_geometry.char_width.value - (int)((glyph.width - 1)<<8)) >> 1;
 
-							Glyph_painter::paint(Glyph_painter::Position(x, (int)y),
+							Glyph_painter::paint(Glyph_painter::Position(glyph_x, (int)y),
 							                     glyph, fb_base, _geometry.fb_size.w(),
 							                     clip_top, clip_bottom, clip_left, clip_right,
 							                     pixel, fg_alpha);
-							x = next_x;
+
+							/* cache cells that are not affected by neighboring glyphs */
+							bool const glyph_within_cell =
+								glyph_x.decimal() >= x.decimal() &&
+								glyph_x.decimal() + (int)glyph.width - 1 <= next_x.decimal() &&
+								glyph.vpos + glyph.height <= _geometry.char_height;
+
+							if (_glyph_cache.constructed() && glyph_within_cell)
+								_glyph_cache->insert(key, cell_pixels, fb_line_len);
 						});
+						x = next_x;
 					}
 				}
 				y += _geometry.char_height;
@@ -72,8 +72,50 @@ struct Test::Main
 			return;
 		}
 
+		if (!_test_batch(key, plaintext)) {
+			error("batched operation differs from single-block operation");
+			return;
+		}
+
 		log("Test succeeded");
 	}
+
+	/*
+	 * Compare the batched API with the encryption of single blocks
+	 */
+	enum { BATCH = 7 };
+
+	Aes_cbc_4k::Plaintext  _batch_plaintext  [BATCH] { };
+	Aes_cbc_4k::Ciphertext _batch_ciphertext [BATCH] { };
+	Aes_cbc_4k::Plaintext  _batch_decrypted  [BATCH] { };
+
+	bool _test_batch(Aes_cbc_4k::Key const &key, Aes_cbc_4k::Plaintext const &plaintext)
+	{
+		Aes_cbc_4k::Block_number const first { 3 };
+
+		for (unsigned i = 0; i < BATCH; i++) {
+			_batch_plaintext[i] = plaintext;
+			_batch_plaintext[i].values[i] = (char)(i + 1);
+		}
+
+		Aes_cbc_4k::encrypt(key, first, _batch_plaintext, _batch_ciphertext, BATCH);
+		Aes_cbc_4k::decrypt(key, first, _batch_ciphertext, _batch_decrypted, BATCH);
+
+		for (unsigned i = 0; i < BATCH; i++) {
+
+			Aes_cbc_4k::Block_number const block_number { first.value + i };
+
+			Aes_cbc_4k::encrypt(key, block_number, _batch_plaintext[i], _ciphertext);
+
+			if (memcmp(_ciphertext.values, _batch_ciphertext[i].values, sizeof(_ciphertext)))
+				return false;
+
+			if (memcmp(_batch_plaintext[i].values, _batch_decrypted[i].values,
+			           sizeof(_batch_plaintext[i])))
+				return false;
+		}
+		return true;
+	}
 };
 
 
@@ -0,0 +1,118 @@
+/*
+ * \brief  Throughput benchmark of the AES CBC 4KiB block encryption
+ * \author Pirmin Duss
+ * \date   2020-11-04
+ *
+ * Each test encrypts or decrypts the same buffer repeatedly for a fixed
+ * period, once block by block and once by the batched interface.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/heap.h>
+#include <base/log.h>
+#include <timer_session/connection.h>
+
+#include <aes_cbc_4k/aes_cbc_4k.h>
+
+namespace Test {
+	struct Main;
+	using namespace Genode;
+}
+
+
+struct Test::Main
+{
+	/*
+	 * Noncopyable
+	 */
+	Main(Main const &);
+	Main &operator = (Main const &);
+
+	enum { BLOCKS = 256, DURATION_MS = 2000 };
+
+	Env &_env;
+
+	Timer::Connection _timer { _env };
+
+	Heap _heap { _env.ram(), _env.rm() };
+
+	template <typename T>
+	T *_alloc()
+	{
+		T *ptr = nullptr;
+		_heap.alloc(BLOCKS*sizeof(T), (void **)&ptr);
+		return ptr;
+	}
+
+	Aes_cbc_4k::Plaintext  * const _plaintext  = _alloc<Aes_cbc_4k::Plaintext>();
+	Aes_cbc_4k::Ciphertext * const _ciphertext = _alloc<Aes_cbc_4k::Ciphertext>();
+
+	Aes_cbc_4k::Key const _key { "Not for the public" };
+
+	/**
+	 * Call 'fn' with the first block number until the test period expired
+	 */
+	template <typename FN>
+	void _measure(char const *brief, FN const &fn)
+	{
+		uint64_t const start_ms = _timer.elapsed_ms();
+		uint64_t       kib      = 0;
+
+		for (uint64_t nr = 0; _timer.elapsed_ms() - start_ms < DURATION_MS; nr += BLOCKS) {
+			fn(Aes_cbc_4k::Block_number { nr });
+			kib += BLOCKS*sizeof(Aes_cbc_4k::Block) / 1024;
+		}
+
+		uint64_t const ms = max(_timer.elapsed_ms() - start_ms, (uint64_t)1);
+
+		log(brief, ": ", (kib*1000/1024) / ms, " MiB/s");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- AES CBC 4K benchmark ---");
+
+		for (unsigned i = 0; i < BLOCKS; i++)
+			for (unsigned j = 0; j < sizeof(Aes_cbc_4k::Block); j++)
+				_plaintext[i].values[j] = (char)(i + j);
+
+		_measure("encrypt single", [&] (Aes_cbc_4k::Block_number first) {
+			for (unsigned i = 0; i < BLOCKS; i++)
+				Aes_cbc_4k::encrypt(_key, Aes_cbc_4k::Block_number { first.value + i },
+				                    _plaintext[i], _ciphertext[i]); });
+
+		_measure("encrypt batch ", [&] (Aes_cbc_4k::Block_number first) {
+			Aes_cbc_4k::encrypt(_key, first, _plaintext, _ciphertext, BLOCKS); });
+
+		_measure("decrypt single", [&] (Aes_cbc_4k::Block_number first) {
+			for (unsigned i = 0; i < BLOCKS; i++)
+				Aes_cbc_4k::decrypt(_key, Aes_cbc_4k::Block_number { first.value + i },
+				                    _ciphertext[i], _plaintext[i]); });
+
+		_measure("decrypt batch ", [&] (Aes_cbc_4k::Block_number first) {
+			Aes_cbc_4k::decrypt(_key, first, _ciphertext, _plaintext, BLOCKS); });
+
+		log("--- AES CBC 4K benchmark finished ---");
+	}
+};
+
+
+Genode::Env *__genode_env;
+
+
+void Component::construct(Genode::Env &env)
+{
+	/* make ada-runtime happy */
+	__genode_env = &env;
+	env.exec_static_constructors();
+
+	static Test::Main inst(env);
+}
@@ -2,4 +2,7 @@ TARGET = test-cpu_sampler
 SRC_CC = main.cc
 LIBS   = base
 
+# keep frame pointers for the call-stack sampling of the CPU sampler
+CC_OPT += -fno-omit-frame-pointer
+
 CC_CXX_WARN_STRICT =
@@ -0,0 +1,127 @@
+/*
+ * \brief  Benchmark of the terminal output throughput
+ * \author Pirmin Duss
+ * \date   2020-10-28
+ *
+ * The test floods the terminal with lines of text, similar to a build log,
+ * and reports the achieved number of lines per second.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* Genode includes */
+#include <base/component.h>
+#include <base/attached_rom_dataspace.h>
+#include <base/log.h>
+#include <terminal_session/connection.h>
+#include <timer_session/connection.h>
+
+namespace Test {
+	using namespace Genode;
+	struct Main;
+}
+
+
+struct Test::Main
+{
+	Env &_env;
+
+	Attached_rom_dataspace _config { _env, "config" };
+
+	Timer::Connection    _timer    { _env };
+	Terminal::Connection _terminal { _env };
+
+	unsigned const _lines   = _config.xml().attribute_value("lines",   20000U);
+	unsigned const _columns = _config.xml().attribute_value("columns", 72U);
+
+	char _buf[4096];
+
+	size_t _used = 0;
+
+	void _flush()
+	{
+		for (size_t written = 0; written < _used; )
+			written += _terminal.write(_buf + written, _used - written);
+
+		_used = 0;
+	}
+
+	void _append(char const *s, size_t len)
+	{
+		if (_used + len > sizeof(_buf))
+			_flush();
+
+		memcpy(_buf + _used, s, len);
+		_used += len;
+	}
+
+	/**
+	 * Generate one line of text
+	 *
+	 * \param colored  use a different foreground color for each word
+	 */
+	void _line(unsigned n, bool colored)
+	{
+		String<16> const number(n, ": ");
+		_append(number.string(), number.length() - 1);
+
+		static char const * const words[] = {
+			"compiling", "src/lib/", "target.mk", "[CC]", "main.cc",
+			"genode", "linking", "object" };
+
+		unsigned column = number.length() - 1;
+		for (unsigned i = n; column < _columns; i++) {
+
+			if (colored) {
+				char const esc[] = { 27, '[', '3', char('1' + i % 7), 'm' };
+				_append(esc, sizeof(esc));
+			}
+
+			char const * const word = words[i % 8];
+			size_t const len = min(strlen(word), (size_t)(_columns - column));
+			_append(word, len);
+			_append(" ", 1);
+			column += len + 1;
+		}
+
+		if (colored) {
+			char const reset[] = { 27, '[', '0', 'm' };
+			_append(reset, sizeof(reset));
+		}
+
+		_append("\r\n", 2);
+	}
+
+	void _measure(char const *name, bool colored)
+	{
+		uint64_t const start = _timer.elapsed_ms();
+
+		for (unsigned i = 0; i < _lines; i++)
+			_line(i, colored);
+
+		_flush();
+
+		uint64_t const ms = max(_timer.elapsed_ms() - start, (uint64_t)1);
+
+		log(name, ": ", _lines, " lines in ", ms, " ms, ",
+		    (_lines*1000ULL)/ms, " lines/s");
+	}
+
+	Main(Env &env) : _env(env)
+	{
+		log("--- terminal flood benchmark started ---");
+
+		_measure("plain text",   false);
+		_measure("colored text", true);
+
+		log("--- terminal flood benchmark finished ---");
+	}
+};
+
+
+void Component::construct(Genode::Env &env) { static Test::Main main(env); }
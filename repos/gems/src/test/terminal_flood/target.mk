@@ -0,0 +1,3 @@
+TARGET = test-terminal_flood
+SRC_CC = main.cc
+LIBS   = base
@@ -18,8 +18,23 @@
 #include <base/allocator.h>
 
 namespace Lwip {
+
+	/**
+	 * Initialize the lwIP stack
+	 *
+	 * The state of lwIP is global to the component. Hence, only the first
+	 * call has an effect and determines the allocator of the stack.
+	 */
 	void genode_init(Genode::Allocator &heap, Genode::Timeout_scheduler &timer);
 
+	/**
+	 * Set TCP receive window and send buffer in bytes
+	 *
+	 * The values are limited to the range supported by the stack and
+	 * apply to connections created afterwards.
+	 */
+	void configure_tcp(Genode::size_t window, Genode::size_t send_buffer);
+
 	Genode::Mutex &mutex();
 }
 
@@ -38,11 +38,25 @@ extern "C" {
 #define LWIP_TCP_TIMESTAMPS         1
 #define TCP_LISTEN_BACKLOG              1
 #define TCP_MSS                         1460
-#define TCP_WND                     (32 * TCP_MSS)
-#define TCP_SND_BUF                 (32 * TCP_MSS)
+
+/*
+ * The receive window and the send buffer are variables that are set at
+ * runtime via 'Lwip::configure_tcp'. The window scale permits windows of
+ * up to 8 MiB. As the preprocessor cannot evaluate the variables, lwIP's
+ * compile-time sanity checks are disabled and the values are validated by
+ * 'configure_tcp' instead. The send-queue length is dimensioned for the
+ * largest send buffer.
+ */
+extern unsigned lwip_tcp_wnd;
+extern unsigned lwip_tcp_snd_buf;
+
+#define TCP_WND                     (lwip_tcp_wnd)
+#define TCP_SND_BUF                 (lwip_tcp_snd_buf)
+#define TCP_SND_BUF_MAX             (8*1024*1024)
 #define LWIP_WND_SCALE                  3
-#define TCP_RCV_SCALE                   2
-#define TCP_SND_QUEUELEN                ((8 * (TCP_SND_BUF) + (TCP_MSS - 1))/(TCP_MSS))
+#define TCP_RCV_SCALE                   7
+#define TCP_SND_QUEUELEN                ((8 * (TCP_SND_BUF_MAX) + (TCP_MSS - 1))/(TCP_MSS))
+#define LWIP_DISABLE_TCP_SANITY_CHECKS  1
 
 #define LWIP_NETIF_STATUS_CALLBACK  1  /* callback function used for interface changes */
 #define LWIP_NETIF_LINK_CALLBACK    1  /* callback function used for link-state changes */
@@ -59,6 +73,7 @@ extern "C" {
  ** Memory settings **
  *********************/
 
+/* memory and pools are served by the slab-backed 'genode_malloc' */
 #define MEM_LIBC_MALLOC             1
 #define MEMP_MEM_MALLOC             1
 /* MEM_ALIGNMENT > 4 e.g. for x86_64 are not supported, see Genode issue #817 */
@@ -50,6 +50,7 @@ extern "C" {
 	extern "C" {
 
 		static void nic_netif_pbuf_free(pbuf *p);
+		static void nic_netif_tx_pbuf_free(pbuf *p);
 		static err_t nic_netif_init(struct netif *netif);
 		static err_t nic_netif_linkoutput(struct netif *netif, struct pbuf *p);
 		static void  nic_netif_status_callback(struct netif *netif);
@@ -70,6 +71,47 @@ extern "C" {
 			p.custom_free_function = nic_netif_pbuf_free;
 		}
 	};
+
+	/**
+	 * Metadata for pbufs backed by the transmit buffer of the Nic session
+	 *
+	 * The packet is allocated from the bulk buffer of the transmit queue
+	 * and released once lwIP freed the pbuf and the Nic server acknowledged
+	 * all submissions of it.
+	 *
+	 * As for 'Nic_netif_pbuf', the 'pbuf_custom' must be the first member
+	 * because lwIP hands out pointers to it.
+	 */
+	struct Nic_netif_tx_pbuf
+	{
+		/*
+		 * Noncopyable
+		 */
+		Nic_netif_tx_pbuf(Nic_netif_tx_pbuf const &);
+		Nic_netif_tx_pbuf &operator = (Nic_netif_tx_pbuf const &);
+
+		struct pbuf_custom p { };
+		Nic_netif &netif;
+		Nic::Packet_descriptor const packet;
+
+		unsigned submitted = 0;  /* number of unacknowledged submissions */
+		bool     released  = false; /* pbuf freed by lwIP */
+
+		/* element of the list of pbufs with unacknowledged submissions */
+		Genode::List_element<Nic_netif_tx_pbuf> in_flight { this };
+
+		Nic_netif_tx_pbuf(Nic_netif &nic, Nic::Packet_descriptor const &pkt)
+		: netif(nic), packet(pkt)
+		{
+			p.custom_free_function = nic_netif_tx_pbuf_free;
+		}
+
+		bool contains(Nic::Packet_descriptor const &pkt) const
+		{
+			return pkt.offset() >= packet.offset()
+			    && pkt.offset() + pkt.size() <= packet.offset() + packet.size();
+		}
+	};
 }
 
 
@@ -84,6 +126,11 @@ class Lwip::Nic_netif
 
 		Genode::Tslab<Nic_netif_pbuf, 128*sizeof(Nic_netif_pbuf)> _pbuf_alloc;
 
+		Genode::Tslab<Nic_netif_tx_pbuf, 128*sizeof(Nic_netif_tx_pbuf)> _tx_pbuf_alloc;
+
+		/* packet-backed transmit pbufs with unacknowledged submissions */
+		Genode::List<Genode::List_element<Nic_netif_tx_pbuf> > _tx_pbufs_in_flight { };
+
 		Nic::Packet_allocator _nic_tx_alloc;
 		Nic::Connection _nic;
 
@@ -98,6 +145,53 @@ class Lwip::Nic_netif
 
 		bool _dhcp { false };
 
+		/**
+		 * Return size of a packet-stream buffer as configured
+		 *
+		 * Large TCP windows require a receive buffer that is able to hold
+		 * the packets of a full window.
+		 */
+		static Genode::size_t _buf_size(Genode::Xml_node const &config,
+		                                char const *attr)
+		{
+			return Genode::max((Genode::size_t)config.attribute_value(attr,
+			                       Genode::Number_of_bytes(BUF_SIZE)),
+			                   (Genode::size_t)(16*PACKET_SIZE));
+		}
+
+		/**
+		 * Release the packets acknowledged by the Nic server
+		 */
+		void _release_acked_packets()
+		{
+			auto &tx = *_nic.tx();
+
+			while (tx.ack_avail()) {
+
+				Nic::Packet_descriptor const acked = tx.get_acked_packet();
+
+				Genode::List_element<Nic_netif_tx_pbuf> *elem = _tx_pbufs_in_flight.first();
+				for (; elem && !elem->object()->contains(acked); elem = elem->next());
+
+				if (!elem) {
+					tx.release_packet(acked);
+					continue;
+				}
+
+				Nic_netif_tx_pbuf * const pbuf = elem->object();
+
+				if (--pbuf->submitted)
+					continue;
+
+				_tx_pbufs_in_flight.remove(elem);
+
+				if (pbuf->released) {
+					tx.release_packet(pbuf->packet);
+					destroy(_tx_pbuf_alloc, pbuf);
+				}
+			}
+		}
+
 	public:
 
 		void free_pbuf(Nic_netif_pbuf &pbuf)
@@ -110,6 +204,60 @@ class Lwip::Nic_netif
 			destroy(_pbuf_alloc, &pbuf);
 		}
 
+		void free_tx_pbuf(Nic_netif_tx_pbuf &pbuf)
+		{
+			pbuf.released = true;
+
+			if (pbuf.submitted)
+				return;
+
+			_nic.tx()->release_packet(pbuf.packet);
+			destroy(_tx_pbuf_alloc, &pbuf);
+		}
+
+		/**
+		 * Allocate a pbuf backed by the transmit buffer of the Nic session
+		 *
+		 * The packet reserves room for the headers of all layers below
+		 * 'layer' in front of the payload. When the pbuf is passed to lwIP
+		 * as a whole, e.g., via 'udp_sendto', lwIP prepends the headers as
+		 * separate pbuf. On output, the headers are copied into the
+		 * reserved room and the payload is submitted without copying.
+		 *
+		 * \return pbuf or nullptr if the transmit buffer is exhausted
+		 */
+		pbuf *alloc_tx_pbuf(pbuf_layer layer, u16_t length)
+		{
+			_release_acked_packets();
+
+			u16_t const size = (u16_t)(LWIP_MEM_ALIGN_SIZE((u16_t)layer) + length);
+
+			Nic::Packet_descriptor packet;
+			try { packet = _nic.tx()->alloc_packet(size); }
+			catch (...) { return nullptr; }
+
+			Nic_netif_tx_pbuf *tx_pbuf = nullptr;
+			try { tx_pbuf = new (_tx_pbuf_alloc) Nic_netif_tx_pbuf(*this, packet); }
+			catch (...) {
+				_nic.tx()->release_packet(packet);
+				return nullptr;
+			}
+
+			/*
+			 * The pbuf type PBUF_REF prevents lwIP from prepending headers
+			 * in place. lwIP would check the header room against the
+			 * location of the pbuf struct, which does not precede the
+			 * payload.
+			 */
+			pbuf *p = pbuf_alloced_custom(layer, length, PBUF_REF, &tx_pbuf->p,
+			                              _nic.tx()->packet_content(packet), size);
+			if (!p) {
+				destroy(_tx_pbuf_alloc, tx_pbuf);
+				_nic.tx()->release_packet(packet);
+			}
+			return p;
+		}
+
 
 		/*************************
 		 ** Nic signal handlers **
@@ -227,9 +375,9 @@ class Lwip::Nic_netif
 		          Genode::Allocator &alloc,
 		          Genode::Xml_node config)
 		:
-			_pbuf_alloc(alloc), _nic_tx_alloc(&alloc),
+			_pbuf_alloc(alloc), _tx_pbuf_alloc(alloc), _nic_tx_alloc(&alloc),
 			_nic(env, &_nic_tx_alloc,
-			     BUF_SIZE, BUF_SIZE,
+			     _buf_size(config, "tx_buf_size"), _buf_size(config, "rx_buf_size"),
 			     config.attribute_value("label", Genode::String<160>("lwip")).string()),
 			_link_state_handler(env.ep(), *this, &Nic_netif::handle_link_state),
 			_rx_packet_handler( env.ep(), *this, &Nic_netif::handle_rx_packets)
@@ -321,14 +469,52 @@ class Lwip::Nic_netif
 			auto &tx = *_nic.tx();
 
 			/* flush acknowledgements */
-			while (tx.ack_avail())
-				tx.release_packet(tx.get_acked_packet());
+			_release_acked_packets();
 
 			if (!tx.ready_to_submit()) {
 				Genode::error("lwIP: Nic packet queue congested, cannot send packet");
 				return ERR_WOULDBLOCK;
 			}
 
+			/*
+			 * Submit the payload that already resides in the transmit buffer
+			 * along with the headers, which are copied into the room in
+			 * front of the payload. Once submitted, the header room may be
+			 * read by the Nic server and must not be overwritten.
+			 */
+			struct pbuf *last = p;
+			u16_t headers_len = 0;
+			for (; last->next; last = last->next)
+				headers_len += last->len;
+
+			if ((last->flags & PBUF_FLAG_IS_CUSTOM)
+			 && ((pbuf_custom *)last)->custom_free_function == nic_netif_tx_pbuf_free) {
+
+				Nic_netif_tx_pbuf &tx_pbuf = *reinterpret_cast<Nic_netif_tx_pbuf *>(last);
+
+				char * const content = tx.packet_content(tx_pbuf.packet);
+				char * const payload = (char *)last->payload;
+
+				if (!tx_pbuf.submitted && payload - content >= headers_len) {
+
+					char *dst = payload - headers_len;
+					for (struct pbuf *q = p; q != last; q = q->next) {
+						Genode::memcpy(dst, q->payload, q->len);
+						dst += q->len;
+					}
+
+					Genode::off_t const offset = payload - headers_len - content;
+
+					tx_pbuf.submitted++;
+					_tx_pbufs_in_flight.insert(&tx_pbuf.in_flight);
+
+					tx.submit_packet(Nic::Packet_descriptor(tx_pbuf.packet.offset() + offset,
+					                                        p->tot_len));
+					LINK_STATS_INC(link.xmit);
+					return ERR_OK;
+				}
+			}
+
 			Nic::Packet_descriptor packet;
 			try { packet = tx.alloc_packet(p->tot_len); }
 			catch (...) {
@@ -377,6 +563,16 @@ static void nic_netif_pbuf_free(pbuf *p)
 }
 
 
+/**
+ * Free a pbuf backed by the transmit buffer
+ */
+static void nic_netif_tx_pbuf_free(pbuf *p)
+{
+	Nic_netif_tx_pbuf *tx_pbuf = reinterpret_cast<Nic_netif_tx_pbuf*>(p);
+	tx_pbuf->netif.free_tx_pbuf(*tx_pbuf);
+}
+
+
 /**
  * Initialize the netif
  */
@@ -112,7 +112,8 @@ namespace Libc {
 	/**
 	 * Pthread/semaphore support
 	 */
-	void init_pthread_support(Suspend &, Resume &, Timer_accessor &);
+	void init_pthread_support(Suspend &, Resume &, Timer_accessor &,
+	                          unsigned num_cpus);
 	void init_pthread_support(Genode::Cpu_session &, Xml_node);
 	void init_semaphore_support(Timer_accessor &);
 
@@ -92,6 +92,18 @@ struct Genode::Thread::Tls::Base
 
 	struct Undefined : Exception { };
 
+	/**
+	 * Return thread-local-storage object of the calling thread
+	 *
+	 * \return nullptr if the thread has no thread-local-storage object
+	 */
+	static Tls::Base *tls_ptr()
+	{
+		Thread * const myself = Thread::myself();
+
+		return myself ? myself->_tls.ptr : nullptr;
+	}
+
 	/**
 	 * Obtain thread-local-storage object for the calling thread
 	 *
@@ -99,12 +111,12 @@ struct Genode::Thread::Tls::Base
 	 */
 	static Tls::Base &tls()
 	{
-		Thread &myself = *Thread::myself();
+		Tls::Base * const ptr = tls_ptr();
 
-		if (!myself._tls.ptr)
+		if (!ptr)
 			throw Undefined();
 
-		return *myself._tls.ptr;
+		return *ptr;
 	}
 };
 
@@ -201,6 +213,28 @@ struct Libc::Pthread : Noncopyable, Thread::Tls::Base
 
 		List<Cleanup_handler> _cleanup_handlers;
 
+		/*
+		 * Thread-specific data
+		 *
+		 * The values are indexed by key and accessed by the owning thread
+		 * only. Each value is tagged with the sequence number of the key at
+		 * the time the value was set. A value with a stale tag belongs to
+		 * a deleted key and reads as null. The array is allocated on the
+		 * first 'pthread_setspecific' of the thread.
+		 */
+		struct Specific
+		{
+			unsigned    key_seq;
+			void const *value;
+		};
+
+		Specific *_specific = nullptr;
+
+		/*
+		 * Call the destructors of the keys with non-null values
+		 */
+		void _destruct_specific();
+
 	public:
 
 		int thread_local_errno = 0;
@@ -238,6 +272,11 @@ struct Libc::Pthread : Noncopyable, Thread::Tls::Base
 		~Pthread()
 		{
 			pthread_registry().remove(*this);
+
+			if (_specific) {
+				Libc::Allocator alloc { };
+				alloc.free(_specific, PTHREAD_KEYS_MAX*sizeof(Specific));
+			}
 		}
 
 		void start() { _thread.start(); }
@@ -253,10 +292,51 @@ struct Libc::Pthread : Noncopyable, Thread::Tls::Base
 		void exit(void *retval)
 		{
 			while (cleanup_pop(1)) { }
+			_destruct_specific();
 			_retval = retval;
 			cancel();
 		}
 
+		/**
+		 * Return thread-specific value of 'key'
+		 *
+		 * \param key_seq  sequence number of the current use of the key
+		 */
+		void *specific(unsigned key, unsigned key_seq) const
+		{
+			if (!_specific || _specific[key].key_seq != key_seq)
+				return nullptr;
+
+			return const_cast<void *>(_specific[key].value);
+		}
+
+		/**
+		 * Set thread-specific value of 'key'
+		 *
+		 * \return false if the value array could not be allocated
+		 */
+		bool specific(unsigned key, unsigned key_seq, void const *value)
+		{
+			if (!_specific) {
+
+				/* a null value is implied by the absence of the array */
+				if (!value)
+					return true;
+
+				Libc::Allocator alloc { };
+				void *ptr = nullptr;
+				if (!alloc.alloc(PTHREAD_KEYS_MAX*sizeof(Specific), &ptr))
+					return false;
+
+				_specific = (Specific *)ptr;
+				for (unsigned i = 0; i < PTHREAD_KEYS_MAX; i++)
+					_specific[i] = Specific { 0, nullptr };
+			}
+
+			_specific[key] = Specific { key_seq, value };
+			return true;
+		}
+
 		void   *stack_addr() const { return _stack_addr; }
 		size_t  stack_size() const { return _stack_size; }
 
@@ -16,6 +16,7 @@
 #include <base/log.h>
 #include <base/sleep.h>
 #include <base/thread.h>
+#include <cpu/atomic.h>
 #include <util/list.h>
 #include <libc/allocator.h>
 
@@ -45,15 +46,18 @@ static Thread         *_main_thread_ptr;
 static Resume         *_resume_ptr;
 static Suspend        *_suspend_ptr;
 static Timer_accessor *_timer_accessor_ptr;
+static bool            _smp;
 
 
 void Libc::init_pthread_support(Suspend &suspend, Resume &resume,
-                                Timer_accessor &timer_accessor)
+                                Timer_accessor &timer_accessor,
+                                unsigned num_cpus)
 {
 	_main_thread_ptr    = Thread::myself();
 	_suspend_ptr        = &suspend;
 	_resume_ptr         = &resume;
 	_timer_accessor_ptr = &timer_accessor;
+	_smp                = num_cpus > 1;
 }
 
 
@@ -187,33 +191,78 @@ namespace Libc {
 struct pthread_mutex_attr { pthread_mutextype type; };
 
 
+/**
+ * Call 'fn' with a blockade suitable for the calling execution context
+ *
+ * \param timeout_ms  timeout or 0 for blocking without timeout
+ */
+template <typename FN>
+static bool with_blockade(Libc::uint64_t timeout_ms, FN const &fn)
+{
+	if (Libc::Kernel::kernel().main_context()) {
+		Main_blockade blockade { timeout_ms };
+		return fn(blockade);
+	}
+
+	struct Missing_call_of_init_pthread_support : Exception { };
+	if (!_timer_accessor_ptr)
+		throw Missing_call_of_init_pthread_support();
+
+	Pthread_blockade blockade { *_timer_accessor_ptr, timeout_ms };
+	return fn(blockade);
+}
+
+
+static inline void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+	asm volatile ("pause" ::: "memory");
+#elif defined(__aarch64__) || defined(__ARM_ARCH_7A__)
+	asm volatile ("yield" ::: "memory");
+#else
+	asm volatile ("" ::: "memory");
+#endif
+}
+
+
 /*
  * This class is named 'struct pthread_mutex' because the 'pthread_mutex_t'
  * type is defined as 'struct pthread_mutex *' in '_pthreadtypes.h'
+ *
+ * The lock state is maintained in an atomically modified word, which is
+ * sufficient to lock and unlock an uncontended mutex. Only if the mutex is
+ * contended, the state is marked as such and the blocked threads are
+ * queued as applicants. On SMP, a thread spins for a while before
+ * blocking. The number of spins adapts to the number of spins that
+ * recently succeeded.
  */
 class pthread_mutex : Genode::Noncopyable
 {
-	private:
+	public:
 
 		struct Applicant : Genode::Noncopyable
-	{
-		pthread_t const thread;
+		{
+			Applicant *next { nullptr };
 
-		Applicant *next { nullptr };
+			Libc::Blockade &blockade;
 
-		Libc::Blockade &blockade;
+			Applicant(Libc::Blockade &blockade) : blockade(blockade) { }
+		};
 
-		Applicant(pthread_t thread, Libc::Blockade &blockade)
-		: thread(thread), blockade(blockade)
-		{ }
-	};
+	private:
 
-		Applicant *_applicants { nullptr };
+		enum State { UNLOCKED = 0, LOCKED = 1, CONTENDED = 2 };
 
-	protected:
+		enum { MAX_SPINS = 1000 };
+
+		int volatile _state { UNLOCKED };
+
+		/* heuristic number of spins, updated without synchronization */
+		int _spins { 0 };
+
+		Mutex _data_mutex { };
 
-		pthread_t _owner      { nullptr };
-		Mutex     _data_mutex;
+		Applicant *_applicants { nullptr };
 
 		/* _data_mutex must be hold when calling the following methods */
 
@@ -223,71 +272,149 @@ class pthread_mutex : Genode::Noncopyable
 
 			for (; *tail; tail = &(*tail)->next) ;
 
+			applicant->next = nullptr;
 			*tail = applicant;
 		}
 
-		void _remove_applicant(Applicant *applicant)
+		bool _remove_applicant(Applicant *applicant)
 		{
 			Applicant **a = &_applicants;
 
 			for (; *a && *a != applicant; a = &(*a)->next) ;
 
+			if (!*a)
+				return false;
+
 			*a = applicant->next;
+			return true;
 		}
 
-		void _next_applicant_to_owner()
+		/**
+		 * Mark mutex as contended
+		 *
+		 * \return true if the mutex was unlocked and is now owned by the
+		 *         caller
+		 */
+		bool _mark_contended()
 		{
-			if (Applicant *next = _applicants) {
-				_remove_applicant(next);
-				_owner = next->thread;
-				next->blockade.wakeup();
-			} else {
-				_owner = nullptr;
+			for (;;) {
+				int const state = _state;
+
+				if (state == CONTENDED)
+					return false;
+
+				if (Genode::cmpxchg(&_state, state, CONTENDED))
+					return state == UNLOCKED;
 			}
 		}
 
-		bool _applicant_for_mutex(pthread_t thread, Libc::Blockade &blockade)
+		bool _spin()
 		{
-			Applicant applicant { thread, blockade };
-
-			_append_applicant(&applicant);
-
-			_data_mutex.release();
+			if (!_smp)
+				return false;
 
-			blockade.block();
+			int const max_spins = Genode::min(2*_spins + 10, (int)MAX_SPINS);
 
-			_data_mutex.acquire();
+			for (int i = 0; i < max_spins; i++) {
 
-			if (blockade.woken_up()) {
-				return true;
-			} else {
-				_remove_applicant(&applicant);
-				return false;
+				if (_state == UNLOCKED && _try_acquire()) {
+					_spins += (i - _spins) / 8;
+					return true;
+				}
+				cpu_relax();
 			}
-		}
 
-		struct Missing_call_of_init_pthread_support : Exception { };
+			_spins += (max_spins - _spins) / 8;
+			return false;
+		}
 
-		Timer_accessor & _timer_accessor()
+		/**
+		 * Block as applicant for mutex
+		 *
+		 * \return false on timeout
+		 */
+		bool _block(Libc::uint64_t timeout_ms)
 		{
-			if (!_timer_accessor_ptr)
-				throw Missing_call_of_init_pthread_support();
-			return *_timer_accessor_ptr;
+			return with_blockade(timeout_ms, [&] (Libc::Blockade &blockade) {
+
+				Applicant applicant { blockade };
+
+				_append_applicant(&applicant);
+
+				_data_mutex.release();
+
+				blockade.block();
+
+				/*
+				 * Applicants are woken up with '_data_mutex' held. Acquiring
+				 * it ensures that the waker left 'wakeup' before the blockade
+				 * goes out of scope.
+				 */
+				_data_mutex.acquire();
+
+				if (blockade.woken_up())
+					return true;
+
+				/* the applicant may have been woken up after the timeout */
+				return !_remove_applicant(&applicant);
+			});
 		}
 
+	protected:
+
+		pthread_t _owner { nullptr };
+
+		bool _try_acquire() {
+			return Genode::cmpxchg(&_state, UNLOCKED, LOCKED); }
+
 		/**
-		 * Enqueue current context as applicant for mutex
+		 * Acquire mutex
 		 *
-		 * Return true if mutex was aquired, false on timeout expiration.
+		 * \param abs_timeout  absolute timeout or nullptr
+		 * \param contended    acquire mutex in contended state
+		 *
+		 * \return false on timeout
 		 */
-		bool _apply_for_mutex(pthread_t thread, Libc::uint64_t timeout_ms)
+		bool _acquire(timespec const *abs_timeout, bool contended = false)
+		{
+			if (!contended && (_try_acquire() || _spin()))
+				return true;
+
+			Mutex::Guard guard(_data_mutex);
+
+			for (;;) {
+				if (_mark_contended())
+					return true;
+
+				Libc::uint64_t timeout_ms = 0;
+				if (abs_timeout) {
+					timespec abs_now;
+					clock_gettime(CLOCK_REALTIME, &abs_now);
+
+					timeout_ms = calculate_relative_timeout_ms(abs_now, *abs_timeout);
+					if (!timeout_ms)
+						return false;
+				}
+
+				if (!_block(timeout_ms))
+					return false;
+			}
+		}
+
+		void _release()
 		{
-			if (Libc::Kernel::kernel().main_context()) {
-				Main_blockade blockade { timeout_ms };
-				return _applicant_for_mutex(thread, blockade);
-			} else {
-				Pthread_blockade blockade { _timer_accessor(), timeout_ms };
-				return _applicant_for_mutex(thread, blockade);
+			/* fast path without applicants */
+			if (Genode::cmpxchg(&_state, LOCKED, UNLOCKED))
+				return;
+
+			Mutex::Guard guard(_data_mutex);
+
+			Genode::cmpxchg(&_state, CONTENDED, UNLOCKED);
+
+			/* the woken applicant competes for the mutex */
+			if (Applicant *next = _applicants) {
+				_remove_applicant(next);
+				next->blockade.wakeup();
 			}
 		}
 
@@ -297,12 +424,65 @@ class pthread_mutex : Genode::Noncopyable
 
 		virtual ~pthread_mutex() { }
 
+		/**
+		 * Move waiters of a condition variable to the applicants
+		 *
+		 * The applicants are woken one after another on unlock instead of
+		 * all at once. Waiters cannot be moved if the mutex is unlocked
+		 * because no unlock may follow.
+		 *
+		 * \return false if the applicants were not moved
+		 */
+		bool requeue(Applicant *applicants)
+		{
+			Mutex::Guard guard(_data_mutex);
+
+			for (;;) {
+				int const state = _state;
+
+				if (state == UNLOCKED)
+					return false;
+
+				if (Genode::cmpxchg(&_state, state, CONTENDED))
+					break;
+			}
+
+			while (Applicant *applicant = applicants) {
+				applicants = applicant->next;
+				_append_applicant(applicant);
+			}
+			return true;
+		}
+
+		/**
+		 * Withdraw a moved waiter, e.g., on timeout
+		 *
+		 * \return false if the waiter was already woken up
+		 */
+		bool withdraw(Applicant &applicant)
+		{
+			Mutex::Guard guard(_data_mutex);
+			return _remove_applicant(&applicant);
+		}
+
+		/**
+		 * Wait until the wakeup of a moved waiter is completed
+		 *
+		 * Applicants are woken up with '_data_mutex' held. Hence, the
+		 * waker left 'wakeup' once the mutex can be acquired.
+		 */
+		void wait_for_wakeup() { Mutex::Guard guard(_data_mutex); }
+
 		/*
+		 * The 'contended' argument of 'lock' enforces the contended state
+		 * of the mutex after the lock was acquired, which is needed if
+		 * applicants may be queued without the mutex being marked.
+		 *
 		 * The behavior of the following function follows the "robust mutex"
 		 * described IEEE Std 1003.1 POSIX.1-2017
 		 * https://pubs.opengroup.org/onlinepubs/9699919799/functions/pthread_mutex_lock.html
 		 */
-		virtual int lock()                      = 0;
+		virtual int lock(bool contended)        = 0;
 		virtual int timedlock(timespec const &) = 0;
 		virtual int trylock()                   = 0;
 		virtual int unlock()                    = 0;
@@ -311,72 +491,39 @@ class pthread_mutex : Genode::Noncopyable
 
 struct Libc::Pthread_mutex_normal : pthread_mutex
 {
-	/* unsynchronized try */
-	int _try_lock(pthread_t thread)
-	{
-		if (!_owner) {
-			_owner = thread;
-			return 0;
-		}
-
-		return EBUSY;
-	}
-
-	int lock() override final
+	int lock(bool contended) override final
 	{
-		pthread_t const myself = pthread_self();
-
-		Mutex::Guard guard(_data_mutex);
-
-		/* fast path without lock contention */
-		if (_try_lock(myself) == 0)
-			return 0;
-
-		_apply_for_mutex(myself, 0);
-
+		_acquire(nullptr, contended);
+		_owner = pthread_self();
 		return 0;
 	}
 
 	int timedlock(timespec const &abs_timeout) override final
 	{
-		pthread_t const myself = pthread_self();
-
-		Mutex::Guard guard(_data_mutex);
-
-		/* fast path without lock contention - does not check abstimeout according to spec */
-		if (_try_lock(myself) == 0)
-			return 0;
-
-		timespec abs_now;
-		clock_gettime(CLOCK_REALTIME, &abs_now);
-
-		uint64_t const timeout_ms = calculate_relative_timeout_ms(abs_now, abs_timeout);
-		if (!timeout_ms)
+		/* an uncontended mutex is acquired without checking abs_timeout according to spec */
+		if (!_acquire(&abs_timeout))
 			return ETIMEDOUT;
 
-		if (_apply_for_mutex(myself, timeout_ms))
-			return 0;
-		else
-			return ETIMEDOUT;
+		_owner = pthread_self();
+		return 0;
 	}
 
 	int trylock() override final
 	{
-		pthread_t const myself = pthread_self();
-
-		Mutex::Guard guard(_data_mutex);
+		if (!_try_acquire())
+			return EBUSY;
 
-		return _try_lock(myself);
+		_owner = pthread_self();
+		return 0;
 	}
 
 	int unlock() override final
 	{
-		Mutex::Guard guard(_data_mutex);
-
 		if (_owner != pthread_self())
 			return EPERM;
 
-		_next_applicant_to_owner();
+		_owner = nullptr;
+		_release();
 
 		return 0;
 	}
@@ -385,30 +532,15 @@ struct Libc::Pthread_mutex_normal : pthread_mutex
 
 struct Libc::Pthread_mutex_errorcheck : pthread_mutex
 {
-	/* unsynchronized try */
-	int _try_lock(pthread_t thread)
-	{
-		if (!_owner) {
-			_owner = thread;
-			return 0;
-		}
-
-		return _owner == thread ? EDEADLK : EBUSY;
-	}
-
-	int lock() override final
+	int lock(bool contended) override final
 	{
 		pthread_t const myself = pthread_self();
 
-		Mutex::Guard guard(_data_mutex);
-
-		/* fast path without lock contention (or deadlock) */
-		int const result = _try_lock(myself);
-		if (!result || result == EDEADLK)
-			return result;
-
-		_apply_for_mutex(myself, 0);
+		if (_owner == myself)
+			return EDEADLK;
 
+		_acquire(nullptr, contended);
+		_owner = myself;
 		return 0;
 	}
 
@@ -422,19 +554,23 @@ struct Libc::Pthread_mutex_errorcheck : pthread_mutex
 	{
 		pthread_t const myself = pthread_self();
 
-		Mutex::Guard guard(_data_mutex);
+		if (_owner == myself)
+			return EDEADLK;
 
-		return _try_lock(myself);
+		if (!_try_acquire())
+			return EBUSY;
+
+		_owner = myself;
+		return 0;
 	}
 
 	int unlock() override final
 	{
-		Mutex::Guard guard(_data_mutex);
-
 		if (_owner != pthread_self())
 			return EPERM;
 
-		_next_applicant_to_owner();
+		_owner = nullptr;
+		_release();
 
 		return 0;
 	}
@@ -445,32 +581,17 @@ struct Libc::Pthread_mutex_recursive : pthread_mutex
 {
 	unsigned _nesting_level { 0 };
 
-	/* unsynchronized try */
-	int _try_lock(pthread_t thread)
-	{
-		if (!_owner) {
-			_owner = thread;
-			return 0;
-		} else if (_owner == thread) {
-			++_nesting_level;
-			return 0;
-		}
-
-		return EBUSY;
-	}
-
-	int lock() override final
+	int lock(bool contended) override final
 	{
 		pthread_t const myself = pthread_self();
 
-		Mutex::Guard guard(_data_mutex);
-
-		/* fast path without lock contention */
-		if (_try_lock(myself) == 0)
+		if (_owner == myself) {
+			++_nesting_level;
 			return 0;
+		}
 
-		_apply_for_mutex(myself, 0);
-
+		_acquire(nullptr, contended);
+		_owner = myself;
 		return 0;
 	}
 
@@ -483,21 +604,27 @@ struct Libc::Pthread_mutex_recursive : pthread_mutex
 	{
 		pthread_t const myself = pthread_self();
 
-		Mutex::Guard guard(_data_mutex);
+		if (_owner == myself) {
+			++_nesting_level;
+			return 0;
+		}
 
-		return _try_lock(myself);
+		if (!_try_acquire())
+			return EBUSY;
+
+		_owner = myself;
+		return 0;
 	}
 
 	int unlock() override final
 	{
-		Mutex::Guard guard(_data_mutex);
-
 		if (_owner != pthread_self())
 			return EPERM;
 
-		if (_nesting_level == 0)
-			_next_applicant_to_owner();
-		else
+		if (_nesting_level == 0) {
+			_owner = nullptr;
+			_release();
+		} else
 			--_nesting_level;
 
 		return 0;
@@ -505,15 +632,6 @@ struct Libc::Pthread_mutex_recursive : pthread_mutex
 };
 
 
-/*
- * The pthread_cond implementation uses the POSIX semaphore API
- * internally that does not have means to set the clock. For this
- * reason the private 'sem_set_clock' function is introduced,
- * see 'semaphore.cc' for the implementation.
-*/
-extern "C" int sem_set_clock(sem_t *sem, clockid_t clock_id);
-
-
 extern "C" {
 
 	/* Thread */
@@ -821,7 +939,7 @@ extern "C" {
 		if (*mutex == PTHREAD_MUTEX_INITIALIZER)
 			pthread_mutex_init(mutex, nullptr);
 
-		return (*mutex)->lock();
+		return (*mutex)->lock(false);
 	}
 
 	typeof(pthread_mutex_lock) _pthread_mutex_lock
@@ -876,35 +994,80 @@ extern "C" {
 
 
 	/*
-	 * Implementation based on
-	 * http://web.archive.org/web/20010914175514/http://www-classic.be.com/aboutbe/benewsletter/volume_III/Issue40.html#Workshop
+	 * Waiters are queued in FIFO order and each signal wakes exactly one
+	 * waiter. A broadcast wakes the first waiter only and moves the others
+	 * to the applicants of the mutex. So the waiters are woken one after
+	 * another as the mutex becomes available instead of all competing for
+	 * the mutex at once.
 	 */
-
-	struct pthread_cond
+	struct pthread_cond : Genode::Noncopyable
 	{
-		int             num_waiters;
-		int             num_signallers;
-		pthread_mutex_t counter_mutex;
-		sem_t           signal_sem;
-		sem_t           handshake_sem;
-
-		pthread_cond(clockid_t clock_id) : num_waiters(0), num_signallers(0)
+		struct Waiter : pthread_mutex::Applicant
 		{
-			pthread_mutex_init(&counter_mutex, nullptr);
-			sem_init(&signal_sem, 0, 0);
-			sem_init(&handshake_sem, 0, 0);
+			/* mutex the waiter was moved to by a broadcast */
+			pthread_mutex *requeued_to { nullptr };
+
+			using Applicant::Applicant;
+
+			Waiter *next_waiter() { return static_cast<Waiter *>(next); }
+		};
+
+		clockid_t const clock_id;
+
+		Mutex data_mutex { };
 
-			if (sem_set_clock(&signal_sem, clock_id)) {
+		Waiter *waiters { nullptr };
+
+		/* mutex used by the current waiters */
+		pthread_mutex *mutex { nullptr };
+
+		pthread_cond(clockid_t clock_id) : clock_id(clock_id)
+		{
+			if (clock_id != CLOCK_REALTIME && clock_id != CLOCK_MONOTONIC) {
 				struct Invalid_timedwait_clock { };
 				throw Invalid_timedwait_clock();
 			}
 		}
 
-		~pthread_cond()
+		/* data_mutex must be hold when calling the following methods */
+
+		void append(Waiter &waiter)
+		{
+			waiter.next = nullptr;
+
+			if (!waiters) {
+				waiters = &waiter;
+				return;
+			}
+
+			Waiter *last = waiters;
+			for (; last->next; last = last->next_waiter()) ;
+
+			last->next = &waiter;
+		}
+
+		bool remove(Waiter &waiter)
+		{
+			if (waiters == &waiter) {
+				waiters = waiter.next_waiter();
+				return true;
+			}
+
+			for (Waiter *w = waiters; w; w = w->next_waiter())
+				if (w->next == &waiter) {
+					w->next = waiter.next;
+					return true;
+				}
+
+			return false;
+		}
+
+		Waiter *dequeue()
 		{
-			sem_destroy(&handshake_sem);
-			sem_destroy(&signal_sem);
-			pthread_mutex_destroy(&counter_mutex);
+			Waiter *waiter = waiters;
+			if (waiter)
+				waiters = waiter->next_waiter();
+			return waiter;
 		}
 	};
 
@@ -1009,41 +1172,89 @@ extern "C" {
 	                           pthread_mutex_t *__restrict mutex,
 	                           const struct timespec *__restrict abstime)
 	{
-		int result = 0;
-
-		if (!cond)
+		if (!cond || !mutex || *mutex == PTHREAD_MUTEX_INITIALIZER)
 			return EINVAL;
 
 		if (*cond == PTHREAD_COND_INITIALIZER)
 			cond_init(cond, NULL);
 
-		pthread_cond *c = *cond;
+		pthread_cond  &c = **cond;
+		pthread_mutex &m = **mutex;
 
-		pthread_mutex_lock(&c->counter_mutex);
-		c->num_waiters++;
-		pthread_mutex_unlock(&c->counter_mutex);
+		Libc::uint64_t timeout_ms = 0;
+		if (abstime) {
+			timespec abs_now;
+			clock_gettime(c.clock_id, &abs_now);
 
-		pthread_mutex_unlock(mutex);
-
-		if (!abstime) {
-			if (sem_wait(&c->signal_sem) == -1)
-				result = errno;
-		} else {
-			if (sem_timedwait(&c->signal_sem, abstime) == -1)
-				result = errno;
+			timeout_ms = calculate_relative_timeout_ms(abs_now, *abstime);
+			if (!timeout_ms)
+				return ETIMEDOUT;
 		}
 
-		pthread_mutex_lock(&c->counter_mutex);
-		if (c->num_signallers > 0) {
-			if (result == ETIMEDOUT) /* timeout occured */
-				sem_wait(&c->signal_sem);
-			sem_post(&c->handshake_sem);
-			--c->num_signallers;
-		}
-		c->num_waiters--;
-		pthread_mutex_unlock(&c->counter_mutex);
+		int  result    = 0;
+		bool contended = false;
+
+		with_blockade(timeout_ms, [&] (Libc::Blockade &blockade) {
+
+			pthread_cond::Waiter waiter { blockade };
+
+			{
+				Mutex::Guard guard(c.data_mutex);
+				c.append(waiter);
+				c.mutex = &m;
+			}
+
+			result = m.unlock();
+			if (result) {
+				Mutex::Guard guard(c.data_mutex);
+				c.remove(waiter);
+				return false;
+			}
+
+			blockade.block();
+
+			/*
+			 * A waiter moved to the mutex may be woken up while other moved
+			 * waiters are still queued at the mutex.
+			 */
+			if (blockade.woken_up()) {
+				contended = (waiter.requeued_to != nullptr);
+
+				/*
+				 * The waker may still be in 'wakeup' of the blockade, which
+				 * goes out of scope on return. Wait for the waker to release
+				 * the lock it held while waking us up.
+				 */
+				if (waiter.requeued_to)
+					waiter.requeued_to->wait_for_wakeup();
+				else
+					Mutex::Guard guard(c.data_mutex);
+
+				return true;
+			}
+
+			/*
+			 * On timeout, the waiter leaves the queue it is in. If it is not
+			 * found there, it was woken up concurrently and the wait succeeded.
+			 */
+			Mutex::Guard guard(c.data_mutex);
+
+			contended = (waiter.requeued_to != nullptr);
+
+			bool const timed_out = waiter.requeued_to
+			                     ? waiter.requeued_to->withdraw(waiter)
+			                     : c.remove(waiter);
+			if (timed_out)
+				result = ETIMEDOUT;
 
-		pthread_mutex_lock(mutex);
+			return !timed_out;
+		});
+
+		/* the caller did not own the mutex if unlocking failed */
+		if (result == EPERM)
+			return result;
+
+		m.lock(contended);
 
 		return result;
 	}
@@ -1070,16 +1281,12 @@ extern "C" {
 		if (*cond == PTHREAD_COND_INITIALIZER)
 			cond_init(cond, NULL);
 
-		pthread_cond *c = *cond;
+		pthread_cond &c = **cond;
 
-		pthread_mutex_lock(&c->counter_mutex);
-		if (c->num_waiters > c->num_signallers) {
-			++c->num_signallers;
-			sem_post(&c->signal_sem);
-			pthread_mutex_unlock(&c->counter_mutex);
-			sem_wait(&c->handshake_sem);
-		} else
-			pthread_mutex_unlock(&c->counter_mutex);
+		Mutex::Guard guard(c.data_mutex);
+
+		if (pthread_cond::Waiter *waiter = c.dequeue())
+			waiter->blockade.wakeup();
 
 		return 0;
 	}
@@ -1096,19 +1303,35 @@ extern "C" {
 		if (*cond == PTHREAD_COND_INITIALIZER)
 			cond_init(cond, NULL);
 
-		pthread_cond *c = *cond;
-
-		pthread_mutex_lock(&c->counter_mutex);
-		if (c->num_waiters > c->num_signallers) {
-			int still_waiting = c->num_waiters - c->num_signallers;
-			c->num_signallers = c->num_waiters;
-			for (int i = 0; i < still_waiting; i++)
-				sem_post(&c->signal_sem);
-			pthread_mutex_unlock(&c->counter_mutex);
-			for (int i = 0; i < still_waiting; i++)
-				sem_wait(&c->handshake_sem);
-		} else
-			pthread_mutex_unlock(&c->counter_mutex);
+		pthread_cond &c = **cond;
+
+		Mutex::Guard guard(c.data_mutex);
+
+		pthread_cond::Waiter *first = c.dequeue();
+		if (!first)
+			return 0;
+
+		first->blockade.wakeup();
+
+		pthread_cond::Waiter * const others = c.waiters;
+		if (!others)
+			return 0;
+
+		c.waiters = nullptr;
+
+		/* a timed-out waiter must find itself at the mutex */
+		for (pthread_cond::Waiter *w = others; w; w = w->next_waiter())
+			w->requeued_to = c.mutex;
+
+		if (c.mutex && c.mutex->requeue(others))
+			return 0;
+
+		/* the mutex is not locked, so wake up all waiters */
+		for (pthread_cond::Waiter *w = others, *next = nullptr; w; w = next) {
+			next = w->next_waiter();
+			w->requeued_to = nullptr;
+			w->blockade.wakeup();
+		}
 
 		return 0;
 	}
@@ -1120,6 +1343,31 @@ extern "C" {
 	/* TLS */
 
 
+	/*
+	 * Key slots
+	 *
+	 * The sequence number of a slot is odd while the key is in use. It is
+	 * incremented on creation and deletion so that values set for a deleted
+	 * key are not visible via a new key of the same slot. The slots are
+	 * modified with 'key_list_mutex' held but read without the mutex by
+	 * 'pthread_getspecific' and 'pthread_setspecific'.
+	 */
+	struct Key_slot
+	{
+		unsigned seq;
+		void (*destructor)(void *);
+
+		bool used() const { return seq & 1; }
+	};
+
+
+	static Key_slot key_slots[PTHREAD_KEYS_MAX];
+
+
+	/*
+	 * Values of threads that are not pthreads, e.g., threads created via
+	 * the Genode API, are kept in per-key lists.
+	 */
 	struct Key_element : List<Key_element>::Element
 	{
 		const void *thread_base;
@@ -1151,6 +1399,26 @@ extern "C" {
 	}
 
 
+	/*
+	 * Return pthread object of the calling thread
+	 *
+	 * In contrast to 'pthread_self()', the function does not consult the
+	 * pthread registry and returns nullptr for threads that are no pthreads.
+	 */
+	static Pthread *myself_pthread()
+	{
+		/* avoid the exception of 'tls()' on this hot path */
+		if (Thread::Tls::Base *tls = Thread::Tls::Base::tls_ptr())
+			return static_cast<Pthread *>(tls);
+
+		/* the pthread object of the main thread is created on demand */
+		if (_pthread_main_np())
+			return pthread_self();
+
+		return nullptr;
+	}
+
+
 	int pthread_key_create(pthread_key_t *key, void (*destructor)(void*))
 	{
 		if (!key)
@@ -1159,14 +1427,12 @@ extern "C" {
 		Mutex::Guard guard(key_list_mutex());
 
 		for (int k = 0; k < PTHREAD_KEYS_MAX; k++) {
-			/*
-			 * Find an empty key slot and insert an element for the current
-			 * thread to mark the key slot as used.
-			 */
-			if (!keys().key[k].first()) {
-				Libc::Allocator alloc { };
-				Key_element *key_element = new (alloc) Key_element(Thread::myself(), 0);
-				keys().key[k].insert(key_element);
+
+			Key_slot &slot = key_slots[k];
+
+			if (!slot.used()) {
+				slot.destructor = destructor;
+				slot.seq++;
 				*key = k;
 				return 0;
 			}
@@ -1181,11 +1447,19 @@ extern "C" {
 
 	int pthread_key_delete(pthread_key_t key)
 	{
-		if (key < 0 || key >= PTHREAD_KEYS_MAX || !keys().key[key].first())
+		if (key < 0 || key >= PTHREAD_KEYS_MAX)
 			return EINVAL;
 
 		Mutex::Guard guard(key_list_mutex());
 
+		Key_slot &slot = key_slots[key];
+
+		if (!slot.used())
+			return EINVAL;
+
+		slot.seq++;
+		slot.destructor = nullptr;
+
 		while (Key_element * element = keys().key[key].first()) {
 			keys().key[key].remove(element);
 			Libc::Allocator alloc { };
@@ -1204,6 +1478,14 @@ extern "C" {
 		if (key < 0 || key >= PTHREAD_KEYS_MAX)
 			return EINVAL;
 
+		unsigned const seq = key_slots[key].seq;
+
+		if (!(seq & 1))
+			return EINVAL;
+
+		if (Pthread *pthread = myself_pthread())
+			return pthread->specific(key, seq, value) ? 0 : ENOMEM;
+
 		void *myself = Thread::myself();
 
 		Mutex::Guard guard(key_list_mutex());
@@ -1231,6 +1513,14 @@ extern "C" {
 		if (key < 0 || key >= PTHREAD_KEYS_MAX)
 			return nullptr;
 
+		unsigned const seq = key_slots[key].seq;
+
+		if (!(seq & 1))
+			return nullptr;
+
+		if (Pthread *pthread = myself_pthread())
+			return pthread->specific(key, seq);
+
 		void *myself = Thread::myself();
 
 		Mutex::Guard guard(key_list_mutex());
@@ -1275,7 +1565,7 @@ extern "C" {
 			if (p) pthread_mutex_destroy(&p);
 		}
 
-		once->mutex->lock();
+		once->mutex->lock(false);
 
 		if (once->state == PTHREAD_DONE_INIT) {
 			once->mutex->unlock();
@@ -1294,3 +1584,37 @@ extern "C" {
 	typeof(pthread_once) _pthread_once
 		__attribute__((alias("pthread_once")));
 }
+
+
+void Libc::Pthread::_destruct_specific()
+{
+	if (!_specific)
+		return;
+
+	/*
+	 * A destructor may set values of other keys, which are destructed in
+	 * a subsequent iteration.
+	 */
+	for (unsigned i = 0; i < PTHREAD_DESTRUCTOR_ITERATIONS; i++) {
+
+		bool called = false;
+
+		for (unsigned k = 0; k < PTHREAD_KEYS_MAX; k++) {
+
+			Key_slot const &slot = key_slots[k];
+			Specific      &s    = _specific[k];
+
+			if (!s.value || s.key_seq != slot.seq || !slot.destructor)
+				continue;
+
+			void * const value = const_cast<void *>(s.value);
+			s.value = nullptr;
+
+			slot.destructor(value);
+			called = true;
+		}
+
+		if (!called)
+			return;
+	}
+}
@@ -16,6 +16,7 @@
 #include <timer_session/connection.h>
 #include <util/reconstructible.h>
 #include <base/sleep.h>
+#include <base/slab.h>
 
 #include <lwip/genode_init.h>
 
@@ -30,10 +31,109 @@ extern "C" {
 #include <string.h>
 }
 
+unsigned lwip_tcp_wnd     = 32*TCP_MSS;
+unsigned lwip_tcp_snd_buf = 32*TCP_MSS;
+
+
 namespace Lwip {
 
 	static Genode::Allocator *_heap;
 
+	/**
+	 * Allocator for the memory and pool allocations of the stack
+	 *
+	 * TCP segments, pbufs, and protocol control blocks are allocated and
+	 * freed at a high rate. Small allocations are therefore served by
+	 * slabs of power-of-two size classes. Each allocation is preceded by
+	 * a header that records its size class because lwIP frees memory
+	 * without a size argument. Allocations beyond the largest size class
+	 * are passed to the heap.
+	 *
+	 * Like the state of lwIP, the pool is global to the component and uses
+	 * the allocator passed to the first call of 'genode_init'. In contrast
+	 * to the heap, the slabs are not thread-safe, hence the mutex.
+	 */
+	class Mem_pool
+	{
+		private:
+
+			/*
+			 * Noncopyable
+			 */
+			Mem_pool(Mem_pool const &);
+			Mem_pool &operator = (Mem_pool const &);
+
+			enum {
+				MIN_CLASS_LOG2 = 5,
+				MAX_CLASS_LOG2 = 11,
+				NUM_CLASSES    = MAX_CLASS_LOG2 - MIN_CLASS_LOG2 + 1,
+				BLOCK_SIZE     = 32*1024,
+				HEAP_CLASS     = ~0U,
+			};
+
+			struct Header
+			{
+				unsigned size_class;
+				unsigned pad;
+			};
+
+			Genode::Allocator &_heap;
+
+			Genode::Mutex _mutex { };
+
+			Genode::Constructible<Genode::Slab> _slabs[NUM_CLASSES];
+
+			static unsigned _size_class(Genode::size_t size)
+			{
+				for (unsigned i = 0; i < NUM_CLASSES; i++)
+					if (size <= (1UL << (MIN_CLASS_LOG2 + i)))
+						return i;
+				return HEAP_CLASS;
+			}
+
+		public:
+
+			Mem_pool(Genode::Allocator &heap) : _heap(heap)
+			{
+				for (unsigned i = 0; i < NUM_CLASSES; i++)
+					_slabs[i].construct(1UL << (MIN_CLASS_LOG2 + i),
+					                    BLOCK_SIZE, nullptr, &_heap);
+			}
+
+			void *alloc(Genode::size_t size)
+			{
+				Genode::size_t const total     = size + sizeof(Header);
+				unsigned       const cls       = _size_class(total);
+				Genode::Allocator   &allocator = (cls == HEAP_CLASS)
+				                               ? _heap : *_slabs[cls];
+
+				Genode::Mutex::Guard guard(_mutex);
+
+				void *ptr = nullptr;
+				if (!allocator.alloc(total, &ptr))
+					return nullptr;
+
+				Header &header = *(Header *)ptr;
+				header.size_class = cls;
+				return &header + 1;
+			}
+
+			void free(void *ptr)
+			{
+				Header * const header = (Header *)ptr - 1;
+				unsigned const cls    = header->size_class;
+
+				Genode::Mutex::Guard guard(_mutex);
+
+				if (cls == HEAP_CLASS)
+					_heap.free(header, 0);
+				else
+					_slabs[cls]->free(header, 1UL << (MIN_CLASS_LOG2 + cls));
+			}
+	};
+
+	static Mem_pool *_mem_pool;
+
 	struct Sys_timer
 	{
 		void check_timeouts(Genode::Duration)
@@ -58,14 +158,39 @@ namespace Lwip {
 		LWIP_ASSERT("LwIP initialized with an allocator that does not track sizes",
 		            !heap.need_size_for_free());
 
+		if (_mem_pool) {
+			Genode::warning("lwIP is already initialized, "
+			                "keeping the allocator of the first stack");
+			return;
+		}
+
 		_heap = &heap;
 
+		static Mem_pool mem_pool(heap);
+		_mem_pool = &mem_pool;
+
 		static Sys_timer sys_timer(timer);
 		sys_timer_ptr = &sys_timer;
 
 		lwip_init();
 	}
 
+	void configure_tcp(Genode::size_t window, Genode::size_t send_buffer)
+	{
+		using Genode::size_t;
+
+		size_t const min_size   = 2*TCP_MSS;
+		size_t const max_window = 0xffffUL << TCP_RCV_SCALE;
+
+		window      = Genode::min(Genode::max(window,      min_size), max_window);
+		send_buffer = Genode::min(Genode::max(send_buffer, min_size), (size_t)TCP_SND_BUF_MAX);
+
+		Genode::Mutex::Guard guard { mutex() };
+
+		lwip_tcp_wnd     = (unsigned)window;
+		lwip_tcp_snd_buf = (unsigned)send_buffer;
+	}
+
 	Genode::Mutex &mutex()
 	{
 		static Genode::Mutex _lwip_mutex;
@@ -84,24 +209,22 @@ extern "C" {
 
 	void genode_free(void *ptr)
 	{
-		Lwip::_heap->free(ptr, 0);
+		if (ptr)
+			Lwip::_mem_pool->free(ptr);
 	}
 
 	void *genode_malloc(unsigned long size)
 	{
-		void *ptr = nullptr;
-		return Lwip::_heap->alloc(size, &ptr) ? ptr : 0;
+		return Lwip::_mem_pool->alloc(size);
 	}
 
 	void *genode_calloc(unsigned long number, unsigned long size)
 	{
-		void *ptr = nullptr;
 		size *= number;
-		if (Lwip::_heap->alloc(size, &ptr)) {
+		void * const ptr = Lwip::_mem_pool->alloc(size);
+		if (ptr)
 			Genode::memset(ptr, 0x00, size);
-			return ptr;
-		}
-		return nullptr;
+		return ptr;
 	}
 
 	u32_t sys_now(void) {
@@ -12,11 +12,15 @@
  */
 
 /* Genode includes */
+#include <base/log.h>
+#include <base/shared_object.h>
 #include <libc/component.h>
 
 /* libc includes */
 #include <libc/args.h>
 #include <stdlib.h> /* 'exit'   */
+#include <fcntl.h>  /* 'open'   */
+#include <unistd.h> /* 'write'  */
 
 /* initial environment for the FreeBSD libc implementation */
 extern char **environ;
@@ -24,6 +28,45 @@ extern char **environ;
 /* provided by the application */
 extern "C" int main(int argc, char **argv, char **envp);
 
+/**
+ * Store relocation record of the dynamic linker at the configured path
+ *
+ * The file is expected to be provided as "ld_reloc_cache" ROM module on
+ * the next start of the component.
+ */
+static void store_reloc_cache(Libc::Env &env)
+{
+	typedef Genode::String<256> Path;
+
+	Path const path = env.libc_config().attribute_value("reloc_cache", Path());
+	if (!path.valid())
+		return;
+
+	Genode::Dynamic_linker::with_relocation_record(env,
+		[&] (void const *data, Genode::size_t size) {
+
+			int const fd = open(path.string(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+			if (fd < 0) {
+				Genode::warning("unable to create relocation cache ", path);
+				return;
+			}
+
+			char const *ptr = (char const *)data;
+			while (size) {
+				ssize_t const n = write(fd, ptr, size);
+				if (n <= 0) {
+					Genode::warning("unable to write relocation cache ", path);
+					break;
+				}
+				ptr  += n;
+				size -= n;
+			}
+
+			close(fd);
+		});
+}
+
+
 static void construct_component(Libc::Env &env)
 {
 	int argc    = 0;
@@ -34,6 +77,8 @@ static void construct_component(Libc::Env &env)
 
 	environ = envp;
 
+	store_reloc_cache(env);
+
 	exit(main(argc, argv, envp));
 }
 
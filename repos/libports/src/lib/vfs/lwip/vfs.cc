@@ -556,6 +556,7 @@ class Lwip::Protocol_dir_impl final : public Protocol_dir
 
 		Genode::Allocator  &_alloc;
 		Genode::Entrypoint &_ep;
+		Lwip::Nic_netif    &_netif;
 
 		Genode::List<SOCKET_DIR> _socket_dirs { };
 
@@ -567,8 +568,10 @@ class Lwip::Protocol_dir_impl final : public Protocol_dir
 		friend class Tcp_socket_dir;
 		friend class Udp_socket_dir;
 
-		Protocol_dir_impl(Vfs::Env &vfs_env)
-		: _alloc(vfs_env.alloc()), _ep(vfs_env.env().ep()) { }
+		Protocol_dir_impl(Vfs::Env &vfs_env, Lwip::Nic_netif &netif)
+		: _alloc(vfs_env.alloc()), _ep(vfs_env.env().ep()), _netif(netif) { }
+
+		Lwip::Nic_netif &netif() { return _netif; }
 
 		SOCKET_DIR *lookup(char const *name)
 		{
@@ -999,19 +1002,36 @@ class Lwip::Udp_socket_dir final :
 			case Lwip_file_handle::DATA: {
 				if (ip_addr_isany(&_to_addr)) break;
 
+				enum { MAX_DATAGRAM = 0xffff - PBUF_TRANSPORT };
+
 				file_size remain = count;
 				while (remain) {
-					pbuf *buf = pbuf_alloc(PBUF_RAW, remain, PBUF_RAM);
-					pbuf_take(buf, src, buf->tot_len);
+					u16_t const n = (u16_t)min(remain, (file_size)MAX_DATAGRAM);
+
+					/*
+					 * Prefer a pbuf located in the transmit buffer of the
+					 * Nic session, which is submitted without copying.
+					 */
+					pbuf *buf = _proto_dir.netif().alloc_tx_pbuf(PBUF_TRANSPORT, n);
+					if (!buf)
+						buf = pbuf_alloc(PBUF_TRANSPORT, n, PBUF_RAM);
+					if (!buf)
+						break;
+
+					pbuf_take(buf, src, n);
 
 					err_t err = udp_sendto(_pcb, buf, &_to_addr, _to_port);
 					pbuf_free(buf);
 					if (err != ERR_OK)
 						return Write_result::WRITE_ERR_IO;
-					remain -= buf->tot_len;
-					src += buf->tot_len;
+					remain -= n;
+					src    += n;
 				}
-				out_count = count;
+
+				if (remain == count)
+					return Write_result::WRITE_ERR_WOULD_BLOCK;
+
+				out_count = count - remain;
 				return Write_result::WRITE_OK;
 			}
 
@@ -1121,6 +1141,47 @@ class Lwip::Tcp_socket_dir final :
 		pbuf *_recv_pbuf = nullptr;
 		u16_t _recv_off  = 0;
 
+		/**
+		 * Copy received data to 'dst' and release the consumed pbufs
+		 *
+		 * The data is copied segment by segment directly from the payload
+		 * of the pbufs, which are released as soon as they are consumed.
+		 * In contrast to 'pbuf_copy_partial', the amount of data is not
+		 * limited to 64 KiB.
+		 *
+		 * \return number of copied bytes
+		 */
+		file_size _consume(char *dst, file_size const count)
+		{
+			file_size n = 0;
+
+			while (_recv_pbuf && n < count) {
+
+				pbuf * const head = _recv_pbuf;
+
+				u16_t const len = (u16_t)min(count - n, (file_size)(head->len - _recv_off));
+
+				Genode::memcpy(dst + n, (char const *)head->payload + _recv_off, len);
+				n         += len;
+				_recv_off += len;
+
+				if (_recv_off < head->len)
+					break;
+
+				/* keep the remainder of the chain referenced */
+				pbuf * const next = head->next;
+				if (next)
+					pbuf_ref(next);
+
+				pbuf_free(head);
+
+				_recv_pbuf = next;
+				_recv_off  = 0;
+			}
+
+			return n;
+		}
+
 		Open_result _accept_new_socket(Vfs::File_system &fs,
                                        Genode::Allocator &alloc,
                                        Vfs::Vfs_handle **out_handle) override
@@ -1325,28 +1386,15 @@ class Lwip::Tcp_socket_dir final :
 							: Read_result::READ_OK;
 					}
 
-					u16_t const ucount = count;
-					u16_t const n = pbuf_copy_partial(_recv_pbuf, dst, ucount, _recv_off);
-					_recv_off += n;
-					{
-						u16_t new_off;
-						pbuf *new_head = pbuf_skip(_recv_pbuf, _recv_off, &new_off);
-						if (new_head != NULL && new_head != _recv_pbuf) {
-							/* increment the references on the new head */
-							pbuf_ref(new_head);
-							/* free the buffers chained to the old head */
-							pbuf_free(_recv_pbuf);
-						}
-
-						if (!new_head)
-							pbuf_free(_recv_pbuf);
-						_recv_pbuf = new_head;
-						_recv_off = new_off;
-					}
+					file_size const n = _consume(dst, count);
 
-					/* ACK the remote */
+					/* ACK the remote, in portions representable by lwIP */
 					if (_pcb)
-						tcp_recved(_pcb, n);
+						for (file_size acked = 0; acked < n; ) {
+							u16_t const len = (u16_t)min(n - acked, (file_size)0xffff);
+							tcp_recved(_pcb, len);
+							acked += len;
+						}
 
 					if (state == CLOSING)
 						shutdown();
@@ -1358,7 +1406,7 @@ class Lwip::Tcp_socket_dir final :
 
 			case Lwip_file_handle::PEEK:
 				if (_recv_pbuf != nullptr) {
-					u16_t const ucount = count;
+					u16_t const ucount = (u16_t)min(count, (file_size)0xffff);
 					u16_t const n = pbuf_copy_partial(_recv_pbuf, dst, ucount, _recv_off);
 					out_count = n;
 				}
@@ -1729,7 +1777,7 @@ class Lwip::File_system final : public Vfs::File_system, public Lwip::Directory
 			Vfs_netif(Vfs::Env &vfs_env,
 			          Genode::Xml_node config)
 			: Lwip::Nic_netif(vfs_env.env(), vfs_env.alloc(), config),
-			  tcp_dir(vfs_env), udp_dir(vfs_env)
+			  tcp_dir(vfs_env, *this), udp_dir(vfs_env, *this)
 			{ }
 
 			~Vfs_netif()
@@ -1804,17 +1852,38 @@ class Lwip::File_system final : public Vfs::File_system, public Lwip::Directory
 		static bool match_nameserver(char const *name) {
 			return (!strcmp(name, "nameserver")); }
 
+		/**
+		 * Apply TCP tuning of the '<lwip>' node
+		 *
+		 * The receive window and the send buffer default to 32 segments.
+		 * Windows beyond 64 KiB are announced via window scaling.
+		 */
+		static void _configure_tcp(Genode::Xml_node const &config)
+		{
+			typedef Genode::Number_of_bytes Size;
+
+			Size const default_size { 32*TCP_MSS };
+
+			Lwip::configure_tcp(config.attribute_value("tcp_wnd",     default_size),
+			                    config.attribute_value("tcp_snd_buf", default_size));
+		}
+
 	public:
 
 		File_system(Vfs::Env &vfs_env, Genode::Xml_node config)
 		: _ep(vfs_env.env().ep()), _netif(vfs_env, config)
-		{ }
+		{
+			_configure_tcp(config);
+		}
 
 		/**
 		 * Reconfigure the LwIP Nic interface with the VFS config hook
 		 */
-		void apply_config(Genode::Xml_node const &node) override {
-			_netif.configure(node); }
+		void apply_config(Genode::Xml_node const &node) override
+		{
+			_configure_tcp(node);
+			_netif.configure(node);
+		}
 
 
 		/*********************
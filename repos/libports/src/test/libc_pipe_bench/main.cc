@@ -0,0 +1,111 @@
+/*
+ * \brief  Throughput benchmark of libc pipes
+ * \author Pirmin Duss
+ * \date   2020-11-05
+ *
+ * A writer thread transfers a fixed amount of data through a pipe to the
+ * main thread, once for each write size.
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+enum {
+	TOTAL_SIZE = 256*1024*1024,
+	MAX_CHUNK  = 1024*1024,
+};
+
+static char write_buf[MAX_CHUNK];
+static char read_buf[MAX_CHUNK];
+
+static int pipefd[2];
+
+
+struct Writer_args { size_t chunk; };
+
+
+static void *write_pipe(void *arg)
+{
+	size_t const chunk = ((Writer_args *)arg)->chunk;
+
+	for (size_t total = 0; total < TOTAL_SIZE; ) {
+
+		ssize_t const res = write(pipefd[1], write_buf, chunk);
+		if (res < 0) {
+			fprintf(stderr, "Error writing to pipe\n");
+			exit(1);
+		}
+		total += res;
+	}
+	return 0;
+}
+
+
+static unsigned long long now_us()
+{
+	struct timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec*1000000ULL + ts.tv_nsec/1000;
+}
+
+
+static void measure(size_t chunk)
+{
+	if (pipe(pipefd) != 0) {
+		fprintf(stderr, "Error creating pipe\n");
+		exit(1);
+	}
+
+	Writer_args args { chunk };
+
+	unsigned long long const start_us = now_us();
+
+	pthread_t tid;
+	pthread_create(&tid, 0, write_pipe, &args);
+
+	size_t total = 0;
+	for (;;) {
+		ssize_t const res = read(pipefd[0], read_buf, MAX_CHUNK);
+		if (res < 0) {
+			fprintf(stderr, "Error reading from pipe\n");
+			exit(1);
+		}
+		total += res;
+		if (total == TOTAL_SIZE)
+			break;
+	}
+
+	unsigned long long const us = now_us() - start_us + 1;
+
+	pthread_join(tid, NULL);
+
+	close(pipefd[0]);
+	close(pipefd[1]);
+
+	printf("write size %7zu: %llu MiB/s\n",
+	       chunk, TOTAL_SIZE*1000000ULL/us/(1024*1024));
+}
+
+
+int main(int, char **)
+{
+	printf("--- pipe benchmark ---\n");
+
+	for (size_t chunk = 4096; chunk <= MAX_CHUNK; chunk *= 16)
+		measure(chunk);
+
+	printf("--- pipe benchmark finished ---\n");
+	return 0;
+}
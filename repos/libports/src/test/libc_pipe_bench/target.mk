@@ -0,0 +1,3 @@
+TARGET = test-libc_pipe_bench
+LIBS   = posix
+SRC_CC = main.cc
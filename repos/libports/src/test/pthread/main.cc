@@ -1080,6 +1080,107 @@ static void test_cleanup()
 }
 
 
+/*
+ * Test thread-specific data
+ */
+
+static pthread_key_t key_a, key_b;
+
+static unsigned destructor_a_calls = 0;
+static unsigned destructor_b_calls = 0;
+
+static void destructor_b(void *value)
+{
+	if (value != (void*)2) {
+		printf("Error: destructor_b(): incorrect value\n");
+		exit(-1);
+	}
+	destructor_b_calls++;
+}
+
+static void destructor_a(void *value)
+{
+	if (value != (void*)1) {
+		printf("Error: destructor_a(): incorrect value\n");
+		exit(-1);
+	}
+	destructor_a_calls++;
+
+	/* values set by destructors are destructed in the next iteration */
+	pthread_setspecific(key_b, (void*)2);
+}
+
+static void *thread_specific_func(void *)
+{
+	if (pthread_getspecific(key_a) || pthread_getspecific(key_b)) {
+		printf("Error: thread-specific value of new thread not null\n");
+		exit(-1);
+	}
+
+	pthread_setspecific(key_a, (void*)1);
+
+	if (pthread_getspecific(key_a) != (void*)1) {
+		printf("Error: pthread_getspecific() returned wrong value\n");
+		exit(-1);
+	}
+
+	return nullptr;
+}
+
+static void test_specific()
+{
+	printf("main thread: test thread-specific data\n");
+
+	if (pthread_key_create(&key_a, destructor_a) != 0 ||
+	    pthread_key_create(&key_b, destructor_b) != 0) {
+		printf("Error: pthread_key_create() failed\n");
+		exit(-1);
+	}
+
+	pthread_setspecific(key_a, (void*)3);
+
+	pthread_t t;
+	if (pthread_create(&t, 0, thread_specific_func, nullptr) != 0) {
+		printf("Error: pthread_create() failed\n");
+		exit(-1);
+	}
+	pthread_join(t, nullptr);
+
+	if (destructor_a_calls != 1 || destructor_b_calls != 1) {
+		printf("Error: destructors called %u/%u times, expected 1/1\n",
+		       destructor_a_calls, destructor_b_calls);
+		exit(-1);
+	}
+
+	/* the value of the main thread is unaffected by the other thread */
+	if (pthread_getspecific(key_a) != (void*)3) {
+		printf("Error: value of main thread changed\n");
+		exit(-1);
+	}
+
+	/* a re-created key does not reveal values of the deleted key */
+	pthread_key_delete(key_a);
+	if (pthread_setspecific(key_a, (void*)4) != EINVAL) {
+		printf("Error: pthread_setspecific() succeeded for deleted key\n");
+		exit(-1);
+	}
+	pthread_key_t key_c;
+	if (pthread_key_create(&key_c, nullptr) != 0) {
+		printf("Error: pthread_key_create() failed\n");
+		exit(-1);
+	}
+	if (pthread_getspecific(key_c)) {
+		printf("Error: re-created key has a stale value\n");
+		exit(-1);
+	}
+
+	pthread_key_delete(key_b);
+	pthread_key_delete(key_c);
+
+	printf("main thread: thread-specific data testing done\n");
+}
+
+
 int main(int argc, char **argv)
 {
 	printf("--- pthread test ---\n");
@@ -1097,6 +1198,7 @@ int main(int argc, char **argv)
 	test_lock_and_sleep();
 	test_cond();
 	test_cleanup();
+	test_specific();
 
 	printf("--- returning from main ---\n");
 	return 0;
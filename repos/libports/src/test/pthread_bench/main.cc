@@ -0,0 +1,220 @@
+/*
+ * \brief  Micro benchmarks of the POSIX thread implementation
+ * \author Pirmin Duss
+ * \date   2020-10-28
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+/* libc includes */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+static uint64_t now_us()
+{
+	timespec ts { };
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000*1000 + ts.tv_nsec/1000;
+}
+
+
+/**
+ * Run 'fn' in 'num_threads' threads concurrently and report the duration
+ *
+ * \param ops  number of operations performed by each thread
+ */
+template <typename FN>
+static void measure(char const *name, unsigned num_threads, unsigned long ops,
+                    FN const &fn)
+{
+	enum { MAX_THREADS = 16 };
+
+	struct Arg
+	{
+		FN const        *fn;
+		pthread_mutex_t *start_gate;
+	};
+
+	auto entry = [] (void *ptr) -> void * {
+		Arg const &arg = *(Arg const *)ptr;
+
+		/* wait until the main thread opens the start gate */
+		pthread_mutex_lock(arg.start_gate);
+		pthread_mutex_unlock(arg.start_gate);
+
+		(*arg.fn)();
+		return nullptr;
+	};
+
+	num_threads = num_threads < (unsigned)MAX_THREADS ? num_threads : (unsigned)MAX_THREADS;
+
+	pthread_mutex_t start_gate;
+	pthread_mutex_init(&start_gate, nullptr);
+	pthread_mutex_lock(&start_gate);
+
+	Arg arg { &fn, &start_gate };
+
+	pthread_t threads[MAX_THREADS];
+	for (unsigned i = 0; i < num_threads; i++)
+		if (pthread_create(&threads[i], nullptr, entry, &arg) != 0) {
+			printf("Error: pthread_create() failed\n");
+			exit(-1);
+		}
+
+	/* start all threads at once */
+	uint64_t const start = now_us();
+	pthread_mutex_unlock(&start_gate);
+
+	for (unsigned i = 0; i < num_threads; i++)
+		pthread_join(threads[i], nullptr);
+
+	uint64_t const duration = now_us() - start;
+
+	pthread_mutex_destroy(&start_gate);
+
+	unsigned long long const total = (unsigned long long)ops*num_threads;
+
+	printf("%-24s threads=%-2u ops=%llu duration=%llu us (%llu ns/op per thread)\n",
+	       name, num_threads, total, (unsigned long long)duration,
+	       duration ? (unsigned long long)duration*1000*num_threads/total : 0ULL);
+}
+
+
+/*
+ * Thread-specific data
+ */
+
+static pthread_key_t bench_key;
+
+static void bench_specific(unsigned num_threads)
+{
+	enum { OPS = 4*1000*1000 };
+
+	measure("getspecific/setspecific", num_threads, OPS, [] () {
+		for (unsigned long i = 0; i < OPS; i++) {
+			uintptr_t const v = (uintptr_t)pthread_getspecific(bench_key);
+			pthread_setspecific(bench_key, (void *)(v + 1));
+		}
+
+		if ((uintptr_t)pthread_getspecific(bench_key) != OPS) {
+			printf("Error: unexpected thread-specific value\n");
+			exit(-1);
+		}
+	});
+}
+
+
+/*
+ * Mutexes
+ */
+
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static unsigned long bench_counter;
+
+static void bench_mutex_lock(unsigned num_threads)
+{
+	enum { OPS = 1000*1000 };
+
+	bench_counter = 0;
+
+	measure("mutex lock/unlock", num_threads, OPS, [] () {
+		for (unsigned long i = 0; i < OPS; i++) {
+			pthread_mutex_lock(&bench_mutex);
+			bench_counter++;
+			pthread_mutex_unlock(&bench_mutex);
+		}
+	});
+
+	if (bench_counter != (unsigned long)OPS*num_threads) {
+		printf("Error: mutex did not serialize the counter updates\n");
+		exit(-1);
+	}
+}
+
+
+/*
+ * Condition variables
+ *
+ * The threads pass a token around in a ring. Each thread waits until the
+ * token arrives at its position and hands it to the next thread. With
+ * 'pthread_cond_broadcast', all threads wake up for each pass but only
+ * one of them can proceed. With 'pthread_cond_signal', the ring must
+ * consist of two threads because the signalled thread is not selected.
+ */
+
+static pthread_cond_t bench_cond = PTHREAD_COND_INITIALIZER;
+
+static unsigned bench_token;
+static unsigned bench_ring_size;
+static unsigned bench_next_position;
+
+template <bool BROADCAST>
+static void bench_cond_ring(char const *name, unsigned num_threads)
+{
+	enum { OPS = 20*1000 };
+
+	bench_token         = 0;
+	bench_ring_size     = num_threads;
+	bench_next_position = 0;
+
+	measure(name, num_threads, OPS, [] () {
+
+		pthread_mutex_lock(&bench_mutex);
+		unsigned const position = bench_next_position++;
+		pthread_mutex_unlock(&bench_mutex);
+
+		for (unsigned long i = 0; i < OPS; i++) {
+
+			pthread_mutex_lock(&bench_mutex);
+
+			while (bench_token % bench_ring_size != position)
+				pthread_cond_wait(&bench_cond, &bench_mutex);
+
+			bench_token++;
+
+			if (BROADCAST)
+				pthread_cond_broadcast(&bench_cond);
+			else
+				pthread_cond_signal(&bench_cond);
+
+			pthread_mutex_unlock(&bench_mutex);
+		}
+	});
+}
+
+
+int main(int, char **)
+{
+	printf("--- pthread benchmark ---\n");
+
+	if (pthread_key_create(&bench_key, nullptr) != 0) {
+		printf("Error: pthread_key_create() failed\n");
+		return -1;
+	}
+
+	for (unsigned threads = 1; threads <= 8; threads *= 2)
+		bench_specific(threads);
+
+	pthread_key_delete(bench_key);
+
+	for (unsigned threads = 1; threads <= 8; threads *= 2)
+		bench_mutex_lock(threads);
+
+	bench_cond_ring<false>("cond signal ping-pong", 2);
+
+	for (unsigned threads = 2; threads <= 8; threads *= 2)
+		bench_cond_ring<true>("cond broadcast ring", threads);
+
+	printf("--- pthread benchmark finished ---\n");
+	return 0;
+}
@@ -18,6 +18,7 @@
 #include <block_session/block_session.h>
 #include <packet_stream_tx/rpc_object.h>
 #include <block/request.h>
+#include <util/reconstructible.h>
 
 namespace Block { struct Request_stream; }
 
@@ -116,6 +117,38 @@ class Block::Request_stream : Genode::Noncopyable
 
 		Payload const _payload;
 
+		/*
+		 * Window of blocks the stream is restricted to, see
+		 * 'Block::Session::restrict_queue'
+		 */
+		Genode::Constructible<Session::Queue_window> _window { };
+
+		bool _within_window(Operation const &operation) const
+		{
+			if (!_window.constructed())
+				return true;
+
+			/* a revoked stream must not issue any operation, e.g., a SYNC */
+			if (_window->count == 0)
+				return false;
+
+			switch (operation.type) {
+			case Operation::Type::WRITE:
+				if (!_window->writeable)
+					return false;
+				[[fallthrough]];
+			case Operation::Type::READ:
+			case Operation::Type::TRIM:
+				return operation.count <= _window->count
+				    && operation.block_number <= _window->count - operation.count;
+			default:
+				return true;
+			}
+		}
+
+		block_number_t _window_first() const {
+			return _window.constructed() ? _window->first : 0; }
+
 	public:
 
 		Request_stream(Genode::Region_map               &rm,
@@ -142,6 +175,35 @@ class Block::Request_stream : Genode::Noncopyable
 
 		Block::Session::Info info() const { return _info; }
 
+		/**
+		 * Restrict stream to a window of blocks
+		 *
+		 * Requests outside the window are rejected by 'with_requests'. The
+		 * block numbers of the requests passed to the functor are absolute,
+		 * the translation is reverted when acknowledging the request.
+		 *
+		 * An existing window can only be narrowed. In particular, an empty
+		 * read-only window revokes the access via the stream.
+		 *
+		 * \return false if the window exceeds the current one
+		 */
+		bool restrict(Session::Queue_window window)
+		{
+			block_number_t const first = _window.constructed() ? _window->first : 0;
+			block_count_t  const count = _window.constructed() ? _window->count
+			                                                   : _info.block_count;
+
+			if (window.first < first || window.count > count
+			 || window.first - first > count - window.count)
+				return false;
+
+			if (window.writeable && _window.constructed() && !_window->writeable)
+				return false;
+
+			_window.construct(window);
+			return true;
+		}
+
 		/**
 		 * Call functor 'fn' with 'Payload' interface as argument
 		 *
@@ -190,13 +252,16 @@ class Block::Request_stream : Genode::Noncopyable
 
 				Packet_descriptor const packet = tx_sink.peek_packet();
 
-				bool const packet_valid = tx_sink.packet_valid(packet)
-				                       && (packet.offset() >= 0);
-
 				Operation operation { .type         = packet.operation_type(),
 				                      .block_number = packet.block_number(),
 				                      .count        = packet.block_count() };
 
+				bool const packet_valid = tx_sink.packet_valid(packet)
+				                       && (packet.offset() >= 0)
+				                       && _within_window(operation);
+
+				operation.block_number += _window_first();
+
 				Request request { .operation = operation,
 				                  .success   = false,
 				                  .offset    = packet.offset(),
@@ -253,8 +318,14 @@ class Block::Request_stream : Genode::Noncopyable
 
 				Genode::size_t const _block_size;
 
-				Ack(Tx_sink &tx_sink, Genode::size_t block_size)
-				: _tx_sink(tx_sink), _block_size(block_size) { }
+				block_number_t const _window_first;
+
+				Ack(Tx_sink &tx_sink, Genode::size_t block_size,
+				    block_number_t window_first)
+				:
+					_tx_sink(tx_sink), _block_size(block_size),
+					_window_first(window_first)
+				{ }
 
 			public:
 
@@ -270,7 +341,10 @@ class Block::Request_stream : Genode::Noncopyable
 						payload { .offset = request.offset,
 						          .bytes  = request.operation.count * _block_size };
 
-					Packet_descriptor packet(request.operation, payload, request.tag);
+					Operation operation = request.operation;
+					operation.block_number -= _window_first;
+
+					Packet_descriptor packet(operation, payload, request.tag);
 
 					packet.succeeded(request.success);
 
@@ -294,7 +368,7 @@ class Block::Request_stream : Genode::Noncopyable
 
 			while (tx_sink.ack_slots_free()) {
 
-				Ack ack(tx_sink, _payload._info.block_size);
+				Ack ack(tx_sink, _payload._info.block_size, _window_first());
 
 				fn(ack);
 
@@ -161,6 +161,34 @@ struct Block::Session : public Genode::Session
 {
 	enum { TX_QUEUE_SIZE = 256 };
 
+	/**
+	 * Maximum number of request queues per session
+	 *
+	 * A client may ask for multiple independent request queues by
+	 * specifying the 'queues' session argument. Each queue is a packet
+	 * stream with its own bulk buffer of 'tx_buf_size' bytes and its own
+	 * signal handlers. So, the queues can be used from different threads
+	 * without synchronization. The server may provide fewer queues than
+	 * requested. Queue 0 is the packet stream returned by 'tx_cap'.
+	 */
+	enum { MAX_QUEUES = 8 };
+
+	struct Queue_index { unsigned value; };
+
+	/**
+	 * Range of blocks a queue is restricted to
+	 *
+	 * The block numbers of the requests of a restricted queue are
+	 * relative to 'first'. Requests beyond 'count' blocks, or write
+	 * requests to a window that is not 'writeable', are rejected.
+	 */
+	struct Queue_window
+	{
+		block_number_t first;
+		block_count_t  count;
+		bool           writeable;
+	};
+
 	typedef Genode::Packet_stream_policy<Block::Packet_descriptor,
 	                                     TX_QUEUE_SIZE, TX_QUEUE_SIZE,
 	                                     char> Tx_policy;
@@ -206,6 +234,56 @@ struct Block::Session : public Genode::Session
 	 */
 	virtual Genode::Capability<Tx> tx_cap() = 0;
 
+	/**
+	 * Return capability for packet-transmission channel of the given queue
+	 *
+	 * An invalid capability is returned if the server does not provide the
+	 * requested queue.
+	 *
+	 * In contrast to the other RPC functions, this method is not pure
+	 * virtual. Multiple queues are an optional extension of the session
+	 * interface, and the default implementation, which provides queue 0
+	 * only, keeps the many existing single-queue servers working
+	 * unmodified.
+	 */
+	virtual Genode::Capability<Tx> queue_tx_cap(Queue_index index)
+	{
+		return (index.value == 0) ? tx_cap() : Genode::Capability<Tx>();
+	}
+
+	/**
+	 * Restrict queue to a window of blocks
+	 *
+	 * This method allows a component that stacks on a block session, e.g.,
+	 * a partition multiplexer, to hand out the packet stream of a queue
+	 * directly to its own client. The server translates the block numbers
+	 * of the requests and enforces the boundaries of the window. This way,
+	 * the payload is transferred without any intermediate copy. A window
+	 * in effect can only be narrowed, never widened. Restricting a queue to
+	 * an empty read-only window revokes the access of whoever possesses the
+	 * queue's packet stream.
+	 *
+	 * \return false if the server does not support windows, if the queue
+	 *         is not available, or if the window exceeds the one in effect
+	 */
+	virtual bool restrict_queue(Queue_index, Queue_window) { return false; }
+
+	/**
+	 * Replace the packet stream of a queue by a fresh one
+	 *
+	 * The queue obtains a new bulk buffer and packet-stream capability,
+	 * which must be requested anew via 'queue_tx_cap'. The former
+	 * capability becomes invalid and the window of the queue is lifted.
+	 * This way, a queue that was handed out via 'restrict_queue' can be
+	 * reused for another client once the former one is gone. Queue 0
+	 * cannot be reset.
+	 *
+	 * eturn false if the server does not support resetting queues, if
+	 *         the queue is not available, or if requests of the queue are
+	 *         still in flight
+	 */
+	virtual bool reset_queue(Queue_index) { return false; }
+
 	/**
 	 * Return packet descriptor for syncing the entire block session
 	 */
@@ -223,7 +301,11 @@ struct Block::Session : public Genode::Session
 
 	GENODE_RPC(Rpc_info, Info, info);
 	GENODE_RPC(Rpc_tx_cap, Genode::Capability<Tx>, tx_cap);
-	GENODE_RPC_INTERFACE(Rpc_info, Rpc_tx_cap);
+	GENODE_RPC(Rpc_queue_tx_cap, Genode::Capability<Tx>, queue_tx_cap, Queue_index);
+	GENODE_RPC(Rpc_restrict_queue, bool, restrict_queue, Queue_index, Queue_window);
+	GENODE_RPC(Rpc_reset_queue, bool, reset_queue, Queue_index);
+	GENODE_RPC_INTERFACE(Rpc_info, Rpc_tx_cap, Rpc_queue_tx_cap, Rpc_restrict_queue,
+	                     Rpc_reset_queue);
 };
 
 #endif /* _INCLUDE__BLOCK_SESSION__BLOCK_SESSION_H_ */
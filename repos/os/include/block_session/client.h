@@ -59,6 +59,15 @@ class Block::Session_client : public Genode::Rpc_client<Session>
 
 		Genode::Capability<Tx> tx_cap() override { return call<Rpc_tx_cap>(); }
 
+		Genode::Capability<Tx> queue_tx_cap(Queue_index index) override {
+			return call<Rpc_queue_tx_cap>(index); }
+
+		bool restrict_queue(Queue_index index, Queue_window window) override {
+			return call<Rpc_restrict_queue>(index, window); }
+
+		bool reset_queue(Queue_index index) override {
+			return call<Rpc_reset_queue>(index); }
+
 		/**
 		 * Allocate packet respecting the server's alignment constraints
 		 */
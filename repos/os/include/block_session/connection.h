@@ -229,16 +229,24 @@ struct Block::Connection : Genode::Connection<Session>, Session_client
 		 * \param tx_buffer_alloc  allocator used for managing the
 		 *                         transmission buffer
 		 * \param tx_buf_size      size of transmission buffer in bytes
+		 * \param queues           number of request queues, each equipped
+		 *                         with a transmission buffer of
+		 *                         'tx_buf_size' bytes
+		 *
+		 * The additional queues are accessed via 'Block::Queue' objects.
 		 */
 		Connection(Genode::Env             &env,
 		           Genode::Range_allocator *tx_block_alloc,
 		           Genode::size_t           tx_buf_size = 128*1024,
-		           const char              *label = "")
+		           const char              *label = "",
+		           unsigned                 queues = 1)
 		:
 			Genode::Connection<Session>(env,
 				session(env.parent(),
-				        "ram_quota=%ld, cap_quota=%ld, tx_buf_size=%ld, label=\"%s\"",
-				        14*1024 + tx_buf_size, CAP_QUOTA, tx_buf_size, label)),
+				        "ram_quota=%ld, cap_quota=%ld, tx_buf_size=%ld, "
+				        "queues=%u, label=\"%s\"",
+				        14*1024 + tx_buf_size*queues, CAP_QUOTA*queues,
+				        tx_buf_size, queues, label)),
 			Session_client(cap(), *tx_block_alloc, env.rm()),
 			_max_block_count(_init_max_block_count(_tx.source()->bulk_buffer_size()))
 		{ }
@@ -0,0 +1,97 @@
+/*
+ * \brief  Client-side access to an additional queue of a block session
+ * \author Pirmin Duss
+ * \date   2020-10-20
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__BLOCK_SESSION__QUEUE_H_
+#define _INCLUDE__BLOCK_SESSION__QUEUE_H_
+
+#include <base/allocator_avl.h>
+#include <block_session/client.h>
+
+namespace Block { class Queue; }
+
+
+/**
+ * Request queue of a multi-queue block session
+ *
+ * Each queue has its own packet stream and bulk buffer. A queue object
+ * can thereby be used by a thread other than the one using the session's
+ * primary packet stream. The interface mirrors the packet-stream related
+ * part of 'Block::Session_client'.
+ */
+class Block::Queue : Genode::Noncopyable
+{
+	private:
+
+		Genode::Allocator_avl _tx_block_alloc;
+
+		static Genode::Capability<Session::Tx>
+		_tx_cap(Session_client &session, Session::Queue_index index)
+		{
+			Genode::Capability<Session::Tx> cap = session.queue_tx_cap(index);
+			if (!cap.valid())
+				throw Unavailable();
+
+			return cap;
+		}
+
+		Packet_stream_tx::Client<Session::Tx> _tx;
+
+		Session::Info const _info;
+
+	public:
+
+		/**
+		 * Exception type
+		 */
+		struct Unavailable : Genode::Exception { };
+
+		/**
+		 * Constructor
+		 *
+		 * \param md_alloc  meta-data allocator used for managing the
+		 *                  transmission buffer
+		 *
+		 * \throw Unavailable  the server does not provide the queue
+		 */
+		Queue(Session_client       &session,
+		      Session::Queue_index  index,
+		      Genode::Allocator    &md_alloc,
+		      Genode::Region_map   &rm)
+		:
+			_tx_block_alloc(&md_alloc),
+			_tx(_tx_cap(session, index), rm, _tx_block_alloc),
+			_info(session.info())
+		{ }
+
+		Session::Tx         *tx_channel() { return &_tx; }
+		Session::Tx::Source *tx()         { return _tx.source(); }
+
+		/**
+		 * Register handler for data-flow signals of the queue
+		 */
+		void sigh(Genode::Signal_context_capability sigh)
+		{
+			_tx.sigh_ack_avail(sigh);
+			_tx.sigh_ready_to_submit(sigh);
+		}
+
+		/**
+		 * Allocate packet respecting the server's alignment constraints
+		 */
+		Packet_descriptor alloc_packet(Genode::size_t size)
+		{
+			return tx()->alloc_packet(size, _info.align_log2);
+		}
+};
+
+#endif /* _INCLUDE__BLOCK_SESSION__QUEUE_H_ */
@@ -18,6 +18,9 @@
 #include <util/reconstructible.h>
 #include <os/session_policy.h>
 #include <base/attached_ram_dataspace.h>
+#include <region_map/client.h>
+#include <rm_session/rm_session.h>
+#include <rom_session/rom_session.h>
 
 namespace Rom {
 	using Genode::size_t;
@@ -31,6 +34,8 @@ namespace Rom {
 	class Writer;
 	class Reader;
 	class Buffer;
+	class Snapshot;
+	struct Snapshot_env;
 
 	typedef Genode::List<Module> Module_list;
 	typedef Genode::List<Reader> Reader_list;
@@ -57,6 +62,100 @@ struct Rom::Reader : private Reader_list::Element, Interface
 };
 
 
+/**
+ * Environment for sharing the module content via snapshots
+ */
+struct Rom::Snapshot_env
+{
+	Genode::Allocator  &alloc;   /* allocator for the snapshot meta data */
+	Genode::Rm_session &rm;      /* used to create read-only views */
+
+	/* content size from which on snapshots are used instead of copies */
+	size_t const min_size;
+
+	Snapshot_env(Genode::Allocator &alloc, Genode::Rm_session &rm,
+	             size_t min_size)
+	: alloc(alloc), rm(rm), min_size(min_size) { }
+};
+
+
+/**
+ * Immutable version of the content of a ROM module
+ *
+ * A snapshot is shared by all readers that obtained the module content
+ * while the snapshot was current. The readers attach a managed dataspace
+ * that contains the backing store read-only. So no reader can modify the
+ * content seen by the others. The snapshot is reference counted and
+ * destroyed once it is neither current nor used by any reader.
+ */
+class Rom::Snapshot : Genode::Noncopyable
+{
+	private:
+
+		friend class Module;
+
+		Genode::Rm_session &_rm_session;
+
+		Attached_ram_dataspace _ds;
+
+		Genode::Capability<Genode::Region_map> const _view;
+
+		Genode::Dataspace_capability const _view_ds;
+
+		size_t _size = 0;
+
+		/* the module refers to its current snapshot */
+		unsigned _refs = 1;
+
+		Genode::Capability<Genode::Region_map> _create_view()
+		{
+			Genode::Capability<Genode::Region_map> view = _rm_session.create(_ds.size());
+
+			Genode::Region_map_client(view).attach(_ds.cap(), 0, 0, false,
+			                                       (Genode::addr_t)0, false, false);
+			return view;
+		}
+
+		size_t _capacity() const { return _ds.size(); }
+
+		/**
+		 * Write content, only permitted while no reader uses the snapshot
+		 */
+		void _write(char const *src, size_t len)
+		{
+			char * const dst = _ds.local_addr<char>();
+
+			Genode::memcpy(dst, src, len);
+
+			/* zero-terminate and clear the remainder of the previous content */
+			Genode::memset(dst + len, 0, (_size > len ? _size - len : 0) + 1);
+
+			_size = len;
+		}
+
+	public:
+
+		Snapshot(Genode::Ram_allocator &ram, Genode::Region_map &rm,
+		         Genode::Rm_session &rm_session, size_t capacity)
+		:
+			_rm_session(rm_session), _ds(ram, rm, capacity),
+			_view(_create_view()),
+			_view_ds(Genode::Region_map_client(_view).dataspace())
+		{ }
+
+		~Snapshot() { _rm_session.destroy(_view); }
+
+		char const *content() const { return _ds.local_addr<char const>(); }
+
+		size_t size() const { return _size; }
+
+		Genode::Rom_dataspace_capability cap() const
+		{
+			return Genode::static_cap_cast<Genode::Rom_dataspace>(_view_ds);
+		}
+};
+
+
 struct Rom::Readable_module : Interface
 {
 	/**
@@ -75,6 +174,19 @@ struct Rom::Readable_module : Interface
 	                            size_t dst_len) const = 0;
 
 	virtual size_t size() const = 0;
+
+	/**
+	 * Obtain reference to the snapshot of the current content
+	 *
+	 * \return nullptr if the content is not available as snapshot,
+	 *         in this case, the content must be read via 'read_content'
+	 */
+	virtual Snapshot *acquire_snapshot(Reader const &reader) const = 0;
+
+	/**
+	 * Drop reference obtained via 'acquire_snapshot'
+	 */
+	virtual void release_snapshot(Snapshot &snapshot) const = 0;
 };
 
 
@@ -164,6 +276,65 @@ struct Rom::Module : private Module_list::Element, Readable_module
 		 */
 		size_t _size = 0;
 
+		Snapshot_env * const _snapshot_env;
+
+		/**
+		 * Snapshot holding the current content instead of '_ds'
+		 */
+		Snapshot *_snapshot = nullptr;
+
+		void _drop_snapshot()
+		{
+			if (_snapshot)
+				release_snapshot(*_snapshot);
+
+			_snapshot = nullptr;
+		}
+
+		char const *_content() const
+		{
+			return _snapshot ? _snapshot->content() : _ds->local_addr<char const>();
+		}
+
+		void _write_buffer(char const * const src, size_t const src_len)
+		{
+			_drop_snapshot();
+
+			/*
+			 * Realloc backing store if needed
+			 *
+			 * Take a terminating zero into account, which we append to each
+			 * report. This way, we do not need to trust report clients to
+			 * append a zero termination to textual reports.
+			 */
+			if (!_ds.constructed() || _ds->size() < (src_len + 1))
+				_ds.construct(_ram, _rm, (src_len + 1));
+
+			/* copy content into backing store */
+			_size = src_len;
+			Genode::memcpy(_ds->local_addr<char>(), src, _size);
+
+			/* append zero termination */
+			_ds->local_addr<char>()[src_len] = 0;
+		}
+
+		void _write_snapshot(char const * const src, size_t const src_len)
+		{
+			_ds.destruct();
+
+			/* a snapshot not used by any reader can be overwritten in place */
+			bool const reusable = _snapshot && _snapshot->_refs == 1
+			                   && _snapshot->_capacity() >= src_len + 1;
+			if (!reusable) {
+				_drop_snapshot();
+				_snapshot = new (_snapshot_env->alloc)
+					Snapshot(_ram, _rm, _snapshot_env->rm, src_len + 1);
+			}
+
+			_snapshot->_write(src, src_len);
+			_size = src_len;
+		}
+
 
 		/********************************
 		 ** Interface used by registry **
@@ -182,15 +353,20 @@ struct Rom::Module : private Module_list::Element, Readable_module
 		 *                      time when the module content is obtained
 		 * \param write_policy  policy hook function that is evaluated each
 		 *                      time when the module content is changed
+		 * \param snapshot_env  environment for sharing the content with
+		 *                      readers via snapshots, or nullptr to
+		 *                      provide a copy to each reader
 		 */
 		Module(Genode::Ram_allocator &ram,
 		       Genode::Region_map    &rm,
 		       Name            const &name,
 		       Read_policy     const &read_policy,
-		       Write_policy    const &write_policy)
+		       Write_policy    const &write_policy,
+		       Snapshot_env          *snapshot_env = nullptr)
 		:
 			_name(name), _ram(ram), _rm(rm),
-			_read_policy(read_policy), _write_policy(write_policy)
+			_read_policy(read_policy), _write_policy(write_policy),
+			_snapshot_env(snapshot_env)
 		{ }
 
 
@@ -222,7 +398,10 @@ struct Rom::Module : private Module_list::Element, Readable_module
 
 			/* clear content if its origin disappears */
 			if (_last_writer == &writer) {
-				Genode::memset(_ds->local_addr<char>(), 0, _size);
+				if (_snapshot)
+					_drop_snapshot();
+				else
+					Genode::memset(_ds->local_addr<char>(), 0, _size);
 				_size = 0;
 				_last_writer = nullptr;
 			}
@@ -246,6 +425,8 @@ struct Rom::Module : private Module_list::Element, Readable_module
 
 	public:
 
+		~Module() { _drop_snapshot(); }
+
 		/**
 		 * Assign new content to the ROM module
 		 *
@@ -261,21 +442,13 @@ struct Rom::Module : private Module_list::Element, Readable_module
 			_last_writer = &writer;
 
 			/*
-			 * Realloc backing store if needed
-			 *
-			 * Take a terminating zero into account, which we append to each
-			 * report. This way, we do not need to trust report clients to
-			 * append a zero termination to textual reports.
+			 * Copying small reports to each reader is cheaper than the
+			 * creation of a snapshot.
 			 */
-			if (!_ds.constructed() || _ds->size() < (src_len + 1))
-				_ds.construct(_ram, _rm, (src_len + 1));
-
-			/* copy content into backing store */
-			_size = src_len;
-			Genode::memcpy(_ds->local_addr<char>(), src, _size);
-
-			/* append zero termination */
-			_ds->local_addr<char>()[src_len] = 0;
+			if (_snapshot_env && src_len + 1 >= _snapshot_env->min_size)
+				_write_snapshot(src, src_len);
+			else
+				_write_buffer(src, src_len);
 
 			/* notify ROM clients that access the module */
 			for (Reader *r = _readers.first(); r; r = r->next()) {
@@ -292,7 +465,7 @@ struct Rom::Module : private Module_list::Element, Readable_module
 		 */
 		size_t read_content(Reader const &reader, char *dst, size_t dst_len) const override
 		{
-			if (!_ds.constructed() || !_last_writer)
+			if ((!_ds.constructed() && !_snapshot) || !_last_writer)
 				return 0;
 
 			if (!_read_policy.read_permitted(*this, *_last_writer, reader))
@@ -301,12 +474,36 @@ struct Rom::Module : private Module_list::Element, Readable_module
 			if (dst_len < _size)
 				throw Buffer_too_small();
 
-			Genode::memcpy(dst, _ds->local_addr<char>(), _size);
+			Genode::memcpy(dst, _content(), _size);
 			return _size;
 		}
 
 		virtual size_t size() const override { return _size; }
 
+		/**
+		 * Readable_module interface
+		 */
+		Snapshot *acquire_snapshot(Reader const &reader) const override
+		{
+			if (!_snapshot || !_last_writer)
+				return nullptr;
+
+			if (!_read_policy.read_permitted(*this, *_last_writer, reader))
+				return nullptr;
+
+			_snapshot->_refs++;
+			return _snapshot;
+		}
+
+		/**
+		 * Readable_module interface
+		 */
+		void release_snapshot(Snapshot &snapshot) const override
+		{
+			if (--snapshot._refs == 0)
+				Genode::destroy(_snapshot_env->alloc, &snapshot);
+		}
+
 		Name name() const { return _name; }
 };
 
@@ -35,6 +35,12 @@ class Rom::Session_component : public Genode::Rpc_object<Genode::Rom_session>,
 {
 	private:
 
+		/*
+		 * Noncopyable
+		 */
+		Session_component(Session_component const &);
+		Session_component &operator = (Session_component const &);
+
 		Genode::Ram_allocator &_ram;
 		Genode::Region_map    &_rm;
 
@@ -63,6 +69,19 @@ class Rom::Session_component : public Genode::Rpc_object<Genode::Rom_session>,
 
 		Genode::Signal_context_capability _sigh { };
 
+		/**
+		 * Snapshot shared with other readers, used instead of '_ds'
+		 */
+		Snapshot *_snapshot = nullptr;
+
+		void _release_snapshot()
+		{
+			if (_snapshot)
+				_module.release_snapshot(*_snapshot);
+
+			_snapshot = nullptr;
+		}
+
 		void _notify_client()
 		{
 			if (_sigh.valid())
@@ -81,6 +100,7 @@ class Rom::Session_component : public Genode::Rpc_object<Genode::Rom_session>,
 
 		~Session_component()
 		{
+			_release_snapshot();
 			_registry.release(*this, _module);
 		}
 
@@ -90,9 +110,26 @@ class Rom::Session_component : public Genode::Rpc_object<Genode::Rom_session>,
 		{
 			using namespace Genode;
 
+				/*
+				 * When falling back from a snapshot to a copy, keep the
+				 * dataspace valid for the client even if the module is empty.
+				 */
+				size_t const min_size = _snapshot ? _snapshot->size() + 1 : 0;
+
+				_release_snapshot();
+
+				/* hand out the current snapshot without copying the content */
+				_snapshot = _module.acquire_snapshot(*this);
+				if (_snapshot) {
+					_ds.destruct();
+					_content_size = _snapshot->size();
+					_valid = _content_size > 0;
+					return _snapshot->cap();
+				}
+
 				/* replace dataspace by new one */
 				/* XXX we could keep the old dataspace if the size fits */
-				_ds.construct(_ram, _rm, _module.size());
+				_ds.construct(_ram, _rm, max(_module.size(), min_size));
 
 				/* fill dataspace content with report contained in module */
 				_content_size =
@@ -107,6 +144,24 @@ class Rom::Session_component : public Genode::Rpc_object<Genode::Rom_session>,
 
 		bool update() override
 		{
+			/*
+			 * The content of a snapshot never changes. The client has to
+			 * obtain a new dataspace unless the snapshot is still current.
+			 */
+			if (_snapshot) {
+				Snapshot * const current = _module.acquire_snapshot(*this);
+				if (current)
+					_module.release_snapshot(*current);
+
+				return current == _snapshot;
+			}
+
+			/* switch over to the snapshot shared with the other readers */
+			if (Snapshot * const snapshot = _module.acquire_snapshot(*this)) {
+				_module.release_snapshot(*snapshot);
+				return false;
+			}
+
 			if (!_ds.constructed() || _module.size() > _ds->size())
 				return false;
 
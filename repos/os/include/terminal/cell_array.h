@@ -39,8 +39,19 @@ class Cell_array
 		unsigned           _num_cols;
 		unsigned           _num_lines;
 		Genode::Allocator &_alloc;
-		CELL             **_array      = nullptr;
-		bool              *_line_dirty = nullptr;
+		CELL             **_array       = nullptr;
+
+		/*
+		 * For each line, the line position at which the current content
+		 * of the line was displayed when the line was marked as clean, or
+		 * DIRTY if the content changed since then. A line is clean if its
+		 * origin equals its position. After scrolling, the origin allows
+		 * the user of the cell array to move the displayed representation
+		 * of a line instead of drawing it anew.
+		 */
+		int               *_line_origin = nullptr;
+
+		enum { DIRTY = -1 };
 
 		typedef CELL *Char_cell_line;
 
@@ -53,27 +64,31 @@ class Cell_array
 		void _mark_lines_as_dirty(int start, int end)
 		{
 			for (int line = start; line <= end; line++)
-				_line_dirty[line] = true;
+				_line_origin[line] = DIRTY;
 		}
 
 		void _scroll_vertically(int start, int end, bool up)
 		{
-			/* rotate lines of the scroll region */
+			/* rotate lines of the scroll region along with their origins */
 			Char_cell_line yanked_line = _array[up ? start : end];
 
 			if (up) {
-				for (int line = start; line <= end - 1; line++)
-					_array[line] = _array[line + 1];
+				for (int line = start; line <= end - 1; line++) {
+					_array[line]       = _array[line + 1];
+					_line_origin[line] = _line_origin[line + 1];
+				}
 			} else {
-				for (int line = end; line >= start + 1; line--)
-					_array[line] = _array[line - 1];
+				for (int line = end; line >= start + 1; line--) {
+					_array[line]       = _array[line - 1];
+					_line_origin[line] = _line_origin[line - 1];
+				}
 			}
 
 			_clear_line(yanked_line);
 
 			_array[up ? end: start] = yanked_line;
 
-			_mark_lines_as_dirty(start, end);
+			_line_origin[up ? end : start] = DIRTY;
 		}
 
 	public:
@@ -87,7 +102,7 @@ class Cell_array
 		{
 			_array = new (alloc) Char_cell_line[num_lines];
 
-			_line_dirty = new (alloc) bool[num_lines];
+			_line_origin = new (alloc) int[num_lines];
 			mark_all_lines_as_dirty();
 
 			for (unsigned i = 0; i < num_lines; i++)
@@ -97,7 +112,7 @@ class Cell_array
 		static Genode::size_t bytes_needed(unsigned num_cols, unsigned num_lines)
 		{
 			return sizeof(Char_cell_line[num_lines])
-			     + sizeof(bool[num_lines])
+			     + sizeof(int[num_lines])
 			     + sizeof(CELL[num_cols])*num_lines;
 		}
 
@@ -106,20 +121,20 @@ class Cell_array
 			for (unsigned i = 0; i < _num_lines; i++)
 				Genode::destroy(_alloc, _array[i]);
 
-			Genode::destroy(_alloc, _line_dirty);
+			Genode::destroy(_alloc, _line_origin);
 			Genode::destroy(_alloc, _array);
 		}
 
 		void mark_all_lines_as_dirty()
 		{
 			for (unsigned i = 0; i < _num_lines; i++)
-				_line_dirty[i] = true;
+				_line_origin[i] = DIRTY;
 		}
 
 		void set_cell(int column, int line, CELL cell)
 		{
 			_array[line][column] = cell;
-			_line_dirty[line] = true;
+			_line_origin[line] = DIRTY;
 		}
 
 		CELL get_cell(int column, int line) const
@@ -139,16 +154,29 @@ class Cell_array
 			mark_all_lines_as_dirty();
 		}
 
-		bool line_dirty(int line) { return _line_dirty[line]; }
+		bool line_dirty(int line) const { return _line_origin[line] != line; }
+
+		/**
+		 * Return true if the line was not modified since it was displayed
+		 */
+		bool line_unmodified(int line) const { return _line_origin[line] != DIRTY; }
+
+		/**
+		 * Return line position where the line was displayed when it was
+		 * marked as clean
+		 *
+		 * The return value is only meaningful if 'line_unmodified' is true.
+		 */
+		int line_origin(int line) const { return _line_origin[line]; }
 
 		void mark_line_as_clean(int line)
 		{
-			_line_dirty[line] = false;
+			_line_origin[line] = line;
 		}
 
 		void mark_line_as_dirty(int line)
 		{
-			_line_dirty[line] = true;
+			_line_origin[line] = DIRTY;
 		}
 
 		void scroll_up(int region_start, int region_end)
@@ -183,7 +211,7 @@ class Cell_array
 				cell.clear_cursor();
 
 			if (mark_dirty)
-				_line_dirty[pos.y] = true;
+				_line_origin[pos.y] = DIRTY;
 		}
 
 		unsigned num_cols()  const { return _num_cols; }
@@ -22,6 +22,7 @@
 #include <base/attached_dataspace.h>
 
 #include <terminal_session/terminal_session.h>
+#include <terminal_session/stream.h>
 
 namespace Terminal { class Session_client; }
 
@@ -38,6 +39,77 @@ class Terminal::Session_client : public Genode::Rpc_client<Session>
 		 */
 		Genode::Attached_dataspace _io_buffer;
 
+		/**
+		 * State of the streaming mode
+		 */
+		class Stream_mode : Genode::Noncopyable
+		{
+			private:
+
+				Genode::Signal_context_capability _server_sigh { };
+
+				Genode::Constructible<Genode::Attached_dataspace> _ds       { };
+				Genode::Constructible<Stream::Endpoint>           _endpoint { };
+
+			public:
+
+				/**
+				 * Attach stream dataspace obtained from the server
+				 *
+				 * \return false if the dataspace is unusable
+				 */
+				bool attach(Genode::Region_map &local_rm,
+				            Genode::Dataspace_capability ds,
+				            Genode::Signal_context_capability server_sigh)
+				{
+					if (!ds.valid() || !server_sigh.valid())
+						return false;
+
+					try { _ds.construct(local_rm, ds); }
+					catch (Genode::Region_map::Invalid_dataspace) { return false; }
+
+					Genode::size_t const capacity = Stream::ring_capacity(_ds->size());
+					if (!capacity)
+						return false;
+
+					_endpoint.construct(_ds->local_addr<void>(), capacity,
+					                    Stream::Endpoint::CLIENT);
+					_server_sigh = server_sigh;
+					return true;
+				}
+
+				bool avail() const { return _endpoint->consumer.avail() > 0; }
+
+				Genode::size_t read(void *buf, Genode::size_t buf_size)
+				{
+					bool was_full = false;
+					Genode::size_t const n = _endpoint->consumer.read(buf, buf_size, was_full);
+
+					/* the server may wait for space to deliver more data */
+					if (n && was_full)
+						Genode::Signal_transmitter(_server_sigh).submit();
+
+					return n;
+				}
+
+				/**
+				 * Write data as far as the ring has space
+				 *
+				 * \return number of bytes written, 0 if the ring is full
+				 */
+				Genode::size_t write(void const *buf, Genode::size_t num_bytes)
+				{
+					Genode::size_t const n = _endpoint->producer.write(buf, num_bytes);
+
+					if (n)
+						Genode::Signal_transmitter(_server_sigh).submit();
+
+					return n;
+				}
+		};
+
+		Genode::Constructible<Stream_mode> _stream { };
+
 	public:
 
 		Session_client(Genode::Region_map &local_rm, Genode::Capability<Session> cap)
@@ -48,12 +120,21 @@ class Terminal::Session_client : public Genode::Rpc_client<Session>
 
 		Size size() override { return call<Rpc_size>(); }
 
-		bool avail() override { return call<Rpc_avail>(); }
+		bool avail() override
+		{
+			if (_stream.constructed())
+				return _stream->avail();
+
+			return call<Rpc_avail>();
+		}
 
 		Genode::size_t read(void *buf, Genode::size_t buf_size) override
 		{
 			Genode::Mutex::Guard _guard(_mutex);
 
+			if (_stream.constructed())
+				return _stream->read(buf, buf_size);
+
 			/* instruct server to fill the I/O buffer */
 			Genode::size_t num_bytes = call<Rpc_read>(buf_size);
 
@@ -68,6 +149,9 @@ class Terminal::Session_client : public Genode::Rpc_client<Session>
 		{
 			Genode::Mutex::Guard _guard(_mutex);
 
+			if (_stream.constructed())
+				return _stream->write(buf, num_bytes);
+
 			Genode::size_t     written_bytes = 0;
 			char const * const src           = (char const *)buf;
 
@@ -106,7 +190,46 @@ class Terminal::Session_client : public Genode::Rpc_client<Session>
 			call<Rpc_size_changed_sigh>(cap);
 		}
 
+		Genode::Dataspace_capability stream(Genode::Signal_context_capability sigh) override
+		{
+			return call<Rpc_stream>(sigh);
+		}
+
+		Genode::Signal_context_capability stream_sigh() override
+		{
+			return call<Rpc_stream_sigh>();
+		}
+
 		Genode::size_t io_buffer_size() const { return _io_buffer.size(); }
+
+		/**
+		 * Switch to streaming mode if supported by the server
+		 *
+		 * In streaming mode, 'write' does not block but returns 0 while
+		 * the ring towards the server is full.
+		 *
+		 * \param space_sigh  signal handler to be notified whenever the
+		 *                    server consumed data from the full ring
+		 *
+		 * \return true if the streaming mode is used
+		 */
+		bool enable_stream(Genode::Region_map &local_rm,
+		                   Genode::Signal_context_capability space_sigh)
+		{
+			Genode::Mutex::Guard _guard(_mutex);
+
+			if (_stream.constructed())
+				return true;
+
+			_stream.construct();
+
+			Genode::Dataspace_capability const ds = stream(space_sigh);
+
+			if (!_stream->attach(local_rm, ds, stream_sigh()))
+				_stream.destruct();
+
+			return _stream.constructed();
+		}
 };
 
 #endif /* _INCLUDE__TERMINAL_SESSION__CLIENT_H_ */
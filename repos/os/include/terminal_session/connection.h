@@ -22,6 +22,18 @@ namespace Terminal { struct Connection; }
 
 struct Terminal::Connection : Genode::Connection<Session>, Session_client
 {
+	/**
+	 * Return RAM quota needed for the rings of the streaming mode
+	 *
+	 * \noapi
+	 */
+	static Genode::size_t stream_quota(Genode::size_t stream_size)
+	{
+		Genode::size_t const capacity = Stream::capacity(stream_size);
+
+		return capacity ? Genode::align_addr(Stream::ds_size(capacity), 12) : 0;
+	}
+
 	/**
 	 * Wait for connection-established signal
 	 *
@@ -46,15 +58,34 @@ struct Terminal::Connection : Genode::Connection<Session>, Session_client
 
 	/**
 	 * Constructor
+	 *
+	 * \param stream_size  capacity of each ring buffer used in streaming
+	 *                     mode, 0 disables the streaming mode
+	 * \param space_sigh   signal handler notified whenever the server
+	 *                     consumed data from the full ring in streaming mode
+	 *
+	 * The streaming mode is used only if supported by the server. The
+	 * quota for the ring buffers is donated to the server. In streaming
+	 * mode, 'write' returns 0 instead of blocking while the ring is full.
 	 */
-	Connection(Genode::Env &env, char const *label = "")
+	Connection(Genode::Env &env, char const *label = "",
+	           Genode::size_t stream_size = 0,
+	           Genode::Signal_context_capability space_sigh =
+	           Genode::Signal_context_capability())
 	:
 		Genode::Connection<Session>(env, session(env.parent(),
-		                                         "ram_quota=%ld, cap_quota=%ld, label=\"%s\"",
-		                                         10*1024, CAP_QUOTA, label)),
+		                                         "ram_quota=%ld, cap_quota=%ld, "
+		                                         "stream_size=%ld, label=\"%s\"",
+		                                         10*1024 + stream_quota(stream_size),
+		                                         CAP_QUOTA + (stream_size ? 2 : 0),
+		                                         Stream::capacity(stream_size),
+		                                         label)),
 		Session_client(env.rm(), cap())
 	{
 		wait_for_connection(cap());
+
+		if (stream_size)
+			enable_stream(env.rm(), space_sigh);
 	}
 };
 
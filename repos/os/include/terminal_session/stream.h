@@ -0,0 +1,275 @@
+/*
+ * \brief  Shared-memory ring buffers for the streaming mode of terminal sessions
+ * \author Pirmin Duss
+ * \date   2020-10-29
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _INCLUDE__TERMINAL_SESSION__STREAM_H_
+#define _INCLUDE__TERMINAL_SESSION__STREAM_H_
+
+/* Genode includes */
+#include <util/misc_math.h>
+#include <util/string.h>
+#include <cpu/memory_barrier.h>
+
+namespace Terminal { struct Stream; }
+
+
+/**
+ * Layout of the stream dataspace shared between client and server
+ *
+ * The dataspace starts with a header that contains the indices of two
+ * ring buffers, one for each direction, followed by the ring-buffer data.
+ * Each index is written by only one side. The indices are free-running
+ * byte counters. Each side keeps a private copy of the index it owns and
+ * merely validates the index of the peer. So a misbehaving peer can
+ * corrupt the transferred data but never cause an out-of-bounds access.
+ */
+struct Terminal::Stream
+{
+	typedef Genode::size_t size_t;
+
+	struct Indices
+	{
+		unsigned long volatile head;  /* written by producer */
+		unsigned long volatile tail;  /* written by consumer */
+	};
+
+	struct Header
+	{
+		Indices to_server;
+		Indices to_client;
+	};
+
+	enum { HEADER_SIZE = 64, MIN_CAPACITY = 4096, MAX_CAPACITY = 1024*1024 };
+
+	/**
+	 * Return size of stream dataspace for rings of 'capacity' bytes
+	 */
+	static size_t ds_size(size_t capacity) { return HEADER_SIZE + 2*capacity; }
+
+	/**
+	 * Return ring capacity for the requested value
+	 *
+	 * \return power of two within the supported range, or 0 if
+	 *         'requested' is 0
+	 */
+	static size_t capacity(size_t requested)
+	{
+		if (requested == 0)
+			return 0;
+
+		size_t capacity = MIN_CAPACITY;
+		while (capacity*2 <= Genode::min(requested, (size_t)MAX_CAPACITY))
+			capacity *= 2;
+
+		return capacity;
+	}
+
+	/**
+	 * Return capacity of the rings within a stream dataspace
+	 *
+	 * \return 0 if the dataspace is too small
+	 */
+	static size_t ring_capacity(size_t ds_size)
+	{
+		if (ds_size < Stream::ds_size(MIN_CAPACITY))
+			return 0;
+
+		size_t capacity = MIN_CAPACITY;
+		while (capacity < MAX_CAPACITY && Stream::ds_size(capacity*2) <= ds_size)
+			capacity *= 2;
+
+		return capacity;
+	}
+
+	class Ring
+	{
+		protected:
+
+			Indices       &_indices;
+			char  * const  _data;
+			size_t  const  _capacity;  /* power of two */
+
+			size_t _offset(unsigned long index) const {
+				return index & (_capacity - 1); }
+
+			/*
+			 * The number of used bytes is clamped to the capacity to
+			 * sanitize the index of the peer.
+			 */
+			static size_t _used(unsigned long head, unsigned long tail,
+			                    size_t capacity)
+			{
+				return Genode::min((size_t)(head - tail), capacity);
+			}
+
+		public:
+
+			Ring(Indices &indices, char *data, size_t capacity)
+			: _indices(indices), _data(data), _capacity(capacity) { }
+
+			size_t capacity() const { return _capacity; }
+	};
+
+	class Producer : public Ring
+	{
+		private:
+
+			unsigned long _head = 0;
+
+		public:
+
+			using Ring::Ring;
+
+			/**
+			 * Return number of bytes that can be written
+			 */
+			size_t space() const
+			{
+				return _capacity - _used(_head, _indices.tail, _capacity);
+			}
+
+			/**
+			 * Write as many bytes as fit into the ring
+			 *
+			 * \return number of written bytes
+			 */
+			size_t write(void const *src, size_t len)
+			{
+				size_t const n = Genode::min(len, space());
+
+				size_t const offset = _offset(_head),
+				             first  = Genode::min(n, _capacity - offset);
+
+				Genode::memcpy(_data + offset, src, first);
+				Genode::memcpy(_data, (char const *)src + first, n - first);
+
+				/* make data visible before publishing the new head */
+				Genode::memory_barrier();
+
+				_head += n;
+				_indices.head = _head;
+
+				return n;
+			}
+	};
+
+	class Consumer : public Ring
+	{
+		private:
+
+			unsigned long _tail = 0;
+
+		public:
+
+			using Ring::Ring;
+
+			/**
+			 * Return number of bytes available for reading
+			 */
+			size_t avail() const
+			{
+				return _used(_indices.head, _tail, _capacity);
+			}
+
+			/**
+			 * Consume up to 'max_len' bytes
+			 *
+			 * The functor is called with a pointer and the length of each
+			 * contiguous chunk of data and returns the number of bytes it
+			 * consumed.
+			 *
+			 * \param was_full  set to true if the ring was full, which
+			 *                  means that the producer may wait for space
+			 *
+			 * \return number of consumed bytes
+			 */
+			template <typename FN>
+			size_t consume(size_t max_len, bool &was_full, FN const &fn)
+			{
+				size_t const avail = this->avail();
+
+				was_full = (avail == _capacity);
+
+				/* read the head before the data */
+				Genode::memory_barrier();
+
+				size_t left = Genode::min(avail, max_len), consumed = 0;
+				while (left) {
+					size_t const offset = _offset(_tail + consumed),
+					             chunk  = Genode::min(left, _capacity - offset),
+					             n      = Genode::min(fn(_data + offset, chunk), chunk);
+					consumed += n;
+					left     -= n;
+					if (n < chunk)
+						break;
+				}
+
+				/* finish reading the data before releasing the space */
+				Genode::memory_barrier();
+
+				_tail += consumed;
+				_indices.tail = _tail;
+
+				return consumed;
+			}
+
+			size_t read(void *dst, size_t len, bool &was_full)
+			{
+				char *d = (char *)dst;
+				return consume(len, was_full, [&] (char const *src, size_t n) {
+					Genode::memcpy(d, src, n);
+					d += n;
+					return n; });
+			}
+	};
+
+	/**
+	 * Rings of a stream dataspace as seen from one side of the session
+	 */
+	class Endpoint
+	{
+		public:
+
+			enum Side { CLIENT, SERVER };
+
+		private:
+
+			static Header &_header(void *base) { return *(Header *)base; }
+
+			static char *_ring(void *base, size_t capacity, bool to_server)
+			{
+				return (char *)base + HEADER_SIZE + (to_server ? 0 : capacity);
+			}
+
+		public:
+
+			Producer producer;
+			Consumer consumer;
+
+			/**
+			 * Constructor
+			 *
+			 * \param base      local address of the stream dataspace
+			 * \param capacity  capacity of each ring in bytes, must be
+			 *                  a power of two
+			 */
+			Endpoint(void *base, size_t capacity, Side side)
+			:
+				producer(side == CLIENT ? _header(base).to_server : _header(base).to_client,
+				         _ring(base, capacity, side == CLIENT), capacity),
+				consumer(side == CLIENT ? _header(base).to_client : _header(base).to_server,
+				         _ring(base, capacity, side == SERVER), capacity)
+			{ }
+	};
+};
+
+#endif /* _INCLUDE__TERMINAL_SESSION__STREAM_H_ */
@@ -18,6 +18,7 @@
 #include <session/session.h>
 #include <base/rpc.h>
 #include <dataspace/capability.h>
+#include <base/signal.h>
 
 namespace Terminal { struct Session; }
 
@@ -98,6 +99,40 @@ struct Terminal::Session : Genode::Session
 	 */
 	virtual void size_changed_sigh(Genode::Signal_context_capability cap) = 0;
 
+	/**
+	 * Switch session to streaming mode
+	 *
+	 * In streaming mode, the payload is transferred via the ring buffers of
+	 * the returned dataspace (see 'terminal_session/stream.h') instead of
+	 * the 'read' and 'write' RPC functions. The server notifies the client
+	 * about new data via the read-avail signal. The size of the rings is
+	 * requested via the 'stream_size' session argument.
+	 *
+	 * Servers without support for the streaming mode need not implement
+	 * this method.
+	 *
+	 * \param sigh  signal handler to be notified whenever the server
+	 *              consumed data from a full ring
+	 *
+	 * \return stream dataspace, or an invalid capability if streaming is
+	 *         not supported
+	 */
+	virtual Genode::Dataspace_capability stream(Genode::Signal_context_capability)
+	{
+		return Genode::Dataspace_capability();
+	}
+
+	/**
+	 * Return signal context for notifying the server in streaming mode
+	 *
+	 * The client submits a signal whenever it wrote data to the server or
+	 * consumed data from a full ring.
+	 */
+	virtual Genode::Signal_context_capability stream_sigh()
+	{
+		return Genode::Signal_context_capability();
+	}
+
 
 	/*******************
 	 ** RPC interface **
@@ -111,10 +146,13 @@ struct Terminal::Session : Genode::Session
 	GENODE_RPC(Rpc_read_avail_sigh, void, read_avail_sigh, Genode::Signal_context_capability);
 	GENODE_RPC(Rpc_size_changed_sigh, void, size_changed_sigh, Genode::Signal_context_capability);
 	GENODE_RPC(Rpc_dataspace, Genode::Dataspace_capability, _dataspace);
+	GENODE_RPC(Rpc_stream, Genode::Dataspace_capability, stream, Genode::Signal_context_capability);
+	GENODE_RPC(Rpc_stream_sigh, Genode::Signal_context_capability, stream_sigh);
 
 	GENODE_RPC_INTERFACE(Rpc_size, Rpc_avail, Rpc_read, Rpc_write,
 	                     Rpc_connected_sigh, Rpc_read_avail_sigh,
-	                     Rpc_size_changed_sigh, Rpc_dataspace);
+	                     Rpc_size_changed_sigh, Rpc_dataspace,
+	                     Rpc_stream, Rpc_stream_sigh);
 };
 
 #endif /* _INCLUDE__TERMINAL_SESSION__TERMINAL_SESSION_H_ */
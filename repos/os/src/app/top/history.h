@@ -0,0 +1,128 @@
+/*
+ * \brief  History of the CPU load of a trace subject
+ * \author Pirmin Duss
+ * \date   2020-10-27
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _HISTORY_H_
+#define _HISTORY_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <util/string.h>
+
+namespace App { class Load_history; }
+
+
+/**
+ * Ring buffer of the load values of the most recent periods
+ *
+ * Alongside the ring buffer, a histogram of the buffered values is kept
+ * with a resolution of one percent. It is updated incrementally whenever a
+ * value enters or leaves the ring buffer. So percentiles are obtained by
+ * scanning the histogram without sorting the buffered values.
+ */
+class App::Load_history
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Load_history(Load_history const &);
+		Load_history &operator = (Load_history const &);
+
+		typedef Genode::uint16_t Value;
+
+		enum { BUCKETS = 101 };
+
+		Genode::Allocator &_alloc;
+
+		unsigned const _capacity;
+
+		Value * const _values;
+
+		unsigned _next  = 0;  /* ring-buffer position of the next value */
+		unsigned _count = 0;  /* number of valid values */
+
+		unsigned _buckets[BUCKETS] { };
+
+		static unsigned _bucket(Value permille) {
+			return Genode::min(permille / 10U, (unsigned)BUCKETS - 1); }
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param capacity  number of periods covered by the history
+		 *
+		 * \throw Out_of_ram
+		 * \throw Out_of_caps
+		 */
+		Load_history(Genode::Allocator &alloc, unsigned capacity)
+		:
+			_alloc(alloc), _capacity(Genode::max(capacity, 1U)),
+			_values((Value *)_alloc.alloc(_capacity*sizeof(Value)))
+		{ }
+
+		~Load_history() { _alloc.free(_values, _capacity*sizeof(Value)); }
+
+		/**
+		 * Record load of the most recent period in permille
+		 */
+		void add(unsigned permille)
+		{
+			Value const value = (Value)Genode::min(permille, 1000U);
+
+			if (_count == _capacity)
+				_buckets[_bucket(_values[_next])]--;
+			else
+				_count++;
+
+			_values[_next] = value;
+			_buckets[_bucket(value)]++;
+
+			_next = (_next + 1) % _capacity;
+		}
+
+		/**
+		 * Return load of the most recent period in permille
+		 */
+		unsigned last() const
+		{
+			return _count ? _values[(_next + _capacity - 1) % _capacity] : 0;
+		}
+
+		/**
+		 * Return the given percentile of the recorded loads in percent
+		 *
+		 * The result is the lower bound of the histogram bucket that
+		 * contains the percentile.
+		 */
+		unsigned percentile(unsigned p) const
+		{
+			if (!_count)
+				return 0;
+
+			/* rank of the percentile, rounded up */
+			unsigned const rank = Genode::max(1U, (Genode::min(p, 100U)*_count + 99)/100);
+
+			unsigned sum = 0;
+			for (unsigned i = 0; i < BUCKETS; i++) {
+				sum += _buckets[i];
+				if (sum >= rank)
+					return i;
+			}
+			return BUCKETS - 1;
+		}
+};
+
+#endif /* _HISTORY_H_ */
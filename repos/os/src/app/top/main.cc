@@ -1,5 +1,6 @@
 /*
  * \brief  Application to show highest CPU consumer per CPU via LOG session
+ *         and to publish CPU-load statistics
  * \author Norman Feske
  *         Alexander Boettcher
  * \date   2015-06-15
@@ -19,15 +20,42 @@
 #include <base/attached_rom_dataspace.h>
 #include <base/heap.h>
 #include <os/reporter.h>
+#include <os/vfs.h>
+#include <util/avl_string.h>
+
+/* local includes */
+#include "history.h"
 
 enum SORT_TIME { EC_TIME = 0, SC_TIME = 1};
 
 struct Trace_subject_registry
 {
-	private:
+	public:
 
-		struct Entry : Genode::List<Entry>::Element
+		/**
+		 * Aggregate of all threads of one component
+		 */
+		struct Component : Genode::Avl_string<Genode::Session_label::capacity()>
 		{
+			Genode::uint64_t recent_time[2] = { 0, 0 };
+
+			/* load summed up over all threads in permille of a CPU */
+			unsigned load = 0;
+
+			unsigned threads = 0;
+
+			Component(Genode::Session_label const &label)
+			: Genode::Avl_string<Genode::Session_label::capacity()>(label.string()) { }
+		};
+
+		struct Entry : Genode::List<Entry>::Element, Genode::Avl_node<Entry>
+		{
+			/*
+			 * Noncopyable
+			 */
+			Entry(Entry const &);
+			Entry &operator = (Entry const &);
+
 			Genode::Trace::Subject_id const id;
 
 			Genode::Trace::Subject_info info { };
@@ -37,7 +65,26 @@ struct Trace_subject_registry
 			 */
 			Genode::uint64_t recent_time[2] = { 0, 0 };
 
-			Entry(Genode::Trace::Subject_id id) : id(id) { }
+			Component *component = nullptr;
+
+			/**
+			 * Load of the thread on its CPU during the recent periods
+			 */
+			App::Load_history history;
+
+			Entry(Genode::Trace::Subject_id id, Genode::Allocator &alloc,
+			      unsigned history_len)
+			: id(id), history(alloc, history_len) { }
+
+			bool higher(Entry *e) { return e->id.id > id.id; }
+
+			Entry *find_by_id(Genode::Trace::Subject_id const id)
+			{
+				if (id == this->id) return this;
+
+				Entry * const e = Genode::Avl_node<Entry>::child(id.id > this->id.id);
+				return e ? e->find_by_id(id) : nullptr;
+			}
 
 			void update(Genode::Trace::Subject_info const &new_info)
 			{
@@ -57,73 +104,243 @@ struct Trace_subject_registry
 			}
 		};
 
-		Genode::List<Entry> _entries { };
+		enum { MAX_CPUS_X = 16, MAX_CPUS_Y = 4, MAX_ELEMENTS_PER_CPU = 6};
 
-		Entry *_lookup(Genode::Trace::Subject_id const id)
-		{
-			for (Entry *e = _entries.first(); e; e = e->next())
-				if (e->id == id)
-					return e;
+	private:
 
-			return nullptr;
-		}
+		/*
+		 * Noncopyable
+		 */
+		Trace_subject_registry(Trace_subject_registry const &);
+		Trace_subject_registry &operator = (Trace_subject_registry const &);
 
-		enum { MAX_CPUS_X = 16, MAX_CPUS_Y = 4, MAX_ELEMENTS_PER_CPU = 6};
+		Genode::Allocator &_alloc;
+
+		unsigned const _history_len;
+
+		Genode::List<Entry>       _entries    { };
+		Genode::Avl_tree<Entry>   _by_id      { };
+		Genode::Avl_tree<Genode::Avl_string_base> _components { };
+
+		unsigned _num_entries    = 0;
+		unsigned _num_components = 0;
 
 		/* accumulated execution time on all CPUs */
 		unsigned long long total_first [MAX_CPUS_X][MAX_CPUS_Y];
 		unsigned long long total_second [MAX_CPUS_X][MAX_CPUS_Y];
 
+		/* number of threads per CPU */
+		unsigned _threads[MAX_CPUS_X][MAX_CPUS_Y];
+
+		/* sorting the totals above refer to */
+		unsigned _first = EC_TIME;
+
 		/* most significant consumer per CPU */
 		Entry const * load[MAX_CPUS_X][MAX_CPUS_Y][MAX_ELEMENTS_PER_CPU];
 
+		static bool _cpu_valid(Entry const &e)
+		{
+			return e.info.affinity().xpos() < MAX_CPUS_X
+			    && e.info.affinity().ypos() < MAX_CPUS_Y;
+		}
+
+		Component &_component(Genode::Session_label const &label)
+		{
+			Genode::Avl_string_base *node = _components.first()
+			                              ? _components.first()->find_by_name(label.string())
+			                              : nullptr;
+			if (node)
+				return *static_cast<Component *>(node);
+
+			Component &c = *new (_alloc) Component(label);
+			_components.insert(&c);
+			_num_components++;
+			return c;
+		}
+
+		void _destroy(Genode::Trace::Connection &trace, Entry &e)
+		{
+			trace.free(e.id);
+			_entries.remove(&e);
+			_by_id.remove(&e);
+			_num_entries--;
+
+			if (e.component && --e.component->threads == 0) {
+				_components.remove(e.component);
+				_num_components--;
+				Genode::destroy(_alloc, e.component);
+			}
+
+			Genode::destroy(_alloc, &e);
+		}
+
 	public:
 
-		bool update(Genode::Trace::Connection &trace,
-		            Genode::Allocator &alloc)
+		/**
+		 * Constructor
+		 *
+		 * \param history_len  number of periods covered by the load history
+		 *                     of each thread
+		 */
+		Trace_subject_registry(Genode::Allocator &alloc, unsigned history_len)
+		: _alloc(alloc), _history_len(history_len) { }
+
+		unsigned history_len() const { return _history_len; }
+		unsigned subjects()    const { return _num_entries; }
+
+		bool update(Genode::Trace::Connection &trace)
 		{
 			auto res = trace.for_each_subject_info([&](Genode::Trace::Subject_id const &id,
 			                                           Genode::Trace::Subject_info const &info)
 			{
-				Entry *e = _lookup(id);
+				Entry *e = _by_id.first() ? _by_id.first()->find_by_id(id) : nullptr;
 				if (!e) {
-					e = new (alloc) Entry(id);
+					e = new (_alloc) Entry(id, _alloc, _history_len);
 					_entries.insert(e);
+					_by_id.insert(e);
+					_num_entries++;
+
+					e->component = &_component(info.session_label());
+					e->component->threads++;
 				}
 
 				e->update(info);
 
 				/* remove dead threads which did not run in the last period */
 				if (e->info.state() == Genode::Trace::Subject_info::DEAD &&
-				    !e->recent_time[EC_TIME] && !e->recent_time[SC_TIME]) {
-
-					trace.free(e->id);
-					_entries.remove(e);
-					Genode::destroy(alloc, e);
-				}
+				    !e->recent_time[EC_TIME] && !e->recent_time[SC_TIME])
+					_destroy(trace, *e);
 			});
 
 			return res.count < res.limit;
 		}
 
-		void flush(Genode::Trace::Connection &trace, Genode::Allocator &alloc)
+		void flush(Genode::Trace::Connection &trace)
+		{
+			while (Entry * const e = _entries.first())
+				_destroy(trace, *e);
+		}
+
+		/**
+		 * Compute the aggregates of the most recent period
+		 *
+		 * The load of a thread is the fraction of the execution time of all
+		 * threads on the same CPU. It is recorded in the thread's history and
+		 * accumulated per component.
+		 */
+		void account(enum SORT_TIME sorting)
+		{
+			_first = sorting == EC_TIME ? EC_TIME : SC_TIME;
+
+			unsigned const second = _first == EC_TIME ? SC_TIME : EC_TIME;
+
+			Genode::memset(total_first,  0, sizeof(total_first));
+			Genode::memset(total_second, 0, sizeof(total_second));
+			Genode::memset(_threads,     0, sizeof(_threads));
+
+			for (Entry *e = _entries.first(); e; e = e->next()) {
+
+				e->component->recent_time[EC_TIME] = 0;
+				e->component->recent_time[SC_TIME] = 0;
+				e->component->load = 0;
+
+				if (!_cpu_valid(*e))
+					continue;
+
+				unsigned const x = e->info.affinity().xpos();
+				unsigned const y = e->info.affinity().ypos();
+
+				total_first [x][y] += e->recent_time[_first];
+				total_second[x][y] += e->recent_time[second];
+				_threads    [x][y] ++;
+			}
+
+			for (Entry *e = _entries.first(); e; e = e->next()) {
+
+				Component &c = *e->component;
+				c.recent_time[EC_TIME] += e->recent_time[EC_TIME];
+				c.recent_time[SC_TIME] += e->recent_time[SC_TIME];
+
+				if (!_cpu_valid(*e))
+					continue;
+
+				unsigned long long const total =
+					total_first[e->info.affinity().xpos()][e->info.affinity().ypos()];
+
+				unsigned const permille = total
+				                        ? (unsigned)(e->recent_time[_first]*1000/total)
+				                        : 0;
+				e->history.add(permille);
+				c.load += permille;
+			}
+		}
+
+		/**
+		 * Call 'fn' for each CPU with its number of threads and total time
+		 */
+		template <typename FN>
+		void for_each_cpu(FN const &fn) const
 		{
-			while (Entry * const e = _entries.first()) {
-					trace.free(e->id);
-					_entries.remove(e);
-					Genode::destroy(alloc, e);
+			for (unsigned x = 0; x < MAX_CPUS_X; x++)
+				for (unsigned y = 0; y < MAX_CPUS_Y; y++)
+					if (_threads[x][y])
+						fn(x, y, _threads[x][y], total_first[x][y]);
+		}
+
+		template <typename FN>
+		void for_each_component(FN const &fn) const
+		{
+			_components.for_each([&] (Genode::Avl_string_base const &node) {
+				fn(static_cast<Component const &>(node)); });
+		}
+
+		template <typename FN>
+		void for_each_entry(FN const &fn) const
+		{
+			for (Entry const *e = _entries.first(); e; e = e->next())
+				fn(*e);
+		}
+
+		/**
+		 * Call 'fn' for the 'n' threads with the highest recent load
+		 *
+		 * The threads are selected in a single pass over all threads without
+		 * sorting them.
+		 */
+		template <typename FN>
+		void for_each_top_entry(unsigned n, FN const &fn) const
+		{
+			enum { MAX_TOP = 64 };
+			Entry const *top[MAX_TOP] { };
+
+			n = Genode::min(n, (unsigned)MAX_TOP);
+
+			unsigned count = 0;
+			for (Entry const *e = _entries.first(); e && n; e = e->next()) {
+
+				unsigned const load = e->history.last();
+
+				if (count == n && top[n - 1]->history.last() >= load)
+					continue;
+
+				/* insert into the sorted array, dropping the least loaded */
+				unsigned i = (count < n) ? count++ : n - 1;
+				for (; i > 0 && top[i - 1]->history.last() < load; i--)
+					top[i] = top[i - 1];
+				top[i] = e;
 			}
+
+			for (unsigned i = 0; i < count; i++)
+				fn(*top[i]);
 		}
 
-		void top(enum SORT_TIME sorting)
+		void top()
 		{
 			/* clear old calculations */
-			Genode::memset(total_first, 0, sizeof(total_first));
-			Genode::memset(total_second, 0, sizeof(total_second));
 			Genode::memset(load, 0, sizeof(load));
 
-			unsigned const first  = sorting == EC_TIME ? EC_TIME : SC_TIME;
-			unsigned const second = sorting == EC_TIME ? SC_TIME : EC_TIME;
+			unsigned const first  = _first;
+			unsigned const second = first == EC_TIME ? SC_TIME : EC_TIME;
 
 			for (Entry const *e = _entries.first(); e; e = e->next()) {
 
@@ -138,9 +355,6 @@ struct Trace_subject_registry
 					continue;
 				}
 
-				total_first[x][y] += e->recent_time[first];
-				total_second[x][y] += e->recent_time[second];
-
 				enum { NONE = ~0U };
 				unsigned replace = NONE;
 
@@ -274,10 +488,90 @@ struct Trace_subject_registry
 namespace App {
 
 	struct Main;
+	struct Prometheus_output;
 	using namespace Genode;
 }
 
 
+/**
+ * Line-buffered output to a file in the Prometheus text format
+ */
+struct App::Prometheus_output : Output
+{
+	New_file &_file;
+
+	char     _buf[256];
+	unsigned _len = 0;
+	bool     _write_error = false;
+
+	Prometheus_output(New_file &file) : _file(file) { }
+
+	void flush()
+	{
+		if (_len && _file.append(_buf, _len) != New_file::Append_result::OK)
+			_write_error = true;
+
+		_len = 0;
+	}
+
+	bool write_error() const { return _write_error; }
+
+	void out_char(char c) override
+	{
+		_buf[_len++] = c;
+
+		if (c == '\n' || _len == sizeof(_buf))
+			flush();
+	}
+
+	/**
+	 * Label value with backslash, double quote, and newline escaped
+	 */
+	template <typename STRING>
+	struct Label_value
+	{
+		STRING const &string;
+
+		void print(Output &out) const
+		{
+			for (char const *s = string.string(); *s; s++) {
+				switch (*s) {
+				case '\\': Genode::print(out, "\\\\"); break;
+				case '"':  Genode::print(out, "\\\""); break;
+				case '\n': Genode::print(out, "\\n");  break;
+				default:   out.out_char(*s);
+				}
+			}
+		}
+	};
+
+	template <typename STRING>
+	static Label_value<STRING> label_value(STRING const &s) { return { s }; }
+
+	/**
+	 * Labels identifying a thread
+	 */
+	struct Thread_labels
+	{
+		Trace::Subject_info const &info;
+
+		void print(Output &out) const
+		{
+			Genode::print(out, "label=\"",  label_value(info.session_label()), "\",",
+			                   "thread=\"", label_value(info.thread_name()),   "\",",
+			                   "cpu=\"",    info.affinity().xpos(), ".",
+			                                info.affinity().ypos(), "\"");
+		}
+	};
+
+	void metric(char const *name, char const *type, char const *help)
+	{
+		Genode::print(*this, "# HELP ", name, " ", help, "\n",
+		                     "# TYPE ", name, " ", type, "\n");
+	}
+};
+
+
 struct App::Main
 {
 	Env &_env;
@@ -306,7 +600,30 @@ struct App::Main
 
 	Heap _heap { _env.ram(), _env.rm() };
 
-	Trace_subject_registry _trace_subject_registry { };
+	static unsigned _default_history() { return 60; }
+	static unsigned _max_history()     { return 24*60*60; }
+
+	Reconstructible<Trace_subject_registry> _trace_subject_registry {
+		_heap, _default_history() };
+
+	/*
+	 * Outputs, the LOG output is disabled in headless mode
+	 */
+	bool _log_output = true;
+
+	Constructible<Expanding_reporter> _reporter { };
+
+	unsigned _report_threads = 32;
+
+	typedef Directory::Path Path;
+
+	Constructible<Root_directory> _vfs { };
+
+	Path _prometheus_path { };
+
+	void _generate_report();
+
+	void _write_prometheus();
 
 	void _handle_config();
 
@@ -332,30 +649,181 @@ void App::Main::_handle_config()
 {
 	_config.update();
 
-	_period_ms = _config.xml().attribute_value("period_ms", _default_period_ms());
+	Xml_node const config = _config.xml();
+
+	_period_ms = config.attribute_value("period_ms", _default_period_ms());
 
-	String<8> ec_sc(_config.xml().attribute_value("sort_time", String<8>("ec")));
+	String<8> ec_sc(config.attribute_value("sort_time", String<8>("ec")));
 	if (ec_sc == "ec")
 		_sort = EC_TIME;
 	else
 		_sort = SC_TIME;
 
-	log("sorting based on ",
-	    _sort == EC_TIME ? "execution context (ec) [other option is scheduling context (sc)]"
-	                     : "scheduling context (sc) [other option is execution context (ec)]");
+	_log_output = config.attribute_value("log", true);
+
+	if (_log_output)
+		log("sorting based on ",
+		    _sort == EC_TIME ? "execution context (ec) [other option is scheduling context (sc)]"
+		                     : "scheduling context (sc) [other option is execution context (ec)]");
+
+	unsigned history = config.attribute_value("history", _default_history());
+	if (history > _max_history()) {
+		warning("limiting history to ", _max_history(), " periods");
+		history = _max_history();
+	}
+
+	if (history != _trace_subject_registry->history_len()) {
+		_trace_subject_registry->flush(*_trace);
+		_trace_subject_registry.construct(_heap, history);
+	}
+
+	if (config.attribute_value("report", false)) {
+		if (!_reporter.constructed())
+			_reporter.construct(_env, "stats", "stats");
+	} else {
+		_reporter.destruct();
+	}
+
+	_report_threads = config.attribute_value("report_threads", 32U);
+
+	_prometheus_path = config.attribute_value("prometheus", Path());
+
+	if (_prometheus_path.valid() && !_vfs.constructed()) {
+		try {
+			_vfs.construct(_env, _heap, config.sub_node("vfs")); }
+		catch (Xml_node::Nonexistent_sub_node) {
+			error("missing <vfs> configuration for 'prometheus' output"); }
+	}
 
 	_timer.trigger_periodic(1000*_period_ms);
 }
 
 
+void App::Main::_generate_report()
+{
+	Trace_subject_registry const &registry = *_trace_subject_registry;
+
+	using Entry     = Trace_subject_registry::Entry;
+	using Component = Trace_subject_registry::Component;
+
+	_reporter->generate([&] (Xml_generator &xml) {
+
+		xml.attribute("period_ms", _period_ms);
+		xml.attribute("sort_time", _sort == EC_TIME ? "ec" : "sc");
+		xml.attribute("history",   registry.history_len());
+		xml.attribute("subjects",  registry.subjects());
+
+		registry.for_each_cpu([&] (unsigned x, unsigned y, unsigned threads,
+		                           unsigned long long time) {
+			xml.node("cpu", [&] () {
+				xml.attribute("xpos",    x);
+				xml.attribute("ypos",    y);
+				xml.attribute("threads", threads);
+				xml.attribute("time",    time);
+			});
+		});
+
+		registry.for_each_component([&] (Component const &c) {
+			xml.node("component", [&] () {
+				xml.attribute("label",   c.name());
+				xml.attribute("threads", c.threads);
+				xml.attribute("permille", c.load);
+				xml.attribute("ec_time", c.recent_time[EC_TIME]);
+				xml.attribute("sc_time", c.recent_time[SC_TIME]);
+			});
+		});
+
+		registry.for_each_top_entry(_report_threads, [&] (Entry const &e) {
+			xml.node("thread", [&] () {
+				xml.attribute("id",       e.id.id);
+				xml.attribute("label",    e.info.session_label());
+				xml.attribute("name",     e.info.thread_name());
+				xml.attribute("xpos",     e.info.affinity().xpos());
+				xml.attribute("ypos",     e.info.affinity().ypos());
+				xml.attribute("permille", e.history.last());
+				xml.attribute("p50",      e.history.percentile(50));
+				xml.attribute("p90",      e.history.percentile(90));
+				xml.attribute("p99",      e.history.percentile(99));
+			});
+		});
+	});
+}
+
+
+void App::Main::_write_prometheus()
+{
+	Trace_subject_registry const &registry = *_trace_subject_registry;
+
+	using Entry     = Trace_subject_registry::Entry;
+	using Component = Trace_subject_registry::Component;
+
+	try {
+		New_file file(*_vfs, _prometheus_path);
+		Prometheus_output out(file);
+
+		auto thread_labels = [&] (Entry const &e) {
+			return Prometheus_output::Thread_labels { e.info }; };
+
+		out.metric("genode_thread_execution_time_total", "counter",
+		           "Execution time of the thread as reported by the kernel");
+		registry.for_each_entry([&] (Entry const &e) {
+			print(out, "genode_thread_execution_time_total{", thread_labels(e), "} ",
+			      e.info.execution_time().thread_context, "\n"); });
+
+		out.metric("genode_thread_load_permille", "gauge",
+		           "Share of the thread in the execution time of its CPU");
+		registry.for_each_entry([&] (Entry const &e) {
+			print(out, "genode_thread_load_permille{", thread_labels(e), "} ",
+			      e.history.last(), "\n"); });
+
+		out.metric("genode_thread_load_percentile_percent", "gauge",
+		           "Percentiles of the thread load over the recent periods");
+		registry.for_each_entry([&] (Entry const &e) {
+			print(out, "genode_thread_load_percentile_percent{", thread_labels(e),
+			      ",quantile=\"0.5\"} ",  e.history.percentile(50), "\n",
+			      "genode_thread_load_percentile_percent{", thread_labels(e),
+			      ",quantile=\"0.9\"} ",  e.history.percentile(90), "\n",
+			      "genode_thread_load_percentile_percent{", thread_labels(e),
+			      ",quantile=\"0.99\"} ", e.history.percentile(99), "\n"); });
+
+		out.metric("genode_component_load_permille", "gauge",
+		           "Summed up load of all threads of the component");
+		registry.for_each_component([&] (Component const &c) {
+			print(out, "genode_component_load_permille{label=\"",
+			      out.label_value(Session_label(c.name())), "\"} ", c.load, "\n"); });
+
+		out.metric("genode_cpu_threads", "gauge", "Number of threads on the CPU");
+		registry.for_each_cpu([&] (unsigned x, unsigned y, unsigned threads,
+		                           unsigned long long) {
+			print(out, "genode_cpu_threads{cpu=\"", x, ".", y, "\"} ", threads, "\n"); });
+
+		out.flush();
+		if (out.write_error())
+			error("failed to write '", _prometheus_path, "'");
+	}
+	catch (New_file::Create_failed) { }
+}
+
+
 void App::Main::_handle_period()
 {
 	/* update subject information */
-	bool const arg_buffer_sufficient = _trace_subject_registry.update(*_trace,
-	                                                                  _heap);
+	bool const arg_buffer_sufficient = _trace_subject_registry->update(*_trace);
+
 	if (arg_buffer_sufficient) {
+
+		_trace_subject_registry->account(_sort);
+
 		/* show most significant consumers */
-		_trace_subject_registry.top(_sort);
+		if (_log_output)
+			_trace_subject_registry->top();
+
+		if (_reporter.constructed())
+			_generate_report();
+
+		if (_vfs.constructed() && _prometheus_path.valid())
+			_write_prometheus();
+
 		return;
 	}
 
@@ -365,7 +833,7 @@ void App::Main::_handle_period()
 	/* by destructing the session we free up the allocated memory in core */
 	Genode::warning("re-construct trace session");
 
-	_trace_subject_registry.flush(*_trace, _heap);
+	_trace_subject_registry->flush(*_trace);
 
 	_trace.destruct();
 	_trace.construct(_env, trace_ram_quota, arg_buffer_ram, PARENT_LEVELS);
@@ -373,4 +841,3 @@ void App::Main::_handle_period()
 
 
 void Component::construct(Genode::Env &env) { static App::Main main(env); }
-
@@ -1,3 +1,3 @@
 TARGET = top
 SRC_CC = main.cc
-LIBS  += base
+LIBS  += base vfs
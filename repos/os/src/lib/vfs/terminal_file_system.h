@@ -113,8 +113,9 @@ class Vfs::Terminal_file_system::Data_file_system : public Single_file_system
 
 			bool const _raw;
 
-			bool notifying = false;
-			bool blocked   = false;
+			bool notifying     = false;
+			bool blocked       = false;
+			bool write_blocked = false;
 
 			Terminal_vfs_handle(Terminal::Connection &terminal,
 			                    Read_buffer          &read_buffer,
@@ -160,6 +161,13 @@ class Vfs::Terminal_file_system::Data_file_system : public Single_file_system
 			                   file_size &out_count) override
 			{
 				out_count = _terminal.write(src, count);
+
+				/* the ring of the streaming mode is full */
+				if (count && !out_count) {
+					write_blocked = true;
+					return WRITE_ERR_WOULD_BLOCK;
+				}
+
 				return WRITE_OK;
 			}
 		};
@@ -205,6 +213,19 @@ class Vfs::Terminal_file_system::Data_file_system : public Single_file_system
 
 	public:
 
+		/**
+		 * Resume writers once the terminal consumed data from the full ring
+		 */
+		void handle_write_space()
+		{
+			_handle_registry.for_each([] (Registered_handle &handle) {
+				if (handle.write_blocked) {
+					handle.write_blocked = false;
+					handle.io_progress_response();
+				}
+			});
+		}
+
 		Data_file_system(Genode::Entrypoint   &ep,
 		                 Terminal::Connection &terminal,
 		                 Name           const &name,
@@ -258,6 +279,19 @@ class Vfs::Terminal_file_system::Data_file_system : public Single_file_system
 			return true;
 		}
 
+		Write_result write(Vfs_handle *vfs_handle, char const *src,
+		                   file_size count, file_size &out_count) override
+		{
+			Write_result const result =
+				Single_file_system::write(vfs_handle, src, count, out_count);
+
+			/* let the caller retry once the terminal consumed data */
+			if (result == WRITE_ERR_WOULD_BLOCK)
+				throw Insufficient_buffer();
+
+			return result;
+		}
+
 		Ftruncate_result ftruncate(Vfs_handle *, file_size) override
 		{
 			return FTRUNCATE_OK;
@@ -280,7 +314,15 @@ struct Vfs::Terminal_file_system::Local_factory : File_system_factory,
 
 	Genode::Env &_env;
 
-	Terminal::Connection _terminal { _env, _label.string() };
+	Genode::size_t const _stream_size;
+
+	Genode::Io_signal_handler<Local_factory> _write_space_handler {
+		_env.ep(), *this, &Local_factory::_handle_write_space };
+
+	void _handle_write_space() { _data_fs.handle_write_space(); }
+
+	Terminal::Connection _terminal { _env, _label.string(), _stream_size,
+	                                 _write_space_handler };
 
 	bool const _raw;
 
@@ -342,6 +384,7 @@ struct Vfs::Terminal_file_system::Local_factory : File_system_factory,
 		_label(config.attribute_value("label", Label(""))),
 		_name(name(config)),
 		_env(env.env()),
+		_stream_size(config.attribute_value("stream_size", Genode::Number_of_bytes(0))),
 		_raw(config.attribute_value("raw", false))
 	{
 		_terminal.size_changed_sigh(_size_changed_handler);
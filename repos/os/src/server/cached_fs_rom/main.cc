@@ -19,9 +19,12 @@
 #include <region_map/client.h>
 #include <rm_session/connection.h>
 #include <base/attached_ram_dataspace.h>
+#include <base/attached_rom_dataspace.h>
 #include <base/session_label.h>
 #include <base/heap.h>
 #include <base/component.h>
+#include <os/reporter.h>
+#include <timer_session/connection.h>
 
 /* local session-requests utility */
 #include "session_requests.h"
@@ -88,6 +91,28 @@ struct Cached_fs_rom::Cached_rom final
 	 */
 	int _ref_count = 0;
 
+	/**
+	 * Point in time of the last use, for least-recently-used eviction
+	 */
+	unsigned long last_use = 0;
+
+	/**
+	 * True if a client waits for the ROM, which is loaded in preference
+	 * to prefetched ROMs
+	 */
+	bool requested = false;
+
+	/**
+	 * True if the file could not be opened for loading
+	 */
+	bool failed = false;
+
+	/**
+	 * Duration of loading the ROM
+	 */
+	uint64_t load_start_ms = 0;
+	uint64_t load_ms       = 0;
+
 	Cached_rom(Cache_space   &cache_space,
 	           Env           &env,
 	           Rm_connection &rm,
@@ -113,6 +138,7 @@ struct Cached_fs_rom::Cached_rom final
 
 	bool completed() const { return rm_ds.valid(); }
 	bool unused()    const { return (_ref_count < 1); }
+	bool pending()   const { return !completed() && !transfer && !failed; }
 
 	void complete()
 	{
@@ -152,7 +178,7 @@ struct Cached_fs_rom::Transfer final
 
 		File_system::file_size_t const _size;
 		File_system::seek_off_t        _seek = 0;
-		File_system::Packet_descriptor _raw_pkt = _alloc_packet();
+		File_system::Packet_descriptor _raw_pkt;
 		File_system::Packet_guard      _packet_guard { *_fs.tx(), _raw_pkt };
 
 		Transfer_space::Element        _transfer_elem;
@@ -162,12 +188,12 @@ struct Cached_fs_rom::Transfer final
 		 *
 		 * \throw  Packet_alloc_failed
 		 */
-		File_system::Packet_descriptor _alloc_packet()
+		File_system::Packet_descriptor _alloc_packet(size_t packet_size)
 		{
 			if (!_fs.tx()->ready_to_submit())
 				throw Packet_alloc_failed();
 
-			size_t chunk_size = min(_size, _fs.tx()->bulk_buffer_size()/4);
+			size_t chunk_size = min(_size, packet_size);
 			return _fs.tx()->alloc_packet(chunk_size);
 		}
 
@@ -187,15 +213,21 @@ struct Cached_fs_rom::Transfer final
 
 		/**
 		 * Constructor
+		 *
+		 * \param packet_size  maximum size of the read packets
+		 *
+		 * \throw Packet_alloc_failed
 		 */
 		Transfer(Transfer_space           &space,
 		         Cached_rom               &rom,
 		         File_system::Session     &fs,
 		         File_system::File_handle  file_handle,
-		         size_t                    file_size)
+		         size_t                    file_size,
+		         size_t                    packet_size)
 		:
 			_cached_rom(rom), _fs(fs),
 			_handle(file_handle), _size(file_size),
+			_raw_pkt(_alloc_packet(packet_size)),
 			_transfer_elem(*this, space, Transfer_space::Id{_handle.value})
 		{
 			_cached_rom.transfer = this;
@@ -205,6 +237,8 @@ struct Cached_fs_rom::Transfer final
 
 		Path const &path() const { return _cached_rom.path; }
 
+		Cached_rom &cached_rom() { return _cached_rom; }
+
 		bool completed() const { return (_seek >= _size); }
 
 		/**
@@ -271,6 +305,40 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 {
 	Genode::Env &env;
 
+	/*
+	 * The config is optional, without it the defaults apply
+	 */
+	Constructible<Attached_rom_dataspace> config_rom { };
+
+	Xml_node _init_config()
+	{
+		try { config_rom.construct(env, "config"); }
+		catch (Rom_connection::Rom_connection_failed) {
+			return Xml_node("<config/>"); }
+
+		return config_rom->xml();
+	}
+
+	Xml_node const config = _init_config();
+
+	/**
+	 * Number of files loaded concurrently
+	 */
+	unsigned const max_transfers =
+		max(1U, config.attribute_value("max_transfers", 4U));
+
+	/**
+	 * Upper bound of the file content held in the cache, 0 if unlimited
+	 */
+	size_t const ram_budget =
+		config.attribute_value("ram_budget", Number_of_bytes(0));
+
+	size_t const tx_buf_size =
+		config.attribute_value("tx_buf_size",
+		                       Number_of_bytes(File_system::DEFAULT_TX_BUF_SIZE));
+
+	bool const report_enabled = config.attribute_value("report", false);
+
 	Rm_connection rm { env };
 
 	Cache_space    cache     { };
@@ -280,22 +348,65 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 	Heap heap { env.pd(), env.rm() };
 
 	Allocator_avl           fs_tx_block_alloc { &heap };
-	File_system::Connection fs { env, fs_tx_block_alloc };
+	File_system::Connection fs { env, fs_tx_block_alloc, "", "/", true, tx_buf_size };
+
+	/**
+	 * Size of the read packets, the bulk buffer is split among the
+	 * concurrent transfers
+	 */
+	size_t const packet_size =
+		max((size_t)4096, (fs.tx()->bulk_buffer_size() / max_transfers) & ~(size_t)0xfff);
 
 	Session_requests_rom session_requests { env, *this };
 
 	Io_signal_handler<Main> packet_handler {
 		env.ep(), *this, &Main::handle_packets };
 
+	/*
+	 * The timer is used for measuring load times only if the prefetching
+	 * or the report is enabled.
+	 */
+	Constructible<Timer::Connection> timer { };
+
+	Constructible<Expanding_reporter> reporter { };
+
+	unsigned num_transfers = 0;
+
+	unsigned long use_count = 0;
+
+	bool prefetch_complete = true;
+
+	uint64_t prefetch_start_ms = 0;
+
+	uint64_t now_ms() { return timer.constructed() ? timer->elapsed_ms() : 0; }
+
+	size_t cached_bytes()
+	{
+		size_t bytes = 0;
+		cache.for_each<Cached_rom const &>([&] (Cached_rom const &rom) {
+			bytes += rom.file_size; });
+		return bytes;
+	}
+
+	bool fits_into_budget(size_t file_size)
+	{
+		return (env.pd().avail_ram().value >= file_size)
+		    && (env.pd().avail_caps().value >= 8)
+		    && (!ram_budget || cached_bytes() + file_size <= ram_budget);
+	}
+
 	/**
 	 * Return true when a cache element is freed
+	 *
+	 * The least recently used element is evicted first.
 	 */
 	bool cache_evict()
 	{
 		Cached_rom *discard = nullptr;
 
 		cache.for_each<Cached_rom&>([&] (Cached_rom &rom) {
-			if (!discard && rom.unused()) discard = &rom; });
+			if (rom.unused() && (!discard || rom.last_use < discard->last_use))
+				discard = &rom; });
 
 		if (discard)
 			destroy(heap, discard);
@@ -337,6 +448,159 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 		throw Service_denied();
 	}
 
+	/**
+	 * Start loading the content of a cache entry
+	 *
+	 * \return false if the transfer must be deferred
+	 *
+	 * \throw Service_denied  file cannot be opened
+	 */
+	bool start_transfer(Cached_rom &rom)
+	{
+		auto open_file = [&] () {
+			try { return try_open(rom.path); }
+			catch (Service_denied) {
+				rom.failed = true;
+				throw;
+			}
+		};
+
+		File_system::File_handle handle = open_file();
+
+		try {
+			new (heap) Transfer(transfers, rom, fs, handle, rom.file_size,
+			                    packet_size);
+		}
+		catch (...) {
+			fs.close(handle);
+			/* retry when next pending transfer completes */
+			return false;
+		}
+
+		rom.load_start_ms = now_ms();
+		num_transfers++;
+		return true;
+	}
+
+	/**
+	 * Start transfers of pending cache entries up to 'max_transfers'
+	 *
+	 * ROMs requested by clients take precedence over prefetched ones.
+	 */
+	void start_pending_transfers()
+	{
+		auto start = [&] (bool requested_only) {
+			bool deferred = false;
+			cache.for_each<Cached_rom&>([&] (Cached_rom &rom) {
+
+				if (deferred || num_transfers >= max_transfers)
+					return;
+
+				if (!rom.pending() || (requested_only && !rom.requested))
+					return;
+
+				try {
+					if (!start_transfer(rom))
+						deferred = true;
+				}
+				catch (Service_denied) { }
+			});
+			return !deferred;
+		};
+
+		if (start(true))
+			start(false);
+	}
+
+	void generate_report()
+	{
+		if (!reporter.constructed())
+			return;
+
+		reporter->generate([&] (Xml_generator &xml) {
+
+			xml.attribute("prefetch_complete", prefetch_complete);
+			xml.attribute("cached_bytes", cached_bytes());
+			if (ram_budget)
+				xml.attribute("ram_budget", ram_budget);
+
+			cache.for_each<Cached_rom const &>([&] (Cached_rom const &rom) {
+				xml.node("rom", [&] () {
+					xml.attribute("name", rom.path.string());
+					xml.attribute("size", rom.file_size);
+					if (rom.completed())
+						xml.attribute("load_ms", rom.load_ms);
+					else if (rom.failed)
+						xml.attribute("failed", true);
+					else
+						xml.attribute("loading", true);
+				});
+			});
+		});
+	}
+
+	/**
+	 * Populate cache with the ROMs listed in the 'prefetch' config node
+	 *
+	 * Prefetching does not evict any cache entries. ROMs that do not
+	 * fit into the RAM budget are skipped.
+	 */
+	void prefetch(Xml_node const &node)
+	{
+		node.for_each_sub_node("rom", [&] (Xml_node const &rom_node) {
+
+			typedef String<File_system::MAX_PATH_LEN> Name;
+			Path const path(rom_node.attribute_value("name", Name()).string());
+
+			bool cached = false;
+			cache.for_each<Cached_rom const &>([&] (Cached_rom const &rom) {
+				cached |= (rom.path == path); });
+
+			if (cached)
+				return;
+
+			size_t file_size = 0;
+			try {
+				File_system::File_handle handle = try_open(path);
+				File_system::Handle_guard guard(fs, handle);
+				file_size = fs.status(handle).size;
+			}
+			catch (...) { return; }
+
+			if (!fits_into_budget(file_size)) {
+				warning("skip prefetching of ", path, ", RAM budget exceeded");
+				return;
+			}
+
+			Cached_rom &rom = *new (heap) Cached_rom(cache, env, rm, path, file_size);
+			rom.last_use = ++use_count;
+		});
+	}
+
+	/**
+	 * Return true if all prefetched ROMs are loaded
+	 *
+	 * Once complete, the result stays the same.
+	 */
+	bool check_prefetch_complete()
+	{
+		if (prefetch_complete)
+			return true;
+
+		bool complete = true;
+		cache.for_each<Cached_rom const &>([&] (Cached_rom const &rom) {
+			complete &= rom.completed() || rom.failed; });
+
+		if (!complete)
+			return false;
+
+		log("prefetched ", cached_bytes() / 1024, " KiB in ",
+		    now_ms() - prefetch_start_ms, " ms");
+
+		prefetch_complete = true;
+		return true;
+	}
+
 	/**
 	 * Create new sessions
 	 */
@@ -382,14 +646,16 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 			File_system::Handle_guard guard(fs, handle);
 			size_t file_size = fs.status(handle).size;
 
-			while (env.pd().avail_ram().value < file_size || env.pd().avail_caps().value < 8) {
-				/* drop unused cache entries */
+			while (!fits_into_budget(file_size)) {
+				/* drop least recently used cache entries */
 				if (!cache_evict()) break;
 			}
 
 			rom = new (heap) Cached_rom(cache, env, rm, path, file_size);
 		}
 
+		rom->last_use = ++use_count;
+
 		if (rom->completed()) {
 			/* Create new RPC object */
 			Session_component *session = new (heap)
@@ -398,18 +664,15 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 				log("deliver ROM \"", label, "\"");
 			env.parent().deliver_session_cap(pid, env.ep().manage(*session));
 
-		} else if (!rom->transfer) {
-			File_system::File_handle handle = try_open(path);
+		} else {
+			rom->requested = true;
 
-			try {
-				new (heap) Transfer(transfers, *rom, fs, handle, rom->file_size);
-			}
-			catch (...) {
+			if (rom->failed)
+				throw Service_denied();
+
+			if (rom->pending()
+			 && (num_transfers >= max_transfers || !start_transfer(*rom)))
 				Genode::warning("defer transfer of ", rom->path);
-				fs.close(handle);
-				/* retry when next pending transfer completes */
-				return;
-			}
 		}
 	}
 
@@ -429,6 +692,8 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 	{
 		Tx_source &source = *fs.tx();
 
+		bool progress = false;
+
 		while (source.ack_avail()) {
 			File_system::Packet_descriptor pkt = source.get_acked_packet();
 			if (pkt.operation() != File_system::Packet_descriptor::READ) continue;
@@ -441,8 +706,11 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 			{
 				transfer.process_packet(pkt);
 				if (transfer.completed()) {
-					session_requests.schedule();
+					Cached_rom &rom = transfer.cached_rom();
+					rom.load_ms = now_ms() - rom.load_start_ms;
 					destroy(heap, &transfer);
+					num_transfers--;
+					progress = true;
 				}
 				stray_pkt = false;
 			});
@@ -450,12 +718,39 @@ struct Cached_fs_rom::Main final : Genode::Session_request_handler
 			if (stray_pkt)
 				source.release_packet(pkt);
 		}
+
+		if (!progress)
+			return;
+
+		start_pending_transfers();
+		session_requests.schedule();
+
+		check_prefetch_complete();
+		generate_report();
 	}
 
 	Main(Genode::Env &env) : env(env)
 	{
 		fs.sigh_ack_avail(packet_handler);
 
+		config.with_sub_node("prefetch", [&] (Xml_node const &node) {
+			timer.construct(env);
+			prefetch_start_ms = now_ms();
+			prefetch_complete = false;
+			prefetch(node);
+		});
+
+		if (report_enabled) {
+			if (!timer.constructed())
+				timer.construct(env);
+			reporter.construct(env, "cache", "cache");
+		}
+
+		start_pending_transfers();
+
+		check_prefetch_complete();
+		generate_report();
+
 		/* process any requests that have already queued */
 		session_requests.schedule();
 	}
@@ -17,82 +17,21 @@
 #include <base/log.h>
 #include <base/stdint.h>
 #include <util/misc_math.h>
+#include <util/construct_at.h>
 #include <util/token.h>
 
+/* local includes */
 #include "iso9660.h"
+#include "sector_cache.h"
 
 using namespace Genode;
 
 namespace Iso {
-	class Sector;
 	class Rock_ridge;
 	class Iso_base;
 }
 
 
-/*
- *  Sector reads one or more packets from the block interface
- */
-class Iso::Sector {
-
-	public:
-
-		enum {
-			MAX_SECTORS = 32, /* max. number sectors that can be read in one
-			                     transaction */
-			BLOCK_SIZE = 2048,
-		};
-
-	private:
-
-		Block::Session::Tx::Source &_source;
-		Block::Packet_descriptor    _p { };
-
-	public:
-
-		Sector(Block::Connection<> &block,
-		       unsigned long blk_nr, unsigned long count)
-		: _source(*block.tx())
-		{
-			try {
-				_p = Block::Packet_descriptor(
-					block.alloc_packet(blk_size() * count),
-					Block::Packet_descriptor::READ,
-					blk_nr * ((float)blk_size() / BLOCK_SIZE),
-					count * ((float)blk_size() / BLOCK_SIZE));
-
-				_source.submit_packet(_p);
-				_p = _source.get_acked_packet();
-
-				if (!_p.succeeded()) {
-					Genode::error("Could not read block ", blk_nr);
-					throw Io_error();
-				}
-
-			} catch (Block::Session::Tx::Source::Packet_alloc_failed) {
-				Genode::error("packet overrun!");
-				_p = _source.get_acked_packet();
-				throw Io_error();
-			}
-		}
-
-		~Sector() {
-			_source.release_packet(_p);
-		}
-
-		/**
-		 * Return address of packet content
-		 */
-		template <typename T>
-		T addr() { return reinterpret_cast<T>(_source.packet_content(_p)); }
-
-		static size_t blk_size() { return BLOCK_SIZE; }
-
-		static unsigned long to_blk(unsigned long bytes) {
-			return ((bytes + blk_size() - 1) & ~(blk_size() - 1)) / blk_size(); }
-};
-
-
 /**
  * Rock ridge extension (see IEEE P1282)
  */
@@ -184,8 +123,8 @@ class Directory_record : public Iso::Iso_base
 		/* length of file name */
 		uint8_t   file_name_length() { return value<uint8_t>(32); }
 
-		/* retrieve the file name */
-		void file_name(char *buf)
+		/* retrieve the file name, truncated to 'buf_len' - 1 characters */
+		void file_name(char *buf, size_t buf_len)
 		{
 			buf[0] = 0;
 
@@ -194,8 +133,9 @@ class Directory_record : public Iso::Iso_base
 			                                            system_use_size());
 
 			if (rr) {
-				memcpy(buf, rr->name(), rr->length());
-				buf[rr->length()] = 0;
+				size_t const len = min((size_t)rr->length(), buf_len - 1);
+				memcpy(buf, rr->name(), len);
+				buf[len] = 0;
 				return;
 			}
 
@@ -224,8 +164,9 @@ class Directory_record : public Iso::Iso_base
 					return;
 				}
 
-			memcpy(buf, name, file_name_length());
-			buf[file_name_length()] = 0;
+			size_t const len = min((size_t)file_name_length(), buf_len - 1);
+			memcpy(buf, name, len);
+			buf[len] = 0;
 		}
 
 		/* pad byte after file name (if file name length is even, only) */
@@ -245,34 +186,13 @@ class Directory_record : public Iso::Iso_base
 			       - TABLE_LENGTH - pad_byte();
 		}
 
-		/* retrieve next record */
-		Directory_record *next()
-		{
-			Directory_record *_next = this + record_length();
-
-			if (_next->record_length())
-				return _next;
-
-			return 0;
-		}
-
-		/* find a directory record with file name matching 'level' */
-		Directory_record *locate(char const *level)
+		/* describes this record the directory itself or its parent */
+		bool dot_or_dotdot()
 		{
-			Directory_record *dir = this;
+			char const *name = ptr<char const *>(33);
 
-			while (dir) {
-
-				char name[Iso::LEVEL_LENGTH];
-				dir->file_name(name);
-
-				if (!strcmp(name, level))
-					return dir;
-
-				dir = dir->next();
-			}
-
-			return 0;
+			return file_name_length() == 1
+			    && (name[0] == ROOT_DIR || name[0] == PARENT_DIR);
 		}
 
 		/* describes this record a directory */
@@ -289,9 +209,6 @@ class Volume_descriptor : public Iso::Iso_base
 		/* volume types */
 		PRIMARY    = 0x01, /* type of primary volume descriptor */
 		TERMINATOR = 0xff, /* type of terminating descriptor */
-
-		/* constants */
-		ROOT_SIZE  = 34, /* the root directory record has a fixed length */
 	};
 
 	public:
@@ -307,169 +224,261 @@ class Volume_descriptor : public Iso::Iso_base
 
 		/* check for terminating descriptor */
 		bool terminator() { return type() == TERMINATOR; }
-
-		/* copy the root record */
-		Directory_record *copy_root_record(Genode::Allocator &alloc)
-		{
-			Directory_record *buf;
-
-			if (!(alloc.alloc(ROOT_SIZE, &buf)))
-				throw Insufficient_ram_quota();
-
-			memcpy(buf, root_record(), ROOT_SIZE);
-
-			return buf;
-		}
 };
 
 
 /**
  * Locate the root-directory record in the primary volume descriptor
  */
-static Directory_record *locate_root(Genode::Allocator &alloc,
-                                     Block::Connection<> &block)
+static Iso::File_info root_dir(Iso::Sector_cache &cache)
 {
 	/* volume descriptors in ISO9660 start at block 16 */
 	for (unsigned long blk_nr = 16;; blk_nr++) {
-		Iso::Sector sec(block, blk_nr, 1);
-		Volume_descriptor *vol = sec.addr<Volume_descriptor *>();
 
-		if (vol->primary())
-			return vol->copy_root_record(alloc);
+		bool     primary = false, terminator = false;
+		uint32_t root_blk_nr = 0, root_length = 0;
+
+		cache.with_sector(blk_nr, [&] (char const *data) {
+			Volume_descriptor *vol = (Volume_descriptor *)data;
+
+			primary    = vol->primary();
+			terminator = vol->terminator();
+
+			if (primary) {
+				root_blk_nr = vol->root_record()->blk_nr();
+				root_length = vol->root_record()->data_length();
+			}
+		});
+
+		if (primary)
+			return Iso::File_info(root_blk_nr, root_length);
 
-		if (vol->terminator())
-			return nullptr;
+		if (terminator)
+			throw Iso::Non_data_disc();
 	}
 }
 
 
-/**
- * Return root directory record
- */
-static Directory_record *root_dir(Genode::Allocator &alloc,
-                                  Block::Connection<> &block)
-{
-	Directory_record *root = locate_root(alloc, block);
+/*********************
+ ** Directory index **
+ *********************/
 
-	if (!root) { throw Iso::Non_data_disc(); }
+class Iso::Directory_index::Entry : public Avl_string_base
+{
+	private:
 
-	return root;
-}
+		/*
+		 * Noncopyable
+		 */
+		Entry(Entry const &);
+		Entry &operator = (Entry const &);
 
+		/* the path is stored right after the entry */
+		char *_path() { return (char *)(this + 1); }
 
-/*******************
- ** Iso interface **
- *******************/
+	public:
 
-static Directory_record *_root_dir;
+		File_info const info;
+		bool      const directory;
 
+		Entry *next = nullptr;
 
-Iso::File_info *Iso::file_info(Genode::Allocator &alloc,
-                               Block::Connection<> &block, char const *path)
-{
-	char level[PATH_LENGTH];
+		static size_t size(char const *path) {
+			return sizeof(Entry) + strlen(path) + 1; }
 
-	struct Scanner_policy_file
-	{
-		static bool identifier_char(char c, unsigned /* i */)
+		Entry(char const *path, File_info const &info, bool directory)
+		:
+			Avl_string_base(_path()), info(info), directory(directory)
 		{
-			return c != '/' && c != 0;
+			copy_cstring(_path(), path, strlen(path) + 1);
 		}
-	};
-	typedef ::Genode::Token<Scanner_policy_file> Token;
+};
 
-	Token t(path);
 
-	if (!_root_dir) {
-		_root_dir = root_dir(alloc, block);
-	}
+Iso::Directory_index::Entry &
+Iso::Directory_index::_insert(char const *path, File_info const &info,
+                              bool directory)
+{
+	Entry &entry = *construct_at<Entry>(_alloc.alloc(Entry::size(path)),
+	                                    path, info, directory);
+	_tree.insert(&entry);
 
-	Directory_record *dir = _root_dir;
-	uint32_t blk_nr = 0, data_length = 0;
+	if (_last) _last->next = &entry;
+	else       _first      = &entry;
 
-	/* determine block nr and file length on disk, parse directory records */
-	while (t) {
+	_last = &entry;
 
-		if (t.type() != Token::IDENT) {
-			t = t.next();
-			continue;
-		}
+	if (directory) _num_dirs++;
+	else           _num_files++;
 
-		t.string(level, PATH_LENGTH);
+	return entry;
+}
 
-		/*
-		 * Save current block number in a variable because successive
-		 * iterations might override the memory location where dir points
-		 * to when a directory entry spans several sectors.
-		 */
-		uint32_t current_blk_nr = dir->blk_nr();
 
-		/* load extent of directory record and search for level */
-		for (unsigned long i = 0; i < Sector::to_blk(dir->data_length()); i++) {
-			Sector sec(block, current_blk_nr + i, 1);
-			Directory_record *tmp = sec.addr<Directory_record *>()->locate(level);
+void Iso::Directory_index::_scan(Sector_cache &cache, Entry &dir)
+{
+	enum { TABLE_LENGTH = 33, NAME_LENGTH = 256 };
 
-			if (!tmp && i == Sector::to_blk(dir->data_length()) - 1) {
-				Genode::error("file not found: ", Genode::Cstring(path));
-				throw File_not_found();
-			}
+	size_t   const dir_len     = strlen(dir.name());
+	uint32_t const num_sectors = (dir.info.size() + Sector_cache::SECTOR_SIZE - 1)
+	                           / Sector_cache::SECTOR_SIZE;
 
-			if (!tmp) continue;
+	for (uint32_t i = 0; i < num_sectors; i++) {
 
-			dir = tmp;
-			current_blk_nr = dir->blk_nr();
+		cache.with_sector(dir.info.blk_nr() + i, [&] (char const *data) {
 
-			if (!dir->directory()) {
-				blk_nr      = current_blk_nr;
-				data_length = dir->data_length();
-			}
+			/* directory records never cross sector boundaries */
+			for (size_t offset = 0; offset + TABLE_LENGTH <= Sector_cache::SECTOR_SIZE; ) {
 
-			break;
-		}
+				Directory_record *record = (Directory_record *)(data + offset);
 
-		t = t.next();
+				/* the remainder of the sector is unused */
+				if (!record->record_length())
+					break;
+
+				if (record->record_length() < TABLE_LENGTH
+				 || offset + record->record_length() > Sector_cache::SECTOR_SIZE) {
+					error("malformed directory record in block ",
+					      dir.info.blk_nr() + i);
+					break;
+				}
+
+				offset += record->record_length();
+
+				if (record->dot_or_dotdot())
+					continue;
+
+				char name[NAME_LENGTH];
+				record->file_name(name, sizeof(name));
+
+				size_t const name_len = strlen(name);
+				size_t const path_len = dir_len + (dir_len ? 1 : 0) + name_len;
+
+				if (!name_len || path_len >= PATH_LENGTH) {
+					warning("skipping '", Cstring(dir.name()), "/", Cstring(name),
+					        "', path exceeds ", (int)PATH_LENGTH - 1, " characters");
+					continue;
+				}
+
+				char path[PATH_LENGTH];
+				memcpy(path, dir.name(), dir_len);
+				if (dir_len)
+					path[dir_len] = '/';
+				copy_cstring(path + path_len - name_len, name, name_len + 1);
+
+				if (_tree.first() && _tree.first()->find_by_name(path)) {
+					warning("skipping duplicate entry '", Cstring(path), "'");
+					continue;
+				}
+
+				_insert(path, File_info(record->blk_nr(), record->data_length()),
+				        record->directory());
+			}
+		});
 	}
+}
 
-	/* Warning: Don't access 'dir' after this point, since the sector is gone */
 
-	if (!blk_nr && !data_length) {
-		Genode::error("file not found: ", Genode::Cstring(path));
-		throw File_not_found();
+Iso::Directory_index::Directory_index(Allocator &alloc, Sector_cache &cache)
+:
+	_alloc(alloc)
+{
+	_insert("", root_dir(cache), true);
+
+	/*
+	 * Directories are appended to the list of entries while scanning, which
+	 * traverses the directory tree breadth first.
+	 */
+	try {
+		for (Entry *entry = _first; entry; entry = entry->next)
+			if (entry->directory)
+				_scan(cache, *entry);
+	}
+	catch (...) {
+		_free_entries();
+		throw;
 	}
 
-	return new (alloc) File_info(blk_nr, data_length);
+	log("indexed ", _num_files, " files in ", _num_dirs, " directories");
 }
 
 
-unsigned long Iso::read_file(Block::Connection<> &block, File_info *info,
-                             off_t file_offset, uint32_t length, void *buf_ptr)
+void Iso::Directory_index::_free_entries()
 {
-	uint8_t *buf = (uint8_t *)buf_ptr;
-	if (info->size() <= (size_t)(length + file_offset))
-		length = info->size() - file_offset - 1;
+	while (Entry *entry = _first) {
+		_first = entry->next;
+		size_t const size = Entry::size(entry->name());
+		entry->~Entry();
+		_alloc.free(entry, size);
+	}
+	_last = nullptr;
+}
 
-	unsigned long total_blk_count = ((length + (Sector::blk_size() - 1)) &
-	                                 ~((Sector::blk_size()) - 1)) / Sector::blk_size();
-	unsigned long ret = total_blk_count;
-	unsigned long blk_count;
-	unsigned long blk_nr = info->blk_nr() + (file_offset / Sector::blk_size());
 
-	while ((blk_count = min<unsigned long>(Sector::MAX_SECTORS, total_blk_count))) {
-		Sector sec(block, blk_nr, blk_count);
+Iso::Directory_index::~Directory_index() { _free_entries(); }
 
-		total_blk_count -= blk_count;
-		blk_nr          += blk_count;
 
-		unsigned long copy_length = blk_count * Sector::blk_size();
-		memcpy(buf, sec.addr<void *>(), copy_length);
+Iso::File_info const &Iso::Directory_index::lookup(char const *path)
+{
+	struct Scanner_policy_file
+	{
+		static bool identifier_char(char c, unsigned /* i */)
+		{
+			return c != '/' && c != 0;
+		}
+	};
+	typedef ::Genode::Token<Scanner_policy_file> Token;
+
+	/* normalize path by joining its elements with single slashes */
+	char   normalized[PATH_LENGTH];
+	size_t len = 0;
+
+	for (Token t(path); t; t = t.next()) {
 
-		length -= copy_length;
-		buf    += copy_length;
+		if (t.type() != Token::IDENT)
+			continue;
+
+		if (len + (len ? 1 : 0) + t.len() >= PATH_LENGTH)
+			throw File_not_found();
 
-		/* zero out rest of page */
-		if (!total_blk_count && (blk_count % 2))
-			memset(buf, 0, Sector::blk_size());
+		if (len)
+			normalized[len++] = '/';
+
+		memcpy(normalized + len, t.start(), t.len());
+		len += t.len();
 	}
+	normalized[len] = 0;
+
+	Avl_string_base *node = _tree.first() ? _tree.first()->find_by_name(normalized)
+	                                      : nullptr;
+
+	Entry const *entry = static_cast<Entry const *>(node);
+
+	if (!entry || entry->directory) {
+		error("file not found: ", Cstring(path));
+		throw File_not_found();
+	}
+
+	return entry->info;
+}
+
+
+/*******************
+ ** Iso interface **
+ *******************/
+
+unsigned long Iso::read_file(Sector_cache &cache, File_info const &info,
+                             off_t file_offset, uint32_t length, void *buf)
+{
+	if (file_offset < 0 || (size_t)file_offset >= info.size())
+		return 0;
+
+	length = min((size_t)length, info.size() - file_offset);
+
+	size_t const sector_size = Sector_cache::SECTOR_SIZE;
+
+	cache.read(info.blk_nr() + file_offset / sector_size,
+	           (length + sector_size - 1) / sector_size, buf);
 
-	return ret * Sector::blk_size();
+	return length;
 }
@@ -11,9 +11,13 @@
  * under the terms of the GNU Affero General Public License version 3.
  */
 
+#ifndef _ISO9660_H_
+#define _ISO9660_H_
+
 /* Genode includes */
 #include <base/stdint.h>
 #include <block_session/connection.h>
+#include <util/avl_string.h>
 
 namespace Iso {
 
@@ -46,44 +50,96 @@ namespace Iso {
 			File_info(Genode::uint32_t blk_nr, Genode::size_t size)
 			: _blk_nr(blk_nr), _size(size) {}
 
-			Genode::uint32_t blk_nr() { return _blk_nr; }
-			Genode::size_t   size()   { return _size;   }
-			Genode::size_t   page_sized() { return (_size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1); }
+			Genode::uint32_t blk_nr()     const { return _blk_nr; }
+			Genode::size_t   size()       const { return _size;   }
+			Genode::size_t   page_sized() const { return (_size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1); }
 	};
 
 
+	class Sector_cache;
+	class Directory_index;
+
+
 	/*******************
 	 ** Iso interface **
 	 *******************/
 
-	/**
-	 * Retrieve file information
-	 *
-	 * \param alloc allocator used for File_info object
-	 * \param block Block session used to read sectors from ISO
-	 * \param path  absolute path of the file (slash separated)
-	 *
-	 * \throw File_not_found
-	 * \throw Io_error
-	 * \throw Non_data_disc
-	 *
-	 * \return Pointer to File_info class
-	 */
-	File_info *file_info(Genode::Allocator &alloc, Block::Connection<> &block, char const *path);
-
 	/**
 	 * Read data from ISO
 	 *
-	 * \param block Block session used to read sectors from ISO
-	 * \param info File    Info of file to read the data from
-	 * \param file_offset  Offset in file
-	 * \param length       Number of bytes to read
-	 * \param buf          Output buffer
+	 * \param cache        sector cache used to access the block device
+	 * \param info         info of file to read the data from
+	 * \param file_offset  offset in file, must be sector aligned
+	 * \param length       number of bytes to read
+	 * \param buf          output buffer, must be large enough to hold the
+	 *                     sectors containing the requested bytes
 	 *
 	 * \throw Io_error
 	 *
 	 * \return Number of bytes read
 	 */
-	unsigned long read_file(Block::Connection<> &block, File_info *info, Genode::off_t file_offset,
-	                        Genode::uint32_t length, void *buf);
+	unsigned long read_file(Sector_cache &cache, File_info const &info,
+	                        Genode::off_t file_offset, Genode::uint32_t length,
+	                        void *buf);
 } /* namespace Iso */
+
+
+/**
+ * Index of all files of the file system
+ *
+ * The index is built once when the file system is mounted by walking the
+ * directory tree from the root directory. Afterwards, files are looked up
+ * without accessing the block device.
+ */
+class Iso::Directory_index
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Directory_index(Directory_index const &);
+		Directory_index &operator = (Directory_index const &);
+
+		class Entry;
+
+		Genode::Allocator &_alloc;
+
+		Genode::Avl_tree<Genode::Avl_string_base> _tree { };
+
+		/* all entries in the order of their creation */
+		Entry *_first = nullptr;
+		Entry *_last  = nullptr;
+
+		unsigned _num_files = 0;
+		unsigned _num_dirs  = 0;
+
+		Entry &_insert(char const *path, File_info const &info, bool directory);
+
+		void _scan(Sector_cache &, Entry &dir);
+
+		void _free_entries();
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Io_error
+		 * \throw Non_data_disc
+		 */
+		Directory_index(Genode::Allocator &alloc, Sector_cache &cache);
+
+		~Directory_index();
+
+		/**
+		 * Retrieve file information
+		 *
+		 * \param path  path of the file, slash separated
+		 *
+		 * \throw File_not_found
+		 */
+		File_info const &lookup(char const *path);
+};
+
+#endif /* _ISO9660_H_ */
@@ -18,7 +18,7 @@
 #include <base/rpc_server.h>
 #include <dataspace/client.h>
 #include <root/component.h>
-#include <util/avl_string.h>
+#include <util/avl_tree.h>
 #include <base/attached_ram_dataspace.h>
 #include <base/session_label.h>
 #include <block_session/connection.h>
@@ -26,6 +26,7 @@
 
 /* local includes */
 #include "iso9660.h"
+#include "sector_cache.h"
 
 using namespace Genode;
 
@@ -36,12 +37,11 @@ using namespace Genode;
 
 namespace Iso {
 
-	typedef Avl_string<PATH_LENGTH> File_base;
-	typedef Avl_tree<Avl_string_base> File_cache;
-
 	class File;
 	class Rom_component;
 
+	typedef Genode::Avl_tree<File> File_cache;
+
 	typedef Genode::Root_component<Rom_component> Root_component;
 
 
@@ -51,8 +51,12 @@ namespace Iso {
 
 /**
  * File abstraction
+ *
+ * A file is read from the block device when it is requested for the first
+ * time. Its dataspace is shared by all ROM sessions referring to the file's
+ * extent, regardless of the path used to request it.
  */
-class Iso::File : public File_base
+class Iso::File : public Genode::Avl_node<File>
 {
 	private:
 
@@ -62,26 +66,38 @@ class Iso::File : public File_base
 		File(File const &);
 		File &operator = (File const &);
 
-		Genode::Allocator        &_alloc;
+		File_info const        &_info;
+		Attached_ram_dataspace  _ds;
 
-		File_info                *_info;
-		Attached_ram_dataspace    _ds;
+		static uint64_t _key(File_info const &info) {
+			return ((uint64_t)info.blk_nr() << 32) | (uint32_t)info.size(); }
 
 	public:
 
-		File(Genode::Env &env, Genode::Allocator &alloc,
-		     Block::Connection<> &block, char const *path)
+		File(Genode::Env &env, Sector_cache &sectors, File_info const &info)
 		:
-			File_base(path), _alloc(alloc),
-			_info(Iso::file_info(_alloc, block, path)),
-			_ds(env.ram(), env.rm(), align_addr(_info->page_sized(), 12))
+			_info(info),
+			_ds(env.ram(), env.rm(), max(_info.page_sized(), (size_t)PAGE_SIZE))
 		{
-			Iso::read_file(block, _info, 0, _ds.size(), _ds.local_addr<void>());
+			Iso::read_file(sectors, _info, 0, _info.size(), _ds.local_addr<void>());
 		}
-		
-		~File() { destroy(_alloc, _info); }
 
 		Dataspace_capability dataspace() { return _ds.cap(); }
+
+		/************************
+		 ** Avl node interface **
+		 ************************/
+
+		bool higher(File *f) { return _key(f->_info) > _key(_info); }
+
+		File *find(File_info const &info)
+		{
+			if (_key(info) == _key(_info))
+				return this;
+
+			File *f = Avl_node<File>::child(_key(info) > _key(_info));
+			return f ? f->find(info) : nullptr;
+		}
 };
 
 
@@ -97,11 +113,9 @@ class Iso::Rom_component : public Genode::Rpc_object<Rom_session>
 
 		File *_file = nullptr;
 
-		File *_lookup(File_cache &cache, char const *path)
+		File *_lookup(File_cache &cache, File_info const &info)
 		{
-			return static_cast<File *>(cache.first() ?
-			                           cache.first()->find_by_name(path) :
-			                           0);
+			return cache.first() ? cache.first()->find(info) : nullptr;
 		}
 
 	public:
@@ -112,15 +126,17 @@ class Iso::Rom_component : public Genode::Rpc_object<Rom_session>
 		void sigh(Signal_context_capability) override { }
 
 		Rom_component(Genode::Env &env, Genode::Allocator &alloc,
-		              File_cache &cache, Block::Connection<> &block,
-		              char const *path)
+		              File_cache &cache, Directory_index &index,
+		              Sector_cache &sectors, char const *path)
 		{
-			if ((_file = _lookup(cache, path))) {
+			File_info const &info = index.lookup(path);
+
+			if ((_file = _lookup(cache, info))) {
 				Genode::log("cache hit for file ", Genode::Cstring(path));
 				return;
 			}
 
-			_file = new (alloc) File(env, alloc, block, path);
+			_file = new (alloc) File(env, sectors, info);
 			Genode::log("request for file ", Genode::Cstring(path));
 
 			cache.insert(_file);
@@ -135,8 +151,14 @@ class Iso::Root : public Iso::Root_component
 		Genode::Env       &_env;
 		Genode::Allocator &_alloc;
 
+		/* leave room for several block requests in flight */
+		enum { TX_BUF_SIZE = 512*1024 };
+
 		Allocator_avl       _block_alloc { &_alloc };
-		Block::Connection<> _block       { _env, &_block_alloc };
+		Block::Connection<> _block       { _env, &_block_alloc, TX_BUF_SIZE };
+
+		Sector_cache    _sectors { _alloc, _block };
+		Directory_index _index   { _alloc, _sectors };
 
 		/*
 		 * Entries in the cache are never freed, even if the ROM session
@@ -152,7 +174,7 @@ class Iso::Root : public Iso::Root_component
 		{
 			size_t ram_quota =
 				Arg_string::find_arg(args, "ram_quota").ulong_value(0);
-			size_t session_size =  sizeof(Rom_component) + sizeof(File_info);
+			size_t session_size =  sizeof(Rom_component);
 			if (ram_quota < session_size)
 				throw Insufficient_ram_quota();
 
@@ -163,15 +185,21 @@ class Iso::Root : public Iso::Root_component
 				Genode::log("Request for file ", Cstring(_path), " len ", strlen(_path));
 
 			try {
-				return new (_alloc) Rom_component(_env, _alloc, _cache, _block, _path);
+				return new (_alloc) Rom_component(_env, _alloc, _cache, _index,
+				                                  _sectors, _path);
 			}
 			catch (Io_error)       { throw Service_denied(); }
-			catch (Non_data_disc)  { throw Service_denied(); }
 			catch (File_not_found) { throw Service_denied(); }
 		}
 
 	public:
 
+		/**
+		 * Constructor
+		 *
+		 * The directory index is built when the file system is mounted,
+		 * before the service is announced.
+		 */
 		Root(Genode::Env &env, Allocator &alloc)
 		:
 			Root_component(&env.ep().rpc_ep(), &alloc),
@@ -0,0 +1,280 @@
+/*
+ * \brief  Cache of ISO sectors with sequential read-ahead
+ * \author Pirmin Duss
+ * \date   2020-11-02
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _SECTOR_CACHE_H_
+#define _SECTOR_CACHE_H_
+
+/* Genode includes */
+#include <base/allocator.h>
+#include <base/log.h>
+#include <util/misc_math.h>
+
+/* local includes */
+#include "iso9660.h"
+
+
+/**
+ * Access to the sectors of the block device
+ *
+ * Sectors are read and cached in lines of 'LINE_SECTORS' consecutive
+ * sectors. So the volume descriptors and directory extents are obtained by
+ * one block request per line instead of one request per sector. A miss of
+ * the line that follows the line missed last is considered as sequential
+ * access. In this case, the subsequent lines are read ahead by the same
+ * batch of block requests.
+ */
+class Iso::Sector_cache
+{
+	public:
+
+		enum {
+			SECTOR_SIZE      = 2048,
+			LINE_SECTORS     = 16,
+			NUM_LINES        = 64,  /* 2 MiB of cached sectors */
+			READ_AHEAD_LINES = 2,
+
+			/* max. number of sectors per uncached request */
+			MAX_SECTORS      = 32,
+		};
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Sector_cache(Sector_cache const &);
+		Sector_cache &operator = (Sector_cache const &);
+
+		typedef Block::Packet_descriptor Packet_descriptor;
+
+		enum { INVALID = ~0UL };
+
+		struct Line
+		{
+			unsigned long nr;  /* line number, or INVALID */
+			char          data[LINE_SECTORS*SECTOR_SIZE];
+		};
+
+		Genode::Allocator          &_alloc;
+		Block::Connection<>        &_block;
+		Block::Session::Tx::Source &_source = *_block.tx();
+
+		Block::Session::Info const _info = _block.info();
+
+		static Genode::size_t _blocks_per_sector(Block::Session::Info const &info)
+		{
+			if (!info.block_size || info.block_size > SECTOR_SIZE
+			 || SECTOR_SIZE % info.block_size) {
+				Genode::error("unsupported block size ", info.block_size);
+				throw Io_error();
+			}
+			return SECTOR_SIZE / info.block_size;
+		}
+
+		Genode::size_t const _blocks = _blocks_per_sector(_info);
+
+		unsigned long const _num_sectors = _info.block_count / _blocks;
+
+		Line * const _lines = (Line *)_alloc.alloc(NUM_LINES*sizeof(Line));
+
+		unsigned long _last_miss = INVALID;
+
+		Line &_line(unsigned long nr) { return _lines[nr % NUM_LINES]; }
+
+		/**
+		 * Submit request for reading 'count' sectors
+		 *
+		 * \return false if the packet stream cannot take the request
+		 */
+		bool _submit(unsigned long sector, unsigned long count)
+		{
+			if (!_source.ready_to_submit())
+				return false;
+
+			try {
+				_source.submit_packet(
+					Packet_descriptor(_block.alloc_packet(count*SECTOR_SIZE),
+					                  Packet_descriptor::READ,
+					                  sector*_blocks, count*_blocks));
+				return true;
+			}
+			catch (Block::Session::Tx::Source::Packet_alloc_failed) {
+				return false; }
+		}
+
+		/**
+		 * Wait for the completion of a submitted request
+		 *
+		 * The functor is called with the first sector, the number of
+		 * sectors, and the data of the request if it succeeded.
+		 *
+		 * \return false if the request failed
+		 */
+		template <typename FN>
+		bool _complete(FN const &fn)
+		{
+			Packet_descriptor const p = _source.get_acked_packet();
+
+			unsigned long const sector = p.block_number() / _blocks;
+
+			if (p.succeeded())
+				fn(sector, p.block_count() / _blocks,
+				   (char const *)_source.packet_content(p));
+			else
+				Genode::error("could not read sector ", sector);
+
+			_source.release_packet(p);
+			return p.succeeded();
+		}
+
+		/**
+		 * Read sectors by requests of at most 'max' sectors each
+		 *
+		 * The requests are issued in parallel as far as the packet stream
+		 * permits.
+		 *
+		 * \throw Io_error
+		 */
+		template <typename FN>
+		void _read(unsigned long sector, unsigned long count,
+		           unsigned long max, FN const &fn)
+		{
+			unsigned long submitted = 0, pending = 0;
+			bool          ok        = true;
+
+			while (submitted < count || pending) {
+
+				while (ok && submitted < count) {
+					unsigned long const n = Genode::min(max, count - submitted);
+					if (!_submit(sector + submitted, n))
+						break;
+
+					submitted += n;
+					pending++;
+				}
+
+				if (!pending) {
+					if (ok)
+						Genode::error("packet overrun!");
+					throw Io_error();
+				}
+
+				if (!_complete(fn))
+					ok = false;
+
+				pending--;
+			}
+
+			if (!ok)
+				throw Io_error();
+		}
+
+		void _fill(unsigned long nr)
+		{
+			bool const sequential = (_last_miss != INVALID && nr == _last_miss + 1);
+
+			unsigned long const first = nr*LINE_SECTORS;
+
+			/* read ahead up to the next cached line or the end of the device */
+			unsigned long lines = 1;
+			if (sequential)
+				while (lines < 1 + READ_AHEAD_LINES
+				    && (nr + lines)*LINE_SECTORS < _num_sectors
+				    && _line(nr + lines).nr != nr + lines)
+					lines++;
+
+			_last_miss = nr + lines - 1;
+
+			for (unsigned long i = 0; i < lines; i++)
+				_line(nr + i).nr = INVALID;
+
+			_read(first, Genode::min(lines*LINE_SECTORS, _num_sectors - first),
+			      LINE_SECTORS,
+			      [&] (unsigned long sector, unsigned long count, char const *data) {
+				Line &line = _line(sector / LINE_SECTORS);
+				Genode::memcpy(line.data, data, count*SECTOR_SIZE);
+				line.nr = sector / LINE_SECTORS;
+			});
+		}
+
+		void _check_range(unsigned long sector, unsigned long count) const
+		{
+			if (sector < _num_sectors && count <= _num_sectors - sector)
+				return;
+
+			Genode::error("sectors ", sector, "+", count, " out of range");
+			throw Io_error();
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \throw Io_error  block size of the device is not supported
+		 */
+		Sector_cache(Genode::Allocator &alloc, Block::Connection<> &block)
+		:
+			_alloc(alloc), _block(block)
+		{
+			for (unsigned i = 0; i < NUM_LINES; i++)
+				_lines[i].nr = INVALID;
+		}
+
+		~Sector_cache() { _alloc.free(_lines, NUM_LINES*sizeof(Line)); }
+
+		/**
+		 * Call 'fn' with the data of 'sector'
+		 *
+		 * The data is valid during the execution of 'fn' only. The functor
+		 * must not access the cache.
+		 *
+		 * \throw Io_error
+		 */
+		template <typename FN>
+		void with_sector(unsigned long sector, FN const &fn)
+		{
+			_check_range(sector, 1);
+
+			unsigned long const nr = sector / LINE_SECTORS;
+
+			if (_line(nr).nr != nr)
+				_fill(nr);
+
+			fn(_line(nr).data + (sector % LINE_SECTORS)*SECTOR_SIZE);
+		}
+
+		/**
+		 * Read sectors without caching them
+		 *
+		 * Used for file content, which is read only once.
+		 *
+		 * \param dst  buffer of at least 'count*SECTOR_SIZE' bytes
+		 *
+		 * \throw Io_error
+		 */
+		void read(unsigned long sector, unsigned long count, void *dst)
+		{
+			if (!count)
+				return;
+
+			_check_range(sector, count);
+
+			_read(sector, count, MAX_SECTORS,
+			      [&] (unsigned long s, unsigned long n, char const *data) {
+				Genode::memcpy((char *)dst + (s - sector)*SECTOR_SIZE, data,
+				               n*SECTOR_SIZE); });
+		}
+};
+
+#endif /* _SECTOR_CACHE_H_ */
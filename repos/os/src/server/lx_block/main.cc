@@ -12,12 +12,12 @@
  */
 
 /* Genode includes */
+#include <base/attached_ram_dataspace.h>
 #include <base/attached_rom_dataspace.h>
 #include <base/component.h>
-#include <base/heap.h>
 #include <base/log.h>
-#include <block/component.h>
-#include <block/driver.h>
+#include <block/request_stream.h>
+#include <root/root.h>
 #include <util/string.h>
 
 /* libc includes */
@@ -34,11 +34,15 @@ static bool xml_attr_ok(Genode::Xml_node node, char const *attr)
 }
 
 
-class Lx_block_driver : public Block::Driver
+class Lx_block_file
 {
 	private:
 
-		Genode::Env &_env;
+		/*
+		 * Noncopyable
+		 */
+		Lx_block_file(Lx_block_file const &);
+		Lx_block_file &operator = (Lx_block_file const &);
 
 		Block::Session::Info const _info;
 
@@ -80,14 +84,18 @@ class Lx_block_driver : public Block::Driver
 
 		int _fd { -1 };
 
+		bool _in_range(Block::Operation const &op) const
+		{
+			return op.count
+			    && (op.block_number + op.count) <= _info.block_count;
+		}
+
 	public:
 
 		struct Could_not_open_file : Genode::Exception { };
 
-		Lx_block_driver(Genode::Env &env, Genode::Xml_node config)
+		Lx_block_file(Genode::Xml_node config)
 		:
-			Block::Driver(env.ram()),
-			_env(env),
 			_info(_init_info(config))
 		{
 			/* open file */
@@ -104,90 +112,398 @@ class Lx_block_driver : public Block::Driver
 			            "writeable:   ", _info.writeable ? "yes" : "no");
 		}
 
-		~Lx_block_driver() { close(_fd); }
+		~Lx_block_file() { close(_fd); }
 
+		Block::Session::Info info() const { return _info; }
 
-		/*****************************
-		 ** Block::Driver interface **
-		 *****************************/
+		/**
+		 * Return true if the request can be executed
+		 */
+		bool valid(Block::Request const &request, bool writeable) const
+		{
+			using Type = Block::Operation::Type;
 
-		Block::Session::Info info() const override { return _info; }
+			Block::Operation const &op = request.operation;
 
-		void read(Block::sector_t           block_number,
-		          Genode::size_t            block_count,
-		          char                     *buffer,
-		          Block::Packet_descriptor &packet) override
+			switch (op.type) {
+			case Type::READ:  return _in_range(op);
+			case Type::WRITE: return writeable && _in_range(op);
+			case Type::SYNC:  return true;
+			case Type::TRIM:  return true;
+			default:          return false;
+			}
+		}
+
+		/**
+		 * Execute request synchronously
+		 *
+		 * The method is called by the entrypoints of all request queues
+		 * concurrently. It uses positional I/O only and is thereby free
+		 * from shared state.
+		 *
+		 * \return true on success
+		 */
+		bool execute(Block::Request const &request, void *ptr, Genode::size_t size)
 		{
-			off_t  const offset = block_number * _info.block_size;
-			size_t const count  = block_count  * _info.block_size;
+			using Type = Block::Operation::Type;
 
-			ssize_t const n = pread(_fd, buffer, count, offset);
-			if (n == -1) {
-				perror("pread");
-				throw Io_error();
-			}
+			off_t const offset = request.operation.block_number * _info.block_size;
+
+			switch (request.operation.type) {
+
+			case Type::READ:
+				if (pread(_fd, ptr, size, offset) != (ssize_t)size) {
+					perror("pread");
+					return false;
+				}
+				return true;
 
-			ack_packet(packet);
+			case Type::WRITE:
+				if (pwrite(_fd, ptr, size, offset) != (ssize_t)size) {
+					perror("pwrite");
+					return false;
+				}
+				return true;
+
+			case Type::SYNC:
+			case Type::TRIM:
+				return true;
+
+			default:
+				return false;
+			}
 		}
+};
+
+
+/**
+ * Request queue served by an entrypoint
+ *
+ * The first queue of a session is served by the component's entrypoint.
+ * Each additional queue comes with an entrypoint of its own. So the queues
+ * are processed in parallel, each on the CPU it is assigned to.
+ */
+class Lx_block_queue
+{
+	private:
+
+		using Request_stream = Block::Request_stream;
+		using Response       = Request_stream::Response;
+
+		Genode::Env        &_env;
+		Genode::Entrypoint &_ep;
+
+		/* synchronizes the request processing with 'restrict' and 'reset' */
+		Genode::Mutex _mutex { };
+
+		Genode::Reconstructible<Genode::Attached_ram_dataspace> _ds;
+
+		Lx_block_file &_file;
+
+		Block::Session::Info const _info;
+
+		Genode::Signal_handler<Lx_block_queue> _request_handler {
+			_ep, *this, &Lx_block_queue::_handle_requests };
 
-		void write(Block::sector_t           block_number,
-		           Genode::size_t            block_count,
-		           char const               *buffer,
-		           Block::Packet_descriptor &packet) override
+		Genode::Reconstructible<Request_stream> _stream;
+
+		/*
+		 * Executed requests waiting for their acknowledgement
+		 *
+		 * Requests are executed until the array is full, and acknowledged
+		 * in batches as ack slots become available.
+		 */
+		enum { MAX_COMPLETED = 32 };
+
+		Block::Request _completed[MAX_COMPLETED] { };
+
+		unsigned _num_completed = 0;
+		unsigned _num_acked     = 0;
+
+		void _handle_requests()
 		{
-			/* range check is done by Block::Driver */
-			if (!_info.writeable) {
-				throw Io_error();
+			Genode::Mutex::Guard guard(_mutex);
+
+			for (;;) {
+
+				bool progress = false;
+
+				_stream->try_acknowledge([&] (Request_stream::Ack &ack) {
+					if (_num_acked == _num_completed)
+						return;
+
+					ack.submit(_completed[_num_acked++]);
+					progress = true;
+
+					if (_num_acked == _num_completed)
+						_num_acked = _num_completed = 0;
+				});
+
+				_stream->with_requests([&] (Block::Request request) {
+
+					if (_num_completed == MAX_COMPLETED)
+						return Response::RETRY;
+
+					if (!_file.valid(request, _info.writeable))
+						return Response::REJECTED;
+
+					if (Block::Operation::has_payload(request.operation.type))
+						_stream->with_content(request, [&] (void *ptr, Genode::size_t size) {
+							request.success = _file.execute(request, ptr, size); });
+					else
+						request.success = _file.execute(request, nullptr, 0);
+
+					_completed[_num_completed++] = request;
+					progress = true;
+					return Response::ACCEPTED;
+				});
+
+				if (!progress)
+					break;
 			}
 
-			off_t  const offset = block_number * _info.block_size;
-			size_t const count  = block_count  * _info.block_size;
+			_stream->wakeup_client_if_needed();
+		}
+
+	public:
+
+		Lx_block_queue(Genode::Env          &env,
+		               Genode::Entrypoint   &ep,
+		               Genode::size_t        tx_buf_size,
+		               Lx_block_file        &file,
+		               Block::Session::Info  info)
+		:
+			_env(env), _ep(ep),
+			_ds(env.ram(), env.rm(), tx_buf_size),
+			_file(file),
+			_info(info),
+			_stream(env.rm(), _ds->cap(), _ep, _request_handler, _info)
+		{ }
+
+		Genode::Capability<Block::Session::Tx> tx_cap() { return _stream->tx_cap(); }
+
+		/*
+		 * Called by the session's entrypoint while the queue's entrypoint
+		 * may be processing requests, e.g., when revoking the queue.
+		 */
+		bool restrict(Block::Session::Queue_window window)
+		{
+			Genode::Mutex::Guard guard(_mutex);
+			return _stream->restrict(window);
+		}
+
+		/**
+		 * Replace packet stream and bulk buffer by fresh ones
+		 *
+		 * Requests are executed synchronously. So once the mutex is
+		 * acquired, only acknowledgements of the former stream are
+		 * outstanding, which are dropped.
+		 */
+		void reset()
+		{
+			Genode::Mutex::Guard guard(_mutex);
+
+			Genode::size_t const tx_buf_size = _ds->size();
+
+			_stream.destruct();
+			_ds.construct(_env.ram(), _env.rm(), tx_buf_size);
+			_stream.construct(_env.rm(), _ds->cap(), _ep, _request_handler, _info);
+
+			_num_completed = _num_acked = 0;
+		}
+};
+
+
+class Lx_block_session : public Genode::Rpc_object<Block::Session>
+{
+	private:
+
+		enum { QUEUE_EP_STACK_SIZE = 4*1024*sizeof(long) };
+
+		Genode::Entrypoint &_ep;
+
+		Block::Session::Info const _info;
+
+		/* RAM quota donated by the client, covers the queues */
+		Genode::Ram_quota _ram_quota;
+
+		/* entrypoints of the additional queues, queue 0 uses '_ep' */
+		Genode::Constructible<Genode::Entrypoint> _queue_eps[MAX_QUEUES] { };
+
+		Genode::Constructible<Lx_block_queue> _queues[MAX_QUEUES] { };
+
+		unsigned const _num_queues;
+
+	public:
+
+		/**
+		 * Return RAM needed for the queues of a session
+		 *
+		 * Each queue needs its communication buffer. Each additional queue
+		 * needs the stack and thread meta data of its entrypoint.
+		 */
+		static Genode::size_t queues_ram(Genode::size_t tx_buf_size, unsigned num_queues)
+		{
+			Genode::size_t const ep_ram = QUEUE_EP_STACK_SIZE + 4096;
+
+			return num_queues*tx_buf_size + (num_queues - 1)*ep_ram;
+		}
+
+		Lx_block_session(Genode::Env       &env,
+		                 Lx_block_file     &file,
+		                 Genode::size_t     tx_buf_size,
+		                 unsigned           num_queues,
+		                 bool               writeable,
+		                 Genode::Ram_quota  ram_quota)
+		:
+			_ep(env.ep()),
+			_info({ .block_size  = file.info().block_size,
+			        .block_count = file.info().block_count,
+			        .align_log2  = file.info().align_log2,
+			        .writeable   = writeable }),
+			_ram_quota(ram_quota),
+			_num_queues(Genode::max(1u, Genode::min(num_queues, (unsigned)MAX_QUEUES)))
+		{
+			Genode::Affinity::Space space = env.cpu().affinity_space();
+
+			for (unsigned i = 0; i < _num_queues; i++) {
+
+				if (i > 0)
+					_queue_eps[i].construct(env, QUEUE_EP_STACK_SIZE, "queue_ep",
+					                        space.location_of_index(i));
 
-			ssize_t const n = pwrite(_fd, buffer, count, offset);
-			if (n == -1) {
-				perror("pwrite");
-				throw Io_error();
+				Genode::Entrypoint &ep = (i > 0) ? *_queue_eps[i] : _ep;
+
+				_queues[i].construct(env, ep, tx_buf_size, file, _info);
 			}
 
-			ack_packet(packet);
+			_ep.manage(*this);
 		}
 
-		void sync() override { }
+		~Lx_block_session()
+		{
+			_ep.dissolve(*this);
+
+			/* destruct the queues before their entrypoints */
+			for (unsigned i = 0; i < _num_queues; i++)
+				_queues[i].destruct();
+		}
+
+		void upgrade(Genode::Ram_quota ram_quota) {
+			_ram_quota.value += ram_quota.value; }
+
+
+		/*****************************
+		 ** Block session interface **
+		 *****************************/
+
+		Info info() const override { return _info; }
+
+		Genode::Capability<Tx> tx_cap() override { return _queues[0]->tx_cap(); }
+
+		Genode::Capability<Tx> queue_tx_cap(Queue_index index) override
+		{
+			if (index.value >= _num_queues)
+				return Genode::Capability<Tx>();
+
+			return _queues[index.value]->tx_cap();
+		}
+
+		bool restrict_queue(Queue_index index, Queue_window window) override
+		{
+			if (index.value >= _num_queues)
+				return false;
+
+			return _queues[index.value]->restrict(window);
+		}
+
+		bool reset_queue(Queue_index index) override
+		{
+			if (index.value == 0 || index.value >= _num_queues)
+				return false;
+
+			_queues[index.value]->reset();
+			return true;
+		}
 };
 
 
-struct Main
+struct Main : Genode::Rpc_object<Genode::Typed_root<Block::Session>>
 {
-	Genode::Env  &_env;
-	Genode::Heap  _heap { _env.ram(), _env.rm() };
+	Genode::Env &_env;
 
 	Genode::Attached_rom_dataspace _config_rom { _env, "config" };
 
-	struct Factory : Block::Driver_factory
-	{
-		Genode::Constructible<Lx_block_driver> _driver { };
+	Lx_block_file _file { _config_rom.xml() };
 
-		Factory(Genode::Env &env, Genode::Xml_node config)
-		{
-			_driver.construct(env, config);
+	bool const _writeable = xml_attr_ok(_config_rom.xml(), "writeable");
+
+	Genode::Constructible<Lx_block_session> _session { };
+
+
+	/********************
+	 ** Root interface **
+	 ********************/
+
+	Genode::Capability<Genode::Session>
+	session(Root::Session_args const &args, Genode::Affinity const &) override
+	{
+		using namespace Genode;
+
+		if (_session.constructed())
+			throw Service_denied();
+
+		size_t const ram_quota =
+			Arg_string::find_arg(args.string(), "ram_quota").ulong_value(0);
+		size_t const tx_buf_size =
+			Arg_string::find_arg(args.string(), "tx_buf_size").ulong_value(0);
+		unsigned const num_queues = (unsigned)
+			min(max(Arg_string::find_arg(args.string(), "queues").ulong_value(1), 1UL),
+			    (unsigned long)Block::Session::MAX_QUEUES);
+
+		/* delete ram quota by the memory needed for the session */
+		size_t const session_size = max((size_t)4096, sizeof(Lx_block_session));
+		if (ram_quota < session_size)
+			throw Insufficient_ram_quota();
+
+		/*
+		 * Check if donated ram quota suffices for the communication
+		 * buffers and the entrypoints of all queues.
+		 */
+		if (!tx_buf_size || tx_buf_size > (ram_quota - session_size) / num_queues
+		 || Lx_block_session::queues_ram(tx_buf_size, num_queues) > ram_quota - session_size) {
+			error("insufficient 'ram_quota', got ", ram_quota, ", need ",
+			      Lx_block_session::queues_ram(tx_buf_size, num_queues) + session_size);
+			throw Insufficient_ram_quota();
 		}
 
-		~Factory() { _driver.destruct(); }
+		bool const writeable = _writeable
+			? Arg_string::find_arg(args.string(), "writeable").bool_value(true)
+			: false;
 
-		/***********************
-		 ** Factory interface **
-		 ***********************/
+		_session.construct(_env, _file, tx_buf_size, num_queues, writeable,
+		                   Ram_quota { ram_quota });
+		return _session->cap();
+	}
 
-		Block::Driver *create() override { return &*_driver; }
-		void destroy(Block::Driver *) override { }
-	} factory { _env, _config_rom.xml() };
+	void upgrade(Genode::Capability<Genode::Session> cap,
+	             Root::Upgrade_args const &args) override
+	{
+		if (!_session.constructed() || !(cap == _session->cap()))
+			return;
 
-	Block::Root root { _env.ep(), _heap, _env.rm(), factory,
-	                   xml_attr_ok(_config_rom.xml(), "writeable") };
+		_session->upgrade(Genode::ram_quota_from_args(args.string()));
+	}
+
+	void close(Genode::Capability<Genode::Session> cap) override
+	{
+		if (_session.constructed() && cap == _session->cap())
+			_session.destruct();
+	}
 
 	Main(Genode::Env &env) : _env(env)
 	{
-		_env.parent().announce(_env.ep().manage(root));
+		_env.parent().announce(_env.ep().manage(*this));
 	}
 };
 
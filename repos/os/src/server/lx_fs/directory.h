@@ -50,6 +50,59 @@ class Lx_fs::Directory : public Node
 		Path       _path;
 		Allocator &_alloc;
 
+		/**
+		 * Snapshot of the converted directory entries
+		 *
+		 * The snapshot turns the lookup of an entry by its index into an
+		 * array access instead of re-scanning the host directory for each
+		 * 'read'. It is tagged with the inode and the modification and
+		 * status-change times of the host directory and re-created whenever
+		 * those change. The permissions of the entries are not covered by
+		 * the directory's times and are therefore looked up at each 'read'.
+		 */
+		struct Snapshot
+		{
+			/*
+			 * Noncopyable
+			 */
+			Snapshot(Snapshot const &);
+			Snapshot &operator = (Snapshot const &);
+
+			Allocator       &_alloc;
+			ino_t     const  inode;
+			timespec  const  mtime;
+			timespec  const  ctime;
+			size_t    const  capacity;
+			size_t           num_entries = 0;
+			Directory_entry *entries;
+
+			Snapshot(Allocator &alloc, struct stat const &st, size_t capacity)
+			:
+				_alloc(alloc), inode(st.st_ino), mtime(st.st_mtim),
+				ctime(st.st_ctim),
+				capacity(capacity),
+				entries(capacity ? (Directory_entry *)alloc.alloc(capacity*sizeof(Directory_entry))
+				                 : nullptr)
+			{ }
+
+			~Snapshot()
+			{
+				if (entries)
+					_alloc.free(entries, capacity*sizeof(Directory_entry));
+			}
+
+			bool up_to_date(struct stat const &st) const
+			{
+				return st.st_ino == inode
+				    && st.st_mtim.tv_sec  == mtime.tv_sec
+				    && st.st_mtim.tv_nsec == mtime.tv_nsec
+				    && st.st_ctim.tv_sec  == ctime.tv_sec
+				    && st.st_ctim.tv_nsec == ctime.tv_nsec;
+			}
+		};
+
+		Constructible<Snapshot> _snapshot { };
+
 		unsigned long _inode(char const *path, bool create)
 		{
 			int ret;
@@ -97,6 +150,74 @@ class Lx_fs::Directory : public Node
 			return num;
 		}
 
+		Node_rwx _rwx(char const *name) const
+		{
+			Path dent_path(name, _path.base());
+
+			struct stat st { };
+			lstat(dent_path.base(), &st);
+
+			return { .readable   = (st.st_mode & S_IRUSR),
+			         .writeable  = (st.st_mode & S_IWUSR),
+			         .executable = (st.st_mode & S_IXUSR) };
+		}
+
+		Directory_entry _directory_entry(struct dirent const &dent)
+		{
+			auto type = [] (unsigned char type)
+			{
+				switch (type) {
+				case DT_REG: return Node_type::CONTINUOUS_FILE;
+				case DT_DIR: return Node_type::DIRECTORY;
+				case DT_LNK: return Node_type::SYMLINK;
+				default:     return Node_type::CONTINUOUS_FILE;
+				}
+			};
+
+			return {
+				.inode = (unsigned long)dent.d_ino,
+				.type  = type(dent.d_type),
+				.rwx   = _rwx(dent.d_name),
+				.name  = { dent.d_name }
+			};
+		}
+
+		/**
+		 * Call 'fn' with an up-to-date snapshot of the directory entries
+		 *
+		 * If the state of the host directory cannot be obtained, the
+		 * snapshot is used for this call only.
+		 */
+		template <typename FN>
+		void _with_snapshot(FN const &fn)
+		{
+			struct stat st { };
+			bool const valid = (fstat(dirfd(_fd), &st) == 0);
+
+			if (_snapshot.constructed() && (!valid || !_snapshot->up_to_date(st)))
+				_snapshot.destruct();
+
+			if (!_snapshot.constructed()) {
+
+				_snapshot.construct(_alloc, st, _num_entries());
+
+				/* the directory may have changed since it was counted */
+				rewinddir(_fd);
+				Snapshot &snapshot = *_snapshot;
+				while (snapshot.num_entries < snapshot.capacity) {
+					struct dirent const *dent = readdir(_fd);
+					if (!dent)
+						break;
+					snapshot.entries[snapshot.num_entries++] = _directory_entry(*dent);
+				}
+			}
+
+			fn(*_snapshot);
+
+			if (!valid)
+				_snapshot.destruct();
+		}
+
 	public:
 
 		Directory(Allocator &alloc, char const *path, bool create)
@@ -191,44 +312,25 @@ class Lx_fs::Directory : public Node
 				return 0;
 			}
 
-			seek_off_t index = seek_offset / sizeof(Directory_entry);
-
-			/* seek to index and read entry */
-			struct dirent *dent;
-			rewinddir(_fd);
-			for (unsigned i = 0; i <= index; ++i) {
-				dent = readdir(_fd);
-			}
+			size_t const index = seek_offset / sizeof(Directory_entry);
 
-			if (!dent)
-				return 0;
+			/* copy as many entries as fit into the buffer */
+			size_t count = 0;
+			_with_snapshot([&] (Snapshot const &snapshot) {
+				if (index >= snapshot.num_entries)
+					return;
 
-			Path dent_path(dent->d_name, _path.base());
+				count = min(len / sizeof(Directory_entry),
+				            snapshot.num_entries - index);
 
-			struct stat st { };
-			lstat(dent_path.base(), &st);
-
-			auto type = [] (unsigned char type)
-			{
-				switch (type) {
-				case DT_REG: return Node_type::CONTINUOUS_FILE;
-				case DT_DIR: return Node_type::DIRECTORY;
-				case DT_LNK: return Node_type::SYMLINK;
-				default:     return Node_type::CONTINUOUS_FILE;
+				Directory_entry *entries = (Directory_entry *)dst;
+				for (size_t i = 0; i < count; i++) {
+					entries[i]     = snapshot.entries[index + i];
+					entries[i].rwx = _rwx(entries[i].name.buf);
 				}
-			};
-
-			Directory_entry &e = *(Directory_entry *)(dst);
-			e = {
-				.inode = (unsigned long)dent->d_ino,
-				.type  = type(dent->d_type),
-				.rwx   = { .readable   = (st.st_mode & S_IRUSR),
-				           .writeable  = (st.st_mode & S_IWUSR),
-				           .executable = (st.st_mode & S_IXUSR) },
-				.name  = { dent->d_name }
-			};
+			});
 
-			return sizeof(Directory_entry);
+			return count*sizeof(Directory_entry);
 		}
 
 		size_t write(char const *, size_t, seek_off_t) override
@@ -251,8 +353,12 @@ class Lx_fs::Directory : public Node
 			if (fd == -1 || fstat(fd, &st) < 0)
 				st.st_mtime = 0;
 
+			size_t num_entries = 0;
+			_with_snapshot([&] (Snapshot const &snapshot) {
+				num_entries = snapshot.num_entries; });
+
 			return {
-				.size  = _num_entries() * sizeof(File_system::Directory_entry),
+				.size  = num_entries * sizeof(File_system::Directory_entry),
 				.type  = Node_type::DIRECTORY,
 				.rwx   = { .readable   = (st.st_mode & S_IRUSR),
 				           .writeable  = (st.st_mode & S_IWUSR),
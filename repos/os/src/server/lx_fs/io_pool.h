@@ -0,0 +1,340 @@
+/*
+ * \brief  Pool of worker threads for executing file I/O
+ * \author Pirmin Duss
+ * \date   2020-10-19
+ */
+
+/*
+ * Copyright (C) 2020 Genode Labs GmbH
+ *
+ * This file is part of the Genode OS framework, which is distributed
+ * under the terms of the GNU Affero General Public License version 3.
+ */
+
+#ifndef _IO_POOL_H_
+#define _IO_POOL_H_
+
+/* Genode includes */
+#include <base/env.h>
+#include <base/thread.h>
+#include <base/mutex.h>
+#include <base/semaphore.h>
+#include <util/reconstructible.h>
+#include <file_system_session/file_system_session.h>
+
+/* local includes */
+#include <file.h>
+
+
+namespace Lx_fs {
+	using namespace File_system;
+	using File_system::Packet_descriptor;
+	class Io_pool;
+}
+
+
+/**
+ * Execute READ and WRITE packets of a session concurrently
+ *
+ * The blocking host 'pread' and 'pwrite' calls are issued by a set of
+ * worker threads. This way, multiple packets of a session are in flight
+ * at the same time. Once a job is complete, the worker triggers the
+ * packet-stream signal handler of the session, which delivers the
+ * acknowledgement from the context of the entrypoint.
+ */
+class Lx_fs::Io_pool
+{
+	public:
+
+		enum { MAX_WORKERS = 16, MAX_JOBS = 64 };
+
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Io_pool(Io_pool const &);
+		Io_pool &operator = (Io_pool const &);
+
+		struct Job
+		{
+			enum class State { FREE, PENDING, IN_PROGRESS, COMPLETE };
+
+			State             state   = State::FREE;
+			Packet_descriptor packet  { };
+			File             *file    = nullptr;
+			char             *payload = nullptr;
+			size_t            result  = 0;
+
+			bool in_flight() const {
+				return state == State::PENDING || state == State::IN_PROGRESS; }
+
+			void execute()
+			{
+				switch (packet.operation()) {
+
+				case Packet_descriptor::READ:
+					result = file->read(payload, packet.length(), packet.position());
+					break;
+
+				case Packet_descriptor::WRITE:
+					result = file->write(payload, packet.length(), packet.position());
+					break;
+
+				default:
+					result = 0;
+					break;
+				}
+			}
+		};
+
+		struct Worker : Genode::Thread
+		{
+			Io_pool &_pool;
+
+			Worker(Genode::Env &env, Io_pool &pool)
+			:
+				Genode::Thread(env, "io_worker", 8*1024*sizeof(long)),
+				_pool(pool)
+			{
+				start();
+			}
+
+			void entry() override { _pool._work(); }
+		};
+
+		Genode::Mutex     _mutex   { };
+		Genode::Semaphore _pending { };
+
+		/* used by 'wait_for_jobs' to block for the completion of a job */
+		Genode::Semaphore _completion { };
+		bool              _completion_waiter = false;
+
+		Genode::Signal_context_capability const _completion_sigh;
+
+		Job _jobs[MAX_JOBS] { };
+
+		bool _exit = false;
+
+		unsigned const _num_workers;
+
+		Genode::Constructible<Worker> _workers[MAX_WORKERS] { };
+
+		static bool _same_handle(Packet_descriptor const &a, Packet_descriptor const &b)
+		{
+			return a.handle().value == b.handle().value;
+		}
+
+		template <typename FN>
+		bool _any_job(FN const &fn)
+		{
+			for (unsigned i = 0; i < MAX_JOBS; i++)
+				if (fn(_jobs[i]))
+					return true;
+			return false;
+		}
+
+		Job *_pending_job()
+		{
+			for (unsigned i = 0; i < MAX_JOBS; i++)
+				if (_jobs[i].state == Job::State::PENDING)
+					return &_jobs[i];
+			return nullptr;
+		}
+
+		void _work()
+		{
+			for (;;) {
+
+				_pending.down();
+
+				Job *job = nullptr;
+				{
+					Genode::Mutex::Guard guard(_mutex);
+
+					if (_exit)
+						return;
+
+					job = _pending_job();
+					if (!job)
+						continue;
+
+					job->state = Job::State::IN_PROGRESS;
+				}
+
+				job->execute();
+
+				{
+					Genode::Mutex::Guard guard(_mutex);
+
+					job->state = Job::State::COMPLETE;
+
+					if (_completion_waiter) {
+						_completion_waiter = false;
+						_completion.up();
+					}
+				}
+
+				Genode::Signal_transmitter(_completion_sigh).submit();
+			}
+		}
+
+		/**
+		 * Block until no job matching the condition is in flight
+		 */
+		template <typename COND_FN>
+		void _wait_for_jobs(COND_FN const &cond_fn)
+		{
+			for (;;) {
+				{
+					Genode::Mutex::Guard guard(_mutex);
+
+					bool const in_flight = _any_job([&] (Job const &job) {
+						return job.in_flight() && cond_fn(job); });
+
+					if (!in_flight)
+						return;
+
+					_completion_waiter = true;
+				}
+				_completion.down();
+			}
+		}
+
+	public:
+
+		/**
+		 * Constructor
+		 *
+		 * \param num_workers      number of worker threads, a value of 0
+		 *                         disables the pool
+		 * \param completion_sigh  signal handler triggered whenever a job
+		 *                         is complete
+		 */
+		Io_pool(Genode::Env &env, unsigned num_workers,
+		        Genode::Signal_context_capability completion_sigh)
+		:
+			_completion_sigh(completion_sigh),
+			_num_workers(Genode::min(num_workers, (unsigned)MAX_WORKERS))
+		{
+			for (unsigned i = 0; i < _num_workers; i++)
+				_workers[i].construct(env, *this);
+		}
+
+		~Io_pool()
+		{
+			{
+				Genode::Mutex::Guard guard(_mutex);
+				_exit = true;
+			}
+
+			for (unsigned i = 0; i < _num_workers; i++)
+				_pending.up();
+
+			for (unsigned i = 0; i < _num_workers; i++) {
+				_workers[i]->join();
+				_workers[i].destruct();
+			}
+		}
+
+		bool enabled() const { return _num_workers > 0; }
+
+		/**
+		 * Return true if 'packet' must not be processed before the
+		 * outstanding jobs of the same handle are acknowledged
+		 *
+		 * Reads of the same handle may be executed concurrently. All other
+		 * operations are executed in the order of submission.
+		 */
+		bool conflicts(Packet_descriptor const &packet)
+		{
+			Genode::Mutex::Guard guard(_mutex);
+
+			return _any_job([&] (Job const &job) {
+				return job.state != Job::State::FREE
+				    && _same_handle(job.packet, packet)
+				    && (job.packet.operation() != Packet_descriptor::READ
+				     || packet.operation()     != Packet_descriptor::READ); });
+		}
+
+		/**
+		 * Submit READ or WRITE packet for the execution by a worker
+		 *
+		 * \return false if no job slot is available
+		 */
+		bool try_submit(Packet_descriptor const &packet, File &file, char *payload)
+		{
+			{
+				Genode::Mutex::Guard guard(_mutex);
+
+				Job *free_job = nullptr;
+				_any_job([&] (Job &job) {
+					if (job.state != Job::State::FREE)
+						return false;
+					free_job = &job;
+					return true;
+				});
+
+				if (!free_job)
+					return false;
+
+				*free_job = Job { .state   = Job::State::PENDING,
+				                  .packet  = packet,
+				                  .file    = &file,
+				                  .payload = payload,
+				                  .result  = 0 };
+			}
+			_pending.up();
+			return true;
+		}
+
+		/**
+		 * Apply 'fn' to each completed job
+		 *
+		 * The functor is called with the packet descriptor and the number
+		 * of transferred bytes as arguments. It returns true if the job
+		 * was consumed. If it returns false, the iteration stops and the
+		 * job is retained for a later call.
+		 */
+		template <typename FN>
+		void for_each_completed_job(FN const &fn)
+		{
+			for (unsigned i = 0; i < MAX_JOBS; i++) {
+
+				Packet_descriptor packet { };
+				size_t            result = 0;
+				{
+					Genode::Mutex::Guard guard(_mutex);
+
+					Job &job = _jobs[i];
+					if (job.state != Job::State::COMPLETE)
+						continue;
+
+					packet = job.packet;
+					result = job.result;
+				}
+
+				if (!fn(packet, result))
+					return;
+
+				Genode::Mutex::Guard guard(_mutex);
+				_jobs[i].state = Job::State::FREE;
+			}
+		}
+
+		/**
+		 * Block until all jobs of the specified handle are executed
+		 */
+		void wait_for_handle(Node_handle handle)
+		{
+			_wait_for_jobs([&] (Job const &job) {
+				return job.packet.handle().value == handle.value; });
+		}
+
+		/**
+		 * Block until all jobs are executed
+		 */
+		void wait_for_all() { _wait_for_jobs([&] (Job const &) { return true; }); }
+};
+
+#endif /* _IO_POOL_H_ */
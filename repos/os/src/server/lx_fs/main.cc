@@ -23,6 +23,7 @@
 /* local includes */
 #include <directory.h>
 #include <open_node.h>
+#include <io_pool.h>
 
 namespace Lx_fs {
 
@@ -50,6 +51,8 @@ class Lx_fs::Session_component : public Session_rpc_object
 
 		Signal_handler<Session_component> _process_packet_dispatcher;
 
+		Io_pool _io_pool;
+
 
 		/******************************
 		 ** Packet-stream processing **
@@ -75,8 +78,7 @@ class Lx_fs::Session_component : public Session_rpc_object
 					res_length = open_node.node().read((char *)tx_sink()->packet_content(packet), length,
 					                                   packet.position());
 
-					/* read data or EOF is a success */
-					succeeded = res_length || (packet.position() >= open_node.node().status().size);
+					succeeded = _read_succeeded(packet, open_node, res_length);
 				}
 				break;
 
@@ -86,13 +88,9 @@ class Lx_fs::Session_component : public Session_rpc_object
 					                                    length,
 					                                    packet.position());
 
-					/* File system session can't handle partial writes */
-					if (res_length != length) {
-						Genode::error("partial write detected ",
-						              res_length, " vs ", length);
-						/* don't acknowledge */
+					if (!_write_succeeded(packet, res_length))
 						return;
-					}
+
 					succeeded = true;
 				}
 				break;
@@ -133,6 +131,95 @@ class Lx_fs::Session_component : public Session_rpc_object
 			tx_sink()->acknowledge_packet(packet);
 		}
 
+		/* read data or EOF is a success */
+		static bool _read_succeeded(Packet_descriptor const &packet,
+		                            Open_node &open_node, size_t res_length)
+		{
+			return res_length || (packet.position() >= open_node.node().status().size);
+		}
+
+		static bool _write_succeeded(Packet_descriptor const &packet, size_t res_length)
+		{
+			/* File system session can't handle partial writes */
+			if (res_length != packet.length()) {
+				Genode::error("partial write detected ",
+				              res_length, " vs ", packet.length());
+				/* don't acknowledge */
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		 * Deliver acknowledgements of jobs completed by the I/O pool
+		 */
+		void _process_completed_jobs()
+		{
+			_io_pool.for_each_completed_job([&] (Packet_descriptor packet,
+			                                     size_t res_length) {
+
+				if (!tx_sink()->ready_to_ack())
+					return false;
+
+				bool succeeded     = false;
+				bool partial_write = false;
+
+				try {
+					_open_node_registry.apply<Open_node>(packet.handle(),
+					                                     [&] (Open_node &open_node) {
+
+						if (packet.operation() == Packet_descriptor::READ)
+							succeeded = _read_succeeded(packet, open_node, res_length);
+						else
+							partial_write = !(succeeded = _write_succeeded(packet, res_length));
+					});
+				}
+				/* handle closed meanwhile, acknowledge as failed */
+				catch (Id_space<File_system::Node>::Unknown_id const &) { }
+
+				/* partial write, don't acknowledge */
+				if (partial_write)
+					return true;
+
+				packet.length(res_length);
+				packet.succeeded(succeeded);
+				tx_sink()->acknowledge_packet(packet);
+				return true;
+			});
+		}
+
+		/**
+		 * Try to hand over READ or WRITE packet of a file to the I/O pool
+		 *
+		 * \return true if the packet was submitted to the I/O pool
+		 */
+		bool _try_submit_to_io_pool(Packet_descriptor const &packet)
+		{
+			bool const io_operation =
+				packet.operation() == Packet_descriptor::READ ||
+				packet.operation() == Packet_descriptor::WRITE;
+
+			if (!io_operation || !tx_sink()->packet_valid(packet)
+			 || (packet.length() > packet.size()))
+				return false;
+
+			bool submitted = false;
+			try {
+				_open_node_registry.apply<Open_node>(packet.handle(),
+				                                     [&] (Open_node &open_node) {
+
+					File *file = dynamic_cast<File *>(&open_node.node());
+					if (!file)
+						return;
+
+					submitted = _io_pool.try_submit(packet, *file,
+					                                tx_sink()->packet_content(packet));
+				});
+			} catch (Id_space<File_system::Node>::Unknown_id const &) { }
+
+			return submitted;
+		}
+
 		void _process_packet()
 		{
 			Packet_descriptor packet = tx_sink()->get_packet();
@@ -158,6 +245,8 @@ class Lx_fs::Session_component : public Session_rpc_object
 		 */
 		void _process_packets()
 		{
+			_process_completed_jobs();
+
 			while (tx_sink()->packet_avail()) {
 
 				/*
@@ -175,6 +264,25 @@ class Lx_fs::Session_component : public Session_rpc_object
 				if (!tx_sink()->ready_to_ack())
 					return;
 
+				if (_io_pool.enabled()) {
+
+					Packet_descriptor const packet = tx_sink()->peek_packet();
+
+					/*
+					 * Keep the packet in the submit queue until the
+					 * outstanding jobs of the same handle are completed.
+					 * The completion of a job triggers the re-execution of
+					 * '_process_packets'.
+					 */
+					if (_io_pool.conflicts(packet))
+						return;
+
+					if (_try_submit_to_io_pool(packet)) {
+						tx_sink()->get_packet();
+						continue;
+					}
+				}
+
 				_process_packet();
 			}
 		}
@@ -199,6 +307,7 @@ class Lx_fs::Session_component : public Session_rpc_object
 		                  Genode::Env &env,
 		                  char const  *root_dir,
 		                  bool         writable,
+		                  unsigned     io_threads,
 		                  Allocator   &md_alloc)
 		:
 			Session_rpc_object(env.ram().alloc(tx_buf_size), env.rm(), env.ep().rpc_ep()),
@@ -206,7 +315,8 @@ class Lx_fs::Session_component : public Session_rpc_object
 			_md_alloc(md_alloc),
 			_root(*new (&_md_alloc) Directory(_md_alloc, root_dir, false)),
 			_writable(writable),
-			_process_packet_dispatcher(env.ep(), *this, &Session_component::_process_packets)
+			_process_packet_dispatcher(env.ep(), *this, &Session_component::_process_packets),
+			_io_pool(env, io_threads, _process_packet_dispatcher)
 		{
 			/*
 			 * Register '_process_packets' dispatch function as signal
@@ -221,6 +331,9 @@ class Lx_fs::Session_component : public Session_rpc_object
 		 */
 		~Session_component()
 		{
+			/* the workers must not access the packet buffer after its release */
+			_io_pool.wait_for_all();
+
 			Dataspace_capability ds = tx_sink()->dataspace();
 			_env.ram().free(static_cap_cast<Ram_dataspace>(ds));
 			destroy(&_md_alloc, &_root);
@@ -306,6 +419,10 @@ class Lx_fs::Session_component : public Session_rpc_object
 
 		void close(Node_handle handle) override
 		{
+			/* acknowledge outstanding jobs before the node vanishes */
+			_io_pool.wait_for_handle(handle);
+			_process_completed_jobs();
+
 			auto close_fn = [&] (Open_node &open_node) {
 				Node &node = open_node.node();
 				destroy(_md_alloc, &open_node);
@@ -321,6 +438,9 @@ class Lx_fs::Session_component : public Session_rpc_object
 
 		Status status(Node_handle node_handle) override
 		{
+			/* reflect the outstanding writes of the handle */
+			_io_pool.wait_for_handle(node_handle);
+
 			auto status_fn = [&] (Open_node &open_node) {
 				return open_node.node().status();
 			};
@@ -347,6 +467,9 @@ class Lx_fs::Session_component : public Session_rpc_object
 			if (!_writable)
 				throw Permission_denied();
 
+			/* don't race with the outstanding jobs of the handle */
+			_io_pool.wait_for_handle(file_handle);
+
 			auto truncate_fn = [&] (Open_node &open_node) {
 				open_node.node().truncate(size);
 			};
@@ -450,6 +573,14 @@ class Lx_fs::Root : public Root_component<Session_component>
 			writeable = policy.attribute_value("writeable", false) &&
 			            writeable_from_args(args);
 
+			/*
+			 * Determine the number of I/O worker threads of the session,
+			 * which can be overridden by the policy.
+			 */
+			unsigned const io_threads =
+				policy.attribute_value("io_threads",
+				                       _config.xml().attribute_value("io_threads", 4U));
+
 			size_t ram_quota =
 				Arg_string::find_arg(args, "ram_quota"  ).ulong_value(0);
 			size_t tx_buf_size =
@@ -473,7 +604,8 @@ class Lx_fs::Root : public Root_component<Session_component>
 
 			try {
 				return new (md_alloc())
-				       Session_component(tx_buf_size, _env, root_dir, writeable, *md_alloc());
+				       Session_component(tx_buf_size, _env, root_dir, writeable,
+				                         io_threads, *md_alloc());
 			}
 			catch (Lookup_failed) {
 				Genode::error("session root directory \"", root, "\" "
@@ -27,6 +27,7 @@
 
 namespace Block {
 	class  Session_component;
+	class  Zero_copy_session;
 	struct Session_handler;
 	struct Dispatch;
 	class  Main;
@@ -68,10 +69,11 @@ struct Block::Job_queue
 
 struct Block::Dispatch : Interface
 {
-	virtual Response submit(long number, Request const &request, addr_t addr) = 0;
+	virtual Response submit(long number, unsigned queue, Request const &request,
+	                        addr_t addr) = 0;
 	virtual void     update() = 0;
 	virtual void     acknowledge_completed(bool all = true, long number = -1) = 0;
-	virtual Response sync(long number, Request const &request) = 0;
+	virtual Response sync(long number, unsigned queue, Request const &request) = 0;
 };
 
 
@@ -105,16 +107,47 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 		long      _number;
 		Dispatch &_dispatcher;
 
+		/*
+		 * Request queues in addition to the primary queue provided by
+		 * the inherited 'Request_stream'
+		 */
+		struct Queue
+		{
+			Attached_ram_dataspace ds;
+			Request_stream         stream;
+
+			Queue(Env &env, size_t buffer_size,
+			      Signal_context_capability sigh, Session::Info info)
+			:
+				ds(env.ram(), env.rm(), buffer_size),
+				stream(env.rm(), ds.cap(), env.ep(), sigh, info)
+			{ }
+		};
+
+		Constructible<Queue> _queues[MAX_QUEUES - 1] { };
+
+		unsigned const _num_queues;
+
+		Request_stream &_stream(unsigned queue)
+		{
+			return (queue == 0) ? *this : _queues[queue - 1]->stream;
+		}
+
 	public:
 
 		bool syncing { false };
 
 		Session_component(Env &env, long number, size_t buffer_size,
-		                  Session::Info info, Dispatch &dispatcher)
+		                  unsigned num_queues, Session::Info info,
+		                  Dispatch &dispatcher)
 		: Session_handler(env, buffer_size),
 		  Request_stream(env.rm(), ds.cap(), env.ep(), request_handler, info),
-		  _number(number), _dispatcher(dispatcher)
+		  _number(number), _dispatcher(dispatcher),
+		  _num_queues(max(1u, min(num_queues, (unsigned)MAX_QUEUES)))
 		{
+			for (unsigned i = 1; i < _num_queues; i++)
+				_queues[i - 1].construct(env, buffer_size, request_handler, info);
+
 			env.ep().manage(*this);
 		}
 
@@ -127,12 +160,23 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 
 		Capability<Tx> tx_cap() override { return Request_stream::tx_cap(); }
 
+		Capability<Tx> queue_tx_cap(Queue_index index) override
+		{
+			if (index.value >= _num_queues)
+				return Capability<Tx>();
+
+			return _stream(index.value).tx_cap();
+		}
+
 		long number() const { return _number; }
 
-		bool acknowledge(Request &request)
+		bool acknowledge(unsigned queue, Request &request)
 		{
+			if (queue >= _num_queues)
+				return true;
+
 			bool progress = false;
-			try_acknowledge([&] (Ack &ack) {
+			_stream(queue).try_acknowledge([&] (Ack &ack) {
 				if (progress) return;
 				ack.submit(request);
 				progress = true;
@@ -143,6 +187,26 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 
 		void handle_requests() override
 		{
+			/*
+			 * The queues are served in turn so that no queue can starve
+			 * the others of jobs.
+			 */
+			for (unsigned queue = 0; queue < _num_queues; queue++)
+				_handle_queue(queue);
+
+			_dispatcher.update();
+
+			/* poke */
+			for (unsigned queue = 0; queue < _num_queues; queue++)
+				_stream(queue).wakeup_client_if_needed();
+		}
+
+	private:
+
+		void _handle_queue(unsigned const queue)
+		{
+			Request_stream &stream = _stream(queue);
+
 			while (true) {
 
 				bool progress = false;
@@ -153,7 +217,7 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 				 */
 				_dispatcher.acknowledge_completed(false, _number);
 
-				with_requests([&] (Request request) {
+				stream.with_requests([&] (Request request) {
 
 					Response response = Response::RETRY;
 
@@ -173,14 +237,15 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 					}
 
 					if (request.operation.type == Operation::Type::SYNC) {
-						response = _dispatcher.sync(_number, request);
+						response = _dispatcher.sync(_number, queue, request);
 						if (response == Response::ACCEPTED) syncing = true;
 						return response;
 					}
 
-					with_payload([&] (Request_stream::Payload const &payload) {
+					stream.with_payload([&] (Request_stream::Payload const &payload) {
 						payload.with_content(request, [&] (void *addr, size_t) {
-							response = _dispatcher.submit(_number, request, addr_t(addr));
+							response = _dispatcher.submit(_number, queue, request,
+							                              addr_t(addr));
 						});
 					});
 
@@ -192,12 +257,42 @@ class Block::Session_component : public Rpc_object<Block::Session>,
 
 				if (progress == false) break;
 			}
+		}
+};
 
-			_dispatcher.update();
 
-			/* poke */
-			wakeup_client_if_needed();
+/**
+ * Session that hands out a queue of the back-end session directly
+ *
+ * The back end restricts the queue to the blocks of the partition. The
+ * client thereby uses the bulk buffer of the back-end session and the
+ * requests bypass the partition server entirely.
+ */
+class Block::Zero_copy_session : public Rpc_object<Block::Session>
+{
+	private:
+
+		Entrypoint     &_ep;
+		Info     const  _info;
+		Capability<Tx>  _tx_cap;
+
+	public:
+
+		/* back-end queue handed out to the client */
+		Session::Queue_index const queue;
+
+		Zero_copy_session(Entrypoint &ep, Info info, Capability<Tx> tx_cap,
+		                  Session::Queue_index queue)
+		: _ep(ep), _info(info), _tx_cap(tx_cap), queue(queue)
+		{
+			_ep.manage(*this);
 		}
+
+		~Zero_copy_session() { _ep.dissolve(*this); }
+
+		Info info() const override { return _info; }
+
+		Capability<Tx> tx_cap() override { return _tx_cap; }
 };
 
 
@@ -219,8 +314,17 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			_config.xml().attribute_value("io_buffer",
 			                              Number_of_bytes(4*1024*1024));
 
+		/*
+		 * Back-end queues in addition to the primary queue, which are
+		 * handed out to clients with a 'zero_copy' policy
+		 */
+		unsigned const _zero_copy_queues =
+			min(_config.xml().attribute_value("zero_copy_queues", 0u),
+			    (unsigned)Session::MAX_QUEUES - 1);
+
 		Allocator_avl           _block_alloc { &_heap };
-		Block_connection        _block    { _env, &_block_alloc, _io_buffer_size };
+		Block_connection        _block    { _env, &_block_alloc, _io_buffer_size,
+		                                    "", 1 + _zero_copy_queues };
 		Io_signal_handler<Main> _io_sigh  { _env.ep(), *this, &Main::_handle_io };
 		Mbr_partition_table     _mbr      { _env, _block, _heap, _reporter };
 		Gpt                     _gpt      { _env, _block, _heap, _reporter };
@@ -228,6 +332,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 		enum { MAX_SESSIONS = 128 };
 		Session_component   *_sessions[MAX_SESSIONS] { };
+		Zero_copy_session   *_zero_copy_sessions[MAX_SESSIONS] { };
 		Job_queue<128>       _job_queue { };
 		Registry<Block::Job> _job_registry { };
 
@@ -270,6 +375,78 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			_wake_up_index = next_index;
 		}
 
+		/*
+		 * State of the zero-copy queues of the back end
+		 *
+		 * A queue serves a single session only. When the session is
+		 * closed, the queue is revoked because the former client still
+		 * possesses the capability of the queue's packet stream. The queue
+		 * becomes available again once the back end replaced its packet
+		 * stream by a fresh one, which may be delayed by requests of the
+		 * former client still in flight.
+		 */
+		enum class Queue_state { NONE, UNUSED, IN_USE, REVOKED };
+
+		Queue_state _zero_copy_queue_state[Session::MAX_QUEUES] { };
+
+		/**
+		 * Try to make revoked back-end queue available again
+		 */
+		void _try_reset_zero_copy_queue(unsigned i)
+		{
+			if (_zero_copy_queue_state[i] == Queue_state::REVOKED
+			 && _block.reset_queue(Session::Queue_index { i }))
+				_zero_copy_queue_state[i] = Queue_state::UNUSED;
+		}
+
+		/**
+		 * Restrict unused back-end queue to the partition
+		 *
+		 * \return index of the queue, or 0 if no queue is available or the
+		 *         back end does not support queue windows
+		 */
+		unsigned _alloc_zero_copy_queue(long number, bool writeable)
+		{
+			Partition const &partition = _partition_table.partition(number);
+
+			Session::Queue_window const window {
+				.first     = partition.lba,
+				.count     = partition.sectors,
+				.writeable = writeable };
+
+			for (unsigned i = 1; i <= _zero_copy_queues; i++) {
+
+				_try_reset_zero_copy_queue(i);
+
+				if (_zero_copy_queue_state[i] != Queue_state::UNUSED)
+					continue;
+
+				if (!_block.restrict_queue(Session::Queue_index { i }, window))
+					continue;
+
+				_zero_copy_queue_state[i] = Queue_state::IN_USE;
+				return i;
+			}
+			return 0;
+		}
+
+		/**
+		 * Revoke access to the blocks via the back-end queue
+		 */
+		void _revoke_zero_copy_queue(Session::Queue_index queue, long number)
+		{
+			Session::Queue_window const empty {
+				.first     = _partition_table.partition(number).lba,
+				.count     = 0,
+				.writeable = false };
+
+			if (!_block.restrict_queue(queue, empty))
+				error("failed to revoke back-end queue ", queue.value);
+
+			_zero_copy_queue_state[queue.value] = Queue_state::REVOKED;
+			_try_reset_zero_copy_queue(queue.value);
+		}
+
 		void _handle_io()
 		{
 			update();
@@ -289,6 +466,9 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 		Main(Env &env) : _env(env)
 		{
+			for (unsigned i = 1; i <= _zero_copy_queues; i++)
+				_zero_copy_queue_state[i] = Queue_state::UNUSED;
+
 			_block.sigh(_io_sigh);
 
 			/* announce at parent */
@@ -305,6 +485,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 		{
 			long num = -1;
 			bool writeable = false;
+			bool zero_copy = false;
 
 			Session_label const label = label_from_args(args.string());
 			try {
@@ -316,6 +497,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				/* sessions are not writeable by default */
 				writeable = policy.attribute_value("writeable", false);
 
+				zero_copy = policy.attribute_value("zero_copy", false);
+
 			} catch (Xml_node::Nonexistent_attribute) {
 				error("policy does not define partition number for for '",
 				      label, "'");
@@ -334,7 +517,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				throw Service_denied();
 			}
 
-			if (num >= MAX_SESSIONS || _sessions[num]) {
+			if (num >= MAX_SESSIONS || _sessions[num] || _zero_copy_sessions[num]) {
 				error("Partition ", num, " already in use or session limit reached for '",
 				      label, "'");
 				throw Service_denied();
@@ -347,6 +530,33 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			if (!tx_buf_size)
 				throw Service_denied();
 
+			if (zero_copy) {
+				unsigned const queue = _alloc_zero_copy_queue(num, writeable);
+
+				if (queue) {
+					Session::Queue_index const index { queue };
+
+					Session::Info info {
+						.block_size  = _block.info().block_size,
+						.block_count = _partition_table.partition(num).sectors,
+						.align_log2  = _block.info().align_log2,
+						.writeable   = writeable,
+					};
+
+					_zero_copy_sessions[num] = new (_heap)
+						Zero_copy_session(_env.ep(), info,
+						                  _block.queue_tx_cap(index), index);
+					return _zero_copy_sessions[num]->cap();
+				}
+
+				warning("zero-copy queue unavailable for '", label, "', "
+				        "copying payload");
+			}
+
+			unsigned const num_queues = (unsigned)
+				min(max(Arg_string::find_arg(args.string(), "queues").ulong_value(1), 1UL),
+				    (unsigned long)Session::MAX_QUEUES);
+
 			/* delete ram quota by the memory needed for the session */
 			size_t session_size = max((size_t)4096,
 			                          sizeof(Session_component));
@@ -358,9 +568,9 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			 * communication buffers. Also check both sizes separately
 			 * to handle a possible overflow of the sum of both sizes.
 			 */
-			if (tx_buf_size > ram_quota.value - session_size) {
+			if (tx_buf_size > (ram_quota.value - session_size) / num_queues) {
 				error("insufficient 'ram_quota', got ", ram_quota, ", need ",
-				     tx_buf_size + session_size);
+				     tx_buf_size*num_queues + session_size);
 				throw Insufficient_ram_quota();
 			}
 
@@ -372,13 +582,20 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 			};
 
 			_sessions[num] = new (_heap) Session_component(_env, num, tx_buf_size,
-			                                               info, *this);
+			                                               num_queues, info, *this);
 			return _sessions[num]->cap();
 		}
 
 		void close(Genode::Session_capability cap) override
 		{
 			for (long number = 0; number < MAX_SESSIONS; number++) {
+				if (_zero_copy_sessions[number] && cap == _zero_copy_sessions[number]->cap()) {
+					_revoke_zero_copy_queue(_zero_copy_sessions[number]->queue, number);
+					destroy(_heap, _zero_copy_sessions[number]);
+					_zero_copy_sessions[number] = nullptr;
+					return;
+				}
+
 				if (!_sessions[number] || !(cap == _sessions[number]->cap()))
 					continue;
 
@@ -424,7 +641,8 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 		void update() override { _block.update_jobs(*this); }
 
-		Response submit(long number, Request const &request, addr_t addr) override
+		Response submit(long number, unsigned queue, Request const &request,
+		                addr_t addr) override
 		{
 			Partition &partition = _partition_table.partition(number);
 			block_number_t last  = request.operation.block_number + request.operation.count;
@@ -442,13 +660,14 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				Operation op     = request.operation;
 				op.block_number += partition.lba;
 
-				job.construct(_block, op, _job_registry, index, number, request, addr);
+				job.construct(_block, op, _job_registry, index, number, queue,
+				              request, addr);
 			});
 
 			return Response::ACCEPTED;
 		}
 
-		Response sync(long number, Request const &request) override
+		Response sync(long number, unsigned queue, Request const &request) override
 		{
 			addr_t index = 0;
 			try {
@@ -457,7 +676,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 
 			_job_queue.with_job(index, [&](Job_object &job) {
 				job.construct(_block, request.operation, _job_registry,
-				              index, number, request, 0);
+				              index, number, queue, request, 0);
 			});
 
 			return Response::ACCEPTED;
@@ -479,7 +698,7 @@ class Block::Main : Rpc_object<Typed_root<Session>>,
 				if (!all && job.number != number)
 					return;
 
-				if (_sessions[job.number]->acknowledge(job.request))
+				if (_sessions[job.number]->acknowledge(job.queue, job.request))
 					_job_queue.free(index);
 			});
 		}
@@ -46,6 +46,7 @@ struct Block::Job : public Block_connection::Job
 
 	addr_t  const index;                /* job index */
 	long    const number;               /* parition number */
+	unsigned const queue;               /* request queue of the session */
 	Request       request;
 	addr_t  const addr;                 /* target payload address */
 	bool          completed { false };
@@ -56,11 +57,12 @@ struct Block::Job : public Block_connection::Job
 	    Registry<Job>    &registry,
 	    addr_t const      index,
 	    addr_t const      number,
+	    unsigned const    queue,
 	    Request           request,
 	    addr_t            addr)
 	: Block_connection::Job(connection, operation),
 	  registry_element(registry, *this),
-	  index(index), number(number), request(request), addr(addr) { }
+	  index(index), number(number), queue(queue), request(request), addr(addr) { }
 };
 
 
@@ -18,6 +18,7 @@
 #include <report_rom/report_service.h>
 #include <base/attached_rom_dataspace.h>
 #include <base/component.h>
+#include <rm_session/connection.h>
 
 /* local includes */
 #include "rom_registry.h"
@@ -32,12 +33,45 @@ struct Report_rom::Main
 
 	Genode::Sliced_heap sliced_heap { env.ram(), env.rm() };
 
-	Rom::Registry rom_registry { sliced_heap, env.ram(), env.rm(), config_rom };
+	Genode::Heap heap { env.ram(), env.rm() };
 
 	Genode::Attached_rom_dataspace config_rom { env, "config" };
 
 	bool verbose = config_rom.xml().attribute_value("verbose", false);
 
+	Genode::Constructible<Genode::Rm_connection> rm_connection { };
+
+	Genode::Constructible<Rom::Snapshot_env> snapshot_env { };
+
+	/*
+	 * Reports of at least 'snapshot_min_size' are shared among the readers
+	 * via read-only snapshots, which requires an RM session. Without it,
+	 * each reader obtains a private copy.
+	 */
+	Rom::Snapshot_env *_init_snapshot_env()
+	{
+		using namespace Genode;
+
+		Xml_node const config = config_rom.xml();
+
+		if (!config.attribute_value("shared_snapshots", true))
+			return nullptr;
+
+		try { rm_connection.construct(env); }
+		catch (...) {
+			warning("RM session unavailable, readers obtain copies of reports");
+			return nullptr;
+		}
+
+		snapshot_env.construct(heap, *rm_connection,
+		                       config.attribute_value("snapshot_min_size",
+		                                              Number_of_bytes(16*1024)));
+		return &*snapshot_env;
+	}
+
+	Rom::Registry rom_registry { sliced_heap, env.ram(), env.rm(), config_rom,
+	                             _init_snapshot_env() };
+
 	Report::Root report_root { env, sliced_heap, rom_registry, verbose };
 	Rom   ::Root    rom_root { env, sliced_heap, rom_registry };
 
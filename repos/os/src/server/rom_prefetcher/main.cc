@@ -17,12 +17,16 @@
 #include <base/log.h>
 #include <base/heap.h>
 #include <base/attached_rom_dataspace.h>
+#include <base/thread.h>
+#include <dataspace/client.h>
+#include <base/mutex.h>
 #include <timer_session/connection.h>
 #include <base/session_label.h>
 
 namespace Rom_prefetcher {
 	class Rom_session_component;
 	class Rom_root;
+	class Prefetch;
 	struct Main;
 }
 
@@ -101,6 +105,132 @@ class Rom_prefetcher::Rom_root : public Genode::Root_component<Rom_session_compo
 };
 
 
+/**
+ * Prefetch the ROM modules listed in the config by a number of threads
+ *
+ * Each thread picks the next ROM module of the list that is not yet
+ * taken by another thread. So the ROM modules are requested in the
+ * order of the list while the loading of several modules overlaps.
+ */
+class Rom_prefetcher::Prefetch
+{
+	private:
+
+		/*
+		 * Noncopyable
+		 */
+		Prefetch(Prefetch const &);
+		Prefetch &operator = (Prefetch const &);
+
+		typedef Genode::String<64> Name;
+
+		enum { MAX_THREADS = 16 };
+
+		/*
+		 * Each worker has a timer connection of its own because the
+		 * blocking 'msleep' of a connection must not be used by multiple
+		 * threads at a time.
+		 */
+		struct Worker : Genode::Thread
+		{
+			Prefetch &_prefetch;
+
+			Timer::Connection _timer;
+
+			Worker(Genode::Env &env, Prefetch &prefetch)
+			:
+				Genode::Thread(env, "prefetch", 4*1024*sizeof(long)),
+				_prefetch(prefetch), _timer(env)
+			{
+				start();
+			}
+
+			void entry() override { _prefetch._work(_timer); }
+		};
+
+		Genode::Env     &_env;
+		Genode::Xml_node _config;
+
+		/* protects '_next' */
+		Genode::Mutex _mutex { };
+
+		/* index of the next 'rom' node to prefetch */
+		unsigned _next = 0;
+
+		unsigned const _num_threads;
+
+		Genode::Constructible<Worker> _workers[MAX_THREADS] { };
+
+		/**
+		 * Return name of next ROM module, or an invalid name if all
+		 * modules are taken
+		 */
+		Name _take_next()
+		{
+			Genode::Mutex::Guard guard(_mutex);
+
+			Name name { };
+			unsigned i = 0;
+			_config.for_each_sub_node("rom", [&] (Genode::Xml_node entry) {
+				if (i++ == _next)
+					name = entry.attribute_value("name", Name());
+			});
+
+			if (_next < i)
+				_next++;
+
+			return name;
+		}
+
+		void _work(Timer::Connection &timer)
+		{
+			for (Name name = _take_next(); name.valid(); name = _take_next()) {
+
+				Genode::uint64_t const start_ms = timer.elapsed_ms();
+
+				try {
+					Genode::Rom_connection rom(_env, name.string());
+					Genode::Dataspace_client ds(rom.dataspace());
+
+					prefetch_dataspace(_env.rm(), rom.dataspace());
+
+					Genode::log("prefetched ROM module ", name, " (", ds.size() / 1024,
+					    " KiB) in ", timer.elapsed_ms() - start_ms, " ms");
+				} catch (...) {
+					Genode::error("could not open ROM module ", name);
+				}
+
+				/* let other components run between the prefetching of two modules */
+				timer.msleep(1);
+			}
+		}
+
+	public:
+
+		Prefetch(Genode::Env &env, Genode::Xml_node config)
+		:
+			_env(env), _config(config),
+			_num_threads(Genode::min(Genode::max(1U,
+			             config.attribute_value("threads", 1U)),
+			             (unsigned)MAX_THREADS))
+		{
+			for (unsigned i = 0; i < _num_threads; i++)
+				_workers[i].construct(_env, *this);
+		}
+
+		/**
+		 * Block until all ROM modules are prefetched
+		 */
+		void wait_for_completion()
+		{
+			for (unsigned i = 0; i < _num_threads; i++) {
+				_workers[i]->join();
+				_workers[i].destruct();
+			}
+		}
+};
+
+
 struct Rom_prefetcher::Main
 {
 	Genode::Env &_env;
@@ -115,22 +245,14 @@ struct Rom_prefetcher::Main
 	{
 		Timer::Connection timer(_env);
 
-		_config.xml().for_each_sub_node("rom", [&] (Genode::Xml_node entry) {
-
-			typedef Genode::String<64> Name;
-			Name const name = entry.attribute_value("name", Name());
+		Genode::uint64_t const start_ms = timer.elapsed_ms();
 
-			try {
-				Genode::Rom_connection rom(_env, name.string());
-				log("prefetching ROM module ", name);
-				prefetch_dataspace(_env.rm(), rom.dataspace());
-			} catch (...) {
-				error("could not open ROM module ", name);
-			}
+		{
+			Prefetch prefetch(_env, _config.xml());
+			prefetch.wait_for_completion();
+		}
 
-			/* yield */
-			timer.msleep(1);
-		});
+		Genode::log("prefetching finished after ", timer.elapsed_ms() - start_ms, " ms");
 
 		/* announce server */
 		_env.parent().announce(_env.ep().manage(_root));
@@ -16,6 +16,7 @@
 
 /* Genode includes */
 #include <root/component.h>
+#include <terminal_session/connection.h>
 
 /* local includes */
 #include "terminal_session_component.h"
@@ -38,16 +39,41 @@ namespace Terminal_crosslink {
 
 			int _session_state;
 
+			/**
+			 * Return ring capacity for the streaming mode requested by the
+			 * session arguments
+			 *
+			 * The streaming mode is declined if the donated RAM quota does
+			 * not cover the rings.
+			 */
+			static size_t _stream_capacity(Root::Session_args const &args)
+			{
+				size_t const stream_size =
+					Arg_string::find_arg(args.string(), "stream_size").ulong_value(0);
+
+				size_t const ram_quota =
+					Arg_string::find_arg(args.string(), "ram_quota").ulong_value(0);
+
+				if (Terminal::Connection::stream_quota(stream_size) > ram_quota) {
+					warning("insufficient RAM quota for stream_size=", stream_size);
+					return 0;
+				}
+
+				return Terminal::Stream::capacity(stream_size);
+			}
+
 		public:
 
-			Session_capability session(Root::Session_args const &,
+			Session_capability session(Root::Session_args const &args,
 			                           Genode::Affinity   const &) override
 			{
 				if (!(_session_state & FIRST_SESSION_OPEN)) {
 					_session_state |= FIRST_SESSION_OPEN;
+					_session_component1.stream_capacity(_stream_capacity(args));
 					return _session_component1.cap();
 				} else if (!(_session_state & SECOND_SESSION_OPEN)) {
 					_session_state |= SECOND_SESSION_OPEN;
+					_session_component2.stream_capacity(_stream_capacity(args));
 					return _session_component2.cap();
 				}
 
@@ -58,10 +84,13 @@ namespace Terminal_crosslink {
 
 			void close(Genode::Session_capability session) override
 			{
-				if (_session_component1.belongs_to(session))
+				if (_session_component1.belongs_to(session)) {
 					_session_state &= ~FIRST_SESSION_OPEN;
-				else
+					_session_component1.disable_stream();
+				} else {
 					_session_state &= ~SECOND_SESSION_OPEN;
+					_session_component2.disable_stream();
+				}
 			}
 
 			/**
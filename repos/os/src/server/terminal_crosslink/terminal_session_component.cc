@@ -28,11 +28,80 @@ Terminal_crosslink::Session_component::Session_component(Env &env,
   _partner(partner),
   _session_cap(_env.ep().rpc_ep().manage(this)),
   _io_buffer(env.ram(), env.rm(), BUFFER_SIZE),
-  _cross_num_bytes_avail(0)
+  _cross_num_bytes_avail(0),
+  _stream_handler(env.ep(), *this, &Session_component::_handle_stream)
 {
 }
 
 
+void Terminal_crosslink::Session_component::_notify_read_avail()
+{
+	if (_read_avail_sigh.valid())
+		Signal_transmitter(_read_avail_sigh).submit();
+}
+
+
+void Terminal_crosslink::Session_component::_forward()
+{
+	bool was_full = false;
+	size_t moved = 0;
+
+	if (_partner._stream.constructed()) {
+
+		Terminal::Stream::Producer &dst = _partner._stream->producer;
+
+		/* data written via RPC comes first */
+		while (!_buffer.empty() && dst.space()) {
+			unsigned char c = _buffer.get();
+			dst.write(&c, 1);
+			_cross_num_bytes_avail--;
+			moved++;
+		}
+
+		if (_stream.constructed() && _buffer.empty())
+			moved += _stream->consumer.consume(dst.space(), was_full,
+				[&] (char const *src, size_t n) { return dst.write(src, n); });
+
+		if (moved)
+			_partner._notify_read_avail();
+
+	} else if (_stream.constructed()) {
+
+		/* the partner reads via RPC from the local buffer */
+		moved = _stream->consumer.consume(_buffer.avail_capacity(), was_full,
+			[&] (char const *src, size_t n) {
+				for (size_t i = 0; i < n; i++)
+					_buffer.add(src[i]);
+				return n; });
+
+		_cross_num_bytes_avail += moved;
+
+		if (moved)
+			_partner._notify_read_avail();
+	}
+
+	/* the client may wait for space in the ring */
+	if (moved && was_full && _stream_client_sigh.valid())
+		Signal_transmitter(_stream_client_sigh).submit();
+}
+
+
+void Terminal_crosslink::Session_component::_handle_stream()
+{
+	/* the client wrote data or consumed data from its ring */
+	_forward();
+	_partner._forward();
+}
+
+
+void Terminal_crosslink::Session_component::disable_stream()
+{
+	_stream.destruct();
+	_stream_ds.destruct();
+	_stream_client_sigh = Signal_context_capability();
+}
+
+
 Session_capability Terminal_crosslink::Session_component::cap()
 {
 	return _session_cap;
@@ -64,6 +133,9 @@ size_t Terminal_crosslink::Session_component::cross_read(unsigned char *buf,
 
 	_cross_num_bytes_avail -= num_bytes_read;
 
+	/* refill the buffer from the stream */
+	_forward();
+
 	return num_bytes_read;
 }
 
@@ -105,6 +177,9 @@ size_t Terminal_crosslink::Session_component::_write(size_t num_bytes)
 	_cross_num_bytes_avail += num_bytes_written;
 	_partner.cross_write();
 
+	if (_partner._stream.constructed())
+		_forward();
+
 	return num_bytes_written;
 }
 
@@ -130,6 +205,35 @@ void Terminal_crosslink::Session_component::read_avail_sigh(Signal_context_capab
 }
 
 
+Dataspace_capability
+Terminal_crosslink::Session_component::stream(Signal_context_capability sigh)
+{
+	disable_stream();
+
+	if (!_stream_capacity)
+		return Dataspace_capability();
+
+	_stream_ds.construct(_env.ram(), _env.rm(),
+	                     Terminal::Stream::ds_size(_stream_capacity));
+
+	_stream.construct(_stream_ds->local_addr<void>(), _stream_capacity,
+	                  Terminal::Stream::Endpoint::SERVER);
+
+	_stream_client_sigh = sigh;
+
+	/* deliver data that the partner wrote before */
+	_partner._forward();
+
+	return _stream_ds->cap();
+}
+
+
+Signal_context_capability Terminal_crosslink::Session_component::stream_sigh()
+{
+	return _stream_handler;
+}
+
+
 size_t Terminal_crosslink::Session_component::read(void *, size_t)
 { return 0; }
 
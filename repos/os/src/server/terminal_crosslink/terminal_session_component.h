@@ -19,6 +19,7 @@
 #include <base/attached_ram_dataspace.h>
 #include <os/ring_buffer.h>
 #include <terminal_session/terminal_session.h>
+#include <terminal_session/stream.h>
 
 namespace Terminal_crosslink {
 
@@ -45,6 +46,25 @@ namespace Terminal_crosslink {
 			size_t                      _cross_num_bytes_avail;
 			Signal_context_capability   _read_avail_sigh { };
 
+			/*
+			 * Streaming mode
+			 */
+			size_t                                   _stream_capacity = 0;
+			Constructible<Attached_ram_dataspace>    _stream_ds  { };
+			Constructible<Terminal::Stream::Endpoint> _stream    { };
+			Signal_context_capability                _stream_client_sigh { };
+
+			Signal_handler<Session_component> _stream_handler;
+
+			void _handle_stream();
+
+			void _notify_read_avail();
+
+			/**
+			 * Forward data written by the client towards the partner
+			 */
+			void _forward();
+
 		public:
 
 			/**
@@ -59,6 +79,20 @@ namespace Terminal_crosslink {
 			 */
             bool belongs_to(Genode::Session_capability cap);
 
+			/**
+			 * Return to the RPC-based mode when the session gets closed
+			 */
+			void disable_stream();
+
+			/**
+			 * Set capacity of the rings used in streaming mode
+			 *
+			 * The rings are allocated from the RAM quota donated by the
+			 * client on session creation. A capacity of 0 declines the
+			 * streaming mode.
+			 */
+			void stream_capacity(size_t capacity) { _stream_capacity = capacity; }
+
 			/* to be called by the partner component */
 			bool cross_avail();
 			size_t cross_read(unsigned char *buf, size_t dst_len);
@@ -84,6 +118,10 @@ namespace Terminal_crosslink {
 
 			void size_changed_sigh(Genode::Signal_context_capability) override { }
 
+			Genode::Dataspace_capability stream(Genode::Signal_context_capability) override;
+
+			Genode::Signal_context_capability stream_sigh() override;
+
 			Genode::size_t read(void *, Genode::size_t) override;
 			Genode::size_t write(void const *, Genode::size_t) override;
 	};
@@ -193,7 +193,7 @@ class Vfs_server::Session_component : private Session_resources,
 				{
 					drop_packet_from_submit_queue();
 					packet.succeeded(false);
-					_stream.acknowledge_packet(packet);
+					_stream.try_ack_packet(packet);
 
 					overall_progress      = true;
 					progress_in_iteration = true;
@@ -220,6 +220,7 @@ class Vfs_server::Session_component : private Session_resources,
 							if (!node.enqueued())
 								_active_nodes.enqueue(node);
 							drop_packet_from_submit_queue();
+							_try_coalesce_reads(node);
 							break;
 
 						case Node::Submit_result::DENIED:
@@ -243,6 +244,29 @@ class Vfs_server::Session_component : private Session_resources,
 			return overall_progress;
 		}
 
+		/**
+		 * Append contiguous read requests from the submit queue to the job
+		 * just accepted by 'node'
+		 *
+		 * This way, a sequence of reads is served by one VFS read, which
+		 * spares the per-request overhead at the VFS plugins.
+		 */
+		void _try_coalesce_reads(Node &node)
+		{
+			while (_stream.packet_avail()) {
+
+				Packet_descriptor const packet = _stream.peek_packet();
+
+				if (packet.length() > packet.size() || !_stream.packet_valid(packet))
+					break;
+
+				if (!node.coalesce_read(packet))
+					break;
+
+				_stream.get_packet();
+			}
+		}
+
 		void _execute_jobs()
 		{
 			/* nodes with jobs that cannot make progress right now */
@@ -280,7 +304,7 @@ class Vfs_server::Session_component : private Session_resources,
 					 * acknowledgement.
 					 */
 					if (node.acknowledgement_pending()) {
-						_stream.acknowledge_packet(node.dequeue_acknowledgement());
+						_stream.try_ack_packet(node.dequeue_acknowledgement());
 						progress_in_iteration = true;
 					}
 
@@ -328,8 +352,10 @@ class Vfs_server::Session_component : private Session_resources,
 
 			for (;;) {
 
-				if (--iterations == 0)
+				if (--iterations == 0) {
+					_stream.wakeup();
 					return Process_packets_result::TOO_MUCH_PROGRESS;
+				}
 
 				/* true if progress can be made in this iteration */
 				bool progress_in_iteration = false;
@@ -345,6 +371,13 @@ class Vfs_server::Session_component : private Session_resources,
 
 				overall_progress |= progress_in_iteration;
 			}
+
+			/*
+			 * Acknowledgements of the whole batch are added to the ack
+			 * queue via 'try_ack_packet'. Signal the client only once.
+			 */
+			_stream.wakeup();
+
 			return overall_progress ? Process_packets_result::PROGRESS
 			                        : Process_packets_result::NONE;
 		}
@@ -117,6 +117,39 @@ class Vfs_server::Node : Node_space::Element, Node_queue::Element
 
 		Read_ready_state _read_ready_state { Read_ready_state::DONT_CARE };
 
+		/*
+		 * Read requests that directly follow the current READ job, both in
+		 * terms of the file position and the location within the bulk
+		 * buffer. Those requests are executed as one VFS read together with
+		 * '_packet' and are acknowledged individually after '_acked_packet'.
+		 */
+		enum { MAX_COALESCED_READS = 16 };
+
+		Packet_descriptor _coalesced_reads[MAX_COALESCED_READS] { };
+
+		unsigned _num_coalesced_reads = 0;
+
+		/* number of not yet delivered acknowledgements of coalesced reads */
+		unsigned _num_coalesced_acks = 0;
+
+		/*
+		 * Number of coalesced reads left unserved by a short VFS read,
+		 * stored after the acknowledged ones in '_coalesced_reads'
+		 */
+		unsigned _num_deferred_reads = 0;
+
+		/**
+		 * Turn deferred reads into a new job once all acknowledgements
+		 * of the current job are delivered
+		 */
+		virtual void _resume_deferred_reads() { }
+
+		void _resume_deferred_reads_if_acked()
+		{
+			if (_num_deferred_reads && !_acked_packet_valid && !_num_coalesced_acks)
+				_resume_deferred_reads();
+		}
+
 	public:
 
 		friend Node_queue;
@@ -174,7 +207,8 @@ class Vfs_server::Node : Node_space::Element, Node_queue::Element
 		bool acknowledgement_pending() const
 		{
 			return (_read_ready_state == Read_ready_state::READY)
-			     || _acked_packet_valid;
+			     || _acked_packet_valid
+			     || _num_coalesced_acks;
 		}
 
 		bool active() const
@@ -202,13 +236,32 @@ class Vfs_server::Node : Node_space::Element, Node_queue::Element
 
 			if (_acked_packet_valid) {
 				_acked_packet_valid = false;
+				_resume_deferred_reads_if_acked();
 				return _acked_packet;
 			}
 
+			if (_num_coalesced_acks) {
+				unsigned const i = _num_coalesced_reads - _num_coalesced_acks--;
+				Packet_descriptor const ack = _coalesced_reads[i];
+				_resume_deferred_reads_if_acked();
+				return ack;
+			}
+
 			Genode::warning("dequeue_acknowledgement called with no pending ack");
 			return Packet_descriptor();
 		}
 
+		/**
+		 * Append read request to the submitted job
+		 *
+		 * \return true if the packet became part of the current job
+		 *
+		 * The caller is expected to have checked the validity of the
+		 * packet. On success, the packet must be removed from the submit
+		 * queue.
+		 */
+		virtual bool coalesce_read(Packet_descriptor) { return false; }
+
 		/**
 		 * Return true if node was written to
 		 */
@@ -263,10 +316,14 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 			if (job_in_progress())
 				Genode::error("job unexpectedly submitted to busy node");
 
-			_packet             = packet;
-			_payload_ptr        = payload_ptr;
-			_acked_packet_valid = false;
-			_acked_packet       = Packet_descriptor { };
+			_packet              = packet;
+			_payload_ptr         = payload_ptr;
+			_acked_packet_valid  = false;
+			_acked_packet        = Packet_descriptor { };
+			_num_coalesced_reads = 0;
+			_num_coalesced_acks  = 0;
+			_num_deferred_reads  = 0;
+			_read_queued         = false;
 		}
 
 		void _acknowledge_as_success(size_t count)
@@ -306,6 +363,85 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 		 */
 		seek_off_t _initial_write_seek_offset { 0 };
 
+		/**
+		 * True once the VFS read of a coalescable READ job is queued
+		 */
+		bool _read_queued = false;
+
+		/**
+		 * Number of bytes requested by the current READ job including
+		 * the coalesced reads
+		 */
+		size_t _coalesced_read_length() const
+		{
+			size_t length = _packet.length();
+			for (unsigned i = 0; i < _num_coalesced_reads; i++)
+				length += _coalesced_reads[i].length();
+			return length;
+		}
+
+		/**
+		 * Acknowledge READ job and the coalesced reads
+		 *
+		 * The 'count' bytes read from the VFS are distributed over the
+		 * packets in the order of their file positions. A short read is
+		 * legal in the middle of a file whereas a zero-length acknowledgement
+		 * denotes the end of file to the client. Hence, coalesced reads
+		 * that got no data from a non-empty read are not acknowledged but
+		 * deferred to a new VFS read at the advanced position.
+		 */
+		void _acknowledge_coalesced_reads(bool success, file_size count)
+		{
+			file_size remaining = success ? count : 0;
+
+			auto consume = [&] (size_t length)
+			{
+				file_size const n = Genode::min((file_size)length, remaining);
+				remaining -= n;
+				return (size_t)n;
+			};
+
+			size_t const first_count = consume(_packet.length());
+
+			unsigned filled = 0;
+			for (; filled < _num_coalesced_reads; filled++) {
+
+				if (success && count && !remaining)
+					break;
+
+				Packet_descriptor &packet = _coalesced_reads[filled];
+				packet.length(consume(packet.length()));
+				packet.succeeded(success);
+			}
+			_num_deferred_reads  = _num_coalesced_reads - filled;
+			_num_coalesced_reads = filled;
+			_num_coalesced_acks  = filled;
+
+			if (success)
+				_acknowledge_as_success(first_count);
+			else
+				_acknowledge_as_failure();
+		}
+
+		void _resume_deferred_reads() override
+		{
+			Packet_descriptor const first = _coalesced_reads[_num_coalesced_reads];
+
+			char * const ptr = _payload_ptr.ptr + (first.offset() - _packet.offset());
+
+			unsigned const num_coalesced = _num_deferred_reads - 1;
+			for (unsigned i = 0; i < num_coalesced; i++)
+				_coalesced_reads[i] = _coalesced_reads[_num_coalesced_reads + 1 + i];
+
+			_packet              = first;
+			_payload_ptr         = Payload_ptr { ptr };
+			_num_coalesced_reads = num_coalesced;
+			_num_coalesced_acks  = 0;
+			_num_deferred_reads  = 0;
+			_read_queued         = false;
+			_packet_in_progress  = true;
+		}
+
 	protected:
 
 		Submit_result _submit_read_at(file_offset seek_offset)
@@ -325,6 +461,22 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 			                         : Submit_result::STALLED;
 		}
 
+		/**
+		 * Accept READ job without queuing the VFS read yet
+		 *
+		 * Queuing the read is deferred to '_execute_coalescable_read' to
+		 * give the session the chance to append subsequent contiguous read
+		 * requests to the job via 'coalesce_read'.
+		 */
+		Submit_result _submit_coalescable_read()
+		{
+			if (!(_mode & READ_ONLY))
+				return Submit_result::DENIED;
+
+			_packet_in_progress = true;
+			return Submit_result::ACCEPTED;
+		}
+
 		Submit_result _submit_write_at(file_offset seek_offset)
 		{
 			if (!(_mode & WRITE_ONLY))
@@ -399,6 +551,41 @@ class Vfs_server::Io_node : public Vfs_server::Node,
 			}
 		}
 
+		void _execute_coalescable_read(file_offset seek_offset)
+		{
+			size_t const length = _coalesced_read_length();
+
+			if (!_read_queued) {
+				_handle.seek(seek_offset);
+
+				/* retry on next execution if the VFS is congested */
+				if (!_handle.fs().queue_read(&_handle, length))
+					return;
+
+				_read_queued = true;
+			}
+
+			file_size out_count = 0;
+
+			switch (_handle.fs().complete_read(&_handle, _payload_ptr.ptr,
+			                                   length, out_count)) {
+			case Read_result::READ_OK:
+				_acknowledge_coalesced_reads(true, out_count);
+				break;
+
+			case Read_result::READ_ERR_IO:
+			case Read_result::READ_ERR_INVALID:
+				_acknowledge_coalesced_reads(false, 0);
+				break;
+
+			case Read_result::READ_ERR_WOULD_BLOCK:
+			case Read_result::READ_ERR_AGAIN:
+			case Read_result::READ_ERR_INTERRUPT:
+			case Read_result::READ_QUEUED:
+				break;
+			}
+		}
+
 		/**
 		 * Try to execute write operation at the VFS
 		 *
@@ -795,7 +982,7 @@ class Vfs_server::File : public Io_node
 
 			switch (packet.operation()) {
 
-			case Packet_descriptor::READ:            return _submit_read_at(_seek_pos());
+			case Packet_descriptor::READ:            return _submit_coalescable_read();
 			case Packet_descriptor::WRITE:           return _submit_write_at(_seek_pos());
 			case Packet_descriptor::SYNC:            return _submit_sync();
 			case Packet_descriptor::READ_READY:      return _submit_read_ready();
@@ -852,8 +1039,11 @@ class Vfs_server::File : public Io_node
 					break;
 				}
 
+			case Packet_descriptor::READ:
+				_execute_coalescable_read(_seek_pos());
+				break;
+
 			/* generic */
-			case Packet_descriptor::READ:            _execute_read(); break;
 			case Packet_descriptor::SYNC:            _execute_sync(); break;
 			case Packet_descriptor::WRITE_TIMESTAMP: _execute_write_timestamp(); break;
 
@@ -863,6 +1053,39 @@ class Vfs_server::File : public Io_node
 				break;
 			}
 		}
+
+		bool coalesce_read(Packet_descriptor const packet) override
+		{
+			/* the VFS read of the current job must not be queued yet */
+			if (!job_in_progress() || _read_queued)
+				return false;
+
+			if (_packet.operation()  != Packet_descriptor::READ
+			 || packet.operation()   != Packet_descriptor::READ
+			 || packet.handle().value != id().value)
+				return false;
+
+			if (_num_coalesced_reads == MAX_COALESCED_READS)
+				return false;
+
+			Packet_descriptor const &last = _num_coalesced_reads
+			                              ? _coalesced_reads[_num_coalesced_reads - 1]
+			                              : _packet;
+
+			if (last.position()   == (seek_off_t)SEEK_TAIL
+			 || packet.position() == (seek_off_t)SEEK_TAIL)
+				return false;
+
+			bool const contiguous =
+				(packet.position() == last.position() + (seek_off_t)last.length())
+			 && (packet.offset()   == last.offset()   + (Genode::off_t)last.length());
+
+			if (!contiguous)
+				return false;
+
+			_coalesced_reads[_num_coalesced_reads++] = packet;
+			return true;
+		}
 };
 
 
@@ -37,6 +37,9 @@ namespace Vfs_block {
 	File_info file_info_from_policy(Session_policy const &);
 	class File;
 
+	/* number of jobs processed concurrently per session */
+	enum { DEFAULT_JOBS = 1, MAX_JOBS = 32 };
+
 } /* namespace Vfs_block */
 
 
@@ -45,6 +48,8 @@ struct Vfs_block::File_info
 	File_path const path;
 	bool      const writeable;
 	size_t    const block_size;
+	unsigned  const jobs;
+	bool      const in_order;
 };
 
 
@@ -59,10 +64,18 @@ Vfs_block::File_info Vfs_block::file_info_from_policy(Session_policy const &poli
 	size_t const block_size =
 		policy.attribute_value("block_size", 512u);
 
+	unsigned const jobs =
+		policy.attribute_value("jobs", (unsigned)DEFAULT_JOBS);
+
+	bool const in_order =
+		policy.attribute_value("in_order", false);
+
 	return File_info {
 		.path       = file_path,
 		.writeable  = writeable,
-		.block_size = block_size };
+		.block_size = block_size,
+		.jobs       = max(1u, min(jobs, (unsigned)MAX_JOBS)),
+		.in_order   = in_order };
 }
 
 
@@ -74,9 +87,36 @@ class Vfs_block::File
 		File& operator=(const File&) = delete;
 
 		Vfs::File_system &_vfs;
-		Vfs::Vfs_handle  *_vfs_handle;
 
-		Constructible<Vfs_block::Job> _job { };
+		/*
+		 * Each job slot uses a VFS handle of its own because the file
+		 * position and the pending back-end operation are handle state.
+		 */
+		struct Slot
+		{
+			Vfs::Vfs_handle *handle { nullptr };
+
+			Constructible<Vfs_block::Job> job { };
+
+			/* index of the request queue the job originates from */
+			unsigned queue = 0;
+
+			/* submission order, used for in-order acknowledgement */
+			unsigned long seq = 0;
+
+			bool sync() const
+			{
+				return job.constructed()
+				    && job->request.operation.type == Block::Operation::Type::SYNC;
+			}
+		};
+
+		Slot _slots[MAX_JOBS] { };
+
+		unsigned       _num_jobs;
+		bool     const _in_order;
+
+		unsigned long _seq = 0;
 
 		struct Io_response_handler : Vfs::Io_response_handler
 		{
@@ -95,6 +135,66 @@ class Vfs_block::File
 
 		Block::Session::Info _block_info { };
 
+		template <typename FN>
+		void _for_each_job(FN const &fn)
+		{
+			for (unsigned i = 0; i < _num_jobs; i++)
+				if (_slots[i].job.constructed())
+					fn(_slots[i]);
+		}
+
+		Slot *_free_slot()
+		{
+			for (unsigned i = 0; i < _num_jobs; i++)
+				if (!_slots[i].job.constructed())
+					return &_slots[i];
+
+			return nullptr;
+		}
+
+		void _close_handles()
+		{
+			for (unsigned i = 0; i < _num_jobs; i++)
+				if (_slots[i].handle) {
+					_vfs.close(_slots[i].handle);
+					_slots[i].handle = nullptr;
+				}
+		}
+
+		/*
+		 * Return true if 'req' must wait for jobs in flight
+		 *
+		 * A SYNC request acts as barrier: it is started once all
+		 * previously accepted jobs are completed and no other request
+		 * is started before it is completed. Requests that access a
+		 * range that is currently written, or writes to a range that
+		 * is currently accessed, are deferred to retain the order of
+		 * conflicting requests.
+		 */
+		bool _conflicts(Block::Request const &req, file_offset offset,
+		                file_size length)
+		{
+			using Type = Block::Operation::Type;
+
+			bool conflict = false;
+			bool const sync  = req.operation.type == Type::SYNC;
+			bool const write = req.operation.type == Type::WRITE;
+
+			_for_each_job([&] (Slot &slot) {
+
+				if (sync || slot.sync()) {
+					conflict = true;
+					return;
+				}
+
+				if ((write || slot.job->writes())
+				 && slot.job->overlaps(offset, length))
+					conflict = true;
+			});
+
+			return conflict;
+		}
+
 	public:
 
 		File(Genode::Allocator         &alloc,
@@ -102,8 +202,9 @@ class Vfs_block::File
 		     Signal_context_capability  sigh,
 		     File_info           const &info)
 		:
-			_vfs        { vfs },
-			_vfs_handle { nullptr }
+			_vfs      { vfs },
+			_num_jobs { info.jobs },
+			_in_order { info.in_order }
 		{
 			using DS = Vfs::Directory_service;
 
@@ -111,19 +212,35 @@ class Vfs_block::File
 				info.writeable ? DS::OPEN_MODE_RDWR
 				               : DS::OPEN_MODE_RDONLY;
 
+			/*
+			 * Each job needs a handle of its own. If the file cannot be
+			 * opened multiple times, e.g., because the file system grants
+			 * exclusive access, fall back to fewer jobs.
+			 */
 			using Open_result = DS::Open_result;
-			Open_result res = _vfs.open(info.path.string(), mode,
-			                            &_vfs_handle, alloc);
-			if (res != Open_result::OPEN_OK) {
-				error("Could not open '", info.path.string(), "'");
-				throw Genode::Exception();
+			for (unsigned i = 0; i < _num_jobs; i++) {
+				Open_result res = _vfs.open(info.path.string(), mode,
+				                            &_slots[i].handle, alloc);
+				if (res == Open_result::OPEN_OK)
+					continue;
+
+				_slots[i].handle = nullptr;
+
+				if (i == 0) {
+					error("Could not open '", info.path.string(), "'");
+					throw Genode::Exception();
+				}
+
+				warning("could open '", info.path.string(), "' only ", i,
+				        " times, limiting number of jobs");
+				_num_jobs = i;
 			}
 
 			using Stat_result = DS::Stat_result;
 			Vfs::Directory_service::Stat stat { };
 			Stat_result stat_res = _vfs.stat(info.path.string(), stat);
 			if (stat_res != Stat_result::STAT_OK) {
-				_vfs.close(_vfs_handle);
+				_close_handles();
 				error("Could not stat '", info.path.string(), "'");
 				throw Genode::Exception();
 			}
@@ -139,12 +256,14 @@ class Vfs_block::File
 			};
 
 			_io_response_handler.sigh = sigh;
-			_vfs_handle->handler(&_io_response_handler);
+			for (unsigned i = 0; i < _num_jobs; i++)
+				_slots[i].handle->handler(&_io_response_handler);
 
 			log("Block session for file '", info.path.string(),
 			    "' with block count: ",     _block_info.block_count,
 			    " block size: ",            _block_info.block_size,
-				" writeable: ",             _block_info.writeable);
+				" writeable: ",             _block_info.writeable,
+			    " jobs: ",                  _num_jobs);
 		}
 
 		~File()
@@ -153,23 +272,22 @@ class Vfs_block::File
 			 * Sync is expected to be done through the Block
 			 * request stream, omit it here.
 			 */
-			_vfs.close(_vfs_handle);
+			for (unsigned i = 0; i < _num_jobs; i++)
+				_slots[i].job.destruct();
+
+			_close_handles();
 		}
 
 		Block::Session::Info block_info() const { return _block_info; }
 
 		bool execute()
 		{
-			if (!_job.constructed()) {
-				return false;
-			}
+			bool progress = false;
 
-			return _job->execute();
-		}
+			_for_each_job([&] (Slot &slot) {
+				progress |= slot.job->execute(); });
 
-		bool acceptable() const
-		{
-			return !_job.constructed();
+			return progress;
 		}
 
 		bool valid(Block::Request const &request)
@@ -195,28 +313,95 @@ class Vfs_block::File
 			}
 		}
 
-		void submit(Block::Request req, void *ptr, size_t length)
+		/**
+		 * Submit request
+		 *
+		 * The request is appended to a pending job if it is adjacent
+		 * to it, or else started as a new job.
+		 *
+		 * \return false if the request cannot be accepted at the moment
+		 *
+		 * \throw Job::Unsupported_Operation
+		 */
+		bool submit(Block::Request req, void *ptr, size_t length, unsigned queue)
 		{
 			file_offset const base_offset =
 				req.operation.block_number * _block_info.block_size;
 
-			_job.construct(*_vfs_handle, req, base_offset,
-			               reinterpret_cast<char*>(ptr), length);
+			char * const data = reinterpret_cast<char*>(ptr);
+
+			if (_conflicts(req, base_offset, length))
+				return false;
+
+			/*
+			 * Only the most recent job of the queue is extended to keep
+			 * the requests of the queue in submission order.
+			 */
+			Slot *last = nullptr;
+			_for_each_job([&] (Slot &slot) {
+				if (slot.queue == queue && (!last || slot.seq > last->seq))
+					last = &slot; });
+
+			if (last && last->job->try_append(req, base_offset, data, length))
+				return true;
+
+			Slot * const slot = _free_slot();
+			if (!slot)
+				return false;
+
+			slot->job.construct(*slot->handle, req, base_offset, data, length);
+			slot->queue = queue;
+			slot->seq   = _seq++;
+			return true;
 		}
 
+		/**
+		 * Return true if no job of 'queue' is pending or awaiting its
+		 * acknowledgement
+		 */
+		bool idle(unsigned queue)
+		{
+			bool idle = true;
+			_for_each_job([&] (Slot &slot) {
+				if (slot.queue == queue)
+					idle = false; });
+
+			return idle;
+		}
+
+		/**
+		 * Call 'fn' with a request of a completed job of 'queue'
+		 *
+		 * Completed jobs are acknowledged in any order unless the
+		 * 'in_order' policy attribute is set, in which case only the
+		 * oldest job of the queue is considered.
+		 */
 		template <typename FN>
-		void with_any_completed_job(FN const &fn)
+		void with_any_completed_job(unsigned queue, FN const &fn)
 		{
-			if (!_job.constructed() || !_job->completed()) {
-				return;
-			}
+			Slot *oldest = nullptr, *completed = nullptr;
+
+			_for_each_job([&] (Slot &slot) {
+
+				if (slot.queue != queue)
+					return;
+
+				if (!oldest || slot.seq < oldest->seq)
+					oldest = &slot;
 
-			Block::Request req = _job->request;
-			req.success = _job->succeeded();
+				if (slot.job->completed()
+				 && (!completed || slot.seq < completed->seq))
+					completed = &slot;
+			});
+
+			Slot * const slot = _in_order ? oldest : completed;
+			if (!slot || !slot->job->completed())
+				return;
 
-			_job.destruct();
+			slot->job->with_next_request(fn);
 
-			fn(req);
+			if (slot->job->acked())
+				slot->job.destruct();
 		}
 };
 
@@ -224,25 +409,65 @@ class Vfs_block::File
 struct Block_session_component : Rpc_object<Block::Session>,
                                  private Block::Request_stream
 {
-	Entrypoint &_ep;
+	Env &_env;
 
-	using Block::Request_stream::with_requests;
-	using Block::Request_stream::with_content;
-	using Block::Request_stream::try_acknowledge;
-	using Block::Request_stream::wakeup_client_if_needed;
+	Entrypoint &_ep;
 
 	Vfs_block::File &_file;
 
-	Block_session_component(Region_map                 &rm,
-	                        Entrypoint                 &ep,
+	Signal_context_capability const _sigh;
+
+	size_t const _tx_buf_size;
+
+	/*
+	 * Request queues in addition to the primary queue provided by the
+	 * inherited 'Request_stream'. All queues are served by the entrypoint
+	 * because the VFS must not be accessed concurrently.
+	 */
+	struct Queue
+	{
+		Attached_ram_dataspace ds;
+		Block::Request_stream  stream;
+
+		Queue(Env &env, size_t tx_buf_size, Signal_context_capability sigh,
+		      Block::Session::Info info)
+		:
+			ds     { env.ram(), env.rm(), tx_buf_size },
+			stream { env.rm(), ds.cap(), env.ep(), sigh, info }
+		{ }
+	};
+
+	Constructible<Queue> _queues[MAX_QUEUES - 1] { };
+
+	unsigned const _num_queues;
+
+	template <typename FN>
+	void _for_each_queue(FN const &fn)
+	{
+		fn((Block::Request_stream &)*this, 0u);
+
+		for (unsigned i = 1; i < _num_queues; i++)
+			fn(_queues[i - 1]->stream, i);
+	}
+
+	Block_session_component(Env                        &env,
 	                        Dataspace_capability        ds,
 	                        Signal_context_capability   sigh,
-	                        Vfs_block::File            &file)
+	                        Vfs_block::File            &file,
+	                        size_t                      tx_buf_size,
+	                        unsigned                    num_queues)
 	:
-		Request_stream { rm, ds, ep, sigh, file.block_info() },
-		_ep            { ep },
-		_file          { file }
+		Request_stream { env.rm(), ds, env.ep(), sigh, file.block_info() },
+		_env           { env },
+		_ep            { env.ep() },
+		_file          { file },
+		_sigh          { sigh },
+		_tx_buf_size   { tx_buf_size },
+		_num_queues    { max(1u, min(num_queues, (unsigned)MAX_QUEUES)) }
 	{
+		for (unsigned i = 1; i < _num_queues; i++)
+			_queues[i - 1].construct(env, tx_buf_size, sigh, file.block_info());
+
 		_ep.manage(*this);
 	}
 
@@ -252,55 +477,96 @@ struct Block_session_component : Rpc_object<Block::Session>,
 
 	Capability<Tx> tx_cap() override { return Request_stream::tx_cap(); }
 
+	Capability<Tx> queue_tx_cap(Queue_index index) override
+	{
+		if (index.value == 0)
+			return tx_cap();
+
+		if (index.value >= _num_queues)
+			return Capability<Tx>();
+
+		return _queues[index.value - 1]->stream.tx_cap();
+	}
+
+	bool restrict_queue(Queue_index index, Queue_window window) override
+	{
+		if (index.value == 0)
+			return Request_stream::restrict(window);
+
+		if (index.value >= _num_queues)
+			return false;
+
+		return _queues[index.value - 1]->stream.restrict(window);
+	}
+
+	bool reset_queue(Queue_index index) override
+	{
+		if (index.value == 0 || index.value >= _num_queues)
+			return false;
+
+		/* the jobs of the queue refer to its bulk buffer */
+		if (!_file.idle(index.value))
+			return false;
+
+		_queues[index.value - 1].construct(_env, _tx_buf_size, _sigh,
+		                                   _file.block_info());
+		return true;
+	}
+
 	void handle_request()
 	{
 		for (;;) {
 
 			bool progress = false;
 
-			with_requests([&] (Block::Request request) {
+			_for_each_queue([&] (Block::Request_stream &stream, unsigned queue) {
 
-				using Response = Block::Request_stream::Response;
+				stream.with_requests([&] (Block::Request request) {
 
-				if (!_file.acceptable()) {
-					return Response::RETRY;
-				}
+					using Response = Block::Request_stream::Response;
 
-				if (!_file.valid(request)) {
-					return Response::REJECTED;
-				}
+					if (!_file.valid(request)) {
+						return Response::REJECTED;
+					}
+
+					using Op = Block::Operation;
+					bool const payload =
+						Op::has_payload(request.operation.type);
+
+					Response response = Response::REJECTED;
+
+					auto submit = [&] (void *ptr, size_t size) {
+						response = _file.submit(request, ptr, size, queue)
+						         ? Response::ACCEPTED : Response::RETRY; };
 
-				using Op = Block::Operation;
-				bool const payload =
-					Op::has_payload(request.operation.type);
-
-				try {
-					if (payload) {
-						with_content(request,
-						[&] (void *ptr, size_t size) {
-							_file.submit(request, ptr, size);
-						});
-					} else {
-						_file.submit(request, nullptr, 0);
+					try {
+						if (payload) {
+							stream.with_content(request, submit);
+						} else {
+							submit(nullptr, 0);
+						}
+					} catch (Vfs_block::Job::Unsupported_Operation) {
+						return Response::REJECTED;
 					}
-				} catch (Vfs_block::Job::Unsupported_Operation) {
-					return Response::REJECTED;
-				}
 
-				progress |= true;
-				return Response::ACCEPTED;
+					progress |= (response == Response::ACCEPTED);
+					return response;
+				});
 			});
 
 			progress |= _file.execute();
 
-			try_acknowledge([&] (Block::Request_stream::Ack &ack) {
+			_for_each_queue([&] (Block::Request_stream &stream, unsigned queue) {
+
+				stream.try_acknowledge([&] (Block::Request_stream::Ack &ack) {
 
-				auto ack_request = [&] (Block::Request request) {
-					ack.submit(request);
-					progress |= true;
-				};
+					auto ack_request = [&] (Block::Request request) {
+						ack.submit(request);
+						progress |= true;
+					};
 
-				_file.with_any_completed_job(ack_request);
+					_file.with_any_completed_job(queue, ack_request);
+				});
 			});
 
 			if (!progress) {
@@ -308,7 +574,8 @@ struct Block_session_component : Rpc_object<Block::Session>,
 			}
 		}
 
-		wakeup_client_if_needed();
+		_for_each_queue([&] (Block::Request_stream &stream, unsigned) {
+			stream.wakeup_client_if_needed(); });
 	}
 };
 
@@ -355,9 +622,13 @@ struct Main : Rpc_object<Typed_root<Block::Session>>
 			Arg_string::find_arg(args.string(),
 			                     "tx_buf_size").aligned_size();
 
+		unsigned const num_queues = (unsigned)
+			min(max(Arg_string::find_arg(args.string(), "queues").ulong_value(1), 1UL),
+			    (unsigned long)Block::Session::MAX_QUEUES);
+
 		Ram_quota const ram_quota = ram_quota_from_args(args.string());
 
-		if (tx_buf_size > ram_quota.value) {
+		if (tx_buf_size*num_queues > ram_quota.value) {
 			warning("communication buffer size exceeds session quota");
 			throw Insufficient_ram_quota();
 		}
@@ -380,9 +651,9 @@ struct Main : Rpc_object<Typed_root<Block::Session>>
 			_block_ds.construct(_env.ram(), _env.rm(), tx_buf_size);
 			_block_file.construct(_heap, _vfs_env.root_dir(),
 			                      _request_handler, file_info);
-			_block_session.construct(_env.rm(), _env.ep(),
-			                         _block_ds->cap(),
-			                         _request_handler, *_block_file);
+			_block_session.construct(_env, _block_ds->cap(),
+			                         _request_handler, *_block_file,
+			                         tx_buf_size, num_queues);
 
 			return _block_session->cap();
 		} catch (...) {
@@ -21,6 +21,11 @@ namespace Vfs_block {
 
 	struct Job
 	{
+		/*
+		 * Maximum number of requests that are coalesced into one job
+		 */
+		enum { MAX_REQUESTS = 16 };
+
 		struct Unsupported_Operation : Genode::Exception { };
 		struct Invalid_state         : Genode::Exception { };
 
@@ -53,6 +58,14 @@ namespace Vfs_block {
 		Vfs::Vfs_handle &_handle;
 
 		Block::Request const request;
+
+		/* requests appended to 'request' by coalescing */
+		Block::Request _appended[MAX_REQUESTS - 1] { };
+		unsigned       _num_appended = 0;
+
+		/* number of requests already handed out for acknowledgement */
+		unsigned _num_acked = 0;
+
 		char              *data;
 		State              state;
 		file_offset const  base_offset;
@@ -267,9 +280,81 @@ namespace Vfs_block {
 		bool completed() const { return complete; }
 		bool succeeded()   const { return success; }
 
+		/**
+		 * Return true if the file range of the job overlaps the given range
+		 */
+		bool overlaps(file_offset offset, file_size length) const
+		{
+			file_offset const job_end = base_offset + current_offset
+			                          + (file_offset)current_count;
+
+			return offset < job_end
+			    && base_offset < offset + (file_offset)length;
+		}
+
+		bool writes() const {
+			return request.operation.type == Block::Operation::Type::WRITE; }
+
+		/**
+		 * Try to append an adjacent request to the job
+		 *
+		 * A request is appended if it is of the same type as the job,
+		 * directly follows the job within the file as well as within the
+		 * packet-stream buffer, and the job has not been started yet.
+		 * The job is then executed as one larger VFS operation.
+		 *
+		 * \return true if the request was appended
+		 */
+		bool try_append(Block::Request const &other, file_offset offset,
+		                char *other_data, file_size length)
+		{
+			using Type = Block::Operation::Type;
+
+			Type const type = request.operation.type;
+
+			if (type != Type::READ && type != Type::WRITE)
+				return false;
+
+			if (other.operation.type != type
+			 || state != State::PENDING || current_offset != 0
+			 || _num_appended == MAX_REQUESTS - 1)
+				return false;
+
+			if (offset != base_offset + (file_offset)current_count
+			 || other_data != data + current_count)
+				return false;
+
+			_appended[_num_appended++] = other;
+			current_count += length;
+			return true;
+		}
+
+		/**
+		 * Return true if all requests of the completed job were handed out
+		 */
+		bool acked() const { return _num_acked == _num_appended + 1; }
+
+		/**
+		 * Call 'fn' with the next request of the completed job to acknowledge
+		 */
+		template <typename FN>
+		void with_next_request(FN const &fn)
+		{
+			if (!complete || acked())
+				return;
+
+			Block::Request req = _num_acked ? _appended[_num_acked - 1]
+			                                : request;
+			req.success = success;
+			_num_acked++;
+
+			fn(req);
+		}
+
 		void print(Genode::Output &out) const
 		{
 			Genode::print(out, "(", request.operation, ")",
+				" requests: ",       _num_appended + 1,
 				" state: ",          _state_to_string(state),
 				" base_offset: ",    base_offset,
 				" current_offset: ", current_offset,
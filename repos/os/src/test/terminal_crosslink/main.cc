@@ -28,7 +28,8 @@ namespace Test_terminal_crosslink {
 	enum {
 		STACK_SIZE          = sizeof(addr_t)*1024,
 		TEST_DATA_SIZE      = 4097,
-		READ_BUFFER_SIZE    = 8192
+		READ_BUFFER_SIZE    = 8192,
+		BULK_DATA_SIZE      = 512*1024
 	};
 
 	static const char *client_text = "Hello from client.";
@@ -45,21 +46,28 @@ class Test_terminal_crosslink::Partner : public Thread
 {
 	protected:
 
+		Signal_receiver _sig_rec   { };
+		Signal_context  _sig_ctx   { };
+		Signal_context  _space_ctx { };
+
 		Terminal::Connection _terminal;
 
 		char _read_buffer[READ_BUFFER_SIZE];
 
-		Signal_receiver _sig_rec { };
-		Signal_context  _sig_ctx { };
-
 		void _write_all(void const *buf, Genode::size_t num_bytes)
 		{
 			Genode::size_t written_bytes = 0;
 			char const * const src       = (char const *)buf;
 
 			while (written_bytes < num_bytes) {
-				written_bytes += _terminal.write(&src[written_bytes],
-				                                 num_bytes - written_bytes);
+				Genode::size_t const n = _terminal.write(&src[written_bytes],
+				                                         num_bytes - written_bytes);
+
+				/* wait until the server consumed data from the full ring */
+				if (!n)
+					_sig_rec.wait_for_signal();
+
+				written_bytes += n;
 			}
 		}
 
@@ -69,7 +77,8 @@ class Test_terminal_crosslink::Partner : public Thread
 			char * const dst = (char *)buf;
 
 			while (read_bytes < buf_size) {
-				_sig_rec.wait_for_signal();
+				if (!_terminal.avail())
+					_sig_rec.wait_for_signal();
 				read_bytes += _terminal.read(&dst[read_bytes],
 				                             buf_size - read_bytes);
 			}
@@ -79,7 +88,7 @@ class Test_terminal_crosslink::Partner : public Thread
 
 		Partner(Env &env, char const *name)
 		: Thread(env, name, STACK_SIZE),
-		  _terminal(env)
+		  _terminal(env, "", 16*1024, _sig_rec.manage(&_space_ctx))
 		{
 			_terminal.read_avail_sigh(_sig_rec.manage(&_sig_ctx));
 		}
@@ -118,6 +127,16 @@ class Test_terminal_crosslink::Client : public Partner
 			memset(test_data, 5, sizeof(test_data));
 			_write_all(test_data, sizeof(test_data));
 
+			/* write more data than fits into the buffers of the server */
+
+			log("Bulk transfer test");
+
+			for (size_t offset = 0; offset < BULK_DATA_SIZE; offset += READ_BUFFER_SIZE) {
+				for (size_t i = 0; i < READ_BUFFER_SIZE; i++)
+					_read_buffer[i] = (char)(offset + i);
+				_write_all(_read_buffer, READ_BUFFER_SIZE);
+			}
+
 			_read_all(_read_buffer, strlen(bye_text) + 1);
 			log("Client received: ", Cstring(_read_buffer));
 			if (strcmp(_read_buffer, bye_text) != 0) {
@@ -163,6 +182,27 @@ class Test_terminal_crosslink::Server : public Partner
 					sleep_forever();
 				}
 
+			/* read bulk data */
+
+			for (size_t offset = 0; offset < BULK_DATA_SIZE; ) {
+
+				if (!_terminal.avail())
+					_sig_rec.wait_for_signal();
+
+				size_t const n = _terminal.read(_read_buffer,
+				                                min((size_t)READ_BUFFER_SIZE,
+				                                    BULK_DATA_SIZE - offset));
+				for (size_t i = 0; i < n; i++)
+					if (_read_buffer[i] != (char)(offset + i)) {
+						error("Received bulk data is not as expected");
+						sleep_forever();
+					}
+
+				offset += n;
+			}
+
+			log("Server received ", (size_t)BULK_DATA_SIZE, " bytes of bulk data");
+
 			_write_all(bye_text, strlen(bye_text) + 1);
 		}
 };